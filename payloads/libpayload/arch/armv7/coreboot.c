@@ -126,6 +126,12 @@ static void cb_parse_mrc_cache(unsigned char *ptr, struct sysinfo_t *info)
 	info->mrc_cache = phys_to_virt(cbmem->cbmem_tab);
 }
 
+static void cb_parse_cbfs_cache(unsigned char *ptr, struct sysinfo_t *info)
+{
+	struct cb_cbmem_tab *const cbmem = (struct cb_cbmem_tab *)ptr;
+	info->cbfs_cache = phys_to_virt(cbmem->cbmem_tab);
+}
+
 #ifdef CONFIG_NVRAM
 static void cb_parse_optiontable(void *ptr, struct sysinfo_t *info)
 {
@@ -268,6 +274,9 @@ static int cb_parse_header(void *addr, int len, struct sysinfo_t *info)
 		case CB_TAG_MRC_CACHE:
 			cb_parse_mrc_cache(ptr, info);
 			break;
+		case CB_TAG_CBFS_CACHE:
+			cb_parse_cbfs_cache(ptr, info);
+			break;
 		}
 
 		ptr += rec->size;
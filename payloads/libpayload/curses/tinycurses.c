@@ -167,6 +167,145 @@ char sprintf_tmp[1024];
 
 int curses_flags = (F_ENABLE_CONSOLE | F_ENABLE_SERIAL);
 
+/*
+ * The screen as the windows last left it (screen_new) and as the console
+ * shows it (screen_cur). wnoutrefresh() only copies the changed cells of
+ * a window into screen_new; doupdate() then sends out the cells in the
+ * damaged spans that really differ. Menus that wclear() and redraw
+ * everything on each key press thus only cost what actually changed.
+ */
+struct screen_cell {
+	chtype ch;
+	attr_t attr;
+};
+
+/* Nothing matches this, so the cell gets drawn. */
+#define SCREEN_UNKNOWN ((chtype)-1)
+
+static struct screen_cell screen_new[SCREEN_Y][SCREEN_X];
+static struct screen_cell screen_cur[SCREEN_Y][SCREEN_X];
+static NCURSES_SIZE_T screen_first[SCREEN_Y], screen_last[SCREEN_Y];
+static int screen_cury, screen_curx;
+
+#ifdef CONFIG_SERIAL_CONSOLE
+struct serial_state {
+	int is_bold;
+	int is_reverse;
+	int is_altcharset;
+	int cur_pair;
+	int y, x;	/* where the terminal's cursor is, -1 if unknown */
+};
+
+static void serial_put_cell(struct serial_state *serial,
+			    const struct screen_cell *cell)
+{
+	chtype ch = cell->ch;
+	attr_t attr = cell->attr;
+	int need_altcharset;
+	short fg, bg;
+
+	if (attr & A_BOLD) {
+		if (!serial->is_bold) {
+			serial_start_bold();
+			serial->is_bold = 1;
+		}
+	} else {
+		if (serial->is_bold) {
+			serial_end_bold();
+			serial->is_bold = 0;
+			/* work around serial.c
+			 * shortcoming:
+			 */
+			serial->is_reverse = 0;
+			serial->cur_pair = 0;
+		}
+	}
+
+	if (attr & A_REVERSE) {
+		if (!serial->is_reverse) {
+			serial_start_reverse();
+			serial->is_reverse = 1;
+		}
+	} else {
+		if (serial->is_reverse) {
+			serial_end_reverse();
+			serial->is_reverse = 0;
+			/* work around serial.c
+			 * shortcoming:
+			 */
+			serial->is_bold = 0;
+			serial->cur_pair = 0;
+		}
+	}
+
+	need_altcharset = 0;
+	if (attr & A_ALTCHARSET) {
+		if (serial_acs_map[ch & 0x7f]) {
+			ch = serial_acs_map[ch & 0x7f];
+			need_altcharset = 1;
+		} else
+			ch = fallback_acs_map[ch & 0x7f];
+	}
+	if (need_altcharset && !serial->is_altcharset) {
+		serial_start_altcharset();
+		serial->is_altcharset = 1;
+	}
+	if (!need_altcharset && serial->is_altcharset) {
+		serial_end_altcharset();
+		serial->is_altcharset = 0;
+	}
+
+	if (serial->cur_pair != PAIR_NUMBER(attr)) {
+		pair_content(PAIR_NUMBER(attr), &fg, &bg);
+		serial_set_color(fg, bg);
+		serial->cur_pair = PAIR_NUMBER(attr);
+	}
+
+	serial_putchar(ch);
+	serial->x++;
+}
+#endif
+
+#ifdef CONFIG_VIDEO_CONSOLE
+#define SWAP_RED_BLUE(c) \
+	(((c) & 0x4400) >> 2) | ((c) & 0xAA00) | (((c) & 0x1100) << 2)
+
+static void video_put_cell(int y, int x, const struct screen_cell *cell)
+{
+	chtype ch = cell->ch;
+	attr_t attr = cell->attr;
+	unsigned int c = ((int)color_pairs[PAIR_NUMBER(attr)]) << 8;
+
+	c = SWAP_RED_BLUE(c);
+
+	/* Handle some of the attributes. */
+	if (attr & A_BOLD)
+		c |= 0x0800;
+	if (attr & A_DIM)
+		c &= ~0x800;
+	if (attr & A_REVERSE) {
+		unsigned char tmp = (c >> 8) & 0xf;
+		c = (c >> 4) & 0xf00;
+		c |= tmp << 12;
+	}
+	if (attr & A_ALTCHARSET) {
+		if (console_acs_map[ch & 0x7f])
+			ch = console_acs_map[ch & 0x7f];
+		else
+			ch = fallback_acs_map[ch & 0x7f];
+	}
+
+	/*
+	 * FIXME: Somewhere along the line, the
+	 * character value is getting sign-extented.
+	 * For now grab just the 8 bit character,
+	 * but this will break wide characters!
+	 */
+	c |= (chtype) (ch & 0xff);
+	video_console_putc(y, x, c);
+}
+#endif
+
 /* Return bit mask for clearing color pair number if given ch has color */
 #define COLOR_MASK(ch) (~(attr_t)((ch) & A_COLOR ? A_COLOR : 0))
 
@@ -277,7 +416,74 @@ WINDOW *derwin(WINDOW *orig, int num_lines, int num_columns, int begy, int begx)
 	return NULL;
 #endif
 }
-int doupdate(void) { /* TODO */ return(0); }
+int doupdate(void)
+{
+#ifdef CONFIG_SERIAL_CONSOLE
+	struct serial_state serial = { .y = -1, .x = -1 };
+#endif
+	struct screen_cell *new, *cur;
+	int x, y;
+
+#ifdef CONFIG_SERIAL_CONSOLE
+	serial_end_bold();
+	serial_end_altcharset();
+#endif
+
+	for (y = 0; y < SCREEN_Y; y++) {
+
+		if (screen_first[y] == _NOCHANGE)
+			continue;
+
+		for (x = screen_first[y]; x <= screen_last[y]; x++) {
+			new = &screen_new[y][x];
+			cur = &screen_cur[y][x];
+			if (new->ch == cur->ch && new->attr == cur->attr)
+				continue;
+
+#ifdef CONFIG_SERIAL_CONSOLE
+			if (curses_flags & F_ENABLE_SERIAL) {
+				/*
+				 * Reprinting a few unchanged cells is shorter
+				 * than a cursor motion sequence.
+				 */
+				if (serial.y == y && serial.x <= x &&
+				    serial.x + 4 >= x) {
+					while (serial.x < x &&
+					       screen_cur[y][serial.x].ch !=
+					       SCREEN_UNKNOWN)
+						serial_put_cell(&serial,
+							&screen_cur[y][serial.x]);
+				}
+				if (serial.y != y || serial.x != x) {
+					serial_set_cursor(y, x);
+					serial.y = y;
+					serial.x = x;
+				}
+				serial_put_cell(&serial, new);
+			}
+#endif
+#ifdef CONFIG_VIDEO_CONSOLE
+			if (curses_flags & F_ENABLE_CONSOLE)
+				video_put_cell(y, x, new);
+#endif
+			*cur = *new;
+		}
+		screen_first[y] = _NOCHANGE;
+		screen_last[y] = _NOCHANGE;
+	}
+
+#ifdef CONFIG_SERIAL_CONSOLE
+	if (curses_flags & F_ENABLE_SERIAL)
+		serial_set_cursor(screen_cury, screen_curx);
+#endif
+
+#ifdef CONFIG_VIDEO_CONSOLE
+	if (curses_flags & F_ENABLE_CONSOLE)
+		video_console_set_cursor(screen_curx, screen_cury);
+#endif
+
+	return OK;
+}
 // WINDOW * dupwin (WINDOW *) {}
 /* D */ int echo(void) { SP->_echo = TRUE; return OK; }
 int endwin(void)
@@ -308,7 +514,7 @@ void immedok(WINDOW *win, bool flag) { win->_immed = flag; }
 /** Note: Must _not_ be called twice! */
 WINDOW *initscr(void)
 {
-	int i;
+	int i, x, y;
 
 	// newterm(name, stdout, stdin);
 	// def_prog_mode();
@@ -331,6 +537,14 @@ WINDOW *initscr(void)
 
 	// Speaker init?
 
+	/* We don't know what's on the screen, so draw everything once. */
+	for (y = 0; y < SCREEN_Y; y++) {
+		for (x = 0; x < SCREEN_X; x++)
+			screen_cur[y][x].ch = SCREEN_UNKNOWN;
+		screen_first[y] = _NOCHANGE;
+		screen_last[y] = _NOCHANGE;
+	}
+
 	stdscr = newwin(SCREEN_Y, SCREEN_X, 0, 0);
 	// TODO: curscr, newscr?
 
@@ -715,160 +929,35 @@ int whline(WINDOW *win, chtype ch, int n)
 	return OK;
 }
 
-#define SWAP_RED_BLUE(c) \
-	(((c) & 0x4400) >> 2) | ((c) & 0xAA00) | (((c) & 0x1100) << 2)
 int wnoutrefresh(WINDOW *win)
 {
-#ifdef CONFIG_SERIAL_CONSOLE
-	// FIXME.
-	int serial_is_bold = 0;
-	int serial_is_reverse = 0;
-	int serial_is_altcharset = 0;
-	int serial_cur_pair = 0;
-
-	int need_altcharset;
-	short fg, bg;
-#endif
-	int x, y;
-	chtype ch;
-
-#ifdef CONFIG_SERIAL_CONSOLE
-	serial_end_bold();
-	serial_end_altcharset();
-#endif
+	int x, y, sx, sy;
 
 	for (y = 0; y <= win->_maxy; y++) {
 
 		if (win->_line[y].firstchar == _NOCHANGE)
 			continue;
 
-		/* Position the serial cursor */
-
-#ifdef CONFIG_SERIAL_CONSOLE
-		if (curses_flags & F_ENABLE_SERIAL)
-			serial_set_cursor(win->_begy + y, win->_begx +
-					win->_line[y].firstchar);
-#endif
-
+		sy = win->_begy + y;
 		for (x = win->_line[y].firstchar; x <= win->_line[y].lastchar; x++) {
-			attr_t attr = win->_line[y].text[x].attr;
-
-#ifdef CONFIG_SERIAL_CONSOLE
-			if (curses_flags & F_ENABLE_SERIAL) {
-				ch = win->_line[y].text[x].chars[0];
-
-				if (attr & A_BOLD) {
-					if (!serial_is_bold) {
-						serial_start_bold();
-						serial_is_bold = 1;
-					}
-				} else {
-					if (serial_is_bold) {
-						serial_end_bold();
-						serial_is_bold = 0;
-						/* work around serial.c
-						 * shortcoming:
-						 */
-						serial_is_reverse = 0;
-						serial_cur_pair = 0;
-					}
-				}
-
-				if (attr & A_REVERSE) {
-					if (!serial_is_reverse) {
-						serial_start_reverse();
-						serial_is_reverse = 1;
-					}
-				} else {
-					if (serial_is_reverse) {
-						serial_end_reverse();
-						serial_is_reverse = 0;
-						/* work around serial.c
-						 * shortcoming:
-						 */
-						serial_is_bold = 0;
-						serial_cur_pair = 0;
-					}
-				}
-
-				need_altcharset = 0;
-				if (attr & A_ALTCHARSET) {
-					if (serial_acs_map[ch & 0x7f]) {
-						ch = serial_acs_map[ch & 0x7f];
-						need_altcharset = 1;
-					} else
-						ch = fallback_acs_map[ch & 0x7f];
-				}
-				if (need_altcharset && !serial_is_altcharset) {
-					serial_start_altcharset();
-					serial_is_altcharset = 1;
-				}
-				if (!need_altcharset && serial_is_altcharset) {
-					serial_end_altcharset();
-					serial_is_altcharset = 0;
-				}
-
-				if (serial_cur_pair != PAIR_NUMBER(attr)) {
-					pair_content(PAIR_NUMBER(attr),
-						     &fg, &bg);
-					serial_set_color(fg, bg);
-					serial_cur_pair = PAIR_NUMBER(attr);
-				}
-
-				serial_putchar(ch);
+			sx = win->_begx + x;
+			if (sy < 0 || sy >= SCREEN_Y || sx < 0 || sx >= SCREEN_X)
+				continue;
 
-			}
-#endif
-#ifdef CONFIG_VIDEO_CONSOLE
-			unsigned int c =
-				((int)color_pairs[PAIR_NUMBER(attr)]) << 8;
-
-			c = SWAP_RED_BLUE(c);
-
-			if (curses_flags & F_ENABLE_CONSOLE) {
-				ch = win->_line[y].text[x].chars[0];
-
-				/* Handle some of the attributes. */
-				if (attr & A_BOLD)
-					c |= 0x0800;
-				if (attr & A_DIM)
-					c &= ~0x800;
-				if (attr & A_REVERSE) {
-					unsigned char tmp = (c >> 8) & 0xf;
-					c = (c >> 4) & 0xf00;
-					c |= tmp << 12;
-				}
-				if (attr & A_ALTCHARSET) {
-					if (console_acs_map[ch & 0x7f])
-						ch = console_acs_map[ch & 0x7f];
-					else
-						ch = fallback_acs_map[ch & 0x7f];
-				}
+			screen_new[sy][sx].ch = win->_line[y].text[x].chars[0];
+			screen_new[sy][sx].attr = win->_line[y].text[x].attr;
 
-				/*
-				 * FIXME: Somewhere along the line, the
-				 * character value is getting sign-extented.
-				 * For now grab just the 8 bit character,
-				 * but this will break wide characters!
-				 */
-				c |= (chtype) (ch & 0xff);
-				video_console_putc(win->_begy + y, win->_begx + x, c);
-			}
-#endif
+			if (screen_first[sy] == _NOCHANGE || sx < screen_first[sy])
+				screen_first[sy] = sx;
+			if (screen_last[sy] == _NOCHANGE || sx > screen_last[sy])
+				screen_last[sy] = sx;
 		}
 		win->_line[y].firstchar = _NOCHANGE;
 		win->_line[y].lastchar = _NOCHANGE;
 	}
 
-#ifdef CONFIG_SERIAL_CONSOLE
-	if (curses_flags & F_ENABLE_SERIAL)
-		serial_set_cursor(win->_begy + win->_cury, win->_begx + win->_curx);
-#endif
-
-#ifdef CONFIG_VIDEO_CONSOLE
-	if (curses_flags & F_ENABLE_CONSOLE)
-		video_console_set_cursor(win->_begx + win->_curx, win->_begy + win->_cury);
-#endif
+	screen_cury = win->_begy + win->_cury;
+	screen_curx = win->_begx + win->_curx;
 
 	return OK;
 }
@@ -898,19 +987,10 @@ int wredrawln (WINDOW *win, int beg_line, int num_lines)
 
 int wrefresh(WINDOW *win)
 {
-	// FIXME
-	return wnoutrefresh(win);
-
-	// XXX
 	int code;
 
-	if (win == curscr) {
-		curscr->_clear = TRUE;
-		// code = doupdate();
-	} else if ((code = wnoutrefresh(win)) == OK) {
-		if (win->_clear)
-			newscr->_clear = TRUE;
-		// code = doupdate();
+	if ((code = wnoutrefresh(win)) == OK) {
+		code = doupdate();
 		/*
 		 * Reset the clearok() flag in case it was set for the special
 		 * case in hardscroll.c (if we don't reset it here, we'll get 2
@@ -189,11 +189,11 @@ static ssize_t ahci_cmdslot_exec(ahci_dev_t *const dev)
 	dev->port->cmd_issue |= (1 << slotnum);
 
 	/* Wait for the controller to finish command execution. */
-	int timeout = 50000; /* Time out after 50000 * 100us == 5s. */
+	int timeout = 5000000; /* Time out after 5000000 * 1us == 5s. */
 	while ((dev->port->cmd_issue & (1 << slotnum)) &&
 			!(dev->port->intr_status & HBA_PxIS_TFES) &&
 			timeout--)
-		udelay(100);
+		udelay(1);
 	if (timeout < 0) {
 		printf("ahci: Timeout during command execution.\n");
 		return -1;
@@ -210,51 +210,95 @@ static ssize_t ahci_cmdslot_exec(ahci_dev_t *const dev)
 	}
 }
 
-static size_t ahci_cmdslot_prepare(ahci_dev_t *const dev,
-				   u8 *const user_buf, size_t buf_len,
-				   const int out)
+/** Point command slot slotnum to buf, returns the number of bytes covered. */
+static size_t ahci_cmdslot_setup(ahci_dev_t *const dev, const int slotnum,
+				 u8 *buf, size_t buf_len)
 {
-	const int slotnum = 0; /* We always use the first slot. */
-
-	size_t read_count = 0;
+	cmdtable_t *const cmdtable = &dev->cmdtable[slotnum];
 
 	memset((void *)&dev->cmdlist[slotnum],
 			'\0', sizeof(dev->cmdlist[slotnum]));
-	memset((void *)dev->cmdtable,
-			'\0', sizeof(*dev->cmdtable));
+	memset((void *)cmdtable, '\0', sizeof(*cmdtable));
 	dev->cmdlist[slotnum].cmd = CMD_CFL(FIS_H2D_FIS_LEN);
-	dev->cmdlist[slotnum].cmdtable_base = virt_to_phys(dev->cmdtable);
+	dev->cmdlist[slotnum].cmdtable_base = virt_to_phys(cmdtable);
+
+	if (buf_len > BYTES_PER_CMD)
+		buf_len = BYTES_PER_CMD;
 
 	if (buf_len > 0) {
-		size_t prdt_len;
-		u8 *buf;
+		const size_t read_count = buf_len;
+		const size_t prdt_len =
+			((buf_len - 1) >> BYTES_PER_PRD_SHIFT) + 1;
 		int i;
 
-		prdt_len = ((buf_len - 1) >> BYTES_PER_PRD_SHIFT) + 1;
-		const size_t max_prdt_len = ARRAY_SIZE(dev->cmdtable->prdt);
-		if (prdt_len > max_prdt_len) {
-			prdt_len = max_prdt_len;
-			buf_len = prdt_len << BYTES_PER_PRD_SHIFT;
-		}
-
 		dev->cmdlist[slotnum].prdt_length = prdt_len;
-		read_count = buf_len;
-
-		buf = ahci_prdbuf_init(dev, user_buf, buf_len, out);
-		if (!buf)
-			return 0;
 		for (i = 0; i < prdt_len; ++i) {
 			const size_t bytes =
 				(buf_len < BYTES_PER_PRD)
 				? buf_len : BYTES_PER_PRD;
-			dev->cmdtable->prdt[i].data_base = virt_to_phys(buf);
-			dev->cmdtable->prdt[i].flags = PRD_TABLE_BYTES(bytes);
+			cmdtable->prdt[i].data_base = virt_to_phys(buf);
+			cmdtable->prdt[i].flags = PRD_TABLE_BYTES(bytes);
 			buf_len -= bytes;
 			buf += bytes;
 		}
+		return read_count;
+	}
+
+	return 0;
+}
+
+static size_t ahci_cmdslot_prepare(ahci_dev_t *const dev,
+				   u8 *const user_buf, size_t buf_len,
+				   const int out)
+{
+	const int slotnum = 0; /* We always use the first slot. */
+
+	u8 *buf = user_buf;
+
+	if (buf_len > BYTES_PER_CMD)
+		buf_len = BYTES_PER_CMD;
+	if (buf_len > 0) {
+		buf = ahci_prdbuf_init(dev, user_buf, buf_len, out);
+		if (!buf)
+			buf_len = 0;
 	}
 
-	return read_count;
+	return ahci_cmdslot_setup(dev, slotnum, buf, buf_len);
+}
+
+/**
+ * Fill in the command FIS of a DMA read. With tag >= 0 it's a
+ * READ FPDMA QUEUED with that tag, otherwise the device's read_cmd.
+ */
+static void ahci_ata_read_fis(ata_dev_t *const ata_dev,
+			      cmdtable_t *const cmdtable,
+			      const lba_t start, const size_t sectors,
+			      const int tag)
+{
+	cmdtable->fis[ 0] = FIS_HOST_TO_DEVICE;
+	cmdtable->fis[ 1] = FIS_H2D_CMD;
+	cmdtable->fis[ 4] = (start >>  0) & 0xff;
+	cmdtable->fis[ 5] = (start >>  8) & 0xff;
+	cmdtable->fis[ 6] = (start >> 16) & 0xff;
+	cmdtable->fis[ 7] = FIS_H2D_DEV_LBA;
+	cmdtable->fis[ 8] = (start >> 24) & 0xff;
+#ifdef CONFIG_STORAGE_64BIT_LBA
+	if ((tag >= 0) || (ata_dev->read_cmd == ATA_READ_DMA_EXT)) {
+		cmdtable->fis[ 9] = (start >> 32) & 0xff;
+		cmdtable->fis[10] = (start >> 40) & 0xff;
+	}
+#endif
+	if (tag >= 0) {
+		/* Queued commands pass the count in the features register. */
+		cmdtable->fis[ 2] = ATA_READ_FPDMA_QUEUED;
+		cmdtable->fis[ 3] = (sectors >>  0) & 0xff;
+		cmdtable->fis[11] = (sectors >>  8) & 0xff;
+		cmdtable->fis[12] = tag << 3;
+	} else {
+		cmdtable->fis[ 2] = ata_dev->read_cmd;
+		cmdtable->fis[12] = (sectors >>  0) & 0xff;
+		cmdtable->fis[13] = (sectors >>  8) & 0xff;
+	}
 }
 
 static ssize_t ahci_ata_read_sectors(ata_dev_t *const ata_dev,
@@ -294,22 +338,7 @@ static ssize_t ahci_ata_read_sectors(ata_dev_t *const ata_dev,
 	const size_t bytes_feasible = ahci_cmdslot_prepare(dev, buf, bytes, 0);
 	const size_t sectors = bytes_feasible >> ata_dev->sector_size_shift;
 
-	dev->cmdtable->fis[ 0] = FIS_HOST_TO_DEVICE;
-	dev->cmdtable->fis[ 1] = FIS_H2D_CMD;
-	dev->cmdtable->fis[ 2] = ata_dev->read_cmd;
-	dev->cmdtable->fis[ 4] = (start >>  0) & 0xff;
-	dev->cmdtable->fis[ 5] = (start >>  8) & 0xff;
-	dev->cmdtable->fis[ 6] = (start >> 16) & 0xff;
-	dev->cmdtable->fis[ 7] = FIS_H2D_DEV_LBA;
-	dev->cmdtable->fis[ 8] = (start >> 24) & 0xff;
-#ifdef CONFIG_STORAGE_64BIT_LBA
-	if (ata_dev->read_cmd == ATA_READ_DMA_EXT) {
-		dev->cmdtable->fis[ 9] = (start >> 32) & 0xff;
-		dev->cmdtable->fis[10] = (start >> 40) & 0xff;
-	}
-#endif
-	dev->cmdtable->fis[12] = (sectors >>  0) & 0xff;
-	dev->cmdtable->fis[13] = (sectors >>  8) & 0xff;
+	ahci_ata_read_fis(ata_dev, dev->cmdtable, start, sectors, -1);
 
 	if (ahci_cmdslot_exec(dev) < 0)
 		return -1;
@@ -317,6 +346,175 @@ static ssize_t ahci_ata_read_sectors(ata_dev_t *const ata_dev,
 		return dev->cmdlist->prd_bytes >> ata_dev->sector_size_shift;
 }
 
+/** Read a whole request through ahci_ata_read_sectors(). */
+static void ahci_ata_read_req(ata_dev_t *const ata_dev,
+			      storage_req_t *const req)
+{
+	req->ret = 0;
+	while (req->ret < req->count) {
+		const ssize_t ret = ahci_ata_read_sectors(ata_dev,
+				req->start + req->ret, req->count - req->ret,
+				req->buf + (req->ret << 9));
+		if (ret <= 0) {
+			req->ret = -1;
+			return;
+		}
+		req->ret += ret;
+	}
+}
+
+/*
+ * Keeps one command per slot in flight, straight from and to the caller's
+ * buffers. With NCQ the drive may work on all of them at once, without it
+ * the controller at least runs them back to back without waiting for us.
+ * Only used for 512-byte sectors (see ata_read512_batch()).
+ */
+static ssize_t ahci_ata_read_batch(ata_dev_t *const ata_dev,
+				   storage_req_t *const reqs,
+				   const size_t count)
+{
+	ahci_dev_t *const dev = (ahci_dev_t *)ata_dev;
+	hba_port_t *const port = dev->port;
+
+	storage_req_t *slot_req[32];
+	size_t slot_sectors[32];
+	u32 issued = 0;
+	size_t next = 0, done = 0; /* next request and its issued sectors */
+	size_t i, failed = 0;
+	ssize_t total = 0;
+	int slot;
+
+	const int ncq = (dev->ctrl->caps & HBA_CAPS_SNCQ) &&
+			ata_dev->queue_depth;
+	const int slots = ncq ? MIN(dev->slots, ata_dev->queue_depth)
+			      : dev->slots;
+	const size_t max_sectors =
+		(ncq || (ata_dev->read_cmd != ATA_READ_DMA)) ? 64 * 1024 : 256;
+
+	if (ata_dev->read_cmd != ATA_READ_DMA
+#ifdef CONFIG_STORAGE_64BIT_LBA
+			&& ata_dev->read_cmd != ATA_READ_DMA_EXT
+#endif
+	   ) {
+		printf("ahci: Unsupported ATA read command (0x%x).\n",
+			ata_dev->read_cmd);
+		return -1;
+	}
+
+	if (!(port->cmd_stat & HBA_PxCMD_CR))
+		return -1;
+
+	/* The controller can't DMA to odd addresses, bounce those first. */
+	for (i = 0; i < count; ++i) {
+		if ((u32)reqs[i].buf & 1)
+			ahci_ata_read_req(ata_dev, &reqs[i]);
+		else
+			reqs[i].ret = 0;
+	}
+
+	int timeout = 5000000; /* Time out after 5000000 * 1us == 5s. */
+	for (;;) {
+		/* Fill all free slots. */
+		for (slot = 0; slot < slots; ++slot) {
+			while ((next < count) &&
+					(((u32)reqs[next].buf & 1) ||
+					 (reqs[next].ret < 0) ||
+					 (done == reqs[next].count))) {
+				++next;
+				done = 0;
+			}
+			if (next == count)
+				break;
+			if (issued & (1 << slot))
+				continue;
+
+			storage_req_t *const req = &reqs[next];
+			const lba_t start = req->start + done;
+			const size_t sectors =
+				MIN(req->count - done, max_sectors);
+			if (!ncq && (ata_dev->read_cmd == ATA_READ_DMA) &&
+					(start + sectors > (1 << 28))) {
+				printf("ahci: Sector is not 28-bit "
+					"addressable.\n");
+				req->ret = -1;
+				continue;
+			}
+
+			ahci_cmdslot_setup(dev, slot, req->buf + (done << 9),
+					   sectors << 9);
+			ahci_ata_read_fis(ata_dev, &dev->cmdtable[slot],
+					  start, sectors, ncq ? slot : -1);
+			slot_req[slot] = req;
+			slot_sectors[slot] = sectors;
+			done += sectors;
+
+			issued |= 1 << slot;
+			if (ncq)
+				port->sata_active = 1 << slot;
+			port->cmd_issue = 1 << slot;
+		}
+		if (!issued)
+			break;
+
+		/* Queued commands are done when their PxSACT bit clears. */
+		const u32 busy = port->cmd_issue |
+				 (ncq ? port->sata_active : 0);
+		const u32 intr_status = port->intr_status;
+		if (intr_status & (HBA_PxIS_FATAL | HBA_PxIS_PCS)) {
+			/* We can't tell which command failed, fail them all. */
+			printf("ahci: Error during batched read.\n");
+			for (slot = 0; slot < slots; ++slot) {
+				if (issued & (1 << slot))
+					slot_req[slot]->ret = -1;
+			}
+			ahci_clear_status(port, intr_status);
+			ahci_error_recovery(dev, intr_status);
+			break;
+		}
+
+		if (!(issued & ~busy)) {
+			if (!timeout--) {
+				printf("ahci: Timeout during batched read.\n");
+				ahci_cmdengine_stop(port);
+				ahci_cmdengine_start(port);
+				for (slot = 0; slot < slots; ++slot) {
+					if (issued & (1 << slot))
+						slot_req[slot]->ret = -1;
+				}
+				break;
+			}
+			udelay(1);
+			continue;
+		}
+
+		for (slot = 0; slot < slots; ++slot) {
+			if ((issued & ~busy) & (1 << slot)) {
+				if (slot_req[slot]->ret >= 0)
+					slot_req[slot]->ret +=
+						slot_sectors[slot];
+				issued &= ~(1 << slot);
+			}
+		}
+		timeout = 5000000;
+	}
+	ahci_clear_status(port, intr_status);
+
+	/* Requests we didn't get to after an error. */
+	for (; next < count; ++next) {
+		if (!((u32)reqs[next].buf & 1) &&
+				(reqs[next].ret != reqs[next].count))
+			reqs[next].ret = -1;
+	}
+
+	for (i = 0; i < count; ++i) {
+		if (reqs[i].ret < 0)
+			++failed;
+		else
+			total += reqs[i].ret;
+	}
+	return (count && failed == count) ? -1 : total;
+}
+
 static ssize_t ahci_packet_read_cmd(atapi_dev_t *const _dev,
 				    const u8 *const cmd, const size_t cmdlen,
 				    u8 *const buf, const size_t buflen)
@@ -367,16 +565,16 @@ static int ahci_dev_init(hba_ctrl_t *const ctrl,
 
 	const int ncs = HBA_CAPS_DECODE_NCS(ctrl->caps);
 
-	/* Allocate command list, one command table and received FIS. */
+	/* Allocate command list, command tables and received FIS. */
 	cmd_t *const cmdlist = memalign(1024, ncs * sizeof(cmd_t));
-	cmdtable_t *const cmdtable = memalign(128, sizeof(cmdtable_t));
+	cmdtable_t *const cmdtable = memalign(128, ncs * sizeof(cmdtable_t));
 	rcvd_fis_t *const rcvd_fis = memalign(256, sizeof(rcvd_fis_t));
 	/* Allocate our device structure. */
 	ahci_dev_t *const dev = calloc(1, sizeof(ahci_dev_t));
 	if (!cmdlist || !cmdtable || !rcvd_fis || !dev)
 		goto _cleanup_ret;
 	memset((void *)cmdlist, '\0', ncs * sizeof(cmd_t));
-	memset((void *)cmdtable, '\0', sizeof(*cmdtable));
+	memset((void *)cmdtable, '\0', ncs * sizeof(*cmdtable));
 	memset((void *)rcvd_fis, '\0', sizeof(*rcvd_fis));
 
 	/* Set command list base and received FIS base. */
@@ -394,6 +592,7 @@ static int ahci_dev_init(hba_ctrl_t *const ctrl,
 	dev->cmdlist = cmdlist;
 	dev->cmdtable = cmdtable;
 	dev->rcvd_fis = rcvd_fis;
+	dev->slots = ncs;
 
 	/* Wait for D2H Register FIS with device' signature. */
 	int timeout = 200; /* Time out after 200 * 10ms == 2s. */
@@ -407,6 +606,7 @@ static int ahci_dev_init(hba_ctrl_t *const ctrl,
 #ifdef CONFIG_STORAGE_ATA
 		dev->ata_dev.identify = ahci_identify_device;
 		dev->ata_dev.read_sectors = ahci_ata_read_sectors;
+		dev->ata_dev.read_sectors_batch = ahci_ata_read_batch;
 		return ata_attach_device(&dev->ata_dev, PORT_TYPE_SATA);
 #endif
 		break;
@@ -108,6 +108,7 @@ typedef volatile struct {
 	hba_port_t ports[32];
 } hba_ctrl_t;
 
+#define HBA_CAPS_SNCQ		(1 << 30) /* SNCQ - Supports Native Cmd Queuing */
 #define HBA_CAPS_SSS		(1 << 27) /* SSS - Supports Staggered Spin-up */
 #define HBA_CAPS_NCS_SHIFT	8	/* NCS - Number of Command Slots */
 #define HBA_CAPS_NCS_MASK	(0x1f << HBA_CAPS_NCS_SHIFT)
@@ -166,8 +167,9 @@ typedef volatile struct {
 		      but implementation needs multiple of 128 bytes. */
 } cmdtable_t;
 
-#define BYTES_PER_PRD_SHIFT	20
+#define BYTES_PER_PRD_SHIFT	22
 #define BYTES_PER_PRD		(4 << 20)
+#define BYTES_PER_CMD		(ARRAY_SIZE(((cmdtable_t *)0)->prdt) * BYTES_PER_PRD)
 
 enum {
 	FIS_HOST_TO_DEVICE	= 0x27,
@@ -190,8 +192,9 @@ typedef struct {
 	hba_port_t *port;
 
 	cmd_t *cmdlist;
-	cmdtable_t *cmdtable;
+	cmdtable_t *cmdtable;	/* one per command slot */
 	rcvd_fis_t *rcvd_fis;
+	int slots;		/* number of command slots */
 
 	u8 *buf, *user_buf;
 	int write_back;
@@ -136,6 +136,28 @@ static ssize_t ata_read512(storage_dev_t *_dev,
 	}
 }
 
+static ssize_t ata_read512_batch(storage_dev_t *const _dev,
+				 storage_req_t *const reqs, const size_t count)
+{
+	ata_dev_t *const dev = (ata_dev_t *)_dev;
+	ssize_t total = 0;
+	size_t i, failed = 0;
+
+	/* Sectors of 512 bytes are all the batch path knows about. */
+	if (dev->read_sectors_batch && (dev->sector_size == 512))
+		return dev->read_sectors_batch(dev, reqs, count);
+
+	for (i = 0; i < count; ++i) {
+		reqs[i].ret = ata_read512(_dev, reqs[i].start,
+					  reqs[i].count, reqs[i].buf);
+		if (reqs[i].ret < 0)
+			++failed;
+		else
+			total += reqs[i].ret;
+	}
+	return (count && failed == count) ? -1 : total;
+}
+
 static ssize_t ata_write512(storage_dev_t *const dev,
 			    const lba_t start, const size_t count,
 			    const unsigned char *const buf)
@@ -148,6 +170,7 @@ void ata_initialize_storage_ops(ata_dev_t *const dev)
 {
 	dev->storage_dev.read_blocks512 = ata_read512;
 	dev->storage_dev.write_blocks512 = ata_write512;
+	dev->storage_dev.read_blocks512_batch = ata_read512_batch;
 }
 
 int ata_set_sector_size(ata_dev_t *const dev, u32 sector_size)
@@ -226,6 +249,16 @@ int ata_attach_device(ata_dev_t *const dev, const storage_port_t port_type)
 	if (ata_decode_sector_size(dev, id))
 		return -1;
 
+	/* Word 76 is only valid on SATA devices, else it's 0 or 0xffff. */
+	if ((id[ATA_ID_SATA_CAPS] != 0xffff) &&
+			(id[ATA_ID_SATA_CAPS] & (1 << 8))) {
+		dev->queue_depth = (id[ATA_ID_QUEUE_DEPTH] & 0x1f) + 1;
+		printf("ata: NCQ supported, queue depth %d.\n",
+			dev->queue_depth);
+	} else {
+		dev->queue_depth = 0;
+	}
+
 	dev->storage_dev.port_type = port_type;
 	ata_initialize_storage_ops(dev);
 
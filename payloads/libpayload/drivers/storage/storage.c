@@ -102,6 +102,46 @@ ssize_t storage_read_blocks512(const size_t dev_num,
 		return -1;
 }
 
+/**
+ * Read several runs of 512-byte blocks
+ *
+ * Reads every request of reqs, each count blocks of 512 bytes from block
+ * start into buf. Drivers that support it keep several of them in flight
+ * at once, so this should be preferred over looping on
+ * storage_read_blocks512() when the blocks to read are known in advance.
+ * The number of blocks read is stored in each request's ret field, -1 if
+ * it failed.
+ *
+ * @dev_num device number counted from 0
+ * @reqs requests to handle, in any order
+ * @count number of requests
+ * @return total number of blocks read, -1 if all requests failed
+ */
+ssize_t storage_read_blocks512_batch(const size_t dev_num,
+				     storage_req_t *const reqs,
+				     const size_t count)
+{
+	ssize_t total = 0;
+	size_t i, failed = 0;
+
+	if ((dev_num >= dev_count) || !devices[dev_num]->read_blocks512)
+		return -1;
+
+	storage_dev_t *const dev = devices[dev_num];
+	if (dev->read_blocks512_batch)
+		return dev->read_blocks512_batch(dev, reqs, count);
+
+	for (i = 0; i < count; ++i) {
+		reqs[i].ret = dev->read_blocks512(dev, reqs[i].start,
+						  reqs[i].count, reqs[i].buf);
+		if (reqs[i].ret < 0)
+			++failed;
+		else
+			total += reqs[i].ret;
+	}
+	return (count && failed == count) ? -1 : total;
+}
+
 /**
  * Initializes storage controllers
  *
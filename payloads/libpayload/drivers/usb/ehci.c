@@ -178,6 +178,10 @@ static void ehci_shutdown (hci_t *controller)
 	/* Free dummy QH */
 	free((void *)EHCI_INST(controller)->dummy_qh);
 
+	/* Free bulk QHs and TDs */
+	free(EHCI_INST(controller)->bulk_qhs);
+	free(EHCI_INST(controller)->bulk_tds);
+
 	EHCI_INST(controller)->operation->configflag = 0;
 
 	free(EHCI_INST(controller));
@@ -312,10 +316,10 @@ static int ehci_set_async_schedule(ehci_t *ehcic, int enable)
 	 * This shouldn't take too long, but we should timeout nevertheless.
 	 */
 	enable = enable ? HC_OP_ASYNC_SCHED_STAT : 0;
-	int timeout = 100; /* time out after 100ms */
+	int timeout = 10000; /* time out after 10000 * 10us == 100ms */
 	while (((ehcic->operation->usbsts & HC_OP_ASYNC_SCHED_STAT) != enable)
 			&& timeout--)
-		mdelay(1);
+		udelay(10);
 	if (timeout < 0) {
 		usb_debug("ehci async schedule status change timed out.\n");
 		return 1;
@@ -346,67 +350,185 @@ static int ehci_process_async_schedule(
 	return result;
 }
 
-static int ehci_bulk (endpoint_t *ep, int size, u8 *data, int finalize)
+/* Wait for the TDs of one transfer, returns 0 on success, 1 on error. */
+static int wait_for_xfer(ehci_pool_td_t *const tds, const int count)
 {
-	int result = 0;
-	int endp = ep->endpoint & 0xf;
-	int pid = (ep->direction==IN)?EHCI_IN:EHCI_OUT;
-
-	int hubaddr = 0, hubport = 0;
-	if (ep->dev->speed < 2) {
-		/* we need a split transaction */
-		if (closest_usb2_hub(ep->dev, &hubaddr, &hubport))
+	int i = 0;
+	int timeout = 40000; /* time out after 40000 * 50us == 2s */
+	while (i < count) {
+		const u32 token = tds[i].td.token;
+		if (token & QTD_HALTED) {
+			usb_debug("ERROR with packet\n");
+			dump_td(virt_to_phys(&tds[i].td));
+			usb_debug("-----------------\n");
 			return 1;
+		}
+		if (token & QTD_ACTIVE) {
+			if (!timeout--) {
+				usb_debug("Error: ehci: queue transfer "
+					"processing timed out.\n");
+				return 1;
+			}
+			udelay(50);
+			continue;
+		}
+		/* a short packet skips the rest of the transfer */
+		if (token & QTD_TOTAL_LEN_MASK)
+			break;
+		++i;
+		timeout = 40000;
 	}
+	return 0;
+}
 
-	qtd_t *head = memalign(32, sizeof(qtd_t));
-	qtd_t *cur = head;
-	while (1) {
-		memset((void *)cur, 0, sizeof(qtd_t));
-		cur->token = QTD_ACTIVE |
-			(pid << QTD_PID_SHIFT) |
-			(0 << QTD_CERR_SHIFT);
-		u32 chunk = fill_td(cur, data, size);
-		size -= chunk;
-		data += chunk;
+/*
+ * All transfers are put into the preallocated TDs at once, one QH per
+ * endpoint, so the controller runs them without waiting for us in between.
+ * Every transfer's alternate next pointer leads to the next transfer on
+ * its endpoint, and the last one to an inactive TD, so a short packet
+ * doesn't leave the controller waiting for data that won't come.
+ */
+static int ehci_bulk_batch(bulk_xfer_t *const xfers, const int count)
+{
+	if (count <= 0)
+		return 0;
 
-		cur->alt_next_qtd = QTD_TERMINATE;
-		if (size == 0) {
-			cur->next_qtd = virt_to_phys(0) | QTD_TERMINATE;
-			break;
-		} else {
-			qtd_t *next = memalign(32, sizeof(qtd_t));
-			cur->next_qtd = virt_to_phys(next);
-			cur = next;
+	ehci_t *const ehcic = EHCI_INST(xfers[0].ep->dev->controller);
+	ehci_pool_qh_t *const qhs = ehcic->bulk_qhs;
+	ehci_pool_td_t *const tds = ehcic->bulk_tds;
+
+	endpoint_t *eps[EHCI_BULK_QHS];
+	u32 next_first[EHCI_BULK_QHS];
+	u8 xfer_qh[EHCI_BULK_TDS], xfer_td[EHCI_BULK_TDS], xfer_ntd[EHCI_BULK_TDS];
+	int i, q, t, nqhs = 0, ntds = 0;
+
+	if (count > EHCI_BULK_TDS - EHCI_BULK_QHS) {
+		usb_debug("ehci: Too many bulk transfers at once.\n");
+		return 0;
+	}
+
+	for (i = 0; i < count; ++i) {
+		endpoint_t *const ep = xfers[i].ep;
+		const int pid = (ep->direction == IN) ? EHCI_IN : EHCI_OUT;
+
+		for (q = 0; (q < nqhs) && (eps[q] != ep); ++q) ;
+		if (q == nqhs) {
+			if (nqhs == EHCI_BULK_QHS) {
+				usb_debug("ehci: Too many bulk endpoints at once.\n");
+				return 0;
+			}
+			eps[nqhs++] = ep;
 		}
+		xfer_qh[i] = q;
+		xfer_td[i] = ntds;
+
+		int size = xfers[i].size;
+		u8 *data = xfers[i].data;
+		do {
+			if (ntds == EHCI_BULK_TDS - EHCI_BULK_QHS) {
+				usb_debug("ehci: Bulk transfers too large.\n");
+				return 0;
+			}
+			qtd_t *const td = &tds[ntds++].td;
+			memset((void *)td, 0, sizeof(*td));
+			td->token = QTD_ACTIVE |
+				(pid << QTD_PID_SHIFT) |
+				(0 << QTD_CERR_SHIFT);
+			const int chunk = fill_td(td, data, size);
+			size -= chunk;
+			data += chunk;
+			td->next_qtd = virt_to_phys(&tds[ntds].td);
+		} while (size > 0);
+		xfer_ntd[i] = ntds - xfer_td[i];
 	}
 
-	/* create QH */
-	ehci_qh_t *qh = memalign(32, sizeof(ehci_qh_t));
-	memset((void *)qh, 0, sizeof(ehci_qh_t));
-	qh->horiz_link_ptr = virt_to_phys(qh) | QH_QH;
-	qh->epchar = ep->dev->address |
-		(endp << QH_EP_SHIFT) |
-		(ep->dev->speed << QH_EPS_SHIFT) |
-		(0 << QH_DTC_SHIFT) |
-		(1 << QH_RECLAIM_HEAD_SHIFT) |
-		(ep->maxpacketsize << QH_MPS_SHIFT) |
-		(0 << QH_NAK_CNT_SHIFT);
-	qh->epcaps = (3 << QH_PIPE_MULTIPLIER_SHIFT) |
-		(hubport << QH_PORT_NUMBER_SHIFT) |
-		(hubaddr << QH_HUB_ADDRESS_SHIFT);
+	/* an inactive TD to end each endpoint's queue */
+	for (q = 0; q < nqhs; ++q) {
+		qtd_t *const td = &tds[ntds++].td;
+		memset((void *)td, 0, sizeof(*td));
+		td->next_qtd = QTD_TERMINATE;
+		td->alt_next_qtd = QTD_TERMINATE;
+		next_first[q] = virt_to_phys(td);
+	}
 
-	qh->td.next_qtd = virt_to_phys(head);
-	qh->td.token |= (ep->toggle?QTD_TOGGLE_DATA1:0);
-	head->token |= (ep->toggle?QTD_TOGGLE_DATA1:0);
+	/* link the transfers of each endpoint, back to front */
+	for (i = count - 1; i >= 0; --i) {
+		q = xfer_qh[i];
+		for (t = xfer_td[i]; t < xfer_td[i] + xfer_ntd[i]; ++t)
+			tds[t].td.alt_next_qtd = next_first[q];
+		tds[t - 1].td.next_qtd = next_first[q];
+		next_first[q] = virt_to_phys(&tds[xfer_td[i]].td);
+	}
 
-	result = ehci_process_async_schedule(
-			EHCI_INST(ep->dev->controller), qh, head);
+	for (q = 0; q < nqhs; ++q) {
+		endpoint_t *const ep = eps[q];
+		ehci_qh_t *const qh = &qhs[q].qh;
 
-	ep->toggle = (cur->token & QTD_TOGGLE_MASK) >> QTD_TOGGLE_SHIFT;
+		int hubaddr = 0, hubport = 0;
+		if (ep->dev->speed < 2) {
+			/* we need a split transaction */
+			if (closest_usb2_hub(ep->dev, &hubaddr, &hubport))
+				return 0;
+		}
 
-	free_qh_and_tds(qh, head);
-	return result;
+		memset((void *)qh, 0, sizeof(*qh));
+		qh->horiz_link_ptr =
+			virt_to_phys(&qhs[(q + 1) % nqhs].qh) | QH_QH;
+		qh->epchar = ep->dev->address |
+			((ep->endpoint & 0xf) << QH_EP_SHIFT) |
+			(ep->dev->speed << QH_EPS_SHIFT) |
+			(0 << QH_DTC_SHIFT) |
+			((q == 0) << QH_RECLAIM_HEAD_SHIFT) |
+			(ep->maxpacketsize << QH_MPS_SHIFT) |
+			(0 << QH_NAK_CNT_SHIFT);
+		qh->epcaps = (3 << QH_PIPE_MULTIPLIER_SHIFT) |
+			(hubport << QH_PORT_NUMBER_SHIFT) |
+			(hubaddr << QH_HUB_ADDRESS_SHIFT);
+
+		qh->td.next_qtd = next_first[q];
+		qh->td.alt_next_qtd = QTD_TERMINATE;
+		qh->td.token |= (ep->toggle?QTD_TOGGLE_DATA1:0);
+	}
+
+	/* make sure async schedule is disabled */
+	if (ehci_set_async_schedule(ehcic, 0))
+		return 0;
+	/* hook up QHs */
+	ehcic->operation->asynclistaddr = virt_to_phys(&qhs[0].qh);
+	/* start async schedule */
+	if (ehci_set_async_schedule(ehcic, 1))
+		return 0;
+
+	for (i = 0; i < count; ++i) {
+		if (wait_for_xfer(&tds[xfer_td[i]], xfer_ntd[i]))
+			break;
+	}
+
+	/* disable async schedule */
+	ehci_set_async_schedule(ehcic, 0);
+
+	for (q = 0; q < nqhs; ++q)
+		eps[q]->toggle = (qhs[q].qh.td.token & QTD_TOGGLE_MASK)
+				 >> QTD_TOGGLE_SHIFT;
+
+	return i;
+}
+
+static int ehci_bulk (endpoint_t *ep, int size, u8 *data, int finalize)
+{
+	bulk_xfer_t xfer = { .ep = ep };
+
+	/* split what doesn't fit into the TD pool */
+	do {
+		xfer.size = MIN(size, EHCI_BULK_MAX);
+		xfer.data = data;
+		if (ehci_bulk_batch(&xfer, 1) != 1)
+			return 1;
+		size -= xfer.size;
+		data += xfer.size;
+	} while (size > 0);
+
+	return 0;
 }
 
 
@@ -593,9 +715,10 @@ static void *ehci_create_intr_queue(
 	}
 	intrq->tail = cur_td;
 
-	/* create spare qTD */
+	/* create spare qTD, it's only filled when it gets queued, so it
+	   doesn't take a data toggle away from the one queued before it */
 	intrq->spare = (intr_qtd_t *)memalign(32, sizeof(intr_qtd_t));
-	fill_intr_queue_td(intrq, intrq->spare, data);
+	intrq->spare->data = data;
 
 	/* initialize QH */
 	const int endp = ep->endpoint & 0xf;
@@ -744,6 +867,7 @@ ehci_init (pcidev_t addr)
 	controller->init = ehci_reinit;
 	controller->shutdown = ehci_shutdown;
 	controller->bulk = ehci_bulk;
+	controller->bulk_batch = ehci_bulk_batch;
 	controller->control = ehci_control;
 	controller->create_intr_queue = ehci_create_intr_queue;
 	controller->destroy_intr_queue = ehci_destroy_intr_queue;
@@ -786,6 +910,14 @@ ehci_init (pcidev_t addr)
 		periodic_list[i] = virt_to_phys(EHCI_INST(controller)->dummy_qh)
 				   | PS_TYPE_QH;
 
+	/* Preallocate what bulk transfers need */
+	EHCI_INST(controller)->bulk_qhs =
+		memalign(32, EHCI_BULK_QHS * sizeof(ehci_pool_qh_t));
+	EHCI_INST(controller)->bulk_tds =
+		memalign(32, EHCI_BULK_TDS * sizeof(ehci_pool_td_t));
+	if (!EHCI_INST(controller)->bulk_qhs || !EHCI_INST(controller)->bulk_tds)
+		fatal("Not enough memory creating EHCI bulk queues.\n");
+
 	/* Make sure periodic schedule is disabled */
 	ehci_set_periodic_schedule(EHCI_INST(controller), 0);
 	/* Set periodic frame list pointer */
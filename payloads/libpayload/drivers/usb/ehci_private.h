@@ -132,10 +132,27 @@ typedef volatile struct {
 	volatile qtd_t td;
 } ehci_qh_t;
 
+/* QHs and qTDs have to be 32-byte aligned, which they aren't in arrays. */
+typedef struct {
+	qtd_t td;
+} __attribute__ ((aligned (32))) ehci_pool_td_t;
+
+typedef struct {
+	ehci_qh_t qh;
+} __attribute__ ((aligned (32))) ehci_pool_qh_t;
+
+/* Bulk transfers use preallocated QHs and TDs, one QH per endpoint. */
+#define EHCI_BULK_QHS 4
+#define EHCI_BULK_TDS 256
+/* every TD takes at least 4 full pages */
+#define EHCI_BULK_MAX ((EHCI_BULK_TDS - EHCI_BULK_QHS) * 4 * 4096)
+
 typedef struct ehci {
 	hc_cap_t *capabilities;
 	hc_op_t *operation;
 	ehci_qh_t *dummy_qh;
+	ehci_pool_qh_t *bulk_qhs;
+	ehci_pool_td_t *bulk_tds;
 } ehci_t;
 
 #define PS_TERMINATE 1
@@ -37,7 +37,7 @@ hci_t *usb_hcs = 0;
 hci_t *
 new_controller (void)
 {
-	hci_t *controller = malloc (sizeof (hci_t));
+	hci_t *controller = calloc (1, sizeof (hci_t));
 
 	if (controller) {
 		/* atomic */
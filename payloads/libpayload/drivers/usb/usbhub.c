@@ -31,21 +31,28 @@
 
 // assume that host_to_device is overwritten if necessary
 #define DR_PORT gen_bmRequestType(host_to_device, class_type, other_recp)
+#define DR_HUB gen_bmRequestType(host_to_device, class_type, dev_recp)
 /* status bits */
 #define PORT_CONNECTION 0x1
 #define PORT_ENABLE 0x2
 #define PORT_RESET 0x10
 /* status change bits */
 #define C_PORT_CONNECTION 0x1
+#define C_PORT_ALL 0x1f
 /* feature selectors (for setting / clearing features) */
+#define SEL_C_HUB_LOCAL_POWER 0x0
+#define SEL_C_HUB_OVER_CURRENT 0x1
 #define SEL_PORT_RESET 0x4
 #define SEL_PORT_POWER 0x8
-#define SEL_C_PORT_CONNECTION 0x10
+#define SEL_C_PORT_CONNECTION 0x10 /* other C_PORT_* follow in bit order */
+#define SEL_C_PORT_RESET 0x14
 
 typedef struct {
 	int num_ports;
 	int *ports;
 	hub_descriptor_t *descriptor;
+	endpoint_t *intr_ep;	/* status change endpoint */
+	void *queue;		/* its interrupt queue, if we got one */
 } usbhub_inst_t;
 
 #define HUB_INST(dev) ((usbhub_inst_t*)(dev)->data)
@@ -55,6 +62,10 @@ usb_hub_destroy (usbdev_t *dev)
 {
 	int i;
 
+	if (HUB_INST (dev)->queue)
+		dev->controller->destroy_intr_queue (HUB_INST (dev)->intr_ep,
+						     HUB_INST (dev)->queue);
+
 	/* First, detach all devices behind this hub. */
 	int *const ports = HUB_INST (dev)->ports;
 	for (i = 1; i <= HUB_INST (dev)->num_ports; i++) {
@@ -72,10 +83,15 @@ usb_hub_destroy (usbdev_t *dev)
 static void
 usb_hub_scanport (usbdev_t *dev, int port)
 {
-	int timeout;
+	int timeout, i;
 
 	unsigned short buf[2];
 	get_status (dev, port, DR_PORT, 4, buf);
+	/* acknowledge changes we don't handle, or the hub keeps reporting them */
+	for (i = 1; i < 5; i++) {
+		if (buf[1] & C_PORT_ALL & (1 << i))
+			clear_feature (dev, port, SEL_C_PORT_CONNECTION + i, DR_PORT);
+	}
 	if (!(buf[1] & C_PORT_CONNECTION))
 		/* no change */
 		return;
@@ -129,8 +145,9 @@ usb_hub_scanport (usbdev_t *dev, int port)
 
 	HUB_INST (dev)->ports[port] = usb_attach_device(dev->controller, dev->address, port, speed);
 
-	/* clear Port Connection status change */
+	/* clear Port Connection and Port Reset status changes */
 	clear_feature (dev, port, SEL_C_PORT_CONNECTION, DR_PORT);
+	clear_feature (dev, port, SEL_C_PORT_RESET, DR_PORT);
 }
 
 static int
@@ -166,6 +183,31 @@ static void
 usb_hub_poll (usbdev_t *dev)
 {
 	int port;
+
+	/*
+	 * With the status change endpoint, the hub tells us which ports to
+	 * look at and an idle hub costs no control transfers at all.
+	 */
+	if (HUB_INST (dev)->queue) {
+		const u8 *report;
+		u8 changes[32];	/* bit 0 is the hub, up to 255 ports */
+		const int len = (HUB_INST (dev)->num_ports + 8) / 8;
+
+		while ((report = dev->controller->poll_intr_queue
+					(HUB_INST (dev)->queue))) {
+			memcpy (changes, report, len);
+			if (changes[0] & 1) {
+				clear_feature (dev, 0, SEL_C_HUB_LOCAL_POWER, DR_HUB);
+				clear_feature (dev, 0, SEL_C_HUB_OVER_CURRENT, DR_HUB);
+			}
+			for (port = 1; port <= HUB_INST (dev)->num_ports; port++) {
+				if (changes[port / 8] & (1 << (port % 8)))
+					usb_hub_scanport (dev, port);
+			}
+		}
+		return;
+	}
+
 	while ((port = usb_hub_report_port_changes (dev)) != -1)
 		usb_hub_scanport (dev, port);
 }
@@ -194,4 +236,24 @@ usb_hub_init (usbdev_t *dev)
 		HUB_INST (dev)->ports[i] = -1;
 	for (i = 1; i <= HUB_INST (dev)->num_ports; i++)
 		usb_hub_enable_port (dev, i);
+
+	/* Changes are still pending until we clear them, so we can't miss
+	   any that happened before the queue was set up. */
+	HUB_INST (dev)->intr_ep = NULL;
+	HUB_INST (dev)->queue = NULL;
+	for (i = 1; i < dev->num_endp; i++) {
+		if ((dev->endpoints[i].endpoint != 0) &&
+				(dev->endpoints[i].type == INTERRUPT) &&
+				(dev->endpoints[i].direction == IN)) {
+			HUB_INST (dev)->intr_ep = &dev->endpoints[i];
+			break;
+		}
+	}
+	if (HUB_INST (dev)->intr_ep && dev->controller->create_intr_queue)
+		/* 2 reports of one bit per port plus one for the hub, every 32ms */
+		HUB_INST (dev)->queue = dev->controller->create_intr_queue (
+				HUB_INST (dev)->intr_ep,
+				(HUB_INST (dev)->num_ports + 8) / 8, 2, 32);
+	if (!HUB_INST (dev)->queue)
+		usb_debug ("usbhub: polling all ports for changes.\n");
 }
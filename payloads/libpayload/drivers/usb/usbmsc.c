@@ -271,6 +271,15 @@ typedef struct {
 	unsigned char res3;	//9 - the block is 10 bytes long
 } __attribute__ ((packed)) cmdblock_t;
 
+typedef struct {
+	unsigned char command;	//0
+	unsigned char res1;	//1
+	unsigned long long block;	//2-9
+	unsigned int numblocks;	//10-13
+	unsigned char res2;	//14
+	unsigned char res3;	//15 - the block is 16 bytes long
+} __attribute__ ((packed)) cmdblock16_t;
+
 typedef struct {
 	unsigned char command;	//0
 	unsigned char res1;	//1
@@ -280,6 +289,11 @@ typedef struct {
 	unsigned char res4;	//5
 } __attribute__ ((packed)) cmdblock6_t;
 
+/* Bytes per command and commands at once if the controller can queue them.
+   Together they have to fit into what EHCI can queue (EHCI_BULK_MAX). */
+#define MSC_PIPE_BYTES (1024 * 1024)
+#define MSC_PIPE_DEPTH 3
+
 /**
  * Like readwrite_blocks, but for soft-sectors of 512b size. Converts the
  * start and count from 512b units.
@@ -294,7 +308,7 @@ typedef struct {
  * @return 0 on success, 1 on failure
  */
 int
-readwrite_blocks_512 (usbdev_t *dev, int start, int n,
+readwrite_blocks_512 (usbdev_t *dev, u64 start, int n,
 	cbw_direction dir, u8 *buf)
 {
 	int blocksize_divider = MSC_INST(dev)->blocksize / 512;
@@ -302,10 +316,93 @@ readwrite_blocks_512 (usbdev_t *dev, int start, int n,
 		n / blocksize_divider, dir, buf);
 }
 
+/* Fills in a READ/WRITE(10), or (16) for blocks above 2^32. Returns its size. */
+static int
+fill_rw_cmdblock (u8 *cb, u64 start, int n, cbw_direction dir)
+{
+	memset (cb, 0, 16);
+	if (start + n > 0x100000000ULL) {
+		cmdblock16_t *const cb16 = (cmdblock16_t *) cb;
+		cb16->command = (dir == cbw_direction_data_in) ? 0x88 : 0x8a;
+		cb16->block = htonll (start);
+		cb16->numblocks = htonl (n);
+		return sizeof (*cb16);
+	} else {
+		cmdblock_t *const cb10 = (cmdblock_t *) cb;
+		cb10->command = (dir == cbw_direction_data_in) ? 0x28 : 0x2a;
+		cb10->block = htonl (start);
+		cb10->numblocks = htonw (n);
+		return sizeof (*cb10);
+	}
+}
+
+/*
+ * Queues up to MSC_PIPE_DEPTH commands with their data and status phases
+ * at once, so the controller sends the next CBW as soon as the device
+ * takes it. Returns the number of blocks that went through, the caller
+ * retries the rest one command at a time to sort out errors. Returns -1
+ * if the device got detached.
+ */
+static int
+readwrite_pipelined (usbdev_t *dev, u64 start, int n, cbw_direction dir,
+		     u8 *buf)
+{
+	cbw_t cbw[MSC_PIPE_DEPTH];
+	csw_t csw[MSC_PIPE_DEPTH];
+	int blocks[MSC_PIPE_DEPTH];
+	bulk_xfer_t xfers[3 * MSC_PIPE_DEPTH];
+	u8 cb[16];
+	int cmds, i, done = 0;
+
+	const int blocksize = MSC_INST(dev)->blocksize;
+	const int per_cmd = MAX (MSC_PIPE_BYTES / blocksize, 1);
+	endpoint_t *const data_ep = (dir == cbw_direction_data_in)
+		? MSC_INST (dev)->bulk_in : MSC_INST (dev)->bulk_out;
+
+	for (cmds = 0; (cmds < MSC_PIPE_DEPTH) && (n > 0); ++cmds) {
+		blocks[cmds] = MIN (n, per_cmd);
+		const int len = blocks[cmds] * blocksize;
+		const int cblen = fill_rw_cmdblock (cb, start, blocks[cmds], dir);
+		wrap_cbw (&cbw[cmds], len, dir, cb, cblen);
+
+		xfers[3 * cmds].ep = MSC_INST (dev)->bulk_out;
+		xfers[3 * cmds].size = sizeof (cbw_t);
+		xfers[3 * cmds].data = (u8 *) &cbw[cmds];
+		xfers[3 * cmds + 1].ep = data_ep;
+		xfers[3 * cmds + 1].size = len;
+		xfers[3 * cmds + 1].data = buf;
+		xfers[3 * cmds + 2].ep = MSC_INST (dev)->bulk_in;
+		xfers[3 * cmds + 2].size = sizeof (csw_t);
+		xfers[3 * cmds + 2].data = (u8 *) &csw[cmds];
+
+		start += blocks[cmds];
+		n -= blocks[cmds];
+		buf += len;
+	}
+
+	const int xfers_done = dev->controller->bulk_batch (xfers, 3 * cmds);
+	for (i = 0; (i < cmds) && (3 * i + 3 <= xfers_done); ++i) {
+		if ((csw[i].dCSWSignature != csw_signature) ||
+				(csw[i].dCSWTag != cbw[i].dCBWTag) ||
+				(csw[i].bCSWStatus != 0) ||
+				(csw[i].dCSWDataResidue != 0))
+			break;
+		done += blocks[i];
+	}
+
+	/* The transport got stuck somewhere, get it back to a known state. */
+	if ((xfers_done < 3 * cmds) &&
+			(reset_transport (dev) == MSC_COMMAND_DETACHED))
+		return -1;
+
+	return done;
+}
+
 /**
  * Reads or writes a number of sequential blocks on a USB storage device.
- * As it uses the READ(10) SCSI-2 command, it's limited to storage devices
- * of at most 2TB. It assumes sectors of 512 bytes.
+ * It uses the READ(10) SCSI-2 command, or READ(16) for blocks beyond 2^32,
+ * and splits large requests into several commands. If the host controller
+ * can queue bulk transfers, these commands are pipelined.
  *
  * @param dev device to access
  * @param start first sector to access
@@ -315,23 +412,31 @@ readwrite_blocks_512 (usbdev_t *dev, int start, int n,
  * @return 0 on success, 1 on failure
  */
 int
-readwrite_blocks (usbdev_t *dev, int start, int n, cbw_direction dir, u8 *buf)
+readwrite_blocks (usbdev_t *dev, u64 start, int n, cbw_direction dir, u8 *buf)
 {
-	cmdblock_t cb;
-	memset (&cb, 0, sizeof (cb));
-	if (dir == cbw_direction_data_in) {
-		// read
-		cb.command = 0x28;
-	} else {
-		// write
-		cb.command = 0x2a;
+	u8 cb[16];
+
+	while (n > 0) {
+		int done = 0;
+		if (dev->controller->bulk_batch) {
+			done = readwrite_pipelined (dev, start, n, dir, buf);
+			if (done < 0)
+				return 1;
+		}
+		if (done == 0) {
+			/* one command at a time, with full error handling */
+			done = MIN (n, 0xffff);
+			const int cblen = fill_rw_cmdblock (cb, start, done, dir);
+			if (execute_command (dev, dir, cb, cblen, buf,
+					done * MSC_INST(dev)->blocksize, 0)
+					!= MSC_COMMAND_OK)
+				return 1;
+		}
+		start += done;
+		n -= done;
+		buf += done * MSC_INST(dev)->blocksize;
 	}
-	cb.block = htonl (start);
-	cb.numblocks = htonw (n);
-
-	return execute_command (dev, dir, (u8 *) &cb, sizeof (cb), buf,
-				n * MSC_INST(dev)->blocksize, 0)
-		!= MSC_COMMAND_OK ? 1 : 0;
+	return 0;
 }
 
 /* Only request it, we don't interpret it.
@@ -369,6 +474,23 @@ spin_up (usbdev_t *dev)
 				sizeof (cb), 0, 0, 0);
 }
 
+static void
+read_capacity_16 (usbdev_t *dev)
+{
+	cmdblock16_t cb;
+	memset (&cb, 0, sizeof (cb));
+	cb.command = 0x9e;	// service action in
+	cb.res1 = 0x10;		// read capacity (16)
+	cb.numblocks = htonl (32);	// allocation length
+	u8 buf[32];
+
+	if (execute_command (dev, cbw_direction_data_in, (u8 *) &cb,
+			     sizeof (cb), buf, 32, 1) == MSC_COMMAND_OK) {
+		MSC_INST (dev)->numblocks = ntohll (*(u64 *) buf) + 1;
+		MSC_INST (dev)->blocksize = ntohl (*(u32 *) (buf + 8));
+	}
+}
+
 static int
 read_capacity (usbdev_t *dev)
 {
@@ -398,14 +520,14 @@ read_capacity (usbdev_t *dev)
 		MSC_INST (dev)->numblocks = 0xffffffff;
 		MSC_INST (dev)->blocksize = 512;
 	} else {
-		MSC_INST (dev)->numblocks = ntohl (*(u32 *) buf) + 1;
+		MSC_INST (dev)->numblocks = ntohl (*(u32 *) buf) + 1ULL;
 		MSC_INST (dev)->blocksize = ntohl (*(u32 *) (buf + 4));
+		/* too large for READ CAPACITY (10) */
+		if (ntohl (*(u32 *) buf) == 0xffffffff)
+			read_capacity_16 (dev);
 	}
-	usb_debug ("  %d %d-byte sectors (%d MB)\n", MSC_INST (dev)->numblocks,
+	usb_debug ("  %llu %d-byte sectors (%llu MB)\n", MSC_INST (dev)->numblocks,
 		MSC_INST (dev)->blocksize,
-		/* round down high block counts to avoid integer overflow */
-		MSC_INST (dev)->numblocks > 1000000
-			? (MSC_INST (dev)->numblocks / 1000) * MSC_INST (dev)->blocksize / 1000 :
 		MSC_INST (dev)->numblocks * MSC_INST (dev)->blocksize / 1000 / 1000);
 	return MSC_COMMAND_OK;
 }
@@ -71,40 +71,6 @@ static unsigned long chars;
 #define FB ((unsigned char *) phys_to_virt(fbaddr))
 #define CHARS ((unsigned short *) phys_to_virt(chars))
 
-static void corebootfb_scroll_up(void)
-{
-	unsigned char *dst = FB;
-	unsigned char *src = FB + (FI->bytes_per_line * FONT_HEIGHT);
-	int y;
-
-	/* Scroll all lines up */
-	for(y = 0; y < FI->y_resolution - FONT_HEIGHT; y++) {
-		memcpy(dst, src, FI->x_resolution * (FI->bits_per_pixel >> 3));
-
-		dst += FI->bytes_per_line;
-		src += FI->bytes_per_line;
-	}
-
-	/* Erase last line */
-	dst = FB + (FI->y_resolution - FONT_HEIGHT) * FI->bytes_per_line;
-
-	for(; y < FI->y_resolution; y++) {
-		memset(dst, 0, FI->x_resolution * (FI->bits_per_pixel >> 3));
-		dst += FI->bytes_per_line;
-	}
-
-	/* And update the char buffer */
-	dst = (unsigned char *) CHARS;
-	src = (unsigned char *) (CHARS + coreboot_video_console.columns);
-	memcpy(dst, src, coreboot_video_console.columns *
-			(coreboot_video_console.rows - 1) * 2);
-	int column;
-	for (column = 0; column < coreboot_video_console.columns; column++)
-		CHARS[(coreboot_video_console.rows - 1) * coreboot_video_console.columns + column] = (VGA_COLOR_DEFAULT << 8);
-
-	cursor_y--;
-}
-
 static void corebootfb_clear(void)
 {
 	int row, column;
@@ -122,7 +88,8 @@ static void corebootfb_clear(void)
 			CHARS[row * coreboot_video_console.columns + column] = (VGA_COLOR_DEFAULT << 8);
 }
 
-static void corebootfb_putchar(u8 row, u8 col, unsigned int ch)
+static void corebootfb_putchar(unsigned int row, unsigned int col,
+			       unsigned int ch)
 {
 	unsigned char *dst;
 	unsigned char *glyph = font8x16 + ((ch & 0xFF) * FONT_HEIGHT);
@@ -148,30 +115,57 @@ static void corebootfb_putchar(u8 row, u8 col, unsigned int ch)
 	dst = FB + ((row * FONT_HEIGHT) * FI->bytes_per_line);
 	dst += (col * FONT_WIDTH * (FI->bits_per_pixel >> 3));
 
+	/*
+	 * The common case: look up four pixels at a time in a table for the
+	 * current colors instead of going through the switch below.
+	 */
+	if (FI->bits_per_pixel == 32) {
+		static u32 nibble[16][4], nibble_fg, nibble_bg;
+		static int nibble_valid;
+
+		if (!nibble_valid || fgval != nibble_fg || bgval != nibble_bg) {
+			for (x = 0; x < 16; x++)
+				for (y = 0; y < 4; y++)
+					nibble[x][y] = (x & (8 >> y)) ?
+						fgval : bgval;
+			nibble_fg = fgval;
+			nibble_bg = bgval;
+			nibble_valid = 1;
+		}
+		for(y = 0; y < FONT_HEIGHT; y++) {
+			dst32 = (u32 *)dst;
+			memcpy(dst32, nibble[*glyph >> 4], 16);
+			memcpy(dst32 + 4, nibble[*glyph & 0xf], 16);
+			dst += FI->bytes_per_line;
+			glyph++;
+		}
+		return;
+	}
+
 	for(y = 0; y < FONT_HEIGHT; y++) {
 		for(x = FONT_WIDTH - 1; x >= 0; x--) {
 
 			switch (FI->bits_per_pixel) {
 			case 8: /* Indexed */
-				dst[(FONT_WIDTH - x) * (FI->bits_per_pixel >> 3)] = (*glyph & (1 << x)) ?  fg : bg;
+				dst[(FONT_WIDTH - 1 - x) * (FI->bits_per_pixel >> 3)] = (*glyph & (1 << x)) ?  fg : bg;
 				break;
 			case 16: /* 16 bpp */
-				dst16 = (u16 *)(dst + (FONT_WIDTH - x) * (FI->bits_per_pixel >> 3));
+				dst16 = (u16 *)(dst + (FONT_WIDTH - 1 - x) * (FI->bits_per_pixel >> 3));
 				*dst16 = (*glyph & (1 << x)) ? fgval : bgval;
 				break;
 			case 24: /* 24 bpp */
 				if (*glyph & (1 << x)) {
-					dst[(FONT_WIDTH - x) * (FI->bits_per_pixel >> 3) + 0] = fgval & 0xff;
-					dst[(FONT_WIDTH - x) * (FI->bits_per_pixel >> 3) + 1] = (fgval >> 8) & 0xff;
-					dst[(FONT_WIDTH - x) * (FI->bits_per_pixel >> 3) + 2] = (fgval >> 16) & 0xff;
+					dst[(FONT_WIDTH - 1 - x) * (FI->bits_per_pixel >> 3) + 0] = fgval & 0xff;
+					dst[(FONT_WIDTH - 1 - x) * (FI->bits_per_pixel >> 3) + 1] = (fgval >> 8) & 0xff;
+					dst[(FONT_WIDTH - 1 - x) * (FI->bits_per_pixel >> 3) + 2] = (fgval >> 16) & 0xff;
 				} else {
-					dst[(FONT_WIDTH - x) * (FI->bits_per_pixel >> 3) + 0] = bgval & 0xff;
-					dst[(FONT_WIDTH - x) * (FI->bits_per_pixel >> 3) + 1] = (bgval >> 8) & 0xff;
-					dst[(FONT_WIDTH - x) * (FI->bits_per_pixel >> 3) + 2] = (bgval >> 16) & 0xff;
+					dst[(FONT_WIDTH - 1 - x) * (FI->bits_per_pixel >> 3) + 0] = bgval & 0xff;
+					dst[(FONT_WIDTH - 1 - x) * (FI->bits_per_pixel >> 3) + 1] = (bgval >> 8) & 0xff;
+					dst[(FONT_WIDTH - 1 - x) * (FI->bits_per_pixel >> 3) + 2] = (bgval >> 16) & 0xff;
 				}
 				break;
 			case 32: /* 32 bpp */
-				dst32 = (u32 *)(dst + (FONT_WIDTH - x) * (FI->bits_per_pixel >> 3));
+				dst32 = (u32 *)(dst + (FONT_WIDTH - 1 - x) * (FI->bits_per_pixel >> 3));
 				*dst32 = (*glyph & (1 << x)) ? fgval : bgval;
 				break;
 			}
@@ -182,7 +176,8 @@ static void corebootfb_putchar(u8 row, u8 col, unsigned int ch)
 	}
 }
 
-static void corebootfb_putc(u8 row, u8 col, unsigned int ch)
+static void corebootfb_putc(unsigned int row, unsigned int col,
+			    unsigned int ch)
 {
 	CHARS[row * coreboot_video_console.columns + col] = ch;
 	corebootfb_putchar(row, col, ch);
@@ -191,6 +186,10 @@ static void corebootfb_putc(u8 row, u8 col, unsigned int ch)
 static void corebootfb_update_cursor(void)
 {
 	int ch, paint;
+
+	if (cursor_y >= coreboot_video_console.rows)
+		return;
+
 	if(cursor_en) {
 		ch = CHARS[cursor_y * coreboot_video_console.columns + cursor_x];
 		paint = (ch & 0xff) | ((ch<<4) & 0xf000) | ((ch >> 4) & 0x0f00);
@@ -198,8 +197,7 @@ static void corebootfb_update_cursor(void)
 		paint = CHARS[cursor_y * coreboot_video_console.columns + cursor_x];
 	}
 
-	if (cursor_y >= 0 && cursor_y < coreboot_video_console.rows)
-		corebootfb_putchar(cursor_y, cursor_x, paint);
+	corebootfb_putchar(cursor_y, cursor_x, paint);
 }
 
 static void corebootfb_enable_cursor(int state)
@@ -228,6 +226,41 @@ static void corebootfb_set_cursor(unsigned int x, unsigned int y)
 		corebootfb_enable_cursor(1);
 }
 
+/*
+ * Reading back the framebuffer is very slow, so rather than moving the
+ * pixels up, shift the char buffer and redraw the cells whose contents
+ * changed. The screen always shows what is in CHARS, except for the
+ * cursor, which is taken off while we're at it.
+ */
+static void corebootfb_scroll_up(void)
+{
+	unsigned int columns = coreboot_video_console.columns;
+	unsigned int rows = coreboot_video_console.rows;
+	unsigned short *cell = CHARS;
+	unsigned short ch;
+	int cursor_remember = cursor_en;
+	int i;
+
+	if (cursor_remember)
+		corebootfb_enable_cursor(0);
+
+	for (i = 0; i < columns * rows; i++, cell++) {
+		if (i < columns * (rows - 1))
+			ch = cell[columns];
+		else
+			ch = VGA_COLOR_DEFAULT << 8;
+		if (*cell == ch)
+			continue;
+		*cell = ch;
+		corebootfb_putchar(i / columns, i % columns, ch);
+	}
+
+	cursor_y--;
+
+	if (cursor_remember)
+		corebootfb_enable_cursor(1);
+}
+
 static int corebootfb_init(void)
 {
 	if (lib_sysinfo.framebuffer == NULL)
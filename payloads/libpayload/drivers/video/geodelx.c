@@ -233,7 +233,7 @@ static void geodelx_clear(void)
 	}
 }
 
-static void geodelx_putc(u8 row, u8 col, unsigned int ch)
+static void geodelx_putc(unsigned int row, unsigned int col, unsigned int ch)
 {
 	unsigned char *dst;
 	unsigned char *glyph = font8x16 + ((ch & 0xFF) * FONT_HEIGHT);
@@ -249,7 +249,7 @@ static void geodelx_putc(u8 row, u8 col, unsigned int ch)
 	for(y = 0; y < FONT_HEIGHT; y++) {
 
 		for(x = FONT_WIDTH - 1; x >= 0; x--)
-			dst[FONT_WIDTH - x] = (*glyph & (1 << x)) ?
+			dst[FONT_WIDTH - 1 - x] = (*glyph & (1 << x)) ?
 				fg : bg;
 
 		dst += vga_mode.hactive;
@@ -119,7 +119,7 @@ static void vga_clear(void)
 	vga_fill(' ', VGA_COLOR_WHITE);
 }
 
-static void vga_putc(u8 row, u8 col, unsigned int c)
+static void vga_putc(unsigned int row, unsigned int col, unsigned int c)
 {
 	u16 *ptr = VIDEO(row, col);
 	*ptr = (u16) (c & 0xFFFF);
@@ -196,7 +196,7 @@ int video_init(void);
 int video_console_init(void);
 void video_get_rows_cols(unsigned int *rows, unsigned int *cols);
 void video_console_putchar(unsigned int ch);
-void video_console_putc(u8 row, u8 col, unsigned int ch);
+void video_console_putc(unsigned int row, unsigned int col, unsigned int ch);
 void video_console_clear(void);
 void video_console_cursor_enable(int state);
 void video_console_get_cursor(unsigned int *x, unsigned int *y, unsigned int *en);
@@ -37,4 +37,22 @@
  */
 unsigned long ulzma(unsigned char *src, unsigned char *dst);
 
+/* decompresses a CBFS_COMPRESS_LZMA_BLOCKED stream of src_len bytes at src
+ * to dst.
+ *
+ * returns the decompressed size, or 0 on error
+ */
+unsigned long ulzma_blocked(unsigned char *src, unsigned long src_len,
+			    unsigned char *dst);
+
+/* decompresses only the blocks of a CBFS_COMPRESS_LZMA_BLOCKED stream that
+ * hold bytes offset to offset + len - 1 of the data, to where
+ * ulzma_blocked() would put them, so they end up at dst + offset.
+ *
+ * returns how many of the len bytes the stream has, or 0 on error
+ */
+unsigned long ulzma_blocked_range(unsigned char *src, unsigned long src_len,
+				  unsigned char *dst, unsigned long offset,
+				  unsigned long len);
+
 #endif
@@ -56,6 +56,15 @@ typedef enum {
 } storage_poll_t;
 
 
+/* One read of a batch, see storage_read_blocks512_batch(). */
+typedef struct storage_req {
+	lba_t start;
+	size_t count;
+	unsigned char *buf;
+	ssize_t ret;	/* blocks read or -1, set on completion */
+} storage_req_t;
+
+
 struct storage_dev;
 
 typedef struct storage_dev {
@@ -64,6 +73,8 @@ typedef struct storage_dev {
 	storage_poll_t (*poll)(struct storage_dev *);
 	ssize_t (*read_blocks512)(struct storage_dev *, lba_t start, size_t count, unsigned char *buf);
 	ssize_t (*write_blocks512)(struct storage_dev *, lba_t start, size_t count, const unsigned char *buf);
+	/* optional, may keep several reads in flight */
+	ssize_t (*read_blocks512_batch)(struct storage_dev *, storage_req_t *reqs, size_t count);
 
 	void (*detach_device)(struct storage_dev *);
 } storage_dev_t;
@@ -74,5 +85,6 @@ int storage_attach_device(storage_dev_t *dev);
 
 storage_poll_t storage_probe(size_t dev_num);
 ssize_t storage_read_blocks512(size_t dev_num, lba_t start, size_t count, unsigned char *buf);
+ssize_t storage_read_blocks512_batch(size_t dev_num, storage_req_t *reqs, size_t count);
 
 #endif
@@ -94,6 +94,7 @@ struct sysinfo_t {
 	void	*tstamp_table;
 	void	*cbmem_cons;
 	void	*mrc_cache;
+	void	*cbfs_cache;
 };
 
 extern struct sysinfo_t lib_sysinfo;
@@ -113,6 +113,13 @@ struct usbdev {
 
 typedef enum { OHCI = 0, UHCI = 1, EHCI = 2, XHCI = 3} hc_type;
 
+/* One transfer of a bulk_batch() */
+typedef struct {
+	endpoint_t *ep;
+	int size;
+	u8 *data;
+} bulk_xfer_t;
+
 struct usbdev_hc {
 	struct usbdev_hc *next;
 	pcidev_t bus_address;
@@ -136,6 +143,11 @@ struct usbdev_hc {
 	void (*shutdown) (hci_t *controller);
 
 	int (*bulk) (endpoint_t *ep, int size, u8 *data, int finalize);
+	/* bulk_batch(): Optional. Queue all transfers at once and wait for
+	                them. Transfers on the same endpoint run in order, a
+	                short packet ends a transfer early. Returns the number
+	                of transfers finished before the first error. */
+	int (*bulk_batch) (bulk_xfer_t *xfers, int count);
 	int (*control) (usbdev_t *dev, direction_t pid, int dr_length,
 			void *devreq, int data_length, u8 *data);
 	void* (*create_intr_queue) (endpoint_t *ep, int reqsize, int reqcount, int reqtiming);
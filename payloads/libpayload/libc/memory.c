@@ -36,6 +36,20 @@
 static void *default_memset(void *s, int c, size_t n)
 {
 	char *os = s;
+	unsigned long word;
+
+	while (n && ((unsigned long)os & (sizeof(unsigned long) - 1))) {
+		*(os++) = c;
+		n--;
+	}
+
+	word = (unsigned char)c;
+	word |= word << 8;
+	word |= word << 16;
+	for (; n >= sizeof(unsigned long); n -= sizeof(unsigned long)) {
+		*(unsigned long *)os = word;
+		os += sizeof(unsigned long);
+	}
 
 	while (n--)
 		*(os++) = c;
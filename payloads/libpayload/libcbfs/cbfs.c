@@ -36,6 +36,7 @@
 #  define CBFS_CORE_WITH_LZMA
 # endif
 # define CBFS_MINI_BUILD
+# define CBFS_CORE_WITH_CACHE
 #elif defined(__SMM__)
 # define CBFS_MINI_BUILD
 #else
@@ -69,6 +70,19 @@
 # define CBFS_HEADER_ROM_ADDRESS (*(uint32_t*)0xfffffffc)
 #endif
 
+#ifdef CBFS_CORE_WITH_CACHE
+# include <sysinfo.h>
+/* Continue with the lookup cache coreboot left in CBMEM, if any. */
+static struct cbfs_cache *cbfs_get_cache(void)
+{
+	struct cbfs_cache *cache = lib_sysinfo.cbfs_cache;
+
+	if (cache == NULL || cache->magic != CBFS_CACHE_MAGIC)
+		return NULL;
+	return cache;
+}
+#endif
+
 #include "cbfs_core.c"
 
 #ifndef __SMM__
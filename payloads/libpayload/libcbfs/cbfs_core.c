@@ -32,7 +32,8 @@
  * target environment:
  *
  * CBFS_CORE_WITH_LZMA (must be #define)
- *      if defined, ulzma() must exist for decompression of data streams
+ *      if defined, ulzma() and ulzma_blocked() must exist for decompression
+ *      of data streams
  *
  * CBFS_HEADER_ROM_ADDRESS
  *	ROM address (offset) of CBFS header. Underlying CBFS media may interpret
@@ -47,11 +48,64 @@
  * DEBUG(x...)
  *      print a debug message x (in printf format)
  *
+ * CBFS_CORE_WITH_CACHE (optional #define)
+ *      if defined, cbfs_get_cache() must return the per-boot lookup cache
+ *      for the default media, or NULL if it is not available (yet)
+ *
  */
 
 #include <cbfs.h>
 #include <string.h>
 
+#ifndef CBFS_CORE_WITH_CACHE
+# define cbfs_get_cache() ((struct cbfs_cache *)NULL)
+#endif
+
+static inline void cbfs_cache_account(struct cbfs_cache *cache, uint32_t bytes)
+{
+	if (cache)
+		cache->media_bytes += bytes;
+}
+
+static const struct cbfs_cache_entry *cbfs_cache_find(
+		const struct cbfs_cache *cache, const char *name)
+{
+	uint32_t i;
+
+	for (i = 0; i < cache->count; i++) {
+		if (strcmp(cache->entries[i].name, name) == 0)
+			return &cache->entries[i];
+	}
+	return NULL;
+}
+
+/* Remembers the component header at offset. returns 0 if it does not fit. */
+static int cbfs_cache_add(struct cbfs_cache *cache, uint32_t offset,
+			  const struct cbfs_file *file, const char *name)
+{
+	struct cbfs_cache_entry *entry;
+	uint32_t i;
+
+	/* Unused space has an empty name and can't be looked up anyway. */
+	if (name[0] == '\0')
+		return 1;
+	for (i = 0; i < cache->count; i++) {
+		if (cache->entries[i].offset == offset)
+			return 1;
+	}
+	if (cache->count >= CBFS_CACHE_ENTRIES ||
+	    strlen(name) >= CBFS_CACHE_NAME_LEN)
+		return 0;
+
+	entry = &cache->entries[cache->count++];
+	entry->offset = offset;
+	entry->data_offset = ntohl(file->offset);
+	entry->len = ntohl(file->len);
+	entry->type = ntohl(file->type);
+	strcpy(entry->name, name);
+	return 1;
+}
+
 /* returns a pointer to CBFS master header, or CBFS_HEADER_INVALID_ADDRESS
  *  on failure */
 const struct cbfs_header *cbfs_get_header(struct cbfs_media *media)
@@ -91,25 +145,131 @@ const struct cbfs_header *cbfs_get_header(struct cbfs_media *media)
 	return header;
 }
 
-/* public API starts here*/
-struct cbfs_file *cbfs_get_file(struct cbfs_media *media, const char *name)
+/* Checks that the component header at offset belongs to name.
+ * returns 1 if it does, 0 if it is another file, -1 if there is no valid
+ * component header at offset. */
+static int cbfs_check_file(struct cbfs_media *media, uint32_t offset,
+			   const char *name, struct cbfs_file *file,
+			   struct cbfs_cache *cache)
 {
 	const char *file_name;
-	uint32_t offset, align, romsize, name_len;
+	int match;
+
+	cbfs_cache_account(cache, sizeof(*file));
+	if (media->read(media, file, offset, sizeof(*file)) != sizeof(*file) ||
+	    memcmp(CBFS_FILE_MAGIC, file->magic, sizeof(file->magic)) != 0)
+		return -1;
+	cbfs_cache_account(cache, ntohl(file->offset) - sizeof(*file));
+	file_name = (const char*)media->map(media, offset + sizeof(*file),
+					     ntohl(file->offset) - sizeof(*file));
+	if (file_name == CBFS_MEDIA_INVALID_MAP_ADDRESS)
+		return -1;
+	match = (strcmp(file_name, name) == 0);
+	if (match && cache)
+		cbfs_cache_add(cache, offset, file, file_name);
+	media->unmap(media, file_name);
+	return match;
+}
+
+/* Looks up name in the CBFS index whose header is at index_offset.
+ * returns 1 and sets *offset and *file_out if the file was found, 0 if the
+ * index has no such file, and -1 if the index is unusable. */
+static int cbfs_find_in_index(struct cbfs_media *media, uint32_t index_offset,
+			      const char *name, uint32_t *offset,
+			      struct cbfs_file *file_out,
+			      struct cbfs_cache *cache)
+{
+	const struct cbfs_index *index;
+	struct cbfs_file file;
+	uint32_t hash, count, lo, hi, mid;
+	int result = 0;
+
+	cbfs_cache_account(cache, sizeof(file));
+	if (media->read(media, &file, index_offset, sizeof(file)) !=
+	    sizeof(file) ||
+	    memcmp(CBFS_FILE_MAGIC, file.magic, sizeof(file.magic)) != 0 ||
+	    ntohl(file.type) != CBFS_TYPE_INDEX)
+		return -1;
+
+	cbfs_cache_account(cache, ntohl(file.len));
+	index = media->map(media, index_offset + ntohl(file.offset),
+			   ntohl(file.len));
+	if (index == CBFS_MEDIA_INVALID_MAP_ADDRESS)
+		return -1;
+	count = ntohl(index->count);
+	if (ntohl(index->magic) != CBFS_INDEX_MAGIC ||
+	    sizeof(*index) + count * sizeof(index->entries[0]) >
+	    ntohl(file.len)) {
+		media->unmap(media, index);
+		return -1;
+	}
+
+	/* Find the first entry with a matching hash. */
+	hash = cbfs_index_hash(name);
+	lo = 0;
+	hi = count;
+	while (lo < hi) {
+		mid = lo + (hi - lo) / 2;
+		if (ntohl(index->entries[mid].hash) < hash)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	for (; lo < count && ntohl(index->entries[lo].hash) == hash; lo++) {
+		*offset = ntohl(index->entries[lo].offset);
+		result = cbfs_check_file(media, *offset, name, &file, cache);
+		if (result != 0)
+			break;
+	}
+	DEBUG("CBFS index: %d entries, '%s' -> %d\n", count, name, result);
+	if (result == 1)
+		*file_out = file;
+	media->unmap(media, index);
+	return result;
+}
+
+/* Looks up name on an initialized media. On success, copies the file header
+ * to *file_out, stores the media offset of the header in *file_offset and
+ * returns 1. Returns 0 if the file is not there. */
+static int cbfs_lookup_file(struct cbfs_media *media, const char *name,
+			    struct cbfs_cache *cache, struct cbfs_file *file_out,
+			    uint32_t *file_offset)
+{
+	const char *file_name;
+	uint32_t offset, align, romsize, name_len, index_offset;
 	const struct cbfs_header *header;
-	struct cbfs_file file, *file_ptr;
-	struct cbfs_media default_media;
+	struct cbfs_file file;
+	const struct cbfs_cache_entry *entry;
+	int found = 0;
 
-	if (media == CBFS_DEFAULT_MEDIA) {
-		media = &default_media;
-		if (init_default_cbfs_media(media) != 0) {
-			ERROR("Failed to initialize default media.\n");
-			return NULL;
+	if (cache) {
+		cache->lookups++;
+		entry = cbfs_cache_find(cache, name);
+		if (entry) {
+			cache->hits++;
+			LOG("Found file '%s' in cache (offset=0x%x, len=%d).\n",
+			    name, entry->offset + entry->data_offset,
+			    entry->len);
+			memcpy(file_out->magic, CBFS_FILE_MAGIC,
+			       sizeof(file_out->magic));
+			file_out->len = htonl(entry->len);
+			file_out->type = htonl(entry->type);
+			file_out->checksum = 0;
+			file_out->offset = htonl(entry->data_offset);
+			*file_offset = entry->offset;
+			return 1;
+		}
+		if (cache->flags & CBFS_CACHE_COMPLETE) {
+			cache->misses++;
+			ERROR("ERROR: '%s' not in CBFS cache.\n", name);
+			return 0;
 		}
 	}
 
 	if (CBFS_HEADER_INVALID_ADDRESS == (header = cbfs_get_header(media)))
-		return NULL;
+		return 0;
+	cbfs_cache_account(cache, sizeof(*header));
 
 	// Logical offset (for source media) of first file.
 	offset = ntohl(header->offset);
@@ -123,10 +283,42 @@ struct cbfs_file *cbfs_get_file(struct cbfs_media *media, const char *name)
 #endif
 	DEBUG("CBFS location: 0x%x~0x%x, align: %d\n", offset, romsize, align);
 
-	LOG("Looking for '%s' starting from 0x%x.\n", name, offset);
+	index_offset = ntohl(header->index_offset);
 	media->open(media);
+	if (index_offset != 0 && index_offset != 0xffffffff) {
+		index_offset--;
+		switch (cbfs_find_in_index(media, index_offset, name,
+					   &offset, file_out, cache)) {
+		case 1:
+			LOG("Found file '%s' in index (offset=0x%x, len=%d).\n",
+			    name, offset + ntohl(file_out->offset),
+			    ntohl(file_out->len));
+			media->close(media);
+			*file_offset = offset;
+			return 1;
+		case 0:
+			/* Files added after the index was built are only
+			 * found by walking the CBFS. */
+			DEBUG("'%s' not in CBFS index.\n", name);
+			offset = ntohl(header->offset);
+			break;
+		default:
+			ERROR("ERROR: CBFS index at 0x%x is invalid.\n",
+			      index_offset);
+			offset = ntohl(header->offset);
+			break;
+		}
+	}
+
+	/* Everything before next_offset is cached already, skip it. */
+	if (cache && !(cache->flags & CBFS_CACHE_OVERFLOW) &&
+	    cache->next_offset > offset)
+		offset = cache->next_offset;
+
+	LOG("Looking for '%s' starting from 0x%x.\n", name, offset);
 	while (offset < romsize &&
 	       media->read(media, &file, offset, sizeof(file)) == sizeof(file)) {
+		cbfs_cache_account(cache, sizeof(file));
 		if (memcmp(CBFS_FILE_MAGIC, file.magic,
 			   sizeof(file.magic)) != 0) {
 			uint32_t new_align = align;
@@ -143,33 +335,90 @@ struct cbfs_file *cbfs_get_file(struct cbfs_media *media, const char *name)
 		      name_len);
 
 		// load file name (arbitrary length).
+		cbfs_cache_account(cache, name_len);
 		file_name = (const char*)media->map(
 				media, offset + sizeof(file), name_len);
 		if (file_name == CBFS_MEDIA_INVALID_MAP_ADDRESS) {
 			ERROR("ERROR: Failed to get filename: 0x%x.\n", offset);
-		} else if (strcmp(file_name, name) == 0) {
-			int file_offset = ntohl(file.offset),
-			    file_len = ntohl(file.len);
-			LOG("Found file (offset=0x%x, len=%d).\n",
-			    offset + file_offset, file_len);
-			media->unmap(media, file_name);
-			file_ptr = media->map(media, offset,
-					      file_offset + file_len);
-			media->close(media);
-			return file_ptr;
 		} else {
-			LOG(" (unmatched file @0x%x: %s)\n", offset, file_name);
+			found = (strcmp(file_name, name) == 0);
+
+			if (cache && !cbfs_cache_add(cache, offset, &file,
+						     file_name))
+				cache->flags |= CBFS_CACHE_OVERFLOW;
+			if (!found)
+				LOG(" (unmatched file @0x%x: %s)\n", offset,
+				    file_name);
 			media->unmap(media, file_name);
+			if (found) {
+				LOG("Found file (offset=0x%x, len=%d).\n",
+				    offset + ntohl(file.offset),
+				    ntohl(file.len));
+				*file_out = file;
+				*file_offset = offset;
+			}
 		}
 
 		// Move to next file.
 		offset += ntohl(file.len) + ntohl(file.offset);
 		if (offset % align)
 			offset += align - (offset % align);
+		if (cache && !(cache->flags & CBFS_CACHE_OVERFLOW))
+			cache->next_offset = offset;
+
+		if (found) {
+			media->close(media);
+			return 1;
+		}
 	}
+	if (cache && !(cache->flags & CBFS_CACHE_OVERFLOW) &&
+	    offset >= romsize)
+		cache->flags |= CBFS_CACHE_COMPLETE;
 	media->close(media);
 	ERROR("ERROR: Not found.\n");
-	return NULL;
+	return 0;
+}
+
+/* public API starts here*/
+struct cbfs_file *cbfs_get_file(struct cbfs_media *media, const char *name)
+{
+	struct cbfs_file file, *file_ptr;
+	struct cbfs_media default_media;
+	struct cbfs_cache *cache = NULL;
+	uint32_t offset;
+
+	if (media == CBFS_DEFAULT_MEDIA) {
+		media = &default_media;
+		if (init_default_cbfs_media(media) != 0) {
+			ERROR("Failed to initialize default media.\n");
+			return NULL;
+		}
+		cache = cbfs_get_cache();
+	}
+
+	if (!cbfs_lookup_file(media, name, cache, &file, &offset))
+		return NULL;
+
+	media->open(media);
+	file_ptr = media->map(media, offset,
+			      ntohl(file.offset) + ntohl(file.len));
+	media->close(media);
+	return file_ptr;
+}
+
+int cbfs_locate_file(struct cbfs_media *media, const char *name,
+		     struct cbfs_file *file, uint32_t *data_offset)
+{
+	uint32_t offset;
+
+	if (media == CBFS_DEFAULT_MEDIA) {
+		ERROR("cbfs_locate_file needs an initialized media.\n");
+		return -1;
+	}
+	if (!cbfs_lookup_file(media, name, NULL, file, &offset))
+		return -1;
+	*data_offset = offset + ntohl(file->offset);
+	return 0;
 }
 
 void *cbfs_get_file_content(struct cbfs_media *media, const char *name, int type)
@@ -202,6 +451,11 @@ int cbfs_decompress(int algo, void *src, void *dst, int len)
 				return 0;
 			}
 			return -1;
+		case CBFS_COMPRESS_LZMA_BLOCKED:
+			if (ulzma_blocked(src, len, dst) != 0) {
+				return 0;
+			}
+			return -1;
 #endif
 		default:
 			ERROR("tried to decompress %d bytes with algorithm #%x,"
@@ -12,9 +12,12 @@
 #include <lzma.h>
 #include <stdio.h>
 #include <string.h>
+#include <cbfs_core.h>
 #include "lzmadecode.c"
 
-unsigned long ulzma(unsigned char * src, unsigned char * dst)
+/* Decodes the stream at src, reading at most src_len bytes of it. */
+static unsigned long ulzma_len(unsigned char *src, SizeT src_len,
+			       unsigned char *dst)
 {
 	unsigned char properties[LZMA_PROPERTIES_SIZE];
 	UInt32 outSize;
@@ -37,7 +40,7 @@ unsigned long ulzma(unsigned char * src, unsigned char * dst)
 		return 0;
 	}
 	state.Probs = (CProb *)scratchpad;
-	res = LzmaDecode(&state, src + LZMA_PROPERTIES_SIZE + 8, (SizeT)0xffffffff, &inProcessed,
+	res = LzmaDecode(&state, src + LZMA_PROPERTIES_SIZE + 8, src_len, &inProcessed,
 		dst, outSize, &outProcessed);
 	if (res != 0) {
 		printf("lzma: Decoding error = %d\n", res);
@@ -45,3 +48,70 @@ unsigned long ulzma(unsigned char * src, unsigned char * dst)
 	}
 	return outSize;
 }
+
+unsigned long ulzma(unsigned char * src, unsigned char * dst)
+{
+	return ulzma_len(src, (SizeT)0xffffffff, dst);
+}
+
+static u32 blocked_get_le32(const unsigned char *cp)
+{
+	return cp[3] << 24 | cp[2] << 16 | cp[1] << 8 | cp[0];
+}
+
+unsigned long ulzma_blocked_range(unsigned char *src, unsigned long src_len,
+				  unsigned char *dst, unsigned long offset,
+				  unsigned long len)
+{
+	u32 block_size, num_blocks, total_size, i, first, last;
+	unsigned char *offsets = src + sizeof(struct cbfs_lzma_blocked);
+
+	if (src_len < sizeof(struct cbfs_lzma_blocked) ||
+	    blocked_get_le32(src) != CBFS_LZMA_BLOCKED_MAGIC) {
+		printf("lzma: Not a blocked LZMA stream.\n");
+		return 0;
+	}
+	block_size = blocked_get_le32(src + 4);
+	num_blocks = blocked_get_le32(src + 8);
+	total_size = blocked_get_le32(src + 12);
+	if (!num_blocks || total_size > (u64)block_size * num_blocks ||
+	    total_size <= (u64)block_size * (num_blocks - 1) ||
+	    sizeof(struct cbfs_lzma_blocked) + 4 * (u64)num_blocks > src_len) {
+		printf("lzma: Bad blocked LZMA header.\n");
+		return 0;
+	}
+	if (!len || offset >= total_size)
+		return 0;
+	if (len > total_size - offset)
+		len = total_size - offset;
+
+	first = offset / block_size;
+	last = (offset + len - 1) / block_size;
+	for (i = first; i <= last; i++) {
+		u32 start = i * block_size;
+		u32 expected = total_size - start;
+		u32 block = blocked_get_le32(offsets + 4 * i);
+
+		if (expected > block_size)
+			expected = block_size;
+		/* The block must lie in the file and decode to exactly its
+		 * share, or it would be decoded past the end of dst. */
+		if (block < LZMA_PROPERTIES_SIZE + 8 ||
+		    block > src_len - LZMA_PROPERTIES_SIZE - 8 ||
+		    blocked_get_le32(src + block + LZMA_PROPERTIES_SIZE) !=
+		    expected ||
+		    ulzma_len(src + block,
+			      src_len - block - LZMA_PROPERTIES_SIZE - 8,
+			      dst + start) != expected) {
+			printf("lzma: Block %d is corrupt.\n", i);
+			return 0;
+		}
+	}
+	return len;
+}
+
+unsigned long ulzma_blocked(unsigned char *src, unsigned long src_len,
+			    unsigned char *dst)
+{
+	return ulzma_blocked_range(src, src_len, dst, 0, ~0UL);
+}
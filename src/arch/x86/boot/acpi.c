@@ -33,6 +33,7 @@
 #include <cbmem.h>
 #include <cpu/x86/lapic_def.h>
 #include <cpu/cpu.h>
+#include <cpu/x86/work_queue.h>
 #if CONFIG_COLLECT_TIMESTAMPS
 #include <timestamp.h>
 #endif
@@ -782,6 +783,9 @@ void acpi_jump_to_wakeup(void *vector)
 	timestamp_add_now(TS_ACPI_WAKE_JUMP);
 #endif
 
+	console_tx_flush();
+	cpu_work_stop();
+
 	acpi_do_wakeup((u32)vector, acpi_backup_memory, CONFIG_RAMBASE,
 		       HIGH_MEMORY_SAVE);
 }
@@ -92,6 +92,26 @@ void jmp_to_elf_entry(void *entry, unsigned long buffer, unsigned long size)
 	printk(BIOS_SPEW, "     elf_boot_notes = 0x%08lx\n", (unsigned long)&elf_boot_notes);
 	printk(BIOS_SPEW, "adjusted_boot_notes = 0x%08lx\n", adjusted_boot_notes);
 
+	/* Nothing was loaded over coreboot, so there is no copy of it to
+	 * swap in and out around the call.
+	 */
+	if (!buffer) {
+#if CONFIG_MULTIBOOT
+		unsigned long eax = MB_MAGIC2, ebx = (unsigned long)mbi;
+#else
+		unsigned long eax = 0x0E1FB007;
+		unsigned long ebx = (unsigned long)&elf_boot_notes;
+#endif
+		__asm__ __volatile__(
+			"	cld	\n\t"
+			"	call	*%2\n\t"
+			: "+a" (eax), "+b" (ebx)
+			: "m" (entry)
+			: "ecx", "edx", "esi", "edi", "memory", "cc"
+			);
+		return;
+	}
+
 	/* Jump to kernel */
 	__asm__ __volatile__(
 		"	cld	\n\t"
@@ -1,15 +1,87 @@
 #include <string.h>
 
+#if CONFIG_SSE && !defined(__PRE_RAM__) && !defined(__SMM__)
+/*
+ * Large copies go through the XMM registers 64 bytes at a time. This is
+ * only done in ramstage, and only if the SSE state has been enabled in
+ * CR4: SMM must not touch the OS's XMM registers, and romcc keeps its
+ * spills there before RAM is up. The rest of coreboot is built without
+ * SSE, so sse_copy() is built for it on its own and never inlined.
+ */
+#define SSE_THRESHOLD 512
+
+static inline int sse_enabled(void)
+{
+	unsigned long cr4;
+
+	asm volatile ("movl %%cr4, %0" : "=r" (cr4));
+	return (cr4 & (1 << 9)) != 0;	/* CR4.OSFXSR */
+}
+
+static void __attribute__((target("sse"), noinline))
+sse_copy(void *dest, const void *src, size_t blocks)
+{
+	asm volatile(
+		"1:\n\t"
+		"movups   (%1), %%xmm0\n\t"
+		"movups 16(%1), %%xmm1\n\t"
+		"movups 32(%1), %%xmm2\n\t"
+		"movups 48(%1), %%xmm3\n\t"
+		"movaps %%xmm0,   (%0)\n\t"
+		"movaps %%xmm1, 16(%0)\n\t"
+		"movaps %%xmm2, 32(%0)\n\t"
+		"movaps %%xmm3, 48(%0)\n\t"
+		"addl $64, %1\n\t"
+		"addl $64, %0\n\t"
+		"decl %2\n\t"
+		"jnz 1b\n\t"
+		: "+r" (dest), "+r" (src), "+r" (blocks)
+		:
+		: "memory", "xmm0", "xmm1", "xmm2", "xmm3"
+	);
+}
+#endif
+
 void *memcpy(void *dest, const void *src, size_t n)
 {
-	unsigned long d0, d1, d2;
+	unsigned long dst = (unsigned long)dest;
+	unsigned long s = (unsigned long)src;
+	unsigned long d0;
+	size_t head;
+
+#if CONFIG_SSE && !defined(__PRE_RAM__) && !defined(__SMM__)
+	if (n >= SSE_THRESHOLD && sse_enabled()) {
+		head = -dst & 15;
+		n -= head;
+		asm volatile(
+			"cld\n\t"
+			"rep ; movsb\n\t"
+			: "+D" (dst), "+S" (s), "+c" (head)
+			:
+			: "memory"
+		);
+		sse_copy((void *)dst, (const void *)s, n >> 6);
+		dst += n & ~63;
+		s += n & ~63;
+		n &= 63;
+	}
+#endif
+
+	/* Align the destination, then move longwords and the tail. */
+	head = -dst & 3;
+	if (head > n)
+		head = n;
+	n -= head;
 
 	asm volatile(
-		"rep ; movsl\n\t"
+		"cld\n\t"
+		"rep ; movsb\n\t"
 		"movl %4,%%ecx\n\t"
+		"rep ; movsl\n\t"
+		"movl %5,%%ecx\n\t"
 		"rep ; movsb\n\t"
-		: "=&c" (d0), "=&D" (d1), "=&S" (d2)
-		: "0" (n >> 2), "g" (n & 3), "1" (dest), "2" (src)
+		: "+D" (dst), "+S" (s), "=&c" (d0)
+		: "2" (head), "g" (n >> 2), "g" (n & 3)
 		: "memory"
 	);
 
@@ -0,0 +1,31 @@
+#include <string.h>
+
+void *memmove(void *dest, const void *src, size_t n)
+{
+	unsigned long d0, d1, d2;
+
+	/* A forward copy is safe unless dest overlaps the end of src. */
+	if ((unsigned long)dest - (unsigned long)src >= n)
+		return memcpy(dest, src, n);
+
+	/*
+	 * Copy backwards: first the odd tail bytes, then longwords. After
+	 * the byte loop ESI/EDI point at the last byte of the last whole
+	 * longword, so step back three to its start.
+	 */
+	asm volatile(
+		"std\n\t"
+		"rep ; movsb\n\t"
+		"subl $3,%%esi\n\t"
+		"subl $3,%%edi\n\t"
+		"movl %4,%%ecx\n\t"
+		"rep ; movsl\n\t"
+		"cld\n\t"
+		: "=&c" (d0), "=&D" (d1), "=&S" (d2)
+		: "0" (n & 3), "g" (n >> 2),
+		  "1" ((char *)dest + n - 1), "2" ((const char *)src + n - 1)
+		: "memory"
+	);
+
+	return dest;
+}
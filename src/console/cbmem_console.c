@@ -32,4 +32,5 @@ static void cbmemc_tx_byte_(unsigned char data)
 static const struct console_driver cbmem_console __console = {
 	.init     = cbmemc_init_,
 	.tx_byte  = cbmemc_tx_byte_,
+	.tx_buf   = cbmemc_tx_buf,
 };
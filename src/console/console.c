@@ -60,6 +60,18 @@ void console_tx_flush(void)
 	}
 }
 
+#if CONFIG_CONSOLE_SERIAL8250_DEFERRED
+void console_drain(void)
+{
+	struct console_driver *driver;
+	for(driver = console_drivers; driver < econsole_drivers; driver++) {
+		if (!driver->drain)
+			continue;
+		driver->drain();
+	}
+}
+#endif
+
 static void __console_tx_byte(unsigned char byte)
 {
 	struct console_driver *driver;
@@ -75,6 +87,37 @@ void console_tx_byte(unsigned char byte)
 	__console_tx_byte(byte);
 }
 
+static void __console_tx_buf(const unsigned char *buf, int len)
+{
+	struct console_driver *driver;
+	int i;
+
+	for(driver = console_drivers; driver < econsole_drivers; driver++) {
+		if (driver->tx_buf) {
+			driver->tx_buf(buf, len);
+			continue;
+		}
+		for (i = 0; i < len; i++)
+			driver->tx_byte(buf[i]);
+	}
+}
+
+/* Same as calling console_tx_byte() for each byte, but in as few chunks
+ * as the newlines allow. */
+void console_tx_buf(const unsigned char *buf, int len)
+{
+	int i, start = 0;
+
+	for (i = 0; i < len; i++) {
+		if (buf[i] != '\n')
+			continue;
+		__console_tx_buf(buf + start, i - start);
+		__console_tx_byte('\r');
+		start = i;
+	}
+	__console_tx_buf(buf + start, len - start);
+}
+
 unsigned char console_rx_byte(void)
 {
 	struct console_driver *driver;
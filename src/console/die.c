@@ -33,6 +33,9 @@
 void NORETURN die(const char *msg)
 {
 	print_emerg(msg);
+#if !defined(__PRE_RAM__) && !defined(__ROMCC__)
+	console_tx_flush();
+#endif
 	do {
 		hlt();
 	} while(1);
@@ -107,4 +107,7 @@ void post_code(uint8_t value)
 #endif
 #endif
 	mainboard_post(value);
+
+	/* Boot phases end with a post code, a good time to catch up. */
+	console_drain();
 }
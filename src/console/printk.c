@@ -28,13 +28,78 @@ int do_printk(int msg_level, const char *fmt, ...)
 	spin_lock(&console_lock);
 
 	va_start(args, fmt);
+#if defined(__SMM__)
 	i = vtxprintf(console_tx_byte, fmt, args);
+#else
+	i = vtxprintf_buf(console_tx_buf, fmt, args);
+#endif
 	va_end(args);
 
+#if CONFIG_CONSOLE_SERIAL8250_DEFERRED && !defined(__SMM__)
+	console_drain();
+#else
 	console_tx_flush();
+#endif
 
 	spin_unlock(&console_lock);
 	ENABLE_TRACE;
 
 	return i;
 }
+
+#if CONFIG_CONSOLE_CBMEM_DICTIONARY && !defined(__SMM__)
+static void dict_tx_u32(u32 value)
+{
+	cbmemc_tx_byte(value);
+	cbmemc_tx_byte(value >> 8);
+	cbmemc_tx_byte(value >> 16);
+	cbmemc_tx_byte(value >> 24);
+}
+
+/* Store a message as a dictionary record, see console/printk_dict.h. */
+int do_printk_dict(int msg_level, const char *fmt, u32 types, ...)
+{
+	va_list args;
+	const char *s;
+	u64 quad;
+	int i;
+
+	if (msg_level > console_loglevel) {
+		return 0;
+	}
+
+	DISABLE_TRACE;
+	spin_lock(&console_lock);
+
+	cbmemc_tx_byte(PRINTK_DICT_MARKER);
+	dict_tx_u32((u32)fmt);
+	dict_tx_u32(types);
+
+	va_start(args, types);
+	for (; types; types >>= 2) {
+		switch (types & 3) {
+		case PRINTK_ARG_WORD:
+			dict_tx_u32(va_arg(args, u32));
+			break;
+		case PRINTK_ARG_QUAD:
+			quad = va_arg(args, u64);
+			dict_tx_u32(quad);
+			dict_tx_u32(quad >> 32);
+			break;
+		case PRINTK_ARG_STRING:
+			s = va_arg(args, const char *);
+			dict_tx_u32((u32)s);
+			for (i = 0; s && s[i] && i < PRINTK_DICT_MAX_STRING; i++)
+				cbmemc_tx_byte(s[i]);
+			cbmemc_tx_byte(0);
+			break;
+		}
+	}
+	va_end(args);
+
+	spin_unlock(&console_lock);
+	ENABLE_TRACE;
+
+	return 0;
+}
+#endif
@@ -20,12 +20,78 @@
 #include <console/console.h>
 #include <uart8250.h>
 #include <pc80/mc146818rtc.h>
+#include <smp/spinlock.h>
+#include <stdlib.h>
 
 static void ttyS0_init(void)
 {
 	uart_init();
 }
 
+#if CONFIG_CONSOLE_SERIAL8250_DEFERRED
+/*
+ * Output is queued here and sent whenever the UART is ready, instead of
+ * printk() waiting for every character to go out. Only printk() adds to
+ * the ring, under console_lock. Anybody may drain it, whoever sets
+ * tx_draining first does.
+ */
+#define TX_RING_SIZE	CONFIG_CONSOLE_SERIAL8250_DEFERRED_BUFFER_SIZE
+
+static unsigned char tx_ring[TX_RING_SIZE];
+static volatile u32 tx_head, tx_tail;	/* free running */
+static volatile int tx_draining;
+
+/*
+ * Send queued bytes as long as the UART takes them, then keep waiting for
+ * it only while more than limit bytes are queued.
+ */
+static void ttyS0_drain_to(u32 limit)
+{
+	u32 queued, tail;
+	int n;
+
+	if (__sync_lock_test_and_set(&tx_draining, 1))
+		return;
+
+	while ((queued = tx_head - tx_tail) != 0) {
+		tail = tx_tail % TX_RING_SIZE;
+		n = MIN(queued, TX_RING_SIZE - tail);
+		n = uart8250_tx_bytes_nowait(CONFIG_TTYS0_BASE,
+					     &tx_ring[tail], n);
+		if (!n) {
+			if (queued <= limit)
+				break;
+			/* This gives up on a stuck UART after a while. */
+			uart8250_tx_byte(CONFIG_TTYS0_BASE, tx_ring[tail]);
+			n = 1;
+		}
+		tx_tail += n;
+	}
+
+	__sync_lock_release(&tx_draining);
+}
+
+static void ttyS0_tx_byte(unsigned char data)
+{
+	while (tx_head - tx_tail >= TX_RING_SIZE)
+		ttyS0_drain_to(TX_RING_SIZE - 1);
+	tx_ring[tx_head % TX_RING_SIZE] = data;
+	barrier();
+	tx_head++;
+}
+
+static void ttyS0_drain(void)
+{
+	ttyS0_drain_to(TX_RING_SIZE);
+}
+
+static void ttyS0_tx_flush(void)
+{
+	while (tx_head != tx_tail)
+		ttyS0_drain_to(0);
+	uart8250_tx_flush(CONFIG_TTYS0_BASE);
+}
+#else
 static void ttyS0_tx_byte(unsigned char data)
 {
 	uart8250_tx_byte(CONFIG_TTYS0_BASE, data);
@@ -35,6 +101,7 @@ static void ttyS0_tx_flush(void)
 {
 	uart8250_tx_flush(CONFIG_TTYS0_BASE);
 }
+#endif
 
 static unsigned char ttyS0_rx_byte(void)
 {
@@ -50,6 +117,9 @@ static const struct console_driver uart8250_console __console = {
 	.init     = ttyS0_init,
 	.tx_byte  = ttyS0_tx_byte,
 	.tx_flush = ttyS0_tx_flush,
+#if CONFIG_CONSOLE_SERIAL8250_DEFERRED
+	.drain    = ttyS0_drain,
+#endif
 	.rx_byte  = ttyS0_rx_byte,
 	.tst_byte = ttyS0_tst_byte,
 };
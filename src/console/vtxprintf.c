@@ -31,7 +31,53 @@ static int skip_atoi(const char **s)
 #define SPECIAL	32		/* 0x */
 #define LARGE	64		/* use 'ABCDEF' instead of 'abcdef' */
 
-static int number(void (*tx_byte)(unsigned char byte),
+/*
+ * Output goes either to tx_byte one character at a time or, if tx_buf is
+ * set, through buf to tx_buf in chunks.
+ */
+struct tx_state {
+	void (*tx_byte)(unsigned char byte);
+	void (*tx_buf)(const unsigned char *buf, int len);
+	int len;
+	unsigned char buf[64];
+};
+
+static void tx_flush(struct tx_state *tx)
+{
+	if (tx->len)
+		tx->tx_buf(tx->buf, tx->len);
+	tx->len = 0;
+}
+
+static inline void tx_char(struct tx_state *tx, unsigned char c)
+{
+	if (!tx->tx_buf) {
+		tx->tx_byte(c);
+		return;
+	}
+	tx->buf[tx->len++] = c;
+	if (tx->len == sizeof(tx->buf))
+		tx_flush(tx);
+}
+
+static void tx_chars(struct tx_state *tx, const char *s, int n)
+{
+	if (!tx->tx_buf) {
+		while (n--)
+			tx->tx_byte(*s++);
+		return;
+	}
+	if (tx->len + n > sizeof(tx->buf))
+		tx_flush(tx);
+	if (n >= sizeof(tx->buf)) {
+		tx->tx_buf((const unsigned char *)s, n);
+		return;
+	}
+	memcpy(tx->buf + tx->len, s, n);
+	tx->len += n;
+}
+
+static int number(struct tx_state *tx,
 	unsigned long long num, int base, int size, int precision, int type)
 {
 	char c,sign,tmp[66];
@@ -69,56 +115,69 @@ static int number(void (*tx_byte)(unsigned char byte),
 	i = 0;
 	if (num == 0)
 		tmp[i++]='0';
-	else while (num != 0){
-		/* there are some nice optimizations in the
-		 * Macros-From-Hell that form the div64 code
-		 * *IF* you call it with a constant.
-		 * We're firmware, we only do bases
-		 * 8, 10, and 16. Let's be smart.
-		 * This greatly helps ARM, reduces the
-		 * code footprint at compile time, and does not hurt x86.
-		 */
+	/* Digits beyond 32 bits. Only decimal needs a real division. */
+	while (num >> 32) {
 		if (base == 10)
 			tmp[i++] = digits[do_div(num,10)];
+		else if (base == 8) {
+			tmp[i++] = digits[num & 7];
+			num >>= 3;
+		} else {
+			tmp[i++] = digits[num & 15];
+			num >>= 4;
+		}
+	}
+	/*
+	 * The rest fits in 32 bits, where the compiler turns the division
+	 * by a constant into a multiplication.
+	 */
+	{
+		u32 n = num;
+
+		if (base == 10)
+			for (; n; n /= 10)
+				tmp[i++] = digits[n % 10];
 		else if (base == 8)
-			tmp[i++] = digits[do_div(num,8)];
+			for (; n; n >>= 3)
+				tmp[i++] = digits[n & 7];
 		else /* sorry, you're out of choices */
-			tmp[i++] = digits[do_div(num,16)];
+			for (; n; n >>= 4)
+				tmp[i++] = digits[n & 15];
 	}
 	if (i > precision)
 		precision = i;
 	size -= precision;
 	if (!(type&(ZEROPAD+LEFT)))
 		while(size-->0)
-			tx_byte(' '), count++;
+			tx_char(tx, ' '), count++;
 	if (sign)
-		tx_byte(sign), count++;
+		tx_char(tx, sign), count++;
 	if (type & SPECIAL) {
 		if (base==8)
-			tx_byte('0'), count++;
+			tx_char(tx, '0'), count++;
 		else if (base==16) {
-			tx_byte('0'), count++;
-			tx_byte(digits[33]), count++;
+			tx_char(tx, '0'), count++;
+			tx_char(tx, digits[33]), count++;
 		}
 	}
 	if (!(type & LEFT))
 		while (size-- > 0)
-			tx_byte(c), count++;
+			tx_char(tx, c), count++;
 	while (i < precision--)
-		tx_byte('0'), count++;
+		tx_char(tx, '0'), count++;
 	while (i-- > 0)
-		tx_byte(tmp[i]), count++;
+		tx_char(tx, tmp[i]), count++;
 	while (size-- > 0)
-		tx_byte(' '), count++;
+		tx_char(tx, ' '), count++;
 	return count;
 }
 
 
-int vtxprintf(void (*tx_byte)(unsigned char byte), const char *fmt, va_list args)
+static int __vtxprintf(struct tx_state *tx, const char *fmt, va_list args)
 {
 	int len;
 	unsigned long long num;
-	int i, base;
+	int base;
 	const char *s;
 
 	int flags;		/* flags to number() */
@@ -130,14 +189,13 @@ int vtxprintf(void (*tx_byte)(unsigned char byte), const char *fmt, va_list args
 
 	int count;
 
-#if defined(__SMM__) && CONFIG_SMM_TSEG
-	/* Fix pointer in TSEG */
-	tx_byte = console_tx_byte;
-#endif
-
 	for (count=0; *fmt ; ++fmt) {
 		if (*fmt != '%') {
-			tx_byte(*fmt), count++;
+			s = fmt;
+			while (fmt[1] && fmt[1] != '%')
+				fmt++;
+			tx_chars(tx, s, fmt - s + 1);
+			count += fmt - s + 1;
 			continue;
 		}
 
@@ -200,10 +258,10 @@ repeat:
 		case 'c':
 			if (!(flags & LEFT))
 				while (--field_width > 0)
-					tx_byte(' '), count++;
-			tx_byte((unsigned char) va_arg(args, int)), count++;
+					tx_char(tx, ' '), count++;
+			tx_char(tx, (unsigned char) va_arg(args, int)), count++;
 			while (--field_width > 0)
-				tx_byte(' '), count++;
+				tx_char(tx, ' '), count++;
 			continue;
 
 		case 's':
@@ -215,11 +273,11 @@ repeat:
 
 			if (!(flags & LEFT))
 				while (len < field_width--)
-					tx_byte(' '), count++;
-			for (i = 0; i < len; ++i)
-				tx_byte(*s++), count++;
+					tx_char(tx, ' '), count++;
+			tx_chars(tx, s, len);
+			count += len;
 			while (len < field_width--)
-				tx_byte(' '), count++;
+				tx_char(tx, ' '), count++;
 			continue;
 
 		case 'p':
@@ -227,7 +285,7 @@ repeat:
 				field_width = 2*sizeof(void *);
 				flags |= ZEROPAD;
 			}
-			count += number(tx_byte,
+			count += number(tx,
 				(unsigned long) va_arg(args, void *), 16,
 				field_width, precision, flags);
 			continue;
@@ -246,7 +304,7 @@ repeat:
 			continue;
 
 		case '%':
-			tx_byte('%'), count++;
+			tx_char(tx, '%'), count++;
 			continue;
 
 		/* integer number formats - set up the flags and "break" */
@@ -267,9 +325,9 @@ repeat:
 			break;
 
 		default:
-			tx_byte('%'), count++;
+			tx_char(tx, '%'), count++;
 			if (*fmt)
-				tx_byte(*fmt), count++;
+				tx_char(tx, *fmt), count++;
 			else
 				--fmt;
 			continue;
@@ -289,8 +347,36 @@ repeat:
 		} else {
 			num = va_arg(args, unsigned int);
 		}
-		count += number(tx_byte, num, base, field_width, precision, flags);
+		count += number(tx, num, base, field_width, precision, flags);
 	}
 	return count;
 }
 
+int vtxprintf(void (*tx_byte)(unsigned char byte), const char *fmt, va_list args)
+{
+	struct tx_state tx;
+
+#if defined(__SMM__) && CONFIG_SMM_TSEG
+	/* Fix pointer in TSEG */
+	tx_byte = console_tx_byte;
+#endif
+
+	tx.tx_byte = tx_byte;
+	tx.tx_buf = NULL;
+	return __vtxprintf(&tx, fmt, args);
+}
+
+int vtxprintf_buf(void (*tx_buf)(const unsigned char *buf, int len),
+		  const char *fmt, va_list args)
+{
+	struct tx_state tx;
+	int count;
+
+	tx.tx_byte = NULL;
+	tx.tx_buf = tx_buf;
+	tx.len = 0;
+	count = __vtxprintf(&tx, fmt, args);
+	tx_flush(&tx);
+	return count;
+}
+
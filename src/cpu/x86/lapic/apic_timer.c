@@ -19,6 +19,7 @@
  */
 
 #include <stdint.h>
+#include <console/console.h>
 #include <delay.h>
 #include <arch/io.h>
 #include <arch/cpu.h>
@@ -102,5 +103,7 @@ void udelay(u32 usecs)
 	start = lapic_read(LAPIC_TMCCT);
 	do {
 		value = lapic_read(LAPIC_TMCCT);
+		if ((start - value) + CONSOLE_DRAIN_US * timer_fsb < ticks)
+			console_drain();
 	} while((start - value) < ticks);
 }
@@ -32,6 +32,8 @@
 #include <smp/spinlock.h>
 #include <cpu/cpu.h>
 #include <cpu/intel/speedstep.h>
+#include <cpu/x86/tsc.h>
+#include <cpu/x86/work_queue.h>
 
 #if CONFIG_SMP && CONFIG_MAX_CPUS > 1
 /* This is a lot more paranoid now, since Linux can NOT handle
@@ -239,25 +241,13 @@ static void *stacks[CONFIG_MAX_CPUS];
 volatile unsigned long secondary_stack;
 volatile unsigned int secondary_cpu_index;
 
-int start_cpu(device_t cpu)
+/* Set up the stack of CPU 'index' and return its top. */
+static unsigned long setup_cpu_stack(unsigned int index)
 {
-	struct cpu_info *info;
 	unsigned long stack_end;
 	unsigned long stack_base;
 	unsigned long *stack;
-	unsigned long apicid;
-	unsigned int index;
-	unsigned long count;
 	int i;
-	int result;
-
-	spin_lock(&start_cpu_lock);
-
-	/* Get the CPU's apicid */
-	apicid = cpu->path.apic.apic_id;
-
-	/* Get an index for the new processor */
-	index = ++last_cpu_index;
 
 	/* Find end of the new processor's stack */
 	stack_end = ((unsigned long)_estack) - (CONFIG_STACK_SIZE*index) -
@@ -270,6 +260,212 @@ int start_cpu(device_t cpu)
 	for(stack = (void *)stack_base, i = 0; i < CONFIG_STACK_SIZE; i++)
 		stack[i/sizeof(*stack)] = 0xDEADBEEF;
 	stacks[index] = stack;
+	return stack_end;
+}
+
+#if CONFIG_PARALLEL_CPU_INIT
+/*
+ * With PARALLEL_CPU_INIT the APs wake up all at once, so they can't be
+ * handed a stack one at a time. Instead secondary.S takes the next index
+ * from ap_next_index and the stack prepared for it from ap_stacks[]. The
+ * AP then reports its APIC ID and waits for the BSP to hand it its device:
+ * allocating one takes malloc(), which only the BSP may call.
+ */
+volatile unsigned int ap_next_index = 1;
+unsigned long ap_stacks[CONFIG_MAX_CPUS];
+
+static struct bus *ap_cpu_bus;
+static device_t volatile ap_cpus[CONFIG_MAX_CPUS];
+static volatile int ap_present[CONFIG_MAX_CPUS];
+static volatile int ap_devices_done;
+static unsigned int ap_apic_ids[CONFIG_MAX_CPUS];
+static atomic_t ap_arrived = ATOMIC_INIT(0);
+static unsigned long long ap_sipi_tsc;
+static unsigned long long ap_arrival_tsc[CONFIG_MAX_CPUS];
+
+static int ap_started(device_t cpu)
+{
+	int i;
+
+	for (i = 1; i < CONFIG_MAX_CPUS; i++)
+		if (ap_cpus[i] == cpu)
+			return 1;
+	return 0;
+}
+
+/* Called on the BSP: give every AP that called in its device. */
+static void ap_assign_devices(void)
+{
+	struct device_path cpu_path;
+	int i;
+
+	for (i = 1; i < CONFIG_MAX_CPUS; i++) {
+		if (!ap_present[i] || ap_cpus[i])
+			continue;
+		cpu_path.type = DEVICE_PATH_APIC;
+		cpu_path.apic.apic_id = ap_apic_ids[i];
+		ap_cpus[i] = alloc_find_dev(ap_cpu_bus, &cpu_path);
+	}
+}
+
+/* Called on the AP: tell the BSP we're here and wait for our device. */
+static int ap_claim_device(unsigned int index, unsigned long long arrival)
+{
+	struct cpu_info *info;
+	device_t cpu;
+
+	ap_apic_ids[index] = lapicid();
+	ap_arrival_tsc[index] = arrival;
+	barrier();
+	ap_present[index] = 1;
+	atomic_inc(&ap_arrived);
+
+	while (!ap_cpus[index] && !ap_devices_done)
+		cpu_relax();
+	cpu = ap_cpus[index];
+	if (!cpu)
+		return 0;
+
+	info = cpu_info();
+	info->index = index;
+	info->cpu = cpu;
+	return cpu->enabled;
+}
+
+static int lapic_send_ipi_all_but_self(unsigned long icr)
+{
+	int timeout;
+
+	lapic_write_around(LAPIC_ICR2, 0);
+	lapic_write_around(LAPIC_ICR, LAPIC_DEST_ALLBUT | icr);
+
+	for (timeout = 0; timeout < 100000; timeout++) {
+		if (!(lapic_read(LAPIC_ICR) & LAPIC_ICR_BUSY))
+			return 1;
+		udelay(1);
+	}
+	return 0;
+}
+
+static void start_all_aps(struct bus *cpu_bus, device_t bsp_cpu)
+{
+	device_t cpu;
+	unsigned int i, expected, arrived, last;
+	int count, idle;
+	unsigned long long wait_tsc, tsc_per_us = 1;
+
+	ap_cpu_bus = cpu_bus;
+	for (i = 1; i < CONFIG_MAX_CPUS; i++)
+		ap_stacks[i] = setup_cpu_stack(i);
+
+	/* CPUs in the devicetree should all show up. */
+	expected = 0;
+	for (cpu = cpu_bus->children; cpu; cpu = cpu->sibling) {
+		if (cpu->path.type != DEVICE_PATH_APIC || cpu == bsp_cpu)
+			continue;
+		if (cpu->path.apic.apic_id == SPEEDSTEP_APIC_MAGIC)
+			continue;
+		if (cpu->enabled)
+			expected++;
+	}
+
+	printk(BIOS_SPEW, "Asserting INIT on all APs.\n");
+	if (!lapic_send_ipi_all_but_self(LAPIC_INT_LEVELTRIG |
+					 LAPIC_INT_ASSERT | LAPIC_DM_INIT)) {
+		printk(BIOS_ERR, "INIT broadcast timed out.\n");
+		return;
+	}
+#if !CONFIG_CPU_AMD_MODEL_10XXX && !CONFIG_CPU_INTEL_MODEL_206AX
+	mdelay(10);
+#endif
+
+	ap_sipi_tsc = rdtscll();
+	for (i = 0; i < 2; i++) {
+		printk(BIOS_SPEW, "Sending STARTUP #%d to all APs.\n", i + 1);
+		if (!lapic_send_ipi_all_but_self(LAPIC_DM_STARTUP |
+						 (AP_SIPI_VECTOR >> 12))) {
+			printk(BIOS_ERR, "STARTUP broadcast timed out.\n");
+			break;
+		}
+		/* The first wait also tells how fast the TSC runs. */
+		wait_tsc = rdtscll();
+		udelay(200);
+		if (!i && rdtscll() - wait_tsc >= 200)
+			tsc_per_us = (rdtscll() - wait_tsc) / 200;
+	}
+
+	/*
+	 * Nobody knows how many APs there are, so wait until they stop
+	 * coming in: 1ms without a new one once the expected ones are up,
+	 * 1s at most.
+	 */
+	last = 0;
+	idle = 0;
+	for (count = 0; count < 100000 && idle < 100; count++) {
+		arrived = atomic_read(&ap_arrived);
+		if (arrived != last) {
+			last = arrived;
+			idle = 0;
+		} else if (arrived >= expected) {
+			idle++;
+		}
+		udelay(10);
+	}
+
+	ap_assign_devices();
+	printk(BIOS_DEBUG, "%d APs started (%d expected)\n", last, expected);
+	for (i = 1; i < CONFIG_MAX_CPUS; i++) {
+		if (!ap_cpus[i])
+			continue;
+		printk(BIOS_DEBUG, "CPU%d: APIC 0x%02x up %lu us after "
+			"STARTUP\n", i, ap_cpus[i]->path.apic.apic_id,
+			(unsigned long)((ap_arrival_tsc[i] - ap_sipi_tsc) /
+					tsc_per_us));
+	}
+	if (ap_next_index > CONFIG_MAX_CPUS)
+		printk(BIOS_ERR, "%d CPUs over CONFIG_MAX_CPUS left halted\n",
+			ap_next_index - CONFIG_MAX_CPUS);
+}
+
+int start_cpu(device_t cpu)
+{
+	unsigned long count;
+
+	/* Most likely it came up with everybody else. */
+	if (ap_started(cpu))
+		return 1;
+
+	/* Missed the broadcast. It'll take a stack from the pool all the same. */
+	if (lapic_start_cpu(cpu->path.apic.apic_id)) {
+		/* Wait 1s or until the new cpu calls in */
+		for(count = 0; count < 100000 ; count++) {
+			ap_assign_devices();
+			if (ap_started(cpu))
+				return 1;
+			udelay(10);
+		}
+	}
+	return 0;
+}
+#else
+int start_cpu(device_t cpu)
+{
+	struct cpu_info *info;
+	unsigned long stack_end;
+	unsigned long apicid;
+	unsigned int index;
+	unsigned long count;
+	int result;
+
+	spin_lock(&start_cpu_lock);
+
+	/* Get the CPU's apicid */
+	apicid = cpu->path.apic.apic_id;
+
+	/* Get an index for the new processor */
+	index = ++last_cpu_index;
+
+	stack_end = setup_cpu_stack(index);
 	/* Record the index and which CPU structure we are using */
 	info = (struct cpu_info *)stack_end;
 	info->index = index;
@@ -301,6 +497,7 @@ int start_cpu(device_t cpu)
 	spin_unlock(&start_cpu_lock);
 	return result;
 }
+#endif
 
 #if CONFIG_AP_IN_SIPI_WAIT
 
@@ -410,7 +607,18 @@ static __inline__ __attribute__((always_inline)) void writecr4(unsigned long Dat
 /* C entry point of secondary cpus */
 void asmlinkage secondary_cpu_init(unsigned int index)
 {
+#if CONFIG_PARALLEL_CPU_INIT
+	unsigned long long arrival = rdtscll();
+#endif
+
 	atomic_inc(&active_cpus);
+#if CONFIG_PARALLEL_CPU_INIT
+	if (!ap_claim_device(index, arrival)) {
+		/* Disabled in the devicetree, or too late */
+		atomic_dec(&active_cpus);
+		stop_this_cpu();
+	}
+#endif
 #if CONFIG_SERIAL_CPU_INIT
 	spin_lock(&start_cpu_lock);
 #endif
@@ -430,7 +638,12 @@ void asmlinkage secondary_cpu_init(unsigned int index)
 	spin_unlock(&start_cpu_lock);
 #endif
 
+#if CONFIG_PARALLEL_CPU_INIT
+	/* Stay around for cpu_work_queue() until the payload is loaded. */
+	cpu_work_ap_loop(&active_cpus);
+#else
 	atomic_dec(&active_cpus);
+#endif
 
 	stop_this_cpu();
 }
@@ -438,13 +651,19 @@ void asmlinkage secondary_cpu_init(unsigned int index)
 static void start_other_cpus(struct bus *cpu_bus, device_t bsp_cpu)
 {
 	device_t cpu;
+
+#if CONFIG_PARALLEL_CPU_INIT
+	/* Wake everybody at once; the loop below only picks up stragglers. */
+	start_all_aps(cpu_bus, bsp_cpu);
+#endif
+
 	/* Loop through the cpus once getting them started */
 
 	for(cpu = cpu_bus->children; cpu ; cpu = cpu->sibling) {
 		if (cpu->path.type != DEVICE_PATH_APIC) {
 			continue;
 		}
-	#if !CONFIG_SERIAL_CPU_INIT
+	#if !CONFIG_SERIAL_CPU_INIT || CONFIG_PARALLEL_CPU_INIT
 		if(cpu==bsp_cpu) {
 			continue;
 		}
@@ -477,6 +696,12 @@ static void wait_other_cpus_stop(struct bus *cpu_bus)
 	long loopcount = 0;
 	int i;
 
+#if CONFIG_PARALLEL_CPU_INIT
+	/* APs that call in from now on have nobody to give them a device. */
+	ap_assign_devices();
+	ap_devices_done = 1;
+#endif
+
 	/* Now loop until the other cpus have finished initializing */
 	old_active_count = 1;
 	active_count = atomic_read(&active_cpus);
@@ -502,7 +727,14 @@ static void wait_other_cpus_stop(struct bus *cpu_bus)
 				cpu->path.apic.apic_id);
 		}
 	}
+#if CONFIG_PARALLEL_CPU_INIT
+	printk(BIOS_DEBUG, "All AP CPUs initialized (%ld loops)\n", loopcount);
+	last_cpu_index = ap_next_index - 1;
+	if (last_cpu_index >= CONFIG_MAX_CPUS)
+		last_cpu_index = CONFIG_MAX_CPUS - 1;
+#else
 	printk(BIOS_DEBUG, "All AP CPUs stopped (%ld loops)\n", loopcount);
+#endif
 	for(i = 1; i <= last_cpu_index; i++)
 		checkstack((void *)stacks[i] + CONFIG_STACK_SIZE, i);
 }
@@ -543,7 +775,7 @@ void initialize_cpus(struct bus *cpu_bus)
 #endif
 
 #if CONFIG_SMP && CONFIG_MAX_CPUS > 1
-	#if !CONFIG_SERIAL_CPU_INIT
+	#if !CONFIG_SERIAL_CPU_INIT || CONFIG_PARALLEL_CPU_INIT
 	/* start all aps at first, so we can init ECC all together */
 	start_other_cpus(cpu_bus, info->cpu);
 	#endif
@@ -553,7 +785,7 @@ void initialize_cpus(struct bus *cpu_bus)
 	cpu_initialize(0);
 
 #if CONFIG_SMP && CONFIG_MAX_CPUS > 1
-	#if CONFIG_SERIAL_CPU_INIT
+	#if CONFIG_SERIAL_CPU_INIT && !CONFIG_PARALLEL_CPU_INIT
 	start_other_cpus(cpu_bus, info->cpu);
 	#endif
 
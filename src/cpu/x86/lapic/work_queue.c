@@ -0,0 +1,155 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+#include <stddef.h>
+#include <smp/atomic.h>
+#include <smp/spinlock.h>
+#include <cpu/x86/work_queue.h>
+
+/* The queue is a plain FIFO; the jobs live wherever the caller put them. */
+static spinlock_t work_lock = SPIN_LOCK_UNLOCKED;
+static struct cpu_work *work_head, *work_tail;
+
+/* APs sitting in cpu_work_ap_loop() */
+static atomic_t work_cpus = ATOMIC_INIT(0);
+static volatile int work_stop;
+
+static struct cpu_work *cpu_work_next(void)
+{
+	struct cpu_work *work;
+
+	spin_lock(&work_lock);
+	work = work_head;
+	if (work) {
+		work_head = work->next;
+		if (!work_head)
+			work_tail = NULL;
+	}
+	spin_unlock(&work_lock);
+	return work;
+}
+
+static void cpu_work_run(struct cpu_work *work)
+{
+	work->func(work->arg);
+	barrier();
+	work->done = 1;
+}
+
+void cpu_work_queue(struct cpu_work *work, cpu_work_func func, void *arg)
+{
+	work->func = func;
+	work->arg = arg;
+	work->done = 0;
+	work->next = NULL;
+
+	if (!atomic_read(&work_cpus)) {
+		cpu_work_run(work);
+		return;
+	}
+
+	spin_lock(&work_lock);
+	if (work_tail)
+		work_tail->next = work;
+	else
+		work_head = work;
+	work_tail = work;
+	spin_unlock(&work_lock);
+}
+
+void cpu_work_wait(struct cpu_work *work)
+{
+	struct cpu_work *next;
+
+	/* Rather than spin, help with whatever is still queued. */
+	while (!work->done) {
+		next = cpu_work_next();
+		if (next)
+			cpu_work_run(next);
+		else
+			cpu_relax();
+	}
+}
+
+struct cpu_work_part {
+	struct cpu_work work;
+	cpu_work_part_func func;
+	void *arg;
+	unsigned int part, parts;
+};
+
+static void cpu_work_run_part(void *arg)
+{
+	struct cpu_work_part *p = arg;
+
+	p->func(p->arg, p->part, p->parts);
+}
+
+void cpu_work_split(cpu_work_part_func func, void *arg)
+{
+	struct cpu_work_part parts[CONFIG_MAX_CPUS];
+	unsigned int i, n;
+
+	n = atomic_read(&work_cpus) + 1;
+	if (n > CONFIG_MAX_CPUS)
+		n = CONFIG_MAX_CPUS;
+
+	for (i = 1; i < n; i++) {
+		parts[i].func = func;
+		parts[i].arg = arg;
+		parts[i].part = i;
+		parts[i].parts = n;
+		cpu_work_queue(&parts[i].work, cpu_work_run_part, &parts[i]);
+	}
+	func(arg, 0, n);
+	for (i = 1; i < n; i++)
+		cpu_work_wait(&parts[i].work);
+}
+
+void cpu_work_stop(void)
+{
+	struct cpu_work *work;
+
+	if (!atomic_read(&work_cpus))
+		return;
+
+	while ((work = cpu_work_next()))
+		cpu_work_run(work);
+
+	work_stop = 1;
+	while (atomic_read(&work_cpus))
+		cpu_relax();
+}
+
+void cpu_work_ap_loop(atomic_t *initializing)
+{
+	struct cpu_work *work;
+
+	/* Count ourselves in before the BSP stops waiting for our init. */
+	atomic_inc(&work_cpus);
+	atomic_dec(initializing);
+	while (!work_stop) {
+		work = cpu_work_next();
+		if (work)
+			cpu_work_run(work);
+		else
+			cpu_relax();
+	}
+	atomic_dec(&work_cpus);
+}
@@ -160,6 +160,8 @@ void udelay(unsigned us)
         count = rdtscll();
         stop = clocks + count;
         while(stop > count) {
+		if (stop - count > CONSOLE_DRAIN_US * clocks_per_usec)
+			console_drain();
 		cpu_relax();
 		count = rdtscll();
         }
@@ -37,6 +37,7 @@
 #include <device/device.h>
 #include <device/pci.h>
 #include <device/pci_ids.h>
+#include <device/profile.h>
 #include <stdlib.h>
 #include <string.h>
 #include <smp/spinlock.h>
@@ -93,11 +94,7 @@ uint64_t uma_memory_size = 0;
  */
 static device_t __alloc_dev(struct bus *parent, struct device_path *path)
 {
-	device_t dev, child;
-
-	/* Find the last child of our parent. */
-	for (child = parent->children; child && child->sibling; /* */ )
-		child = child->sibling;
+	device_t dev;
 
 	dev = malloc(sizeof(*dev));
 	if (dev == 0)
@@ -111,10 +108,7 @@ static device_t __alloc_dev(struct bus *parent, struct device_path *path)
 
 	/* Add the new device to the list of children of the bus. */
 	dev->bus = parent;
-	if (child)
-		child->sibling = dev;
-	else
-		parent->children = dev;
+	bus_append_child(parent, dev);
 
 	/* Append a new device to the global device list.
 	 * The list is used to find devices once everything is set up.
@@ -183,6 +177,7 @@ static void read_resources(struct bus *bus)
 	/* Walk through all devices and find which resources they need. */
 	for (curdev = bus->children; curdev; curdev = curdev->sibling) {
 		struct bus *link;
+		int prof;
 
 		if (!curdev->enabled)
 			continue;
@@ -192,7 +187,9 @@ static void read_resources(struct bus *bus)
 			       dev_path(curdev));
 			continue;
 		}
+		prof = device_profile_enter(curdev, DEVPROF_READ_RESOURCES);
 		curdev->ops->read_resources(curdev);
+		device_profile_exit(prof);
 
 		/* Read in the resources behind the current device's links. */
 		for (link = curdev->link_list; link; link = link->next)
@@ -202,61 +199,123 @@ static void read_resources(struct bus *bus)
 	       dev_path(bus->dev), bus->secondary, bus->link_num);
 }
 
-struct pick_largest_state {
-	struct resource *last;
-	struct device *result_dev;
-	struct resource *result;
-	int seen_last;
+/*
+ * The allocator places the resources of a bus from largest alignment to
+ * smallest, and within the same alignment from largest size to smallest.
+ * Resources that compare equal keep the order search_bus_resources() finds
+ * them in.
+ *
+ * The resources of a bus are collected and sorted once per pass. Passes
+ * over a bus never nest, because compute_resources() recurses before its
+ * pass and allocate_resources() after its pass. So one array sized for
+ * every resource in the tree serves them all.
+ */
+struct resource_ref {
+	struct device *dev;
+	struct resource *res;
+	unsigned int seq;	/* Position in search order. */
 };
 
-static void pick_largest_resource(void *gp, struct device *dev,
-				  struct resource *resource)
+static struct resource_ref *sorted_resources;
+static unsigned int max_sorted_resources;
+static unsigned int num_sorted_resources;
+
+static void reserve_sorted_resources(void)
 {
-	struct pick_largest_state *state = gp;
-	struct resource *last;
+	struct device *dev;
+	struct resource *res;
+	unsigned int count = 0;
 
-	last = state->last;
+	for (dev = all_devices; dev; dev = dev->next)
+		for (res = dev->resource_list; res; res = res->next)
+			count++;
 
-	/* Be certain to pick the successor to last. */
-	if (resource == last) {
-		state->seen_last = 1;
+	if (count <= max_sorted_resources)
 		return;
-	}
-	if (resource->flags & IORESOURCE_FIXED)
+
+	sorted_resources = malloc(count * sizeof(*sorted_resources));
+	if (!sorted_resources)
+		die("reserve_sorted_resources(): out of memory.\n");
+	max_sorted_resources = count;
+}
+
+static void collect_resource(void *gp, struct device *dev,
+			     struct resource *res)
+{
+	struct resource_ref *ref;
+
+	if (res->flags & IORESOURCE_FIXED)
 		return;	/* Skip it. */
-	if (last && ((last->align < resource->align) ||
-		     ((last->align == resource->align) &&
-		      (last->size < resource->size)) ||
-		     ((last->align == resource->align) &&
-		      (last->size == resource->size) && (!state->seen_last)))) {
-		return;
-	}
-	if (!state->result ||
-	    (state->result->align < resource->align) ||
-	    ((state->result->align == resource->align) &&
-	     (state->result->size < resource->size))) {
-		state->result_dev = dev;
-		state->result = resource;
-	}
+
+	if (num_sorted_resources == max_sorted_resources)
+		die("collect_resource(): too many resources.\n");
+
+	ref = &sorted_resources[num_sorted_resources];
+	ref->dev = dev;
+	ref->res = res;
+	ref->seq = num_sorted_resources++;
 }
 
-static struct device *largest_resource(struct bus *bus,
-				       struct resource **result_res,
-				       unsigned long type_mask,
-				       unsigned long type)
+/* Return non-zero if a has to be placed before b. */
+static int resource_before(const struct resource_ref *a,
+			   const struct resource_ref *b)
 {
-	struct pick_largest_state state;
+	if (a->res->align != b->res->align)
+		return a->res->align > b->res->align;
+	if (a->res->size != b->res->size)
+		return a->res->size > b->res->size;
+	return a->seq < b->seq;
+}
 
-	state.last = *result_res;
-	state.result_dev = NULL;
-	state.result = NULL;
-	state.seen_last = 0;
+static void sift_down(struct resource_ref *refs, unsigned int i,
+		      unsigned int n)
+{
+	struct resource_ref tmp;
+	unsigned int child;
+
+	while ((child = 2 * i + 1) < n) {
+		if (child + 1 < n &&
+		    resource_before(&refs[child], &refs[child + 1]))
+			child++;
+		if (!resource_before(&refs[i], &refs[child]))
+			break;
+		tmp = refs[i];
+		refs[i] = refs[child];
+		refs[child] = tmp;
+		i = child;
+	}
+}
 
-	search_bus_resources(bus, type_mask, type, pick_largest_resource,
-			     &state);
+/**
+ * Collect the resources on a bus in the order they are to be placed.
+ *
+ * @param bus The bus to collect the resources of.
+ * @param type_mask This value gets ANDed with the resource type.
+ * @param type This value must match the result of the AND.
+ * @return The number of entries in sorted_resources.
+ */
+static unsigned int collect_resources(struct bus *bus,
+				      unsigned long type_mask,
+				      unsigned long type)
+{
+	struct resource_ref tmp;
+	unsigned int i, n;
+
+	num_sorted_resources = 0;
+	search_bus_resources(bus, type_mask, type, collect_resource, NULL);
+	n = num_sorted_resources;
+
+	/* Heapsort, the order is total thanks to seq. */
+	for (i = n / 2; i-- > 0;)
+		sift_down(sorted_resources, i, n);
+	for (i = n; i-- > 1;) {
+		tmp = sorted_resources[0];
+		sorted_resources[0] = sorted_resources[i];
+		sorted_resources[i] = tmp;
+		sift_down(sorted_resources, 0, i);
+	}
 
-	*result_res = state.result;
-	return state.result_dev;
+	return n;
 }
 
 /**
@@ -298,6 +357,7 @@ static void compute_resources(struct bus *bus, struct resource *bridge,
 	struct device *dev;
 	struct resource *resource;
 	resource_t base;
+	unsigned int i, n;
 	base = round(bridge->base, bridge->align);
 
 	printk(BIOS_SPEW,  "%s %s_%s: base: %llx size: %llx align: %d gran: %d"
@@ -347,15 +407,15 @@ static void compute_resources(struct bus *bus, struct resource *bridge,
 		}
 	}
 
-	/* Remember we haven't found anything yet. */
-	resource = NULL;
-
 	/*
 	 * Walk through all the resources on the current bus and compute the
 	 * amount of address space taken by them. Take granularity and
 	 * alignment into account.
 	 */
-	while ((dev = largest_resource(bus, &resource, type_mask, type))) {
+	n = collect_resources(bus, type_mask, type);
+	for (i = 0; i < n; i++) {
+		dev = sorted_resources[i].dev;
+		resource = sorted_resources[i].res;
 
 		/* Size 0 resources can be skipped. */
 		if (!resource->size)
@@ -446,6 +506,7 @@ static void allocate_resources(struct bus *bus, struct resource *bridge,
 	struct device *dev;
 	struct resource *resource;
 	resource_t base;
+	unsigned int i, n;
 	base = bridge->base;
 
 	printk(BIOS_SPEW, "%s %s_%s: base:%llx size:%llx align:%d gran:%d "
@@ -454,14 +515,14 @@ static void allocate_resources(struct bus *bus, struct resource *bridge,
 	       "prefmem" : "mem",
 	       base, bridge->size, bridge->align, bridge->gran, bridge->limit);
 
-	/* Remember we haven't found anything yet. */
-	resource = NULL;
-
 	/*
 	 * Walk through all the resources on the current bus and allocate them
 	 * address space.
 	 */
-	while ((dev = largest_resource(bus, &resource, type_mask, type))) {
+	n = collect_resources(bus, type_mask, type);
+	for (i = 0; i < n; i++) {
+		dev = sorted_resources[i].dev;
+		resource = sorted_resources[i].res;
 
 		/* Propagate the bridge limit to the resource register. */
 		if (resource->limit > bridge->limit)
@@ -844,8 +905,12 @@ static void enable_resources(struct bus *link)
 	struct bus *c_link;
 
 	for (dev = link->children; dev; dev = dev->sibling) {
-		if (dev->enabled && dev->ops && dev->ops->enable_resources)
+		if (dev->enabled && dev->ops && dev->ops->enable_resources) {
+			int prof = device_profile_enter(dev,
+						DEVPROF_ENABLE_RESOURCES);
 			dev->ops->enable_resources(dev);
+			device_profile_exit(prof);
+		}
 	}
 
 	for (dev = link->children; dev; dev = dev->sibling) {
@@ -894,7 +959,9 @@ unsigned int scan_bus(struct device *busdev, unsigned int max)
 	do_scan_bus = 1;
 	while (do_scan_bus) {
 		struct bus *link;
+		int prof = device_profile_enter(busdev, DEVPROF_SCAN_BUS);
 		new_max = busdev->ops->scan_bus(busdev, max);
+		device_profile_exit(prof);
 		do_scan_bus = 0;
 		for (link = busdev->link_list; link; link = link->next) {
 			if (link->reset_needed) {
@@ -992,6 +1059,8 @@ void dev_configure(void)
 
 	print_resource_tree(root, BIOS_SPEW, "After reading.");
 
+	reserve_sorted_resources();
+
 	/* Compute resources for all domains. */
 	for (child = root->link_list->children; child; child = child->sibling) {
 		if (!(child->path.type == DEVICE_PATH_DOMAIN))
@@ -1099,6 +1168,8 @@ void dev_enable(void)
  */
 static void init_dev(struct device *dev)
 {
+	int prof;
+
 	if (!dev->enabled)
 		return;
 
@@ -1110,7 +1181,9 @@ static void init_dev(struct device *dev)
 
 		printk(BIOS_DEBUG, "%s init\n", dev_path(dev));
 		dev->initialized = 1;
+		prof = device_profile_enter(dev, DEVPROF_INIT);
 		dev->ops->init(dev);
+		device_profile_exit(prof);
 	}
 }
 
@@ -47,6 +47,32 @@ device_t find_dev_path(struct bus *parent, struct device_path *path)
 	return child;
 }
 
+/**
+ * Append a device, or a chain of siblings, to the children of a bus.
+ *
+ * The bus remembers the device appended last, so building up a bus one
+ * device at a time does not walk the whole sibling list for every device.
+ * Lists that were set up statically, or changed behind our back, have no
+ * usable tail yet and are walked once.
+ *
+ * @param bus The bus to add the device to.
+ * @param dev The device (or first device of a chain) to append.
+ */
+void bus_append_child(struct bus *bus, device_t dev)
+{
+	device_t child = bus->last_child;
+
+	if (!bus->children) {
+		bus->children = dev;
+	} else {
+		if (!child || child->bus != bus || child->sibling)
+			for (child = bus->children; child->sibling;)
+				child = child->sibling;
+		child->sibling = dev;
+	}
+	bus->last_child = dev;
+}
+
 /**
  * Given a PCI bus and a devfn number, find the device structure.
  *
@@ -292,10 +318,23 @@ int path_eq(struct device_path *path1, struct device_path *path2)
 	return equal;
 }
 
+/*
+ * Resource structures come from a pool that is carved out of the heap 64 at
+ * a time. Callers keep pointers to resources across new_resource() calls,
+ * and static.c links static resources into resource_list, so resources
+ * never move. Each device has a sorted array of (index, resource) pairs
+ * next to its list for lookups. The list keeps insertion order, which is
+ * the order the allocator sees resources in.
+ */
+struct resource_key {
+	unsigned long index;
+	struct resource *res;
+};
+
 /**
  * Allocate 64 more resources to the free list.
  *
- * @return TODO.
+ * @return 1 on success, 0 if the heap is exhausted.
  */
 static int allocate_more_resources(void)
 {
@@ -316,13 +355,141 @@ static int allocate_more_resources(void)
 	return 1;
 }
 
+/**
+ * Make room for at least one more entry in the device's resource index.
+ *
+ * The heap never frees, so grow by doubling to keep the waste bounded.
+ *
+ * @param dev The device whose index to grow.
+ * @param count The number of entries needed.
+ */
+static void reserve_resource_keys(device_t dev, unsigned int count)
+{
+	struct resource_key *keys;
+	unsigned int max;
+
+	if (count <= dev->max_resources)
+		return;
+
+	max = dev->max_resources ? dev->max_resources : 8;
+	while (max < count)
+		max *= 2;
+
+	keys = malloc(max * sizeof(*keys));
+	if (!keys)
+		die("Couldn't allocate a resource index.");
+	if (dev->num_resources)
+		memcpy(keys, dev->resource_index,
+		       dev->num_resources * sizeof(*keys));
+	dev->resource_index = keys;
+	dev->max_resources = max;
+}
+
+/**
+ * Find where a resource index is, or would go, in the device's index.
+ *
+ * @param dev The device to search.
+ * @param index The resource index to look for.
+ * @return The position of the first key that is not less than index.
+ */
+static unsigned int resource_key_slot(device_t dev, unsigned long index)
+{
+	unsigned int lo = 0, hi = dev->num_resources;
+
+	while (lo < hi) {
+		unsigned int mid = (lo + hi) / 2;
+		if (dev->resource_index[mid].index < index)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	return lo;
+}
+
+static void insert_resource_key(device_t dev, struct resource *res)
+{
+	unsigned int pos;
+
+	reserve_resource_keys(dev, dev->num_resources + 1);
+	pos = resource_key_slot(dev, res->index);
+	memmove(&dev->resource_index[pos + 1], &dev->resource_index[pos],
+		(dev->num_resources - pos) * sizeof(*dev->resource_index));
+	dev->resource_index[pos].index = res->index;
+	dev->resource_index[pos].res = res;
+	dev->num_resources++;
+}
+
+static void remove_resource_key(device_t dev, struct resource *res)
+{
+	unsigned int pos;
+
+	for (pos = 0; pos < dev->num_resources; pos++)
+		if (dev->resource_index[pos].res == res)
+			break;
+	if (pos == dev->num_resources)
+		return;
+
+	dev->num_resources--;
+	memmove(&dev->resource_index[pos], &dev->resource_index[pos + 1],
+		(dev->num_resources - pos) * sizeof(*dev->resource_index));
+}
+
+/**
+ * (Re)build the device's resource index from its resource list.
+ *
+ * @param dev The device to index.
+ */
+static void index_resources(device_t dev)
+{
+	struct resource *res;
+
+	dev->num_resources = 0;
+	for (res = dev->resource_list; res; res = res->next)
+		insert_resource_key(dev, res);
+}
+
+/**
+ * Look a resource up in the device's index.
+ *
+ * Static resources get indexed on the first lookup. An entry whose
+ * resource was renumbered without resource_set_index() does not match,
+ * and makes the index get rebuilt.
+ *
+ * @param dev The device to find the resource on.
+ * @param index The index of the resource on the device.
+ * @return The resource, or NULL if there is none with that index.
+ */
+static struct resource *lookup_resource(device_t dev, unsigned long index)
+{
+	struct resource_key *key;
+	unsigned int pos;
+
+	if (!dev->num_resources && dev->resource_list)
+		index_resources(dev);
+
+	pos = resource_key_slot(dev, index);
+	if (pos == dev->num_resources)
+		return NULL;
+
+	key = &dev->resource_index[pos];
+	if (key->index != index)
+		return NULL;
+	if (key->res->index == index)
+		return key->res;
+
+	index_resources(dev);
+	pos = resource_key_slot(dev, index);
+	if (pos < dev->num_resources && dev->resource_index[pos].index == index)
+		return dev->resource_index[pos].res;
+	return NULL;
+}
+
 /**
  * Remove resource res from the device's list and add it to the free list.
  *
- * @param dev TODO
- * @param res TODO
- * @param prev TODO
- * @return TODO.
+ * @param dev The device the resource belongs to.
+ * @param res The resource to free.
+ * @param prev The resource before res on the device's list, or NULL.
  */
 static void free_resource(device_t dev, struct resource *res,
 			  struct resource *prev)
@@ -332,6 +499,8 @@ static void free_resource(device_t dev, struct resource *res,
 	else
 		dev->resource_list = res->next;
 
+	remove_resource_key(dev, res);
+
 	res->next = free_resources;
 	free_resources = res;
 }
@@ -366,15 +535,25 @@ void compact_resources(device_t dev)
  */
 struct resource *probe_resource(device_t dev, unsigned index)
 {
-	struct resource *res;
+	return lookup_resource(dev, index);
+}
 
-	/* See if there is a resource with the appropriate index */
-	for (res = dev->resource_list; res; res = res->next) {
-		if (res->index == index)
-			break;
-	}
+/**
+ * Change the index of a resource, keeping the device's index in order.
+ *
+ * @param dev The device the resource belongs to.
+ * @param res The resource to renumber.
+ * @param index The new index.
+ */
+void resource_set_index(device_t dev, struct resource *res, unsigned index)
+{
+	int indexed = dev->num_resources;
 
-	return res;
+	if (indexed)
+		remove_resource_key(dev, res);
+	res->index = index;
+	if (indexed)
+		insert_resource_key(dev, res);
 }
 
 /**
@@ -404,6 +583,7 @@ struct resource *new_resource(device_t dev, unsigned index)
 		free_resources = free_resources->next;
 		memset(resource, 0, sizeof(*resource));
 		resource->next = NULL;
+		resource->index = index;
 		tail = dev->resource_list;
 		if (tail) {
 			while (tail->next) tail = tail->next;
@@ -411,6 +591,7 @@ struct resource *new_resource(device_t dev, unsigned index)
 		} else {
 			dev->resource_list = resource;
 		}
+		insert_resource_key(dev, resource);
 	}
 
 	/* Initialize the resource values. */
@@ -624,6 +805,11 @@ void search_global_resources(unsigned long type_mask, unsigned long type,
 		if (!curdev->enabled)
 			continue;
 
+		/*
+		 * Walk the list, not the index. The memory table and MTRR
+		 * code get resources in the order they were added, which
+		 * decides the outcome where ranges overlap.
+		 */
 		for (res = curdev->resource_list; res; res = res->next) {
 			/* If it isn't the right kind of resource ignore it. */
 			if ((res->flags & type_mask) != type)
@@ -60,22 +60,12 @@ static device_t ht_scan_get_devs(device_t *old_devices)
 	}
 
 	if (first) {
-		device_t child;
-
 		/* Unlink the chain from the list of old devices. */
 		*old_devices = last->sibling;
 		last->sibling = 0;
 
-		/* Now add the device to the list of devices on the bus. */
-		/* Find the last child of our parent. */
-		for (child = first->bus->children; child && child->sibling; )
-			child = child->sibling;
-
 		/* Place the chain on the list of children of their parent. */
-		if (child)
-			child->sibling = first;
-		else
-			first->bus->children = first;
+		bus_append_child(first->bus, first);
 	}
 	return first;
 }
@@ -442,6 +432,7 @@ unsigned int hypertransport_scan_chain(struct bus *bus, unsigned min_devfn,
 	/* See which static device nodes I have. */
 	old_devices = bus->children;
 	bus->children = 0;
+	bus->last_child = 0;
 
 	/* Initialize the hypertransport enumeration state. */
 	prev.dev = bus->dev;
@@ -32,6 +32,7 @@
 #include <device/pci.h>
 #include <device/pci_ids.h>
 #include <delay.h>
+#include <timestamp.h>
 #if CONFIG_HYPERTRANSPORT_PLUGIN_SUPPORT
 #include <device/hypertransport.h>
 #endif
@@ -924,19 +925,8 @@ static struct device *pci_scan_get_dev(struct device **list, unsigned int devfn)
 	 * parents children, and now we are interleaving static and dynamic
 	 * devices in order on the bus.
 	 */
-	if (dev) {
-		struct device *child;
-
-		/* Find the last child of our parent. */
-		for (child = dev->bus->children; child && child->sibling;)
-			child = child->sibling;
-
-		/* Place the device on the list of children of its parent. */
-		if (child)
-			child->sibling = dev;
-		else
-			dev->bus->children = dev;
-	}
+	if (dev)
+		bus_append_child(dev->bus, dev);
 
 	return dev;
 }
@@ -1052,6 +1042,48 @@ device_t pci_probe_dev(device_t dev, struct bus *bus, unsigned devfn)
 	return dev;
 }
 
+/**
+ * Check whether only device 0 can exist on a bus.
+ *
+ * The secondary side of a PCIe root port or switch downstream port is a
+ * point-to-point link, so only device 0 can respond there. With ARI
+ * forwarding enabled, the device number bits become function number bits
+ * instead, and the whole devfn range has to be scanned.
+ *
+ * @param bus Pointer to the bus structure.
+ * @return 1 if only devfn 0x00 - 0x07 need to be scanned, 0 otherwise.
+ */
+static int pci_bus_only_one_child(struct bus *bus)
+{
+	struct device *bridge = bus->dev;
+	unsigned int pos;
+	u16 flags;
+
+	if (!bridge || bridge->path.type != DEVICE_PATH_PCI)
+		return 0;
+
+	pos = pci_find_capability(bridge, PCI_CAP_ID_PCIE);
+	if (!pos)
+		return 0;
+
+	flags = pci_read_config16(bridge, pos + PCI_EXP_FLAGS);
+	switch ((flags & PCI_EXP_FLAGS_TYPE) >> 4) {
+	case PCI_EXP_TYPE_ROOT_PORT:
+	case PCI_EXP_TYPE_DOWNSTREAM:
+		break;
+	default:
+		return 0;
+	}
+
+	/* Device Control 2 only exists from capability version 2 on. */
+	if ((flags & PCI_EXP_FLAGS_VERS) >= 2 &&
+	    (pci_read_config16(bridge, pos + PCI_EXP_DEVCTL2) &
+	     PCI_EXP_DEVCTL2_ARI))
+		return 0;
+
+	return 1;
+}
+
 /**
  * Scan a PCI bus.
  *
@@ -1090,10 +1122,16 @@ unsigned int pci_scan_bus(struct bus *bus, unsigned min_devfn,
 		max_devfn=0xff;
 	}
 
+	/* Don't probe 31 empty slots behind a PCIe port. */
+	if (max_devfn > 0x07 && pci_bus_only_one_child(bus))
+		max_devfn = 0x07;
+
 	old_devices = bus->children;
 	bus->children = NULL;
+	bus->last_child = NULL;
 
 	post_code(0x24);
+	timestamp_add_now(TS_BUS_ID(TS_PCI_SCAN_BUS_START, bus->secondary));
 
 	/*
 	 * Probe all devices/functions on this bus with some optimization for
@@ -1119,6 +1157,7 @@ unsigned int pci_scan_bus(struct bus *bus, unsigned min_devfn,
 		}
 	}
 
+	timestamp_add_now(TS_BUS_ID(TS_PCI_SCAN_BUS_END, bus->secondary));
 	post_code(0x25);
 
 	/*
@@ -0,0 +1,88 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+#include <console/console.h>
+#include <cbmem.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cpu/x86/tsc.h>
+#include <device/device.h>
+#include <device/profile.h>
+
+/*
+ * The device phases run before CBMEM is set up in ramstage, so the records
+ * collect here and are copied to CBMEM by device_profile_sync().
+ */
+static struct device_profile_entry entries[CONFIG_DEVICE_PROFILER_ENTRIES];
+static unsigned int num_entries, dropped, depth;
+
+/**
+ * Record the start of a device operation.
+ *
+ * @param dev The device the operation is called for.
+ * @param op Which operation.
+ * @return Handle to pass to device_profile_exit().
+ */
+int device_profile_enter(struct device *dev, enum device_profile_op op)
+{
+	struct device_profile_entry *entry;
+
+	if (num_entries == ARRAY_SIZE(entries)) {
+		dropped++;
+		depth++;
+		return -1;
+	}
+
+	entry = &entries[num_entries];
+	strncpy(entry->path, dev_path(dev), sizeof(entry->path) - 1);
+	entry->op = op;
+	entry->depth = depth++;
+	entry->start = rdtscll();
+	return num_entries++;
+}
+
+void device_profile_exit(int handle)
+{
+	unsigned long long now = rdtscll();
+
+	depth--;
+	if (handle >= 0)
+		entries[handle].end = now;
+}
+
+void device_profile_sync(void)
+{
+	struct device_profile_table *table;
+	size_t size = num_entries * sizeof(entries[0]);
+
+	table = cbmem_add(CBMEM_ID_DEVICE_PROFILE, sizeof(*table) + size);
+	if (!table) {
+		printk(BIOS_ERR, "ERROR: failed to allocate device profile\n");
+		return;
+	}
+
+	table->max_entries = ARRAY_SIZE(entries);
+	table->num_entries = num_entries;
+	table->dropped = dropped;
+	memcpy(table->entries, entries, size);
+
+	if (dropped)
+		printk(BIOS_WARNING, "Device profile: %d calls not recorded\n",
+		       dropped);
+}
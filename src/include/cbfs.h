@@ -79,9 +79,18 @@ int run_address(void *f);
 /* Defined in src/lib/selfboot.c */
 struct lb_memory;
 int selfboot(struct lb_memory *mem, struct cbfs_payload *payload);
+int selfboot_media(struct lb_memory *mem, struct cbfs_media *media,
+		   const char *name);
 
 /* Defined in individual arch / board implementation. */
 int init_default_cbfs_media(struct cbfs_media *media);
 
+#if CONFIG_CBFS_CACHE && !defined(__PRE_RAM__) && !defined(__SMM__)
+/* Move the lookup cache from BSS into CBMEM once CBMEM is up. */
+void cbfs_cache_sync(void);
+#else
+#define cbfs_cache_sync()
+#endif
+
 #endif
 
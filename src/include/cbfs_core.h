@@ -62,6 +62,7 @@
 
 #define CBFS_COMPRESS_NONE  0
 #define CBFS_COMPRESS_LZMA  1
+#define CBFS_COMPRESS_LZMA_BLOCKED  2
 
 /** These are standard component types for well known
     components (i.e - those that coreboot needs to consume.
@@ -76,6 +77,7 @@
 #define CBFS_TYPE_VSA        0x51
 #define CBFS_TYPE_MBI        0x52
 #define CBFS_TYPE_MICROCODE  0x53
+#define CBFS_TYPE_INDEX      0x60
 #define CBFS_COMPONENT_CMOS_DEFAULT 0xaa
 #define CBFS_COMPONENT_CMOS_LAYOUT 0x01aa
 
@@ -99,7 +101,7 @@ struct cbfs_header {
 	uint32_t align;
 	uint32_t offset;
 	uint32_t architecture;
-	uint32_t pad[1];
+	uint32_t index_offset;
 } __attribute__((packed));
 
 /* "Unknown" refers to CBFS headers version 1,
@@ -109,6 +111,76 @@ struct cbfs_header {
 #define CBFS_ARCHITECTURE_X86      0x00000001
 #define CBFS_ARCHITECTURE_ARMV7    0x00000010
 
+/** If index_offset in the master header is neither 0 nor 0xffffffff, it is
+    one more than the ROM offset of the component header of the CBFS index
+    (CBFS starts at offset 0 in x86 images). The index is a file of type
+    CBFS_TYPE_INDEX that cbfstool keeps up to date. Its content is a
+    cbfs_index followed by one entry per file, sorted by name hash. All
+    fields are big endian, like the component header. Names the index does
+    not have are looked for by walking the CBFS, so files added by tools
+    that do not update the index are still found. */
+
+#define CBFS_INDEX_MAGIC  0x43424958 /* "CBIX" */
+
+struct cbfs_index_entry {
+	uint32_t hash;    /** cbfs_index_hash() of the file name */
+	uint32_t offset;  /** ROM offset of the component header */
+	uint32_t len;
+	uint32_t type;
+} __attribute__((packed));
+
+struct cbfs_index {
+	uint32_t magic;
+	uint32_t count;
+	struct cbfs_index_entry entries[0];
+} __attribute__((packed));
+
+/* FNV-1a hash of a file name, as used in the CBFS index */
+static inline uint32_t cbfs_index_hash(const char *name)
+{
+	uint32_t hash = 0x811c9dc5;
+
+	while (*name) {
+		hash ^= (uint8_t)*name++;
+		hash *= 0x01000193;
+	}
+	return hash;
+}
+
+/** The CBFS lookup cache is a per-boot table in RAM (CBMEM) that remembers
+    every component header found while walking the default CBFS media, so
+    that later lookups, in ramstage or in a payload, need no media reads to
+    locate a file. Files before next_offset are all in the cache; once the
+    walk reached the end of CBFS, CBFS_CACHE_COMPLETE is set and a miss is
+    final. Fields are in host byte order. */
+
+#define CBFS_CACHE_MAGIC     0x43424643 /* "CBFC" */
+#define CBFS_CACHE_ENTRIES   64
+#define CBFS_CACHE_NAME_LEN  48
+
+#define CBFS_CACHE_COMPLETE  (1 << 0) /* walked to the end of CBFS */
+#define CBFS_CACHE_OVERFLOW  (1 << 1) /* a file did not fit, never complete */
+
+struct cbfs_cache_entry {
+	uint32_t offset;      /** ROM offset of the component header */
+	uint32_t data_offset; /** offset field of the component header */
+	uint32_t len;
+	uint32_t type;
+	char name[CBFS_CACHE_NAME_LEN];
+} __attribute__((packed));
+
+struct cbfs_cache {
+	uint32_t magic;
+	uint32_t flags;
+	uint32_t count;
+	uint32_t next_offset; /** where the directory walk continues, or 0 */
+	uint32_t lookups;     /** cbfs_get_file() calls on the default media */
+	uint32_t hits;        /** lookups answered without media reads */
+	uint32_t misses;      /** lookups a complete cache said are not there */
+	uint32_t media_bytes; /** bytes read or mapped to locate files */
+	struct cbfs_cache_entry entries[CBFS_CACHE_ENTRIES];
+} __attribute__((packed));
+
 /** This is a component header - every entry in the CBFS
     will have this header.
 
@@ -172,6 +244,23 @@ struct cbfs_payload {
 #define PAYLOAD_SEGMENT_PARAMS 0x41524150
 #define PAYLOAD_SEGMENT_ENTRY  0x52544E45
 
+/** This is the header of CBFS_COMPRESS_LZMA_BLOCKED data. The data is
+    split into block_size sized pieces (the last one may be shorter) which
+    are compressed as independent LZMA streams, so they can be decoded in
+    any order. The header is followed by num_blocks + 1 offsets, relative
+    to the start of the header, of the LZMA stream of each block; the last
+    offset marks the end of the data. All fields are little endian, like
+    the LZMA stream header. */
+
+#define CBFS_LZMA_BLOCKED_MAGIC 0x4b425a4c /* "LZBK" */
+
+struct cbfs_lzma_blocked {
+	uint32_t magic;
+	uint32_t block_size;
+	uint32_t num_blocks;
+	uint32_t total_size;
+} __attribute__((packed));
+
 struct cbfs_optionrom {
 	uint32_t compression;
 	uint32_t len;
@@ -214,6 +303,12 @@ struct cbfs_media {
 /* returns pointer to a file entry inside CBFS or NULL */
 struct cbfs_file *cbfs_get_file(struct cbfs_media *media, const char *name);
 
+/* looks up a file without mapping it: copies its header to *file and the
+ * offset of its data on media to *data_offset. media must be initialized
+ * (not CBFS_DEFAULT_MEDIA). Returns 0 on success, -1 if not found. */
+int cbfs_locate_file(struct cbfs_media *media, const char *name,
+		     struct cbfs_file *file, uint32_t *data_offset);
+
 /* returns pointer to file content inside CBFS after if type is correct */
 void *cbfs_get_file_content(struct cbfs_media *media, const char *name,
 			    int type);
@@ -20,11 +20,51 @@
 #ifndef _CBMEM_H_
 #define _CBMEM_H_
 
+/* Function trace ring, see trace.h */
+#if CONFIG_TRACE
+#define HIGH_MEMORY_TRACE_SIZE	( 16 + CONFIG_TRACE_ENTRIES * 16 )
+#else
+#define HIGH_MEMORY_TRACE_SIZE	0
+#endif
+
+/* CBFS lookup cache, see cbfs_core.h: struct cbfs_cache with its 64
+ * entries of 64 bytes, rounded up to the 512 byte CBMEM alignment */
+#if CONFIG_CBFS_CACHE
+#define HIGH_MEMORY_CBFS_CACHE_SIZE	( 9 * 512 )
+#else
+#define HIGH_MEMORY_CBFS_CACHE_SIZE	0
+#endif
+
+/* Device profile, see device/profile.h: a 12 byte header and entries of
+ * 48 bytes, rounded up to the 512 byte CBMEM alignment */
+#if CONFIG_DEVICE_PROFILER
+#define HIGH_MEMORY_DEVICE_PROFILE_SIZE \
+	( ( 12 + CONFIG_DEVICE_PROFILER_ENTRIES * 48 + 511 ) & ~511 )
+#else
+#define HIGH_MEMORY_DEVICE_PROFILE_SIZE	0
+#endif
+
+/* Timestamp table, see timestamp.h: a 16 byte header and entries of 12
+ * bytes. There is room for the boot stages and for a start and an end
+ * stamp for each of the 256 buses of a PCI segment. */
+#define MAX_TIMESTAMPS		( 100 + 2 * 256 )
+#if CONFIG_COLLECT_TIMESTAMPS
+#define HIGH_MEMORY_TIMESTAMP_SIZE	( 16 + MAX_TIMESTAMPS * 12 )
+#else
+#define HIGH_MEMORY_TIMESTAMP_SIZE	0
+#endif
+
 /* Reserve 128k for ACPI and other tables */
 #if CONFIG_CONSOLE_CBMEM
-#define HIGH_MEMORY_DEF_SIZE	( 256 * 1024 )
+#define HIGH_MEMORY_DEF_SIZE	( 256 * 1024 + HIGH_MEMORY_TRACE_SIZE + \
+				  HIGH_MEMORY_CBFS_CACHE_SIZE + \
+				  HIGH_MEMORY_DEVICE_PROFILE_SIZE + \
+				  HIGH_MEMORY_TIMESTAMP_SIZE )
 #else
-#define HIGH_MEMORY_DEF_SIZE	( 128 * 1024 )
+#define HIGH_MEMORY_DEF_SIZE	( 128 * 1024 + HIGH_MEMORY_TRACE_SIZE + \
+				  HIGH_MEMORY_CBFS_CACHE_SIZE + \
+				  HIGH_MEMORY_DEVICE_PROFILE_SIZE + \
+				  HIGH_MEMORY_TIMESTAMP_SIZE )
 #endif
 
 #if CONFIG_HAVE_ACPI_RESUME
@@ -56,6 +96,9 @@
 #define CBMEM_ID_CONSOLE	0x434f4e53
 #define CBMEM_ID_ELOG		0x454c4f47
 #define CBMEM_ID_COVERAGE	0x47434f56
+#define CBMEM_ID_CBFS_CACHE	0x43424643
+#define CBMEM_ID_DEVICE_PROFILE	0x44505246
+#define CBMEM_ID_TRACE		0x54524345
 #define CBMEM_ID_NONE		0x00000000
 
 #ifndef __ASSEMBLER__
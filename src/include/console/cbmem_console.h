@@ -22,5 +22,8 @@
 void cbmemc_init(void);
 void cbmemc_reinit(void);
 void cbmemc_tx_byte(unsigned char data);
+#ifndef __PRE_RAM__
+void cbmemc_tx_buf(const unsigned char *buf, int len);
+#endif
 
 #endif
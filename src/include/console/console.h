@@ -39,6 +39,7 @@
 
 #ifndef __PRE_RAM__
 void console_tx_flush(void);
+void console_tx_buf(const unsigned char *buf, int len);
 unsigned char console_rx_byte(void);
 int console_tst_byte(void);
 struct console_driver {
@@ -47,6 +48,8 @@ struct console_driver {
 	void (*tx_flush)(void);
 	unsigned char (*rx_byte)(void);
 	int (*tst_byte)(void);
+	void (*drain)(void);	/* send buffered output, never waits */
+	void (*tx_buf)(const unsigned char *buf, int len);	/* optional */
 };
 
 #define __console	__attribute__((used, __section__ (".rodata.console_drivers")))
@@ -65,6 +68,20 @@ extern int console_loglevel;
 #define console_loglevel CONFIG_DEFAULT_CONSOLE_LOGLEVEL
 #endif
 
+/*
+ * With a deferred console, printk() only queues its output. Code that
+ * spins anyway calls console_drain() to push some of it out; it takes at
+ * most CONSOLE_DRAIN_US.
+ */
+#if CONFIG_CONSOLE_SERIAL8250_DEFERRED && !defined(__PRE_RAM__) && \
+	!defined(__SMM__)
+#define CONSOLE_DRAIN_US	20
+void console_drain(void);
+#else
+#define CONSOLE_DRAIN_US	0
+#define console_drain()		do {} while (0)
+#endif
+
 #ifndef __ROMCC__
 void console_init(void);
 void console_tx_byte(unsigned char byte);
@@ -108,12 +125,31 @@ static inline void printk(int LEVEL, const char *fmt, ...) {
 
 #else
 
+#if CONFIG_CONSOLE_CBMEM_DICTIONARY && !defined(__PRE_RAM__) && \
+	!defined(__SMM__)
+#include <console/printk_dict.h>
+#define __printk(LEVEL, fmt, args...)	printk_dict(LEVEL, fmt, ##args)
+#else
+#define __printk(LEVEL, fmt, args...)	do_printk(LEVEL, fmt, ##args)
+#endif
+
+#if CONFIG_CONSOLE_STRIP_FILTERED_MESSAGES
+/*
+ * Messages above the maximum log level keep the side effects of their
+ * arguments, but neither the call nor the format string.
+ */
+static inline __attribute__((format(printf, 1, 2)))
+void printk_discard(const char *fmt, ...) {}
+#else
+#define printk_discard(fmt, args...)	do_printk(BIOS_NEVER, fmt, ##args)
+#endif
+
 #define printk(LEVEL, fmt, args...)				\
 	do {							\
 		if (CONFIG_MAXIMUM_CONSOLE_LOGLEVEL >= LEVEL) {	\
-			do_printk(LEVEL, fmt, ##args);		\
+			__printk(LEVEL, fmt, ##args);		\
 		} else {					\
-			do_printk(BIOS_NEVER, fmt, ##args);	\
+			printk_discard(fmt, ##args);		\
 		}						\
 	} while(0)
 #endif
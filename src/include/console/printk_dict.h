@@ -0,0 +1,102 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+#ifndef _CONSOLE_PRINTK_DICT_H_
+#define _CONSOLE_PRINTK_DICT_H_
+
+/*
+ * Dictionary logging: instead of formatting a message, printk() writes a
+ * record to the CBMEM console holding the address of the format string and
+ * the raw arguments. The format strings live in the .printk_fmt section of
+ * the ramstage ELF, which is not loaded, and "cbmem -c -d <elf>" formats
+ * the records on the host.
+ *
+ * A record is PRINTK_DICT_MARKER, the u32 format address, the u32 argument
+ * types and the arguments, all little endian. The types are two bits per
+ * argument, first argument lowest, up to PRINTK_DICT_MAX_ARGS arguments.
+ * A string argument is stored as its pointer followed by the string, NUL
+ * terminated and cut at PRINTK_DICT_MAX_STRING bytes.
+ */
+#define PRINTK_DICT_MARKER	0x1e	/* ASCII record separator */
+#define PRINTK_DICT_MAX_ARGS	16
+#define PRINTK_DICT_MAX_STRING	255
+
+#define PRINTK_ARG_WORD		1
+#define PRINTK_ARG_QUAD		2
+#define PRINTK_ARG_STRING	3
+
+#ifndef __ASSEMBLER__
+
+#define __printk_dict_type(x)						\
+	(__builtin_types_compatible_p(typeof((x) + 0), char *) ||	\
+	 __builtin_types_compatible_p(typeof((x) + 0), const char *) ?	\
+		PRINTK_ARG_STRING :					\
+	 sizeof((x) + 0) > 4 ? PRINTK_ARG_QUAD : PRINTK_ARG_WORD)
+
+#define __printk_dict_nargs(args...)					\
+	__printk_dict_nargs_(0, ##args, 16, 15, 14, 13, 12, 11, 10, 9,	\
+			     8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define __printk_dict_nargs_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9,	\
+			     _10, _11, _12, _13, _14, _15, _16, n, ...) n
+
+#define __printk_dict_t0()		0
+#define __printk_dict_t1(a)		__printk_dict_type(a)
+#define __printk_dict_t2(a, b...)	(__printk_dict_type(a) | __printk_dict_t1(b) << 2)
+#define __printk_dict_t3(a, b...)	(__printk_dict_type(a) | __printk_dict_t2(b) << 2)
+#define __printk_dict_t4(a, b...)	(__printk_dict_type(a) | __printk_dict_t3(b) << 2)
+#define __printk_dict_t5(a, b...)	(__printk_dict_type(a) | __printk_dict_t4(b) << 2)
+#define __printk_dict_t6(a, b...)	(__printk_dict_type(a) | __printk_dict_t5(b) << 2)
+#define __printk_dict_t7(a, b...)	(__printk_dict_type(a) | __printk_dict_t6(b) << 2)
+#define __printk_dict_t8(a, b...)	(__printk_dict_type(a) | __printk_dict_t7(b) << 2)
+#define __printk_dict_t9(a, b...)	(__printk_dict_type(a) | __printk_dict_t8(b) << 2)
+#define __printk_dict_t10(a, b...)	(__printk_dict_type(a) | __printk_dict_t9(b) << 2)
+#define __printk_dict_t11(a, b...)	(__printk_dict_type(a) | __printk_dict_t10(b) << 2)
+#define __printk_dict_t12(a, b...)	(__printk_dict_type(a) | __printk_dict_t11(b) << 2)
+#define __printk_dict_t13(a, b...)	(__printk_dict_type(a) | __printk_dict_t12(b) << 2)
+#define __printk_dict_t14(a, b...)	(__printk_dict_type(a) | __printk_dict_t13(b) << 2)
+#define __printk_dict_t15(a, b...)	(__printk_dict_type(a) | __printk_dict_t14(b) << 2)
+#define __printk_dict_t16(a, b...)	(__printk_dict_type(a) | __printk_dict_t15(b) << 2)
+
+#define __printk_dict_cat(a, b)		__printk_dict_cat_(a, b)
+#define __printk_dict_cat_(a, b)	a ## b
+
+/* The argument types of a printk() call, known at compile time. */
+#define __printk_dict_types(args...)					\
+	((u32)__printk_dict_cat(__printk_dict_t,			\
+				__printk_dict_nargs(args))(args))
+
+int do_printk_dict(int msg_level, const char *fmt, u32 types, ...);
+
+/*
+ * Errors and worse still go out as text to every console, so that they
+ * show up on the serial port, too.
+ */
+#define printk_dict(LEVEL, fmt, args...)				\
+	do {								\
+		static const char __printk_fmt[]			\
+			__attribute__((section(".printk_fmt"), used)) = fmt; \
+		if (LEVEL <= BIOS_ERR)					\
+			do_printk(LEVEL, fmt, ##args);			\
+		else							\
+			do_printk_dict(LEVEL, __printk_fmt,		\
+				       __printk_dict_types(args), ##args); \
+	} while (0)
+
+#endif /* __ASSEMBLER__ */
+#endif
@@ -35,5 +35,8 @@ typedef __builtin_va_list	va_list;
 #endif
 
 int vtxprintf(void (*tx_byte)(unsigned char byte), const char *fmt, va_list args);
+/* Like vtxprintf(), but the output is handed to tx_buf in chunks. */
+int vtxprintf_buf(void (*tx_buf)(const unsigned char *buf, int len),
+		  const char *fmt, va_list args);
 
 #endif
@@ -0,0 +1,82 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+#ifndef CPU_X86_WORK_QUEUE_H
+#define CPU_X86_WORK_QUEUE_H
+
+/*
+ * With PARALLEL_CPU_INIT the application processors stay around after
+ * their init and run jobs queued from ramstage, e.g.
+ *
+ *	static struct cpu_work hash_work;
+ *
+ *	cpu_work_queue(&hash_work, hash_image, &image);
+ *	... do something else ...
+ *	cpu_work_wait(&hash_work);
+ *
+ * or split one job between all CPUs with cpu_work_split(), as selfboot
+ * does to clear a payload's BSS and lzma.c to decode LZMA-blocked files.
+ *
+ * A job must not printk() much, use the device tree or call back into
+ * code that isn't reentrant. Without APs the job runs right away on the
+ * calling CPU, so callers never need to know whether the queue exists.
+ */
+
+typedef void (*cpu_work_func)(void *arg);
+
+struct cpu_work {
+	cpu_work_func func;
+	void *arg;
+	volatile int done;
+	struct cpu_work *next;
+};
+
+/* For cpu_work_split(): handle part 'part' out of 'parts'. */
+typedef void (*cpu_work_part_func)(void *arg, unsigned int part,
+				   unsigned int parts);
+
+#if CONFIG_PARALLEL_CPU_INIT && !defined(__PRE_RAM__) && !defined(__SMM__)
+#include <smp/atomic.h>
+
+void cpu_work_queue(struct cpu_work *work, cpu_work_func func, void *arg);
+void cpu_work_wait(struct cpu_work *work);
+/* Run func on every CPU at once, each with its own part number. */
+void cpu_work_split(cpu_work_part_func func, void *arg);
+/* Finish all queued jobs and send the APs to sleep for good. */
+void cpu_work_stop(void);
+
+/* Called by the APs once they are initialized. */
+void cpu_work_ap_loop(atomic_t *initializing);
+#else
+static inline void cpu_work_queue(struct cpu_work *work, cpu_work_func func,
+				  void *arg)
+{
+	work->done = 0;
+	func(arg);
+	work->done = 1;
+}
+static inline void cpu_work_wait(struct cpu_work *work) { }
+static inline void cpu_work_split(cpu_work_part_func func, void *arg)
+{
+	func(arg, 0, 1);
+}
+static inline void cpu_work_stop(void) { }
+#endif
+
+#endif /* CPU_X86_WORK_QUEUE_H */
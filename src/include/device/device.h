@@ -7,6 +7,7 @@
 #include <device/path.h>
 
 struct device;
+struct resource_key;
 #ifndef __PRE_RAM__
 typedef struct device * device_t;
 struct pci_operations;
@@ -49,6 +50,7 @@ struct bus {
 
 	ROMSTAGE_CONST struct device * 	dev;		/* This bridge device */
 	ROMSTAGE_CONST struct device * 	children;	/* devices behind this bridge */
+	ROMSTAGE_CONST struct device *	last_child;	/* tail of children, if known */
 	ROMSTAGE_CONST struct bus	*next;		/* The next bridge on this device */
 	unsigned	bridge_ctrl;	/* Bridge control register */
 	unsigned char	link_num;	/* The index of this link */
@@ -94,6 +96,10 @@ struct device {
 
 	/* Base registers for this device. I/O, MEM and Expansion ROM */
 	ROMSTAGE_CONST struct resource *resource_list;
+	/* resource_list sorted by index, built on first lookup. */
+	struct resource_key *resource_index;
+	u16 num_resources;
+	u16 max_resources;
 
 	/* links are (downstream) buses attached to the device, usually a leaf
 	 * device with no children has 0 buses attached and a bridge has 1 bus
@@ -127,6 +133,7 @@ extern uint64_t uma_memory_size;
 
 /* Generic device interface functions */
 device_t alloc_dev(struct bus *parent, struct device_path *path);
+void bus_append_child(struct bus *bus, device_t dev);
 void dev_initialize_chips(void);
 void dev_enumerate(void);
 void dev_configure(void);
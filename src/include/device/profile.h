@@ -0,0 +1,65 @@
+/*
+ * This file is part of the coreboot project.
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+#ifndef DEVICE_PROFILE_H
+#define DEVICE_PROFILE_H
+
+#include <stdint.h>
+
+enum device_profile_op {
+	DEVPROF_SCAN_BUS = 1,
+	DEVPROF_READ_RESOURCES = 2,
+	DEVPROF_ENABLE_RESOURCES = 3,
+	DEVPROF_INIT = 4,
+};
+
+#define DEVPROF_PATH_LEN 28
+
+/*
+ * One call of a device operation. Entries are in the order the calls were
+ * made; a call's callees follow it with a depth one higher.
+ */
+struct device_profile_entry {
+	uint64_t	start;		/* TSC when the call was made */
+	uint64_t	end;		/* TSC when it returned, 0 if it didn't */
+	uint8_t		op;		/* enum device_profile_op */
+	uint8_t		depth;		/* nesting level, 0 outermost */
+	uint16_t	reserved;
+	char		path[DEVPROF_PATH_LEN];	/* dev_path() */
+} __attribute__((packed));
+
+struct device_profile_table {
+	uint32_t	max_entries;
+	uint32_t	num_entries;
+	uint32_t	dropped;	/* calls that didn't fit */
+	struct device_profile_entry entries[0];
+} __attribute__((packed));
+
+#if CONFIG_DEVICE_PROFILER && !defined(__PRE_RAM__)
+struct device;
+int device_profile_enter(struct device *dev, enum device_profile_op op);
+void device_profile_exit(int handle);
+void device_profile_sync(void);
+#else
+#define device_profile_enter(dev, op) 0
+#define device_profile_exit(handle) do { (void)(handle); } while (0)
+#define device_profile_sync()
+#endif
+
+#endif
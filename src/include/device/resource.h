@@ -61,6 +61,7 @@ extern void compact_resources(struct device * dev);
 extern struct resource *probe_resource(struct device *dev, unsigned index);
 extern struct resource *new_resource(struct device * dev, unsigned index);
 extern struct resource *find_resource(struct device * dev, unsigned index);
+extern void resource_set_index(struct device *dev, struct resource *res, unsigned index);
 extern resource_t resource_end(struct resource *resource);
 extern resource_t resource_max(struct resource *resource);
 extern void report_resource_stored(struct device * dev, struct resource *resource, const char *comment);
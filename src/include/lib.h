@@ -31,6 +31,17 @@ unsigned long log2(unsigned long x);
 
 /* Defined in src/lib/lzma.c */
 unsigned long ulzma(unsigned char *src, unsigned char *dst);
+unsigned long ulzma_blocked(unsigned char *src, unsigned long src_len,
+			    unsigned char *dst);
+/* Decodes only the blocks that hold bytes offset to offset + len - 1, to
+ * where ulzma_blocked() would put them. Returns how many of those bytes
+ * the stream has, or 0 on error. */
+unsigned long ulzma_blocked_range(unsigned char *src, unsigned long src_len,
+				  unsigned char *dst, unsigned long offset,
+				  unsigned long len);
+struct cbfs_media;
+unsigned long ulzma_media(struct cbfs_media *media, unsigned long offset,
+			  unsigned long len, unsigned char *dst);
 
 /* Defined in src/arch/x86/boot/gdt.c */
 void move_gdt(void);
@@ -41,17 +41,33 @@ enum timestamp_id {
 	TS_END_COPYRAM = 9,
 	TS_START_RAMSTAGE = 10,
 	TS_DEVICE_ENUMERATE = 30,
+	TS_PCI_SCAN_BUS_START = 31,
+	TS_PCI_SCAN_BUS_END = 32,
 	TS_DEVICE_CONFIGURE = 40,
 	TS_DEVICE_ENABLE = 50,
 	TS_DEVICE_INITIALIZE = 60,
+	TS_I915_START = 61,
+	TS_I915_PROGRAM_DONE = 62,
+	TS_I915_GTT_DONE = 63,
+	TS_I915_FB_CLEARED = 64,
 	TS_DEVICE_DONE = 70,
 	TS_CBMEM_POST = 75,
 	TS_WRITE_TABLES = 80,
 	TS_LOAD_PAYLOAD = 90,
+	TS_SELFBOOT_SEGMENT_START = 91,
+	TS_SELFBOOT_SEGMENT_END = 92,
 	TS_ACPI_WAKE_JUMP = 98,
 	TS_SELFBOOT_JUMP = 99,
 };
 
+/*
+ * The PCI bus scan stamps carry the number of the bus that was scanned,
+ * segment included, in the upper half of the ID.
+ */
+#define TS_BUS_SHIFT		16
+#define TS_BUS_ID(id, bus)	((enum timestamp_id)((id) | \
+				 ((uint32_t)(bus) << TS_BUS_SHIFT)))
+
 #if CONFIG_COLLECT_TIMESTAMPS
 #include <cpu/x86/tsc.h>
 void timestamp_init(tsc_t base);
@@ -20,12 +20,37 @@
 #ifndef __TRACE_H
 #define __TRACE_H
 
+#include <stdint.h>
+
+/*
+ * With CONFIG_TRACE, every instrumented ramstage function call and return
+ * appends one record to a ring buffer that ends up in CBMEM, where
+ * "cbmem -T" decodes it. Bit 63 of the TSC tells returns from calls.
+ */
+#define TRACE_MAGIC	0x54524345	/* same as CBMEM_ID_TRACE */
+#define TRACE_EXIT	(1ULL << 63)
+
+struct trace_entry {
+	uint64_t	tsc;		/* TSC, TRACE_EXIT on return */
+	uint32_t	func;		/* called function */
+	uint32_t	callsite;	/* return address in the caller */
+} __attribute__((packed));
+
+struct trace_buffer {
+	uint32_t	magic;
+	uint32_t	max_entries;	/* size of the ring */
+	uint32_t	written;	/* records ever written */
+	uint32_t	reserved;
+	struct trace_entry entries[0];
+} __attribute__((packed));
+
 
 #ifdef __PRE_RAM__
 
 #define DISABLE_TRACE
 #define ENABLE_TRACE
 #define DISABLE_TRACE_ON_FUNCTION
+#define trace_sync()
 
 #else /* !__PRE_RAM__ */
 
@@ -39,6 +64,9 @@ void __cyg_profile_func_exit( void *, void * )
 
 extern volatile int trace_dis;
 
+/* Move the trace ring from BSS into CBMEM once CBMEM is up. */
+void trace_sync(void);
+
 #define DISABLE_TRACE  do { trace_dis = 1; } while (0);
 #define ENABLE_TRACE    do { trace_dis = 0; } while (0);
 #define DISABLE_TRACE_ON_FUNCTION  __attribute__ ((no_instrument_function));
@@ -48,6 +76,7 @@ extern volatile int trace_dis;
 #define DISABLE_TRACE
 #define ENABLE_TRACE
 #define DISABLE_TRACE_ON_FUNCTION
+#define trace_sync()
 
 #endif
 #endif
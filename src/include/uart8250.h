@@ -120,6 +120,8 @@ unsigned char uart8250_rx_byte(unsigned base_port);
 int uart8250_can_rx_byte(unsigned base_port);
 void uart8250_tx_byte(unsigned base_port, unsigned char data);
 void uart8250_tx_flush(unsigned base_port);
+int uart8250_tx_bytes_nowait(unsigned base_port, const unsigned char *data,
+			     int len);
 /* Yes it is silly to have three different uart init functions. But we used to
  * have three different sets of uart code, so it's an improvement.
  */
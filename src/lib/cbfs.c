@@ -32,6 +32,10 @@
 #else
 # define CBFS_CORE_WITH_LZMA
 # include <lib.h>
+# if CONFIG_CBFS_CACHE && !defined(__PRE_RAM__)
+#  define CBFS_CORE_WITH_CACHE
+#  include <cbmem.h>
+# endif
 #endif
 
 #include <cbfs.h>
@@ -60,6 +64,37 @@
 # define CBFS_HEADER_ROM_ADDRESS (*(uint32_t *)0xfffffffc)
 #endif
 
+#ifdef CBFS_CORE_WITH_CACHE
+/* Ramstage looks files up long before CBMEM is set up, so the cache starts
+ * out in BSS and cbfs_cache_sync() moves it into CBMEM. It is reset once
+ * per boot since the ROM may have changed since CBMEM was last set up, e.g.
+ * on S3 resume. */
+static struct cbfs_cache bss_cache;
+static struct cbfs_cache *cache;
+
+static struct cbfs_cache *cbfs_get_cache(void)
+{
+	if (!cache) {
+		cache = &bss_cache;
+		cache->magic = CBFS_CACHE_MAGIC;
+	}
+	return cache;
+}
+
+void cbfs_cache_sync(void)
+{
+	struct cbfs_cache *cbmem_cache;
+
+	cbmem_cache = cbmem_add(CBMEM_ID_CBFS_CACHE, sizeof(*cbmem_cache));
+	if (!cbmem_cache) {
+		printk(BIOS_ERR, "ERROR: failed to allocate CBFS cache\n");
+		return;
+	}
+	memcpy(cbmem_cache, cbfs_get_cache(), sizeof(*cbmem_cache));
+	cache = cbmem_cache;
+}
+#endif
+
 #include "cbfs_core.c"
 
 #ifndef __SMM__
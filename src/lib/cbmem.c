@@ -29,7 +29,7 @@
 // the other entries somewhat aligned.
 // Increase if MAX_CBMEM_ENTRIES exceeds 21
 #define CBMEM_TOC_RESERVED	512
-#define MAX_CBMEM_ENTRIES	16
+#define MAX_CBMEM_ENTRIES	20
 #define CBMEM_MAGIC		0x434f5245
 
 struct cbmem_entry {
@@ -262,6 +262,9 @@ void cbmem_list(void)
 		case CBMEM_ID_CONSOLE:   printk(BIOS_DEBUG, "CONSOLE    "); break;
 		case CBMEM_ID_ELOG:      printk(BIOS_DEBUG, "ELOG       "); break;
 		case CBMEM_ID_COVERAGE:  printk(BIOS_DEBUG, "COVERAGE   "); break;
+		case CBMEM_ID_CBFS_CACHE: printk(BIOS_DEBUG, "CBFS CACHE "); break;
+		case CBMEM_ID_DEVICE_PROFILE: printk(BIOS_DEBUG, "DEV PROFILE"); break;
+		case CBMEM_ID_TRACE:     printk(BIOS_DEBUG, "TRACE      "); break;
 		default: printk(BIOS_DEBUG, "%08x ", cbmem_toc[i].id);
 		}
 		printk(BIOS_DEBUG, "%08llx ", cbmem_toc[i].base);
@@ -106,6 +106,25 @@ void cbmemc_tx_byte(unsigned char data)
 		cbm_cons_p->buffer_body[cursor] = data;
 }
 
+#ifndef __PRE_RAM__
+void cbmemc_tx_buf(const unsigned char *buf, int len)
+{
+	struct cbmem_console *cbm_cons_p = cbmem_console_p;
+	u32 cursor;
+
+	if (!cbm_cons_p)
+		return;
+
+	cursor = cbm_cons_p->buffer_cursor;
+	cbm_cons_p->buffer_cursor += len;
+	if (cursor >= cbm_cons_p->buffer_size)
+		return;
+	if (len > cbm_cons_p->buffer_size - cursor)
+		len = cbm_cons_p->buffer_size - cursor;
+	memcpy(cbm_cons_p->buffer_body + cursor, buf, len);
+}
+#endif
+
 /*
  * Copy the current console buffer (either from the cache as RAM area, or from
  * the static buffer, pointed at by cbmem_console_p) into the CBMEM console
@@ -29,6 +29,7 @@ it with the version available from LANL.
 #include <version.h>
 #include <device/device.h>
 #include <device/pci.h>
+#include <device/profile.h>
 #include <delay.h>
 #include <stdlib.h>
 #include <reset.h>
@@ -42,6 +43,7 @@ it with the version available from LANL.
 #include <cbmem.h>
 #include <coverage.h>
 #include <timestamp.h>
+#include <trace.h>
 
 /**
  * @brief Main function of the RAM part of coreboot.
@@ -57,7 +59,9 @@ void hardwaremain(int boot_complete);
 void hardwaremain(int boot_complete)
 {
 	struct lb_memory *lb_mem;
+#if !CONFIG_CBFS_STREAM_PAYLOAD
 	void *payload;
+#endif
 
 	timestamp_stash(TS_START_RAMSTAGE);
 	post_code(POST_ENTRY_RAMSTAGE);
@@ -116,6 +120,9 @@ void hardwaremain(int boot_complete)
 	cbmemc_reinit();
 #endif
 	timestamp_sync();
+	device_profile_sync();
+	trace_sync();
+	cbfs_cache_sync();
 
 #if CONFIG_HAVE_ACPI_RESUME
 	suspend_resume();
@@ -136,12 +143,19 @@ void hardwaremain(int boot_complete)
 
 	timestamp_add_now(TS_LOAD_PAYLOAD);
 
+#if CONFIG_CBFS_STREAM_PAYLOAD
+	/* Only returns if the payload is missing or could not be read. */
+	if (!selfboot_media(lb_mem, CBFS_DEFAULT_MEDIA,
+			    CONFIG_CBFS_PREFIX "/payload"))
+		die("Could not load the payload\n");
+#else
 	payload = cbfs_load_payload(CBFS_DEFAULT_MEDIA,
 				    CONFIG_CBFS_PREFIX "/payload");
 	if (! payload)
 		die("Could not find a payload\n");
 
 	selfboot(lb_mem, payload);
+#endif
 	printk(BIOS_EMERG, "Boot failed");
 }
 
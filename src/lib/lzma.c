@@ -13,8 +13,23 @@
 #include <console/console.h>
 #include <string.h>
 #include <lib.h>
+#include <cbfs_core.h>
+#if defined(CONFIG_ARCH_X86) && CONFIG_ARCH_X86
+#include <cpu/x86/work_queue.h>
+#else
+#define cpu_work_split(func, arg) func(arg, 0, 1)
+#endif
 
-unsigned long ulzma(unsigned char * src, unsigned char * dst)
+#define LZMA_SCRATCHPAD_SIZE 15980
+
+/* Decodes the stream whose 13 byte header is at header. The compressed
+ * data either follows at data, at most in_size bytes of it, or comes from
+ * in if that is set. Callers that may run at the same time as another
+ * decode pass their own scratchpad, all others NULL. */
+static unsigned long ulzma_decode(const unsigned char *header,
+				  const unsigned char *data, SizeT in_size,
+				  ILzmaInCallback *in, unsigned char *dst,
+				  unsigned char *scratchpad)
 {
 	unsigned char properties[LZMA_PROPERTIES_SIZE];
 	UInt32 outSize;
@@ -28,31 +43,204 @@ unsigned long ulzma(unsigned char * src, unsigned char * dst)
 	static
 #endif
 	/* in pre-ram, it must go on the stack */
-	unsigned char scratchpad[15980];
-	unsigned char *cp;
+	unsigned char default_scratchpad[LZMA_SCRATCHPAD_SIZE];
+	const unsigned char *cp;
+
+	if (!scratchpad)
+		scratchpad = default_scratchpad;
 
-	memcpy(properties, src, LZMA_PROPERTIES_SIZE);
+	memcpy(properties, header, LZMA_PROPERTIES_SIZE);
 	/* The outSize in LZMA stream is a 64bit integer stored in little-endian
 	 * (ref: lzma.cc@LZMACompress: put_64). To prevent accessing by
 	 * unaligned memory address and to load in correct endianess, read each
 	 * byte and re-costruct. */
-	cp = src + LZMA_PROPERTIES_SIZE;
+	cp = header + LZMA_PROPERTIES_SIZE;
 	outSize = cp[3] << 24 | cp[2] << 16 | cp[1] << 8 | cp[0];
 	if (LzmaDecodeProperties(&state.Properties, properties, LZMA_PROPERTIES_SIZE) != LZMA_RESULT_OK) {
 		printk(BIOS_WARNING, "lzma: Incorrect stream properties.\n");
 		return 0;
 	}
 	mallocneeds = (LzmaGetNumProbs(&state.Properties) * sizeof(CProb));
-	if (mallocneeds > 15980) {
+	if (mallocneeds > LZMA_SCRATCHPAD_SIZE) {
 		printk(BIOS_WARNING, "lzma: Decoder scratchpad too small!\n");
 		return 0;
 	}
 	state.Probs = (CProb *)scratchpad;
-	res = LzmaDecode(&state, src + LZMA_PROPERTIES_SIZE + 8, (SizeT)0xffffffff, &inProcessed,
-		dst, outSize, &outProcessed);
+	state.InCallback = in;
+	res = LzmaDecode(&state, data, in_size, &inProcessed, dst, outSize,
+		&outProcessed);
 	if (res != 0) {
 		printk(BIOS_WARNING, "lzma: Decoding error = %d\n", res);
 		return 0;
 	}
 	return outSize;
 }
+
+unsigned long ulzma(unsigned char * src, unsigned char * dst)
+{
+	return ulzma_decode(src, src + LZMA_PROPERTIES_SIZE + 8,
+			    (SizeT)0xffffffff, NULL, dst, NULL);
+}
+
+#if !defined(__PRE_RAM__)
+/* Input is pulled from the media in chunks this big, so only one chunk
+ * of the compressed stream is ever in memory, and it is still in the
+ * cache when the decoder consumes it. */
+#define LZMA_MEDIA_CHUNK 4096
+
+struct lzma_media_stream {
+	ILzmaInCallback in;	/* must be first */
+	struct cbfs_media *media;
+	size_t offset;
+	size_t remaining;
+	unsigned char buf[LZMA_MEDIA_CHUNK];
+};
+
+static int lzma_media_read(void *object, const unsigned char **buffer,
+			   SizeT *size)
+{
+	struct lzma_media_stream *stream = object;
+	size_t count = stream->remaining;
+
+	if (count > sizeof(stream->buf))
+		count = sizeof(stream->buf);
+	if (count)
+		count = stream->media->read(stream->media, stream->buf,
+					    stream->offset, count);
+	stream->offset += count;
+	stream->remaining -= count;
+	*buffer = stream->buf;
+	*size = count;
+	return LZMA_RESULT_OK;
+}
+
+unsigned long ulzma_media(struct cbfs_media *media, unsigned long offset,
+			  unsigned long len, unsigned char *dst)
+{
+	static struct lzma_media_stream stream;
+	unsigned char header[LZMA_PROPERTIES_SIZE + 8];
+
+	if (len < sizeof(header) ||
+	    media->read(media, header, offset, sizeof(header)) !=
+	    sizeof(header)) {
+		printk(BIOS_WARNING, "lzma: Could not read stream header.\n");
+		return 0;
+	}
+	stream.in.Read = lzma_media_read;
+	stream.media = media;
+	stream.offset = offset + sizeof(header);
+	stream.remaining = len - sizeof(header);
+	return ulzma_decode(header, NULL, 0, &stream.in, dst, NULL);
+}
+#endif
+
+static u32 blocked_get_le32(const unsigned char *cp)
+{
+	return cp[3] << 24 | cp[2] << 16 | cp[1] << 8 | cp[0];
+}
+
+#if CONFIG_PARALLEL_CPU_INIT && !defined(__PRE_RAM__) && !defined(__SMM__)
+/* Part 0 of a blocked stream is decoded by the calling CPU, with the
+ * default scratchpad. The other parts each need one of their own. */
+static unsigned char part_scratchpads[CONFIG_MAX_CPUS - 1]
+				     [LZMA_SCRATCHPAD_SIZE];
+#define part_scratchpad(part) ((part) ? part_scratchpads[(part) - 1] : NULL)
+#else
+#define part_scratchpad(part) NULL
+#endif
+
+struct ulzma_blocked_job {
+	unsigned char *src;
+	unsigned long src_len;
+	unsigned char *dst;
+	u32 first, last;
+	volatile int failed;
+	volatile u32 bad_block;
+};
+
+/* Decodes every parts'th block of blocks first to last of a
+ * CBFS_COMPRESS_LZMA_BLOCKED stream, starting with block first + part.
+ * The blocks are independent LZMA streams of about the same size, so this
+ * gives every CPU an even share. */
+static void ulzma_blocked_part(void *arg, unsigned int part,
+			       unsigned int parts)
+{
+	struct ulzma_blocked_job *job = arg;
+	unsigned char *src = job->src;
+	u32 block_size = blocked_get_le32(src + 4);
+	u32 total_size = blocked_get_le32(src + 12);
+	unsigned char *offsets = src + sizeof(struct cbfs_lzma_blocked);
+	u32 i;
+
+	for (i = job->first + part; i <= job->last && !job->failed;
+	     i += parts) {
+		u32 start = i * block_size;
+		u32 expected = total_size - start;
+		u32 offset = blocked_get_le32(offsets + 4 * i);
+		unsigned char *block = src + offset;
+
+		if (expected > block_size)
+			expected = block_size;
+		/* The block must lie in the file and decode to exactly its
+		 * share, or it would be decoded past the end of dst. */
+		if (offset < LZMA_PROPERTIES_SIZE + 8 ||
+		    offset > job->src_len - LZMA_PROPERTIES_SIZE - 8 ||
+		    blocked_get_le32(block + LZMA_PROPERTIES_SIZE) != expected ||
+		    ulzma_decode(block, block + LZMA_PROPERTIES_SIZE + 8,
+				 job->src_len - offset - LZMA_PROPERTIES_SIZE - 8,
+				 NULL, job->dst + start,
+				 part_scratchpad(part)) != expected) {
+			/* This may run on an AP, so leave the message to
+			 * the caller. */
+			job->bad_block = i;
+			job->failed = 1;
+		}
+	}
+}
+
+unsigned long ulzma_blocked_range(unsigned char *src, unsigned long src_len,
+				  unsigned char *dst, unsigned long offset,
+				  unsigned long len)
+{
+	struct ulzma_blocked_job job;
+	u32 block_size, num_blocks, total_size;
+
+	if (src_len < sizeof(struct cbfs_lzma_blocked) ||
+	    blocked_get_le32(src) != CBFS_LZMA_BLOCKED_MAGIC) {
+		printk(BIOS_WARNING, "lzma: Not a blocked LZMA stream.\n");
+		return 0;
+	}
+	block_size = blocked_get_le32(src + 4);
+	num_blocks = blocked_get_le32(src + 8);
+	total_size = blocked_get_le32(src + 12);
+	if (!num_blocks || total_size > (u64)block_size * num_blocks ||
+	    total_size <= (u64)block_size * (num_blocks - 1) ||
+	    sizeof(struct cbfs_lzma_blocked) + 4 * (u64)num_blocks > src_len) {
+		printk(BIOS_WARNING, "lzma: Bad blocked LZMA header.\n");
+		return 0;
+	}
+	if (!len || offset >= total_size)
+		return 0;
+	if (len > total_size - offset)
+		len = total_size - offset;
+
+	job.src = src;
+	job.src_len = src_len;
+	job.dst = dst;
+	job.first = offset / block_size;
+	job.last = (offset + len - 1) / block_size;
+	job.failed = 0;
+	cpu_work_split(ulzma_blocked_part, &job);
+	if (job.failed) {
+		printk(BIOS_WARNING, "lzma: Block %d is corrupt.\n",
+		       job.bad_block);
+		return 0;
+	}
+	return len;
+}
+
+unsigned long ulzma_blocked(unsigned char *src, unsigned long src_len,
+			    unsigned char *dst)
+{
+	return ulzma_blocked_range(src, src_len, dst, 0, ~0UL);
+}
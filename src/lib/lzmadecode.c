@@ -34,7 +34,12 @@
   { int i; for(i = 0; i < 5; i++) { RC_TEST; Code = (Code << 8) | RC_READ_BYTE; }}
 
 
-#define RC_TEST { if (Buffer == BufferLim) return LZMA_RESULT_DATA_ERROR; }
+/* When the input buffer runs dry, ask the stream for more (if it has a
+ * read callback) rather than failing. */
+#define RC_TEST { if (Buffer == BufferLim) { SizeT size; \
+  if (!vs->InCallback || vs->InCallback->Read(vs->InCallback, &Buffer, &size) \
+      != LZMA_RESULT_OK || size == 0) return LZMA_RESULT_DATA_ERROR; \
+  BufferLim = Buffer + size; }}
 
 #define RC_INIT(buffer, bufferSize) Buffer = buffer; BufferLim = buffer + bufferSize; RC_INIT2
 
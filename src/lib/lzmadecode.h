@@ -51,10 +51,19 @@ int LzmaDecodeProperties(CLzmaProperties *propsRes, const unsigned char *propsDa
 
 #define kLzmaNeedInitId (-2)
 
+/* Input source for streams that are not in memory all at once. Read()
+ * points *buffer at the next chunk of input and sets *bufferSize to its
+ * length, 0 at the end of input. */
+typedef struct _ILzmaInCallback
+{
+  int (*Read)(void *object, const unsigned char **buffer, SizeT *bufferSize);
+} ILzmaInCallback;
+
 typedef struct _CLzmaDecoderState
 {
   CLzmaProperties Properties;
   CProb *Probs;
+  ILzmaInCallback *InCallback;  /* NULL: whole input is at inStream */
 
 
 } CLzmaDecoderState;
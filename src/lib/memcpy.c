@@ -1,12 +1,27 @@
 #include <string.h>
+
 void *memcpy(void *vdest, const void *vsrc, size_t bytes)
 {
 	const char *src = vsrc;
 	char *dest = vdest;
-	int i;
 
-	for (i = 0; i < (int)bytes; i++)
-		dest[i] = src[i];
+	/* Move whole words when both pointers can be aligned together. */
+	if ((((unsigned long)dest ^ (unsigned long)src) &
+	     (sizeof(unsigned long) - 1)) == 0) {
+		while (bytes && ((unsigned long)dest & (sizeof(unsigned long) - 1))) {
+			*dest++ = *src++;
+			bytes--;
+		}
+		while (bytes >= sizeof(unsigned long)) {
+			*(unsigned long *)dest = *(const unsigned long *)src;
+			dest += sizeof(unsigned long);
+			src += sizeof(unsigned long);
+			bytes -= sizeof(unsigned long);
+		}
+	}
+
+	while (bytes--)
+		*dest++ = *src++;
 
 	return vdest;
 }
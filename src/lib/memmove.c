@@ -1,19 +1,32 @@
 #include <string.h>
+
 void *memmove(void *vdest, const void *vsrc, size_t count)
 {
 	const char *src = vsrc;
 	char *dest = vdest;
 
-	if (dest <= src) {
-		while (count--) {
-			*dest++ = *src++;
+	/* Copying forward is safe unless dest overlaps the end of src. */
+	if ((unsigned long)dest - (unsigned long)src >= count)
+		return memcpy(vdest, vsrc, count);
+
+	src += count;
+	dest += count;
+	if ((((unsigned long)dest ^ (unsigned long)src) &
+	     (sizeof(unsigned long) - 1)) == 0) {
+		while (count && ((unsigned long)dest & (sizeof(unsigned long) - 1))) {
+			*--dest = *--src;
+			count--;
 		}
-	} else {
-		src  += count - 1;
-		dest += count - 1;
-		while(count--) {
-			*dest-- = *src--;
+		while (count >= sizeof(unsigned long)) {
+			dest -= sizeof(unsigned long);
+			src -= sizeof(unsigned long);
+			*(unsigned long *)dest = *(const unsigned long *)src;
+			count -= sizeof(unsigned long);
 		}
 	}
+
+	while (count--)
+		*--dest = *--src;
+
 	return vdest;
 }
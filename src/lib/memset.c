@@ -2,11 +2,29 @@
 
 void *memset(void *s, int c, size_t n)
 {
-	int i;
-	char *ss = (char *) s;
+	unsigned char *ss = s;
+	unsigned long word;
 
-	for (i = 0; i < (int)n; i++)
-		ss[i] = c;
+	while (n && ((unsigned long)ss & (sizeof(unsigned long) - 1))) {
+		*ss++ = c;
+		n--;
+	}
+
+	if (n >= sizeof(unsigned long)) {
+		word = (unsigned char)c;
+		word |= word << 8;
+		word |= word << 16;
+		if (sizeof(unsigned long) > 4)
+			word |= word << 16 << 16;
+		while (n >= sizeof(unsigned long)) {
+			*(unsigned long *)ss = word;
+			ss += sizeof(unsigned long);
+			n -= sizeof(unsigned long);
+		}
+	}
+
+	while (n--)
+		*ss++ = c;
 
 	return s;
 }
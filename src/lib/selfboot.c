@@ -29,10 +29,13 @@
 #include <string.h>
 #include <cbfs.h>
 #include <lib.h>
-#if CONFIG_COLLECT_TIMESTAMPS
 #include <timestamp.h>
-#endif
 #include <coverage.h>
+#if defined(CONFIG_ARCH_X86) && CONFIG_ARCH_X86
+#include <cpu/x86/work_queue.h>
+#else
+#define cpu_work_split(func, arg) func(arg, 0, 1)
+#endif
 
 /* Maximum physical address we can use for the coreboot bounce buffer. */
 #ifndef MAX_ADDR
@@ -46,6 +49,11 @@ extern unsigned char _eram_seg;
 static const unsigned long lb_start = (unsigned long)&_ram_seg;
 static const unsigned long lb_end = (unsigned long)&_eram_seg;
 
+/* Set while loading a payload that is streamed from media; s_srcaddr is
+ * then an offset on that media instead of an address.
+ */
+static struct cbfs_media *payload_media;
+
 struct segment {
 	struct segment *next;
 	struct segment *prev;
@@ -128,7 +136,7 @@ static int valid_area(struct lb_memory *mem, unsigned long buffer,
 		sizeof(mem->map[0]);
 
 	/* See if I conflict with the bounce buffer */
-	if (end >= buffer) {
+	if (buffer && end >= buffer) {
 		return 0;
 	}
 
@@ -295,14 +303,14 @@ static int relocate_segment(unsigned long buffer, struct segment *seg)
 static int build_self_segment_list(
 	struct segment *head,
 	struct lb_memory *mem,
-	struct cbfs_payload *payload, u32 *entry)
+	struct cbfs_payload *payload, unsigned long src_base, u32 *entry)
 {
 	struct segment *new;
 	struct segment *ptr;
-	struct cbfs_payload_segment *segment, *first_segment;
+	struct cbfs_payload_segment *segment;
 	memset(head, 0, sizeof(*head));
 	head->next = head->prev = head;
-	first_segment = segment = &payload->segments;
+	segment = &payload->segments;
 
 	while(1) {
 		printk(BIOS_DEBUG, "Loading segment from rom address 0x%p\n", segment);
@@ -322,13 +330,15 @@ static int build_self_segment_list(
 			new->s_memsz = ntohl(segment->mem_len);
 			new->compression = ntohl(segment->compression);
 
-			new->s_srcaddr = (u32) ((unsigned char *)first_segment)
-						+ ntohl(segment->offset);
+			new->s_srcaddr = src_base + ntohl(segment->offset);
 			new->s_filesz = ntohl(segment->len);
 			printk(BIOS_DEBUG, "  New segment dstaddr 0x%lx memsize 0x%lx srcaddr 0x%lx filesize 0x%lx\n",
 				new->s_dstaddr, new->s_memsz, new->s_srcaddr, new->s_filesz);
-			/* Clean up the values */
-			if (new->s_filesz > new->s_memsz)  {
+			/* Clean up the values. The length of compressed
+			 * data may legitimately exceed the memory size.
+			 */
+			if (new->compression == CBFS_COMPRESS_NONE &&
+			    new->s_filesz > new->s_memsz)  {
 				new->s_filesz = new->s_memsz;
 			}
 			printk(BIOS_DEBUG, "  (cleaned up) New segment addr 0x%lx size 0x%lx offset 0x%lx filesize 0x%lx\n",
@@ -341,8 +351,10 @@ static int build_self_segment_list(
 				 	ntohl(segment->mem_len));
 			new = malloc(sizeof(*new));
 			new->s_filesz = 0;
+			new->s_srcaddr = 0;
 			new->s_dstaddr = ntohll(segment->load_addr);
 			new->s_memsz = ntohl(segment->mem_len);
+			new->compression = CBFS_COMPRESS_NONE;
 			break;
 
 		case PAYLOAD_SEGMENT_ENTRY:
@@ -383,6 +395,89 @@ static int build_self_segment_list(
 	return 1;
 }
 
+/* Plans the load before anything is written: BSS segments that directly
+ * follow a loaded segment are folded into it, so they are cleared in the
+ * same pass that decodes the data. Returns 1 if any segment would land on
+ * coreboot and therefore needs the bounce buffer.
+ */
+static int plan_self_segments(struct segment *head)
+{
+	struct segment *ptr, *seg;
+	int overlap = 0;
+
+	for(ptr = head->next; ptr != head; ptr = ptr->next) {
+		if (ptr->s_filesz)
+			continue;
+		for(seg = head->next; seg != head; seg = seg->next) {
+			if (seg == ptr || !seg->s_filesz)
+				continue;
+			if (seg->s_dstaddr + seg->s_memsz != ptr->s_dstaddr)
+				continue;
+			printk(BIOS_SPEW, "  BSS 0x%lx folded into segment 0x%lx\n",
+				ptr->s_dstaddr, seg->s_dstaddr);
+			seg->s_memsz += ptr->s_memsz;
+			ptr->prev->next = ptr->next;
+			ptr->next->prev = ptr->prev;
+			ptr = ptr->prev;
+			break;
+		}
+	}
+
+	for(ptr = head->next; ptr != head; ptr = ptr->next)
+		if (overlaps_coreboot(ptr))
+			overlap = 1;
+
+	return overlap;
+}
+
+/* Returns the segment's file data in memory, mapping it from the media if
+ * the payload is streamed.
+ */
+static unsigned char *segment_data(struct segment *seg)
+{
+	void *data;
+
+	if (!payload_media)
+		return (unsigned char *)seg->s_srcaddr;
+	data = payload_media->map(payload_media, seg->s_srcaddr, seg->s_filesz);
+	if (data == CBFS_MEDIA_INVALID_MAP_ADDRESS)
+		return NULL;
+	return data;
+}
+
+struct clear_job {
+	unsigned char *dest;
+	unsigned long len;
+};
+
+/* Zeroes part 'part' of 'parts' of the range, in whole cache lines so no
+ * two CPUs store to the same one. */
+static void clear_part(void *arg, unsigned int part, unsigned int parts)
+{
+	struct clear_job *job = arg;
+	unsigned long chunk = ALIGN(job->len / parts, 64);
+	unsigned long start = part * chunk;
+
+	if (start >= job->len)
+		return;
+	if (chunk > job->len - start)
+		chunk = job->len - start;
+	memset(job->dest + start, 0, chunk);
+}
+
+/* A payload's heap and stack can make for megabytes of BSS. With
+ * PARALLEL_CPU_INIT every CPU clears a share of it. */
+static void clear_segment(unsigned char *dest, unsigned long len)
+{
+	struct clear_job job;
+
+	printk(BIOS_DEBUG, "Clearing Segment: addr: 0x%016lx memsz: 0x%016lx\n",
+		(unsigned long)dest, len);
+	job.dest = dest;
+	job.len = len;
+	cpu_work_split(clear_part, &job);
+}
+
 static int load_self_segments(
 	struct segment *head,
 	struct lb_memory *mem,
@@ -391,16 +486,24 @@ static int load_self_segments(
 	struct segment *ptr;
 
 	unsigned long bounce_high = lb_end;
-	for(ptr = head->next; ptr != head; ptr = ptr->next) {
-		if (!overlaps_coreboot(ptr))
-			continue;
-		if (ptr->s_dstaddr + ptr->s_memsz > bounce_high)
-			bounce_high = ptr->s_dstaddr + ptr->s_memsz;
-	}
-	get_bounce_buffer(mem, bounce_high - lb_start);
-	if (!bounce_buffer) {
-		printk(BIOS_ERR, "Could not find a bounce buffer...\n");
-		return 0;
+
+	bounce_buffer = bounce_size = 0;
+	if (!plan_self_segments(head)) {
+		/* Everything goes straight to its final address. */
+		printk(BIOS_DEBUG, "Payload does not overlap coreboot, "
+			"loading in place\n");
+	} else {
+		for(ptr = head->next; ptr != head; ptr = ptr->next) {
+			if (!overlaps_coreboot(ptr))
+				continue;
+			if (ptr->s_dstaddr + ptr->s_memsz > bounce_high)
+				bounce_high = ptr->s_dstaddr + ptr->s_memsz;
+		}
+		get_bounce_buffer(mem, bounce_high - lb_start);
+		if (!bounce_buffer) {
+			printk(BIOS_ERR, "Could not find a bounce buffer...\n");
+			return 0;
+		}
 	}
 	for(ptr = head->next; ptr != head; ptr = ptr->next) {
 		/* Verify the memory addresses in the segment are valid */
@@ -426,6 +529,8 @@ static int load_self_segments(
 		dest = (unsigned char *)(ptr->s_dstaddr);
 		src = (unsigned char *)(ptr->s_srcaddr);
 
+		timestamp_add_now(TS_SELFBOOT_SEGMENT_START);
+
 		/* Copy data from the initial buffer */
 		if (ptr->s_filesz) {
 			unsigned char *middle, *end;
@@ -434,7 +539,23 @@ static int load_self_segments(
 			switch(ptr->compression) {
 				case CBFS_COMPRESS_LZMA: {
 					printk(BIOS_DEBUG, "using LZMA\n");
-					len = ulzma(src, dest);
+					if (payload_media)
+						len = ulzma_media(payload_media,
+							ptr->s_srcaddr,
+							ptr->s_filesz, dest);
+					else
+						len = ulzma(src, dest);
+					if (!len) /* Decompression Error. */
+						return 0;
+					break;
+				}
+				case CBFS_COMPRESS_LZMA_BLOCKED: {
+					printk(BIOS_DEBUG, "using blocked LZMA\n");
+					src = segment_data(ptr);
+					if (!src)
+						return 0;
+					len = ulzma_blocked(src, ptr->s_filesz,
+							   dest);
 					if (!len) /* Decompression Error. */
 						return 0;
 					break;
@@ -444,13 +565,23 @@ static int load_self_segments(
 					printk(BIOS_DEBUG, "using NRV2B\n");
 					unsigned long unrv2b(u8 *src, u8 *dst, unsigned long *ilen_p);
 					unsigned long tmp;
+					src = segment_data(ptr);
+					if (!src)
+						return 0;
 					len = unrv2b(src, dest, &tmp);
 					break;
 				}
 #endif
 				case CBFS_COMPRESS_NONE: {
 					printk(BIOS_DEBUG, "it's not compressed!\n");
-					memcpy(dest, src, len);
+					if (!payload_media) {
+						memcpy(dest, src, len);
+					} else if (payload_media->read(payload_media,
+							dest, ptr->s_srcaddr,
+							len) != len) {
+						printk(BIOS_ERR, "Short read of segment.\n");
+						return -1;
+					}
 					break;
 				}
 				default:
@@ -466,16 +597,11 @@ static int load_self_segments(
 				(unsigned long)src);
 
 			/* Zero the extra bytes between middle & end */
-			if (middle < end) {
-				printk(BIOS_DEBUG, "Clearing Segment: addr: 0x%016lx memsz: 0x%016lx\n",
-					(unsigned long)middle, (unsigned long)(end - middle));
-
-				/* Zero the extra bytes */
-				memset(middle, 0, end - middle);
-			}
+			if (middle < end)
+				clear_segment(middle, end - middle);
 			/* Copy the data that's outside the area that shadows coreboot_ram */
 			printk(BIOS_DEBUG, "dest %p, end %p, bouncebuffer %lx\n", dest, end, bounce_buffer);
-			if ((unsigned long)end > bounce_buffer) {
+			if (bounce_buffer && (unsigned long)end > bounce_buffer) {
 				if ((unsigned long)dest < bounce_buffer) {
 					unsigned char *from = dest;
 					unsigned char *to = (unsigned char*)(lb_start-(bounce_buffer-(unsigned long)dest));
@@ -491,22 +617,37 @@ static int load_self_segments(
 					memcpy((char*)to, (char*)from, amount);
 				}
 			}
+		} else if (ptr->s_memsz) {
+			/* A BSS segment that could not be folded into its
+			 * neighbour.
+			 */
+			clear_segment(dest, ptr->s_memsz);
 		}
+
+		timestamp_add_now(TS_SELFBOOT_SEGMENT_END);
 	}
 	return 1;
 }
 
-int selfboot(struct lb_memory *mem, struct cbfs_payload *payload)
+static int selfboot_segments(struct lb_memory *mem,
+	struct cbfs_payload *payload, unsigned long src_base)
 {
 	u32 entry=0;
 	struct segment head;
+	int loaded;
 
 	/* Preprocess the self segments */
-	if (!build_self_segment_list(&head, mem, payload, &entry))
-		goto out;
+	loaded = build_self_segment_list(&head, mem, payload, src_base, &entry);
 
 	/* Load the segments */
-	if (!load_self_segments(&head, mem, payload))
+	if (loaded > 0)
+		loaded = load_self_segments(&head, mem, payload);
+	if (payload_media) {
+		payload_media->close(payload_media);
+		payload_media = NULL;
+	}
+	/* Both return 0 or -1 on errors. */
+	if (loaded <= 0)
 		goto out;
 
 	printk(BIOS_SPEW, "Loaded segments\n");
@@ -517,9 +658,7 @@ int selfboot(struct lb_memory *mem, struct cbfs_payload *payload)
 	printk(BIOS_DEBUG, "Jumping to boot code at %x\n", entry);
 	post_code(POST_ENTER_ELF_BOOT);
 
-#if CONFIG_COLLECT_TIMESTAMPS
 	timestamp_add_now(TS_SELFBOOT_JUMP);
-#endif
 #if CONFIG_COVERAGE
 	coverage_exit();
 #endif
@@ -529,6 +668,17 @@ int selfboot(struct lb_memory *mem, struct cbfs_payload *payload)
 	 */
 	checkstack(_estack, 0);
 
+	/* The payload owns the UART from here on. */
+	console_tx_flush();
+
+#if CONFIG_PARALLEL_CPU_INIT
+	/*
+	 * The APs helped decode and clear the segments. Their stacks and code are in
+	 * coreboot's memory, which the bounce buffer is copied over next.
+	 */
+	cpu_work_stop();
+#endif
+
 	/* Jump to kernel */
 	jmp_to_elf_entry((void*)entry, bounce_buffer, bounce_size);
 	return 1;
@@ -537,3 +687,65 @@ out:
 	return 0;
 }
 
+int selfboot(struct lb_memory *mem, struct cbfs_payload *payload)
+{
+	return selfboot_segments(mem, payload, (unsigned long)payload);
+}
+
+#if CONFIG_CBFS_STREAM_PAYLOAD
+/* Most segment descriptors read from the head of a streamed payload. */
+#define MAX_STREAM_SEGMENTS 32
+
+/* Like selfboot(), but reads the payload from media as it is loaded
+ * instead of mapping the whole file first.
+ */
+int selfboot_media(struct lb_memory *mem, struct cbfs_media *media,
+		   const char *name)
+{
+	static struct cbfs_payload_segment segments[MAX_STREAM_SEGMENTS];
+	struct cbfs_media default_media;
+	struct cbfs_file file;
+	uint32_t offset;
+	size_t len, i;
+
+	if (media == CBFS_DEFAULT_MEDIA) {
+		media = &default_media;
+		if (init_default_cbfs_media(media) != 0) {
+			printk(BIOS_ERR, "Failed to initialize default media.\n");
+			return 0;
+		}
+	}
+	if (cbfs_locate_file(media, name, &file, &offset) != 0) {
+		printk(BIOS_ERR, "Could not find payload '%s'.\n", name);
+		return 0;
+	}
+	if (ntohl(file.type) != CBFS_TYPE_PAYLOAD) {
+		printk(BIOS_ERR, "'%s' is not a payload.\n", name);
+		return 0;
+	}
+
+	len = ntohl(file.len);
+	if (len > sizeof(segments))
+		len = sizeof(segments);
+	media->open(media);
+	if (media->read(media, segments, offset, len) != len) {
+		printk(BIOS_ERR, "Could not read payload segments.\n");
+		media->close(media);
+		return 0;
+	}
+	/* The descriptor list ends with the entry point; make sure that
+	 * is inside what was read.
+	 */
+	for (i = 0; i < len / sizeof(segments[0]); i++)
+		if (segments[i].type == PAYLOAD_SEGMENT_ENTRY)
+			break;
+	if (i == len / sizeof(segments[0])) {
+		printk(BIOS_ERR, "Payload has too many segments to stream.\n");
+		media->close(media);
+		return 0;
+	}
+
+	payload_media = media;
+	return selfboot_segments(mem, (struct cbfs_payload *)segments, offset);
+}
+#endif
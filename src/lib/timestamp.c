@@ -26,10 +26,9 @@
 #include <cpu/x86/car.h>
 #endif
 
-#define MAX_TIMESTAMPS 30
-
 #ifndef __PRE_RAM__
 static struct timestamp_table* ts_table;
+static void timestamp_cache_add(enum timestamp_id id, tsc_t ts_time);
 #endif
 
 static uint64_t tsc_to_uint64(tsc_t tstamp)
@@ -63,6 +62,11 @@ void timestamp_add(enum timestamp_id id, tsc_t ts_time)
 #else
 	if (!ts_table)
 		ts_table = cbmem_find(CBMEM_ID_TIMESTAMP);
+	/* Before CBMEM is up, keep it for timestamp_sync(). */
+	if (!ts_table) {
+		timestamp_cache_add(id, ts_time);
+		return;
+	}
 #endif
 	if (!ts_table || (ts_table->num_entries == ts_table->max_entries))
 		return;
@@ -79,7 +83,7 @@ void timestamp_add_now(enum timestamp_id id)
 
 #ifndef __PRE_RAM__
 
-#define MAX_TIMESTAMP_CACHE 8
+#define MAX_TIMESTAMP_CACHE 48
 struct timestamp_cache {
 	enum timestamp_id id;
 	tsc_t time;
@@ -95,23 +99,30 @@ static int timestamp_entries CAR_GLOBAL = 0;
  * hardwaremain()
  */
 
-void timestamp_stash(enum timestamp_id id)
+static void timestamp_cache_add(enum timestamp_id id, tsc_t ts_time)
 {
 	if (timestamp_entries >= MAX_TIMESTAMP_CACHE) {
 		printk(BIOS_ERR, "ERROR: failed to add timestamp to cache\n");
 		return;
 	}
 	timestamp_cache[timestamp_entries].id = id;
-	timestamp_cache[timestamp_entries].time = rdtsc();
+	timestamp_cache[timestamp_entries].time = ts_time;
 	timestamp_entries++;
 }
 
+void timestamp_stash(enum timestamp_id id)
+{
+	timestamp_cache_add(id, rdtsc());
+}
+
 void timestamp_sync(void)
 {
-	int i;
-	for (i = 0; i < timestamp_entries; i++)
-		timestamp_add(timestamp_cache[i].id, timestamp_cache[i].time);
+	int i, n = timestamp_entries;
+
+	/* If CBMEM still isn't there, the entries go back in the cache. */
 	timestamp_entries = 0;
+	for (i = 0; i < n; i++)
+		timestamp_add(timestamp_cache[i].id, timestamp_cache[i].time);
 }
 
 #endif
@@ -18,22 +18,77 @@
  */
 
 #include <types.h>
+#include <string.h>
+#include <cbmem.h>
 #include <console/console.h>
 #include <trace.h>
 
 int volatile trace_dis = 0;
 
-void __cyg_profile_func_enter( void *func, void *callsite)
+/*
+ * Calls are recorded here until CBMEM is initialized, then trace_sync()
+ * copies the ring into CBMEM and recording continues there.
+ */
+static struct {
+	struct trace_buffer hdr;
+	struct trace_entry entries[CONFIG_TRACE_ENTRIES];
+} trace_bss;
+
+static struct trace_buffer *trace_buf = &trace_bss.hdr;
+
+/*
+ * Everything called from the hooks has to be inlined by hand: anything
+ * built with -finstrument-functions would call back into them.
+ */
+static inline __attribute__((always_inline, no_instrument_function))
+void trace_record(u32 func, u32 callsite, u64 flags)
 {
+	struct trace_buffer *buf = trace_buf;
+	struct trace_entry *e;
+	u32 lo, hi, slot = 1;
 
+	/* APs may be running instrumented code at the same time. */
+	__asm__ __volatile__("lock; xaddl %0, %1"
+			     : "+r" (slot), "+m" (buf->written));
+	e = &buf->entries[slot % CONFIG_TRACE_ENTRIES];
+
+	__asm__ __volatile__("rdtsc" : "=a" (lo), "=d" (hi));
+	e->tsc = (((u64)hi << 32) | lo) | flags;
+	e->func = func;
+	e->callsite = callsite;
+}
+
+void __cyg_profile_func_enter(void *func, void *callsite)
+{
 	if (trace_dis)
 		return;
 
-	DISABLE_TRACE
-	printk(BIOS_INFO, "~0x%08x(0x%08x)\n", (uint32_t) func, (uint32_t) callsite);
-	ENABLE_TRACE
+	trace_record((u32)func, (u32)callsite, 0);
 }
 
-void __cyg_profile_func_exit( void *func, void *callsite )
+void __cyg_profile_func_exit(void *func, void *callsite)
 {
+	if (trace_dis)
+		return;
+
+	trace_record((u32)func, (u32)callsite, TRACE_EXIT);
+}
+
+void trace_sync(void)
+{
+	struct trace_buffer *buf;
+	size_t size = sizeof(trace_bss);
+
+	DISABLE_TRACE
+	trace_bss.hdr.magic = TRACE_MAGIC;
+	trace_bss.hdr.max_entries = CONFIG_TRACE_ENTRIES;
+	buf = cbmem_add(CBMEM_ID_TRACE, size);
+	if (buf) {
+		memcpy(buf, &trace_bss, size);
+		trace_buf = buf;
+	}
+	ENABLE_TRACE
+
+	if (!buf)
+		printk(BIOS_WARNING, "Could not move trace buffer to CBMEM.\n");
 }
@@ -66,6 +66,25 @@ void uart8250_tx_flush(unsigned base_port)
 	uart8250_wait_until_sent(base_port);
 }
 
+/*
+ * Send as many of the len bytes as the UART takes right now and return
+ * how many that was. An empty transmitter takes a whole FIFO load, which
+ * is 16 bytes once uart8250_init() has enabled the FIFOs.
+ */
+int uart8250_tx_bytes_nowait(unsigned base_port, const unsigned char *data,
+			     int len)
+{
+	int i, room = 1;
+
+	if (!uart8250_can_tx_byte(base_port))
+		return 0;
+	if ((inb(base_port + UART_IIR) & 0xc0) == 0xc0)
+		room = 16;
+	for (i = 0; i < len && i < room; i++)
+		outb(data[i], base_port + UART_TBR);
+	return i;
+}
+
 int uart8250_can_rx_byte(unsigned base_port)
 {
 	return inb(base_port + UART_LSR) & UART_LSR_DR;
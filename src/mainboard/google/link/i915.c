@@ -38,44 +38,32 @@
 #include <device/pci.h>
 #include <ec/google/chromeec/ec.h>
 #include <cbfs_core.h>
+#include <timestamp.h>
+#include <arch/cpu.h>
 
 #include <cpu/x86/tsc.h>
 #include <cpu/x86/cache.h>
 #include <cpu/x86/mtrr.h>
-#include <cpu/amd/mtrr.h>
 #include <cpu/x86/msr.h>
 #include "i915io.h"
 
 enum {
-	vmsg = 1, vio = 2, vspin = 4,
+	vio = 2, vspin = 4,
 };
 
 static int verbose = 0;
 
-static unsigned int *mmio;
+static unsigned long mmio;
 static unsigned int graphics;
 static unsigned short addrport;
-static unsigned short dataport;
 static unsigned int physbase;
 extern int oprom_is_loaded;
 
-#define READ32(addr) io_i915_READ32(addr)
-#define WRITE32(val, addr) io_i915_WRITE32(val, addr)
-
-static unsigned long io_i915_READ32(unsigned long addr)
-{
-       unsigned long val;
-       outl(addr, addrport);
-       val = inl(dataport);
-       return val;
-}
-
-static void io_i915_WRITE32(unsigned long val, unsigned long addr)
-{
-       outl(addr, addrport);
-       outl(val, dataport);
-}
+#define READ32(addr) read32(mmio + (addr))
+#define WRITE32(val, addr) write32(mmio + (addr), val)
 
+/* On gen6/7 the upper half of the 4MB GTTMMADR BAR maps the GTT itself. */
+#define GTT_OFFSET 0x200000
 
 /*
 2560
@@ -93,14 +81,101 @@ PTEs
 static void
 setgtt(int start, int end, unsigned long base, int inc)
 {
-        int i;
+	unsigned long gtt = mmio + GTT_OFFSET;
+	int i;
 
+	/* Going through the GTT aperture instead of the MMIO_INDEX/DATA
+	 * I/O ports saves two port accesses per PTE. */
 	for(i = start; i < end; i++){
-                u32 word = base + i*inc;
-                WRITE32(word|1,(i*4)|1);
-        }
+		u32 word = base + i*inc;
+		write32(gtt + i*4, word|1);
+	}
+	/* Posting read, so the GTT is settled before the memory behind it
+	 * is touched. */
+	if (end > start)
+		read32(gtt + (end - 1)*4);
+}
+
+#if CONFIG_LINK_CLEAR_FRAMEBUFFER
+/* Finds an unused variable MTRR, or returns -1. */
+static int find_free_mtrr(void)
+{
+	msr_t msr;
+	int i, vcnt;
+
+	msr = rdmsr(MTRRcap_MSR);
+	vcnt = msr.lo & 0xff;
+	for (i = 0; i < vcnt; i++) {
+		msr = rdmsr(MTRRphysMask_MSR(i));
+		if (!(msr.lo & MTRRphysMaskValid))
+			return i;
+	}
+	return -1;
 }
 
+/* Covers [base, base + size) with a write-combining MTRR. size must be a
+ * power of two and base aligned to it. */
+static void set_wc_mtrr(int reg, u32 base, u32 size)
+{
+	unsigned int address_bits = 36;
+	msr_t msr;
+
+	if (cpuid_eax(0x80000000) >= 0x80000008)
+		address_bits = cpuid_eax(0x80000008) & 0xff;
+
+	disable_cache();
+	msr.lo = base | MTRR_TYPE_WRCOMB;
+	msr.hi = 0;
+	wrmsr(MTRRphysBase_MSR(reg), msr);
+	msr.lo = ~(size - 1) | MTRRphysMaskValid;
+	msr.hi = (1u << (address_bits - 32)) - 1;
+	wrmsr(MTRRphysMask_MSR(reg), msr);
+	enable_cache();
+}
+
+static void clear_mtrr(int reg)
+{
+	msr_t zero;
+
+	zero.lo = zero.hi = 0;
+	disable_cache();
+	wrmsr(MTRRphysMask_MSR(reg), zero);
+	wrmsr(MTRRphysBase_MSR(reg), zero);
+	enable_cache();
+}
+
+/* Fills the framebuffer with 32-bit stores. The UMA framebuffer is mapped
+ * uncacheable, so if a variable MTRR is free we make the range
+ * write-combining for the duration of the fill; the stores then leave the
+ * core as full bursts instead of one bus cycle each. */
+static void clear_framebuffer(u32 base, u32 size)
+{
+	unsigned long count = size / 4;
+	void *dst = (void *)base;
+	u32 wcsize;
+	int reg;
+
+	for (wcsize = 1; wcsize < size; wcsize <<= 1)
+		;
+	reg = -1;
+	if (!(base & (wcsize - 1)))
+		reg = find_free_mtrr();
+	if (reg >= 0)
+		set_wc_mtrr(reg, base, wcsize);
+	else
+		printk(BIOS_DEBUG, "i915: no free MTRR, clearing uncached\n");
+
+	asm volatile ("cld; rep stosl"
+		      : "+D" (dst), "+c" (count)
+		      : "a" (0)
+		      : "memory");
+
+	/* disable_cache() flushes the WC buffers on the way out. */
+	if (reg >= 0)
+		clear_mtrr(reg);
+}
+#endif
+
 static char *regname(unsigned long addr)
 {
 	static char name[16];
@@ -124,7 +199,6 @@ static unsigned long globalmicroseconds(void)
 	return microseconds(globalstart, rdtscll());
 }
 
-extern struct iodef iodefs[];
 
 static int i915_init_done = 0;
 
@@ -154,6 +228,91 @@ void fill_lb_framebuffer(struct lb_framebuffer *framebuffer)
 
 }
 
+/* How long each poll of the register program took, for tuning. */
+static struct {
+	u32 reg;
+	unsigned long usecs;
+	int timedout;
+} times[64];
+static int ntimes;
+
+/* Waits until (reg & mask) == val, or until timeout microseconds have
+ * passed. Returns 0, or -1 on a timeout. */
+static int wait_reg(u32 reg, u32 mask, u32 val, u32 timeout)
+{
+	unsigned long long start = rdtscll();
+	unsigned long usecs;
+	int timedout = 0;
+	u32 u;
+
+	while (((u = READ32(reg)) & mask) != val) {
+		if (microseconds(start, rdtscll()) >= timeout) {
+			timedout = 1;
+			break;
+		}
+	}
+	usecs = microseconds(start, rdtscll());
+
+	if (timedout)
+		printk(BIOS_ERR, "i915: %s: timeout after %ld us, got %08x "
+		       "want %08x mask %08x\n", regname(reg), usecs, u, val,
+		       mask);
+	else if (verbose & vspin)
+		printk(BIOS_SPEW, "%s: %ld us got %08x want %08x\n",
+		       regname(reg), usecs, u, val);
+
+	if (ntimes < ARRAY_SIZE(times)) {
+		times[ntimes].reg = reg;
+		times[ntimes].usecs = usecs;
+		times[ntimes].timedout = timedout;
+		ntimes++;
+	}
+	return timedout ? -1 : 0;
+}
+
+/* Runs a register program as generated by util/i915tool/i915prog.
+ * Gives up if the panel power sequencer doesn't reach the state the
+ * program waits for: everything after that assumes the panel is
+ * powered. Other waits that time out are logged and passed over, as
+ * the traced driver did. */
+static int run_program(const u32 *pc)
+{
+	u32 reg, val, mask, timeout;
+
+	for (;;) {
+		reg = I915_INSN_ARG(*pc);
+		switch (I915_INSN_OP(*pc++)) {
+		case I915_OP_END:
+			return 0;
+		case I915_OP_WRITE:
+			val = *pc++;
+			if (verbose & vio)
+				printk(BIOS_SPEW, "%s: outl %08x\n",
+				       regname(reg), val);
+			WRITE32(val, reg);
+			break;
+		case I915_OP_POLL:
+			mask = *pc++;
+			val = *pc++;
+			timeout = *pc++;
+			if (wait_reg(reg, mask, val, timeout) &&
+			    reg == PCH_PP_STATUS) {
+				printk(BIOS_ERR, "i915: panel power sequence "
+				       "timed out, leaving the display off\n");
+				return -1;
+			}
+			break;
+		case I915_OP_DELAY:
+			udelay(reg);
+			break;
+		default:
+			printk(BIOS_SPEW, "BAD PROGRAM, opcode %d @ %p\n",
+			       I915_INSN_OP(pc[-1]), pc - 1);
+			return -1;
+		}
+	}
+}
+
 int i915lightup(unsigned int physbase, unsigned int iobase, unsigned int mmio,
 	unsigned int gfx);
 
@@ -162,96 +321,43 @@ int i915lightup(unsigned int pphysbase,
 	unsigned int pmmio,
 	unsigned int pgfx)
 {
-	int i, prev = 0;
-	struct iodef *id, *lastidread = 0;
-	unsigned long u, t;
-	static unsigned long times[4096];
-	mmio = (void *)pmmio;
+	unsigned long u;
+	int i, ret;
+
+	timestamp_add_now(TS_I915_START);
+	mmio = pmmio;
 	addrport = piobase;
-	dataport = addrport + 4;
 	physbase = pphysbase;
 	graphics = pgfx;
 	printk(BIOS_SPEW,
-		"i915lightup: graphics %p mmio %p"
+		"i915lightup: graphics %p mmio %08lx"
 		"addrport %04x physbase %08x\n",
 			(void *)graphics, mmio, addrport, physbase);
 	globalstart = rdtscll();
 
-	/* state machine! */
-	for(i = 0, id = iodefs; id->op; i++, id++){
-		switch(id->op){
-		case M:
-			if (verbose & vmsg) printk(BIOS_SPEW, "%ld: %s\n",
-				globalmicroseconds(), id->msg);
-			break;
-		case R:
-			u = READ32(id->addr);
-			if (verbose & vio)printk(BIOS_SPEW, "%s: Got %08lx, expect %08lx\n",
-				regname(id->addr), u, id->data);
-			/* we're looking for something. */
-			if (lastidread->addr == id->addr){
-				/* they're going to be polling.
-				 * just do it 1000 times
-				 */
-				for(t = 0; t < 1000 && id->data != u; t++){
-					u = READ32(id->addr);
-				}
-				if (verbose & vspin) printk(BIOS_SPEW,
-						"%s: # loops %ld got %08lx want %08lx\n",
-						regname(id->addr),
-						t, u, id->data);
-			}
-			lastidread = id;
-			break;
-		case W:
-			if (verbose & vio)printk(BIOS_SPEW, "%s: outl %08lx\n", regname(id->addr),
-									id->data);
-			WRITE32(id->data, id->addr);
-			if (id->addr == PCH_PP_CONTROL){
-				switch(id->data & 0xf){
-					case 8: break;
-					case 7: break;
-					default: udelay(100000);
-				}
-			}
-			break;
-		case V:
-			if (id->count < 8){
-				prev = verbose;
-				verbose = id->count;
-			} else {
-				verbose = prev;
-			}
-			break;
-		case I:
-			break;
-		default:
-			printk(BIOS_SPEW, "BAD TABLE, opcode %d @ %d\n", id->op, i);
-			return -1;
-		}
-		if (id->udelay)
-			udelay(id->udelay);
-		times[i] = globalmicroseconds();
-	}
-	/* optional, we don't even want to take timestamp overhead
-	 * if we can avoid it. */
-	if (0)
-	for(i = 0, id = iodefs; id->op; i++, id++){
-		switch(id->op){
-		case R:
-			printk(BIOS_SPEW, "%ld: R %08lx\n", times[i], id->addr);
-			break;
-		case W:
-			printk(BIOS_SPEW, "%ld: W %08lx %08lx\n", times[i],
-				id->addr, id->data);
-			break;
-		}
+	ret = run_program(i915_program);
+
+	for (i = 0, u = 0; i < ntimes; i++) {
+		printk(BIOS_SPEW, "wait %d: %s %ld us%s\n", i,
+		       regname(times[i].reg), times[i].usecs,
+		       times[i].timedout ? " (timeout)" : "");
+		u += times[i].usecs;
 	}
+	printk(BIOS_DEBUG, "i915: %d register waits took %ld us\n", ntimes, u);
+
+	if (ret)
+		return ret;
+
+	timestamp_add_now(TS_I915_PROGRAM_DONE);
 
 	setgtt(0, 4520, physbase, 4096);
-	printk(BIOS_SPEW, "memset %p to 0 for %d bytes\n",
+	timestamp_add_now(TS_I915_GTT_DONE);
+#if CONFIG_LINK_CLEAR_FRAMEBUFFER
+	printk(BIOS_SPEW, "clear %p for %d bytes\n",
 				(void *)graphics, 4520*4096);
-	memset((void *)graphics, 0, 4520*4096);
+	clear_framebuffer(graphics, 4520*4096);
+	timestamp_add_now(TS_I915_FB_CLEARED);
+#endif
 	printk(BIOS_SPEW, "%ld microseconds\n", globalmicroseconds());
 	i915_init_done = 1;
 	oprom_is_loaded = 1;
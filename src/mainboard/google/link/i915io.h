@@ -19,42 +19,31 @@
 
 #include "i915_reg.h"
 
-/* One-letter commands for code not meant to be ready for humans.
- * The code was generated by a set of programs/scripts.
- * M print out a kernel message
- * R read a register. We do these mainly to ensure that if hardware wanted
- * the register read, it was read; also, in debug, we can see what was expected
- * and what was found. This has proven *very* useful to get this debugged.
- * The udelay, if non-zero, will make sure there is a
- * udelay() call with the value.
- * The count is from the kernel and tells us how many times this read was done.
- * Also useful for debugging and the state
- * machine uses the info to drive a poll.
- * W Write a register
- * V set verbosity. It's a bit mask.
- *   0 -> nothing
- *   1 -> print kernel messages
- *   2 -> print IO ops
- *   4 -> print the number of times we spin on a register in a poll
- *   8 -> restore whatever the previous verbosity level was
- *   		(only one deep stack)
- *
- * Again, this is not really meant for human consumption. There is not a poll
- * operator as such because, sometimes, there is a read/write/read where the
- * second read is a poll, and this chipset is so touchy I'm reluctant to move
- * things around and/or delete too many reads.
+/* The panel is lit up by a register program that util/i915tool/i915prog
+ * compiles from the kernel driver trace in i915io.trace:
+ *   i915prog -o i915io.c i915io.trace
+ * Each instruction starts with a word holding the opcode in the top 8 bits
+ * and a register offset (or a delay) in the low 24 bits, followed by its
+ * operands:
+ * WRITE  value           write value to the register
+ * POLL   mask value us   read the register until (reg & mask) == value,
+ *                        giving up after us microseconds
+ * DELAY                  wait for the number of microseconds in the low bits
+ * END                    end of program
  */
-#define M 1
-#define R 2
-#define W 3
-#define V 4
-#define I 8
+#define I915_OP_END	0
+#define I915_OP_WRITE	1
+#define I915_OP_POLL	2
+#define I915_OP_DELAY	3
+
+#define I915_INSN(op, arg)	(((op) << 24) | (arg))
+#define I915_INSN_OP(word)	((word) >> 24)
+#define I915_INSN_ARG(word)	((word) & 0xffffff)
+
+#define I915_WRITE(reg, val)	I915_INSN(I915_OP_WRITE, reg), (val)
+#define I915_POLL(reg, mask, val, us) \
+	I915_INSN(I915_OP_POLL, reg), (mask), (val) & (mask), (us)
+#define I915_DELAY(us)		I915_INSN(I915_OP_DELAY, us)
+#define I915_END()		I915_INSN(I915_OP_END, 0)
 
-struct iodef {
-	unsigned char op;
-	unsigned int count;
-	const char *msg;
-	unsigned long addr;
-	unsigned long data;
-	unsigned long udelay;
-};
+extern const u32 i915_program[];
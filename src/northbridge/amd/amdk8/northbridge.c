@@ -551,12 +551,10 @@ static void amdk8_set_resources(device_t dev)
 
 		old = probe_resource(dev, index);
 		if (old) {
-			res->index = old->index;
-			old->index = 0;
+			resource_set_index(dev, old, 0);
 			old->flags = 0;
 		}
-		else
-			res->index = index;
+		resource_set_index(dev, res, index);
 
 		amdk8_set_resource(dev, res, nodeid);
 	}
@@ -0,0 +1,330 @@
+/*
+ * cbfscheck - read cbfstool images with the coreboot CBFS code
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * The host half of cbfscheck: loads an x86 image and the ELF a payload in
+ * it was made from, has the coreboot half find and decode every segment
+ * of the payload, and compares the result with the ELF's PT_LOAD segments.
+ * Work split across CPUs runs on as many threads. -g writes test data for
+ * such an ELF.
+ */
+
+#include <elf.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "cbfscheck.h"
+
+#define GUARD		4096
+#define GUARD_BYTE	0x5a
+
+static const char *const algos[] = { "none", "lzma", "lzma-blocked" };
+
+static int loglevel = 3;
+static unsigned int cpus = 4;
+
+void host_vprintk(int level, const char *fmt, va_list args)
+{
+	if (level <= loglevel)
+		vprintf(fmt, args);
+}
+
+struct part {
+	pthread_t thread;
+	void (*func)(void *arg, unsigned int part, unsigned int parts);
+	void *arg;
+	unsigned int part;
+};
+
+static void *run_part(void *arg)
+{
+	struct part *p = arg;
+
+	p->func(p->arg, p->part, cpus);
+	return NULL;
+}
+
+/* Part 0 runs on the calling thread, like on the BSP. */
+void host_work_split(void (*func)(void *arg, unsigned int part,
+				  unsigned int parts), void *arg)
+{
+	struct part parts[cpus];
+	unsigned int i;
+
+	for (i = 1; i < cpus; i++) {
+		parts[i].func = func;
+		parts[i].arg = arg;
+		parts[i].part = i;
+		if (pthread_create(&parts[i].thread, NULL, run_part,
+				   &parts[i])) {
+			perror("pthread_create");
+			exit(1);
+		}
+	}
+	func(arg, 0, cpus);
+	for (i = 1; i < cpus; i++)
+		pthread_join(parts[i].thread, NULL);
+}
+
+static unsigned char *read_file(const char *name, unsigned long *size)
+{
+	unsigned char *data;
+	FILE *f;
+	long len;
+
+	f = fopen(name, "rb");
+	if (!f) {
+		perror(name);
+		exit(1);
+	}
+	fseek(f, 0, SEEK_END);
+	len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	data = malloc(len ? len : 1);
+	if (!data || fread(data, 1, len, f) != len) {
+		fprintf(stderr, "%s: could not read %ld bytes\n", name, len);
+		exit(1);
+	}
+	fclose(f);
+	*size = len;
+	return data;
+}
+
+/* Lines like the ones in a coreboot log, which LZMA compresses about as
+ * well as code. The same size always gives the same data. */
+static void generate(unsigned long size)
+{
+	unsigned int seed = 1;
+	char line[64];
+	int len;
+
+	while (size) {
+		seed = seed * 1103515245 + 12345;
+		len = snprintf(line, sizeof(line), "PCI: %02x:%02x.%x "
+			       "[%04x/%04x] %s\n", seed >> 28, (seed >> 8) & 31,
+			       (seed >> 4) & 7, 0x8086, seed >> 16,
+			       seed & 0x800 ? "enabled" : "disabled");
+		if (len > size)
+			len = size;
+		fwrite(line, 1, len, stdout);
+		size -= len;
+	}
+}
+
+/* Decodes parts of segment n with cb_payload_range() and checks that each
+ * gives the right bytes and that only the blocks holding them were
+ * decoded. */
+static int check_ranges(const char *name, int n, const unsigned char *data,
+			unsigned long size)
+{
+	unsigned long ranges[][2] = {
+		{ 0, 1 }, { size - 1, 1 }, { size / 2, size / 4 + 1 },
+		{ 131071, 2 }, { 0, ~0UL }, { size, 1 },
+	};
+	unsigned long offset, len, got, block_size = 0, start, end, j;
+	unsigned char *dst;
+	int i, failed = 0;
+
+	dst = malloc(size + GUARD);
+	for (i = 0; i < sizeof(ranges) / sizeof(ranges[0]); i++) {
+		offset = ranges[i][0];
+		len = ranges[i][1];
+		memset(dst, GUARD_BYTE, size + GUARD);
+		got = cb_payload_range(name, n, dst, size, offset, len,
+				       &block_size);
+		if (offset >= size) {
+			if (got) {
+				printf("%s: segment %d: range at %lu past the "
+				       "end decoded\n", name, n, offset);
+				failed = 1;
+			}
+			continue;
+		}
+		if (len > size - offset)
+			len = size - offset;
+		if (got != len || !block_size) {
+			printf("%s: segment %d: range %lu+%lu gave %lu "
+			       "bytes\n", name, n, offset, len, got);
+			failed = 1;
+			continue;
+		}
+		if (memcmp(dst + offset, data + offset, len)) {
+			printf("%s: segment %d: range %lu+%lu differs\n",
+			       name, n, offset, len);
+			failed = 1;
+		}
+		start = offset / block_size * block_size;
+		end = (offset + len - 1) / block_size * block_size +
+		      block_size;
+		for (j = 0; j < size + GUARD; j++) {
+			if ((j < start || j >= end) && dst[j] != GUARD_BYTE) {
+				printf("%s: segment %d: range %lu+%lu wrote "
+				       "at %lu\n", name, n, offset, len, j);
+				failed = 1;
+				break;
+			}
+		}
+	}
+	free(dst);
+	return failed;
+}
+
+static int check_payload(const char *rom_name, const char *name,
+			 const char *elf_name, int algo)
+{
+	unsigned char *rom, *elf, *dst;
+	unsigned long rom_size, elf_size, load, mem_len, total = 0;
+	unsigned long header;
+	Elf32_Ehdr *ehdr;
+	Elf32_Phdr *phdr;
+	int i, n = 0, compression, ret, failed = 0;
+
+	rom = read_file(rom_name, &rom_size);
+	elf = read_file(elf_name, &elf_size);
+
+	/* The pointer to the master header sits at 0xfffffffc. */
+	if (rom_size < 4) {
+		fprintf(stderr, "%s: too small\n", rom_name);
+		return 1;
+	}
+	header = *(unsigned int *)(rom + rom_size - 4) + rom_size;
+	header &= 0xffffffff;
+	cb_set_rom(rom, rom_size, header);
+
+	ehdr = (Elf32_Ehdr *)elf;
+	if (elf_size < sizeof(*ehdr) ||
+	    memcmp(ehdr->e_ident, ELFMAG, SELFMAG) ||
+	    ehdr->e_ident[EI_CLASS] != ELFCLASS32 ||
+	    ehdr->e_phoff + ehdr->e_phnum * sizeof(*phdr) > elf_size) {
+		fprintf(stderr, "%s: not a 32-bit ELF\n", elf_name);
+		return 1;
+	}
+
+	if (!cb_find(name)) {
+		printf("%s: not found\n", name);
+		return 1;
+	}
+
+	phdr = (Elf32_Phdr *)(elf + ehdr->e_phoff);
+	for (i = 0; i < ehdr->e_phnum; i++) {
+		if (phdr[i].p_type != PT_LOAD || !phdr[i].p_filesz)
+			continue;
+
+		dst = malloc(phdr[i].p_memsz + GUARD);
+		memset(dst, GUARD_BYTE, phdr[i].p_memsz + GUARD);
+		ret = cb_payload_segment(name, n, dst, phdr[i].p_memsz, &load,
+					 &mem_len, &compression);
+		if (ret != 1) {
+			printf("%s: segment %d: %s\n", name, n,
+			       ret ? "could not be decoded" : "missing");
+			return 1;
+		}
+		if (load != phdr[i].p_paddr || mem_len != phdr[i].p_memsz) {
+			printf("%s: segment %d: at 0x%lx, %ld bytes, expected "
+			       "0x%x, %d bytes\n", name, n, load, mem_len,
+			       phdr[i].p_paddr, phdr[i].p_memsz);
+			failed = 1;
+		}
+		if (compression != algo) {
+			printf("%s: segment %d: compressed with %d, expected "
+			       "%s\n", name, n, compression, algos[algo]);
+			failed = 1;
+		}
+		if (memcmp(dst, elf + phdr[i].p_offset, phdr[i].p_filesz)) {
+			printf("%s: segment %d: data differs\n", name, n);
+			failed = 1;
+		}
+		for (ret = phdr[i].p_filesz; ret < phdr[i].p_memsz + GUARD;
+		     ret++) {
+			if (dst[ret] != GUARD_BYTE) {
+				printf("%s: segment %d: wrote past %d bytes\n",
+				       name, n, phdr[i].p_filesz);
+				failed = 1;
+				break;
+			}
+		}
+		if (algo == 2 && check_ranges(name, n, elf + phdr[i].p_offset,
+					      phdr[i].p_filesz))
+			failed = 1;
+		total += phdr[i].p_filesz;
+		free(dst);
+		n++;
+	}
+	if (cb_payload_segment(name, n, NULL, 0, &load, &mem_len,
+			       &compression) != 0) {
+		printf("%s: more segments than %s has\n", name, elf_name);
+		failed = 1;
+	}
+
+	printf("%s: %d segment%s, %lu bytes, %s, %d CPU%s: %s\n", name, n,
+	       n == 1 ? "" : "s", total, algos[algo], cpus,
+	       cpus == 1 ? "" : "s", failed ? "FAILED" : "ok");
+	free(rom);
+	free(elf);
+	return failed;
+}
+
+static void usage(void)
+{
+	printf("usage: cbfscheck [-v level] [-c algo] [-j cpus] image name "
+	       "elf\n"
+	       "       cbfscheck -g size > data\n"
+	       "  -c  compression the segments must have: none, lzma or\n"
+	       "      lzma-blocked (lzma)\n"
+	       "  -j  CPUs to split work across, 1 to 8 (4)\n"
+	       "  -v  coreboot console level (3)\n"
+	       "  -g  write size bytes of test data\n");
+}
+
+int main(int argc, char *argv[])
+{
+	int c, algo = 1;
+
+	while ((c = getopt(argc, argv, "c:j:v:g:h")) != -1) {
+		switch (c) {
+		case 'c':
+			for (algo = 0; algo < 3; algo++)
+				if (!strcmp(optarg, algos[algo]))
+					break;
+			if (algo == 3) {
+				usage();
+				return 1;
+			}
+			break;
+		case 'j':
+			cpus = atoi(optarg);
+			if (cpus < 1 || cpus > 8) {
+				usage();
+				return 1;
+			}
+			break;
+		case 'v': loglevel = atoi(optarg); break;
+		case 'g': generate(strtoul(optarg, NULL, 0)); return 0;
+		default: usage(); return c != 'h';
+		}
+	}
+	if (argc - optind != 3) {
+		usage();
+		return 1;
+	}
+	return check_payload(argv[optind], argv[optind + 1],
+			     argv[optind + 2], algo);
+}
@@ -0,0 +1,65 @@
+/*
+ * cbfscheck - read cbfstool images with the coreboot CBFS code
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * cbfscheck is built from two halves that cannot share headers: the
+ * coreboot half (coreboot.c with src/lib/cbfs_core.c, and src/lib/lzma.c)
+ * is compiled against the coreboot include tree, the host half
+ * (cbfscheck.c) against the host C library. This is everything they pass
+ * between each other, so it only uses plain C types.
+ */
+
+#ifndef CBFSCHECK_H
+#define CBFSCHECK_H
+
+#include <stdarg.h>
+
+/* Provided by the host half. */
+void host_vprintk(int level, const char *fmt, va_list args);
+/* Runs func(arg, part, parts) for every part at the same time. */
+void host_work_split(void (*func)(void *arg, unsigned int part,
+				  unsigned int parts), void *arg);
+
+/* Provided by the coreboot half. */
+
+/* Use the image at rom, with its master header at header_offset, as the
+ * default CBFS media. */
+void cb_set_rom(unsigned char *rom, unsigned long size,
+		unsigned long header_offset);
+
+/* Looks up name with cbfs_get_file(). Returns 1 if it was found. */
+int cb_find(const char *name);
+
+/* Decodes the n-th code or data segment of payload name into dst, which
+ * holds dst_size bytes, with cbfs_decompress(). Returns 1 if it did, 0 if
+ * the payload has no such segment and -1 on error. */
+int cb_payload_segment(const char *name, int n, unsigned char *dst,
+		       unsigned long dst_size, unsigned long *load,
+		       unsigned long *mem_len, int *compression);
+
+/* Decodes only the blocks of the n-th segment of payload name, which must
+ * be LZMA-blocked, that hold bytes offset to offset + len - 1, with
+ * ulzma_blocked_range(). dst holds the whole segment, dst_size bytes.
+ * Sets *block_size to the size of the blocks. Returns what
+ * ulzma_blocked_range() does, or 0 if the segment is not LZMA-blocked. */
+unsigned long cb_payload_range(const char *name, int n, unsigned char *dst,
+			       unsigned long dst_size, unsigned long offset,
+			       unsigned long len, unsigned long *block_size);
+
+#endif
@@ -0,0 +1,20 @@
+/*
+ * Kconfig values for building the coreboot CBFS code into cbfscheck.
+ * This stands in for the build/config.h a real coreboot build generates.
+ */
+
+#define CONFIG_ARCH_X86 1
+#define CONFIG_DEFAULT_CONSOLE_LOGLEVEL 8
+#define CONFIG_MAXIMUM_CONSOLE_LOGLEVEL 8
+#define CONFIG_CONSOLE_SERIAL 0
+#define CONFIG_USBDEBUG 0
+#define CONFIG_CONSOLE_NE2K 0
+#define CONFIG_CONSOLE_CBMEM 0
+#define CONFIG_EARLY_CONSOLE 0
+#define CONFIG_DEBUG_CBFS 0
+
+/* lzma.c splits LZMA-blocked streams with cpu_work_split(), which
+ * coreboot.c runs on host threads. */
+#define CONFIG_SMP 0
+#define CONFIG_PARALLEL_CPU_INIT 1
+#define CONFIG_MAX_CPUS 8
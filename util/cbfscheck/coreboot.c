@@ -0,0 +1,207 @@
+/*
+ * cbfscheck - read cbfstool images with the coreboot CBFS code
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * The coreboot half of cbfscheck: src/lib/cbfs_core.c, included the way
+ * src/lib/cbfs.c includes it, on top of a default media that is the image
+ * in host memory. Payload segments are walked like selfboot does and
+ * decoded with cbfs_decompress(). The CPUs cpu_work_split() hands work
+ * to are host threads.
+ */
+
+#include <arch/byteorder.h>
+#include <console/console.h>
+#include <string.h>
+#include <lib.h>
+#include <cpu/x86/work_queue.h>
+#include "cbfscheck.h"
+
+static unsigned char *rom_data;
+static u32 rom_size, rom_header;
+
+#define CBFS_CORE_WITH_LZMA
+#define CBFS_HEADER_ROM_ADDRESS rom_header
+#define CONFIG_ROM_SIZE rom_size
+#define ERROR(x...) printk(BIOS_ERR, "CBFS: " x)
+#define LOG(x...) printk(BIOS_INFO, "CBFS: " x)
+#define DEBUG(x...) printk(BIOS_SPEW, "CBFS: " x)
+
+#include "../../src/lib/cbfs_core.c"
+
+int do_printk(int msg_level, const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	host_vprintk(msg_level, fmt, args);
+	va_end(args);
+	return 0;
+}
+
+void cpu_work_split(cpu_work_part_func func, void *arg)
+{
+	host_work_split(func, arg);
+}
+
+static int rom_open(struct cbfs_media *media)
+{
+	return 0;
+}
+
+static int rom_close(struct cbfs_media *media)
+{
+	return 0;
+}
+
+static void *rom_map(struct cbfs_media *media, size_t offset, size_t count)
+{
+	if (offset > rom_size || count > rom_size - offset)
+		return CBFS_MEDIA_INVALID_MAP_ADDRESS;
+	return rom_data + offset;
+}
+
+static void *rom_unmap(struct cbfs_media *media, const void *address)
+{
+	return NULL;
+}
+
+static size_t rom_read(struct cbfs_media *media, void *dest, size_t offset,
+		       size_t count)
+{
+	void *src = rom_map(media, offset, count);
+
+	if (src == CBFS_MEDIA_INVALID_MAP_ADDRESS)
+		return 0;
+	memcpy(dest, src, count);
+	return count;
+}
+
+int init_default_cbfs_media(struct cbfs_media *media)
+{
+	media->context = NULL;
+	media->open = rom_open;
+	media->close = rom_close;
+	media->map = rom_map;
+	media->unmap = rom_unmap;
+	media->read = rom_read;
+	return 0;
+}
+
+void cb_set_rom(unsigned char *rom, unsigned long size,
+		unsigned long header_offset)
+{
+	rom_data = rom;
+	rom_size = size;
+	rom_header = header_offset;
+}
+
+int cb_find(const char *name)
+{
+	return cbfs_get_file(CBFS_DEFAULT_MEDIA, name) != NULL;
+}
+
+/* The size a segment decodes to, from its stream header. */
+static u32 decoded_size(int algo, const unsigned char *src, u32 len)
+{
+	switch (algo) {
+	case CBFS_COMPRESS_LZMA:
+		return src[8] << 24 | src[7] << 16 | src[6] << 8 | src[5];
+	case CBFS_COMPRESS_LZMA_BLOCKED:
+		return src[15] << 24 | src[14] << 16 | src[13] << 8 | src[12];
+	default:
+		return len;
+	}
+}
+
+/* The n-th code or data segment of payload name. */
+static struct cbfs_payload_segment *find_segment(const char *name, int n,
+						 unsigned char **src)
+{
+	struct cbfs_payload *payload;
+	struct cbfs_payload_segment *segment;
+	int i = 0;
+
+	payload = cbfs_get_file_content(CBFS_DEFAULT_MEDIA, name,
+					CBFS_TYPE_PAYLOAD);
+	if (!payload)
+		return NULL;
+
+	for (segment = &payload->segments;
+	     segment->type != PAYLOAD_SEGMENT_ENTRY; segment++) {
+		if (segment->type != PAYLOAD_SEGMENT_CODE &&
+		    segment->type != PAYLOAD_SEGMENT_DATA)
+			continue;
+		if (i++ != n)
+			continue;
+		*src = (unsigned char *)payload + ntohl(segment->offset);
+		return segment;
+	}
+	return NULL;
+}
+
+int cb_payload_segment(const char *name, int n, unsigned char *dst,
+		       unsigned long dst_size, unsigned long *load,
+		       unsigned long *mem_len, int *compression)
+{
+	struct cbfs_payload_segment *segment;
+	unsigned char *src;
+	u32 len;
+
+	if (!cbfs_get_file_content(CBFS_DEFAULT_MEDIA, name,
+				   CBFS_TYPE_PAYLOAD))
+		return -1;
+	segment = find_segment(name, n, &src);
+	if (!segment)
+		return 0;
+
+	*load = ntohll(segment->load_addr);
+	*mem_len = ntohl(segment->mem_len);
+	*compression = ntohl(segment->compression);
+	len = decoded_size(*compression, src, ntohl(segment->len));
+	if (len > dst_size || len > *mem_len) {
+		printk(BIOS_ERR, "Segment %d decodes to %d bytes, "
+		       "more than it has room for.\n", n, len);
+		return -1;
+	}
+	if (cbfs_decompress(*compression, src, dst,
+			    ntohl(segment->len)) != 0)
+		return -1;
+	return 1;
+}
+
+unsigned long cb_payload_range(const char *name, int n, unsigned char *dst,
+			       unsigned long dst_size, unsigned long offset,
+			       unsigned long len, unsigned long *block_size)
+{
+	struct cbfs_payload_segment *segment;
+	unsigned char *src;
+
+	segment = find_segment(name, n, &src);
+	if (!segment ||
+	    ntohl(segment->compression) != CBFS_COMPRESS_LZMA_BLOCKED)
+		return 0;
+	if (decoded_size(CBFS_COMPRESS_LZMA_BLOCKED, src,
+			 ntohl(segment->len)) > dst_size) {
+		printk(BIOS_ERR, "Segment %d does not fit.\n", n);
+		return 0;
+	}
+	*block_size = src[7] << 24 | src[6] << 16 | src[5] << 8 | src[4];
+	return ulzma_blocked_range(src, ntohl(segment->len), dst, offset,
+				   len);
+}
@@ -35,7 +35,7 @@ struct cbfs_header {
 	uint32_t align;
 	uint32_t offset;
 	uint32_t architecture;	/* Version 2 */
-	uint32_t pad[1];
+	uint32_t index_offset;	/* CBFS index entry + 1, or 0 / 0xffffffff */
 } __attribute__ ((packed));
 
 #define CBFS_ARCHITECTURE_UNKNOWN  0xFFFFFFFF
@@ -92,6 +92,7 @@ struct cbfs_payload {
 #define CBFS_COMPONENT_VSA        0x51
 #define CBFS_COMPONENT_MBI        0x52
 #define CBFS_COMPONENT_MICROCODE  0x53
+#define CBFS_COMPONENT_INDEX      0x60
 #define CBFS_COMPONENT_CMOS_DEFAULT 0xaa
 #define CBFS_COMPONENT_CMOS_LAYOUT 0x01aa
 
@@ -107,6 +108,40 @@ struct cbfs_payload {
  */
 #define CBFS_COMPONENT_NULL 0xFFFFFFFF
 
+/* The CBFS index: a sorted table of file name hashes, so firmware can find a
+ * file without walking the whole CBFS. The index is a regular file of type
+ * CBFS_COMPONENT_INDEX, referenced by index_offset in the master header.
+ * index_offset holds the offset of the index entry plus one: CBFS starts at
+ * offset 0 in x86 images, and 0 already means "no index". All fields are big
+ * endian. */
+#define CBFS_INDEX_NAME "cbfs_index"
+#define CBFS_INDEX_MAGIC 0x43424958 /* "CBIX" */
+
+struct cbfs_index_entry {
+	uint32_t hash;
+	uint32_t offset;
+	uint32_t len;
+	uint32_t type;
+} __attribute__ ((packed));
+
+struct cbfs_index {
+	uint32_t magic;
+	uint32_t count;
+	struct cbfs_index_entry entries[0];
+} __attribute__ ((packed));
+
+/* FNV-1a hash of a file name; must match cbfs_index_hash() in cbfs_core.h */
+static inline uint32_t cbfs_index_hash(const char *name)
+{
+	uint32_t hash = 0x811c9dc5;
+
+	while (*name) {
+		hash ^= (uint8_t)*name++;
+		hash *= 0x01000193;
+	}
+	return hash;
+}
+
 int cbfs_file_header(unsigned long physaddr);
 #define CBFS_NAME(_c) (((char *) (_c)) + sizeof(struct cbfs_file))
 #define CBFS_SUBHEADER(_p) ( (void *) ((((uint8_t *) (_p)) + ntohl((_p)->offset))) )
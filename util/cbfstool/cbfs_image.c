@@ -55,6 +55,7 @@ static struct typedesc_t types_cbfs_entry[] = {
 	{CBFS_COMPONENT_VSA, "vsa"},
 	{CBFS_COMPONENT_MBI, "mbi"},
 	{CBFS_COMPONENT_MICROCODE, "microcode"},
+	{CBFS_COMPONENT_INDEX, "index"},
 	{CBFS_COMPONENT_CMOS_DEFAULT, "cmos_default"},
 	{CBFS_COMPONENT_CMOS_LAYOUT, "cmos_layout"},
 	{CBFS_COMPONENT_DELETED, "deleted"},
@@ -65,6 +66,7 @@ static struct typedesc_t types_cbfs_entry[] = {
 static struct typedesc_t types_cbfs_compression[] = {
 	{CBFS_COMPRESS_NONE, "none"},
 	{CBFS_COMPRESS_LZMA, "LZMA"},
+	{CBFS_COMPRESS_LZMA_BLOCKED, "LZMA-blocked"},
 	{0, NULL},
 };
 
@@ -243,6 +245,15 @@ int cbfs_image_from_file(struct cbfs_image *image, const char *filename) {
 
 int cbfs_image_write_file(struct cbfs_image *image, const char *filename) {
 	assert(image && image->buffer.data);
+	if (image->header) {
+		// Keep an existing index in sync with the directory.
+		if (cbfs_has_index(image)) {
+			if (cbfs_update_index(image) != 0)
+				return -1;
+		} else {
+			image->header->index_offset = htonl(0xffffffff);
+		}
+	}
 	return buffer_write_file(&image->buffer, filename);
 }
 
@@ -365,7 +376,9 @@ int cbfs_add_entry(struct cbfs_image *image, struct buffer *buffer,
 
 		DEBUG("cbfs_add_entry: space at 0x%x+0x%x(%d) bytes\n",
 		      addr, addr_next - addr, addr_next - addr);
-		if (addr + need_size > addr_next)
+		// Leave room for the empty entry that follows the new one.
+		if (align_up(addr + need_size, ntohl(image->header->align)) +
+		    cbfs_calculate_file_header_size("") > addr_next)
 			continue;
 
 		// Can we simply put object here?
@@ -490,6 +503,118 @@ int cbfs_remove_entry(struct cbfs_image *image, const char *name) {
 	return 0;
 }
 
+int cbfs_has_index(struct cbfs_image *image) {
+	uint32_t offset = ntohl(image->header->index_offset);
+	struct cbfs_file *entry;
+
+	if (offset == 0 || offset == 0xffffffff ||
+	    offset - 1 + sizeof(*entry) > image->buffer.size)
+		return 0;
+	offset--;
+	entry = (struct cbfs_file *)(image->buffer.data + offset);
+	return (cbfs_is_valid_entry(image, entry) &&
+		ntohl(entry->type) == CBFS_COMPONENT_INDEX);
+}
+
+struct cbfs_index_context {
+	struct cbfs_index_entry *entries;
+	uint32_t count;
+};
+
+static int cbfs_is_file_entry(struct cbfs_file *entry) {
+	uint32_t type = ntohl(entry->type);
+	return (type != CBFS_COMPONENT_NULL && type != CBFS_COMPONENT_DELETED);
+}
+
+static int cbfs_count_index_entry(struct cbfs_image *image,
+				  struct cbfs_file *entry, void *arg) {
+	struct cbfs_index_context *ctx = (struct cbfs_index_context *)arg;
+	if (cbfs_is_file_entry(entry))
+		ctx->count++;
+	return 0;
+}
+
+static int cbfs_fill_index_entry(struct cbfs_image *image,
+				 struct cbfs_file *entry, void *arg) {
+	struct cbfs_index_context *ctx = (struct cbfs_index_context *)arg;
+	struct cbfs_index_entry *e;
+
+	if (!cbfs_is_file_entry(entry))
+		return 0;
+	e = &ctx->entries[ctx->count++];
+	e->hash = htonl(cbfs_index_hash(CBFS_NAME(entry)));
+	e->offset = htonl(cbfs_get_entry_addr(image, entry));
+	e->len = entry->len;
+	e->type = entry->type;
+	return 0;
+}
+
+static int cbfs_compare_index_entry(const void *a, const void *b) {
+	const struct cbfs_index_entry *ea = a, *eb = b;
+	uint32_t ha = ntohl(ea->hash), hb = ntohl(eb->hash);
+	uint32_t oa = ntohl(ea->offset), ob = ntohl(eb->offset);
+
+	if (ha != hb)
+		return ha < hb ? -1 : 1;
+	if (oa != ob)
+		return oa < ob ? -1 : 1;
+	return 0;
+}
+
+int cbfs_update_index(struct cbfs_image *image) {
+	struct cbfs_index_context ctx = { NULL, 0 };
+	struct cbfs_index *index;
+	struct cbfs_file *entry;
+	struct buffer buffer;
+	uint32_t count, size;
+
+	cbfs_walk(image, cbfs_count_index_entry, &ctx);
+	entry = cbfs_get_entry(image, CBFS_INDEX_NAME);
+	if (!entry)
+		ctx.count++; // Count the index, too.
+	count = ctx.count;
+	size = sizeof(*index) + count * sizeof(index->entries[0]);
+
+	// Rewrite the index where it is if it still fits, so that writing
+	// an image does not move it or leave a deleted entry behind.
+	if (entry && ntohl(entry->len) < size) {
+		cbfs_remove_entry(image, CBFS_INDEX_NAME);
+		entry = NULL;
+	}
+	if (!entry) {
+		if (buffer_create(&buffer, size, CBFS_INDEX_NAME) != 0)
+			return -1;
+		memset(buffer.data, 0, buffer.size);
+		if (cbfs_add_entry(image, &buffer, CBFS_INDEX_NAME,
+				   CBFS_COMPONENT_INDEX, 0) != 0) {
+			ERROR("No space for CBFS index (%d entries).\n",
+			      count);
+			buffer_delete(&buffer);
+			return -1;
+		}
+		buffer_delete(&buffer);
+		entry = cbfs_get_entry(image, CBFS_INDEX_NAME);
+		assert(entry);
+	}
+
+	index = (struct cbfs_index *)CBFS_SUBHEADER(entry);
+	memset(index, 0, ntohl(entry->len));
+	ctx.entries = index->entries;
+	ctx.count = 0;
+	cbfs_walk(image, cbfs_fill_index_entry, &ctx);
+	assert(ctx.count == count);
+	qsort(index->entries, count, sizeof(index->entries[0]),
+	      cbfs_compare_index_entry);
+	index->magic = htonl(CBFS_INDEX_MAGIC);
+	index->count = htonl(count);
+
+	image->header->index_offset =
+		htonl(cbfs_get_entry_addr(image, entry) + 1);
+	DEBUG("CBFS index with %d entries at 0x%x.\n", count,
+	      cbfs_get_entry_addr(image, entry));
+	return 0;
+}
+
 int cbfs_print_header_info(struct cbfs_image *image) {
 	char *name = strdup(image->buffer.name);
 	assert(image && image->header);
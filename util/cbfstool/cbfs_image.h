@@ -92,6 +92,15 @@ typedef int (*cbfs_entry_callback)(struct cbfs_image *image,
  * Returns number of entries invoked. */
 int cbfs_walk(struct cbfs_image *image, cbfs_entry_callback callback, void *arg);
 
+/* Returns 1 if the image has a CBFS index referenced by its header. */
+int cbfs_has_index(struct cbfs_image *image);
+
+/* (Re)builds the CBFS index for all files in the image and points the CBFS
+ * header to it. An existing index is rewritten in place if it is still big
+ * enough. cbfs_image_write_file calls this for images that already have an
+ * index. Returns 0 on success, otherwise non-zero. */
+int cbfs_update_index(struct cbfs_image *image);
+
 /* Primitive CBFS utilities */
 
 /* Returns a pointer to the only valid CBFS header in give buffer, otherwise
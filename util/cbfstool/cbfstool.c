@@ -29,6 +29,9 @@
 #include "cbfs.h"
 #include "cbfs_image.h"
 
+/* More threads than this for -j is a typo, not a machine. */
+#define MAX_LZMA_JOBS 256
+
 struct command {
 	const char *name;
 	const char *optstring;
@@ -53,6 +56,8 @@ static struct param {
 	uint32_t offset;
 	uint32_t top_aligned;
 	comp_algo algo;
+	uint32_t lzma_heavy;
+	uint32_t jobs;
 } param = {
 	/* All variables not listed are initialized as zero. */
 	.algo = CBFS_COMPRESS_NONE,
@@ -373,6 +378,28 @@ static int cbfs_locate(void)
 	return 0;
 }
 
+static int cbfs_add_index(void)
+{
+	struct cbfs_image image;
+
+	if (cbfs_image_from_file(&image, param.cbfs_name) != 0) {
+		ERROR("Could not load ROM image '%s'.\n",
+			param.cbfs_name);
+		return 1;
+	}
+
+	if (cbfs_update_index(&image) != 0 ||
+	    cbfs_image_write_file(&image, param.cbfs_name) != 0) {
+		ERROR("Failed to add CBFS index to '%s'.\n",
+		      param.cbfs_name);
+		cbfs_image_delete(&image);
+		return 1;
+	}
+
+	cbfs_image_delete(&image);
+	return 0;
+}
+
 static int cbfs_print(void)
 {
 	struct cbfs_image image;
@@ -416,10 +443,11 @@ static int cbfs_extract(void)
 
 static const struct command commands[] = {
 	{"add", "f:n:t:b:vh?", cbfs_add},
-	{"add-payload", "f:n:t:c:b:vh?", cbfs_add_payload},
-	{"add-stage", "f:n:t:c:b:vh?", cbfs_add_stage},
-	{"add-flat-binary", "f:n:l:e:c:b:vh?", cbfs_add_flat_binary},
+	{"add-payload", "f:n:t:c:b:j:vh?", cbfs_add_payload},
+	{"add-stage", "f:n:t:c:b:j:vh?", cbfs_add_stage},
+	{"add-flat-binary", "f:n:l:e:c:b:j:vh?", cbfs_add_flat_binary},
 	{"remove", "n:vh?", cbfs_remove},
+	{"add-index", "vh?", cbfs_add_index},
 	{"create", "s:B:b:H:a:o:m:vh?", cbfs_create},
 	{"locate", "f:n:a:Tvh?", cbfs_locate},
 	{"print", "vh?", cbfs_print},
@@ -440,6 +468,7 @@ static struct option long_options[] = {
 	{"offset",       required_argument, 0, 'o' },
 	{"file",         required_argument, 0, 'f' },
 	{"arch",         required_argument, 0, 'm' },
+	{"jobs",         required_argument, 0, 'j' },
 	{"verbose",      no_argument,       0, 'v' },
 	{"help",         no_argument,       0, 'h' },
 	{NULL,           0,                 0,  0  }
@@ -452,6 +481,7 @@ static void usage(char *name)
 	     "USAGE:\n" " %s [-h]\n"
 	     " %s FILE COMMAND [-v] [PARAMETERS]...\n\n" "OPTIONs:\n"
 	     "  -T              Output top-aligned memory address\n"
+	     "  -j jobs         Threads for the lzma-heavy parameter search\n"
 	     "  -v              Provide verbose output\n"
 	     "  -h              Display this help message\n\n"
 	     "COMMANDs:\n"
@@ -466,6 +496,8 @@ static void usage(char *name)
 			"Add a 32bit flat mode binary\n"
 	     " remove -n NAME                                              "
 			"Remove a component\n"
+	     " add-index                                                   "
+			"Add a lookup index (kept up to date)\n"
 	     " create -s size -B bootblock -m ARCH [-a align] [-o offset]  "
 			"Create a ROM file\n"
 	     " locate -f FILE -n NAME [-a align] [-T]                      "
@@ -475,6 +507,9 @@ static void usage(char *name)
 	     " extract -n NAME -f FILE                                     "
 			"Extracts a raw payload from ROM\n"
 	     "\n"
+	     "COMPRESSIONs:\n"
+	     "  none, lzma, lzma-heavy (try all lzma pb/lp/lc settings),\n"
+	     "  lzma-blocked (independently decodable 128k lzma blocks)\n"
 	     "ARCHes:\n"
 	     "  armv7, x86\n"
 	     "TYPEs:\n", name, name
@@ -533,6 +568,11 @@ int main(int argc, char **argv)
 			case 'c':
 				if (!strncasecmp(optarg, "lzma", 5))
 					param.algo = CBFS_COMPRESS_LZMA;
+				else if (!strncasecmp(optarg, "lzma-heavy", 11)) {
+					param.algo = CBFS_COMPRESS_LZMA;
+					param.lzma_heavy = 1;
+				} else if (!strncasecmp(optarg, "lzma-blocked", 13))
+					param.algo = CBFS_COMPRESS_LZMA_BLOCKED;
 				else if (!strncasecmp(optarg, "none", 5))
 					param.algo = CBFS_COMPRESS_NONE;
 				else
@@ -587,6 +627,17 @@ int main(int argc, char **argv)
 			case 'm':
 				arch = string_to_arch(optarg);
 				break;
+			case 'j': {
+				unsigned long jobs = strtoul(optarg, &suffix, 0);
+				if (!*optarg || *suffix || !jobs ||
+				    jobs > MAX_LZMA_JOBS) {
+					ERROR("-j needs a number of threads "
+					      "from 1 to %d.\n", MAX_LZMA_JOBS);
+					return 1;
+				}
+				param.jobs = jobs;
+				break;
+			}
 			case 'h':
 			case '?':
 				usage(argv[0]);
@@ -596,6 +647,9 @@ int main(int argc, char **argv)
 			}
 		}
 
+		if (param.lzma_heavy)
+			lzma_set_search(2, param.jobs);
+
 		return commands[i].function();
 	}
 
@@ -91,10 +91,18 @@ int writerom(const char *filename, void *start, uint32_t size);
 int iself(unsigned char *input);
 
 typedef void (*comp_func_ptr) (char *, int, char *, int *);
-typedef enum { CBFS_COMPRESS_NONE = 0, CBFS_COMPRESS_LZMA = 1 } comp_algo;
+typedef enum {
+	CBFS_COMPRESS_NONE = 0,
+	CBFS_COMPRESS_LZMA = 1,
+	CBFS_COMPRESS_LZMA_BLOCKED = 2,
+} comp_algo;
 
 comp_func_ptr compression_function(comp_algo algo);
 
+/* Search level for LZMA parameters: 0 = defaults, 1 = auto, 2 = exhaustive.
+ * threads is the number of workers used by the exhaustive search. */
+void lzma_set_search(int heavy_level, int threads);
+
 uint64_t intfiletype(const char *name);
 
 /* cbfs-mkpayload.c */
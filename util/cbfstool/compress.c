@@ -27,12 +27,25 @@
 #include "common.h"
 
 extern void do_lzma_compress(char *in, int in_len, char *out, int *out_len);
+extern void do_lzma_blocked_compress(char *in, int in_len, char *out,
+				     int *out_len);
+extern void do_lzma_set_search(int heavy_level, int threads);
+
+void lzma_set_search(int heavy_level, int threads)
+{
+	do_lzma_set_search(heavy_level, threads);
+}
 
 void lzma_compress(char *in, int in_len, char *out, int *out_len)
 {
 	do_lzma_compress(in, in_len, out, out_len);
 }
 
+void lzma_blocked_compress(char *in, int in_len, char *out, int *out_len)
+{
+	do_lzma_blocked_compress(in, in_len, out, out_len);
+}
+
 void none_compress(char *in, int in_len, char *out, int *out_len)
 {
 	memcpy(out, in, in_len);
@@ -49,6 +62,9 @@ comp_func_ptr compression_function(comp_algo algo)
 	case CBFS_COMPRESS_LZMA:
 		compress = lzma_compress;
 		break;
+	case CBFS_COMPRESS_LZMA_BLOCKED:
+		compress = lzma_blocked_compress;
+		break;
 	default:
 		ERROR("Unknown compression algorithm %d!\n", algo);
 		return NULL;
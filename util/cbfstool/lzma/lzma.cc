@@ -17,7 +17,10 @@ extern "C" {
 
 #include <stdint.h>
 
-/* We don't want threads */
+#include <pthread.h>
+
+/* The heavy search uses its own worker threads (see LZMA_NumThreads);
+ * the auto search below still runs single-threaded. */
 #ifdef linux
 #include <sched.h>
 #define ForceSwitchThread() sched_yield()
@@ -28,6 +31,20 @@ extern "C" {
 
 int LZMA_verbose = 0;
 
+/* Number of worker threads used by LZMACompressHeavy. 1 = serial search. */
+unsigned LZMA_NumThreads = 1;
+
+/* Search level used by do_lzma_compress: 0 = default settings,
+ * 1 = LZMACompressAuto, 2 = LZMACompressHeavy. */
+int LZMA_HeavyLevel = 0;
+
+/* Uncompressed size of each block of a CBFS_COMPRESS_LZMA_BLOCKED stream. */
+unsigned LZMA_BlockSize = 128 * 1024;
+
+/* Upper bound for lc+lp tried by LZMACompressHeavy. The firmware decoders
+ * size their probability tables for lc+lp <= 3 (see src/lib/lzma.c). */
+unsigned LZMA_MaxLcLp = 3;
+
 // -fb
 unsigned LZMA_NumFastBytes = 273;
 /*from lzma.txt:
@@ -235,6 +252,38 @@ const std::vector<unsigned char> LZMACompress(const unsigned char* data, size_t
         SelectDictionarySizeFor(length));
 }
 
+/* Aborts an encoder run as soon as its output grows beyond *cutoff bytes.
+ * The cutoff is shared between the heavy search workers and only ever
+ * shrinks, so a stale read just lets a hopeless candidate run a bit longer.
+ */
+class CutoffProgress: public ICompressProgress
+{
+public:
+    const volatile unsigned* const cutoff;
+public:
+    CutoffProgress(const volatile unsigned* c)
+        : ICompressProgress(), cutoff(c)
+    {
+        Progress = ProgressMethod;
+    }
+    static SRes ProgressMethod(void *pp, UInt64, UInt64 outSize)
+    {
+        CutoffProgress& p = *(CutoffProgress*)pp;
+        if(outSize + LZMA_PROPS_SIZE + 8 > *p.cutoff)
+            return SZ_ERROR_PROGRESS;
+        return SZ_OK;
+    }
+};
+
+static const std::vector<unsigned char> LZMACompressCutoff(
+    const unsigned char* data, size_t length,
+    unsigned pb,
+    unsigned lp,
+    unsigned lc,
+    unsigned dictionarysize,
+    const volatile unsigned* cutoff,
+    bool& aborted);
+
 const std::vector<unsigned char> LZMACompress(
     const unsigned char* data, size_t length,
     unsigned pb,
@@ -242,6 +291,21 @@ const std::vector<unsigned char> LZMACompress(
     unsigned lc,
     unsigned dictionarysize)
 {
+    bool aborted_unused;
+    return LZMACompressCutoff(data,length, pb,lp,lc, dictionarysize,
+        0, aborted_unused);
+}
+
+static const std::vector<unsigned char> LZMACompressCutoff(
+    const unsigned char* data, size_t length,
+    unsigned pb,
+    unsigned lp,
+    unsigned lc,
+    unsigned dictionarysize,
+    const volatile unsigned* cutoff,
+    bool& aborted)
+{
+    aborted = false;
     if(!length) return std::vector<unsigned char>();
 
     CLzmaEncProps props;
@@ -302,9 +366,18 @@ const std::vector<unsigned char> LZMACompress(
     put_64(propsEncoded+LZMA_PROPS_SIZE, length);
     os.buf.insert(os.buf.end(), propsEncoded, propsEncoded+LZMA_PROPS_SIZE+8);
 
-    res = LzmaEnc_Encode(p, &os, &is, 0, &LZMAalloc, &LZMAalloc);
+    CutoffProgress progress(cutoff);
+    res = LzmaEnc_Encode(p, &os, &is, cutoff ? &progress : 0,
+                         &LZMAalloc, &LZMAalloc);
+    if(res == SZ_ERROR_PROGRESS) aborted = true;
     if(res != SZ_OK) goto Error;
 
+    if(cutoff && os.buf.size() > *cutoff)
+    {
+        aborted = true;
+        goto Error;
+    }
+
     return os.buf;
 }
 
@@ -382,9 +455,127 @@ int main(void)
 }
 #endif
 
+/* State shared by the LZMACompressHeavy worker threads. Candidates are
+ * handed out in the same (pb, lp, lc) order the serial search uses, and
+ * ties on size are resolved towards the lowest compress_mode, so the
+ * result is byte-identical to the serial search.
+ */
+struct HeavySearch
+{
+    const unsigned char* data;
+    size_t               length;
+    bool                 use_small_dict;
+    const char*          why;
+
+    pthread_mutex_t      lock;
+    int                  next_mode;
+    int                  best_mode;
+    volatile unsigned    cutoff;
+    std::vector<unsigned char> bestresult;
+};
+
+static void* LZMACompressHeavyWorker(void* arg)
+{
+    HeavySearch& s = *(HeavySearch*)arg;
+    for(;;)
+    {
+        pthread_mutex_lock(&s.lock);
+        const int compress_mode = s.next_mode++;
+        pthread_mutex_unlock(&s.lock);
+        if(compress_mode >= (5*5*9)) break;
+
+        const unsigned pb = compress_mode % 5;
+        const unsigned lp = (compress_mode / 5) % 5;
+        const unsigned lc = (compress_mode / 5 / 5) % 9;
+
+        if(lc + lp > LZMA_MaxLcLp) continue;
+
+        bool aborted;
+        std::vector<unsigned char> result = LZMACompressCutoff(
+            s.data, s.length, pb,lp,lc,
+            s.use_small_dict ? 4096 : SelectDictionarySizeFor(s.length),
+            &s.cutoff, aborted);
+
+        if(aborted)
+        {
+            if(LZMA_verbose >= 2)
+                std::fprintf(stderr, "%s: pb%u lp%u lc%u cut off\n",
+                    s.why, pb,lp,lc);
+            continue;
+        }
+
+        pthread_mutex_lock(&s.lock);
+        if(s.best_mode < 0
+        || result.size() < s.bestresult.size()
+        || (result.size() == s.bestresult.size() && compress_mode < s.best_mode))
+        {
+            if(LZMA_verbose >= 1)
+                std::fprintf(stderr, "Yay result with pb%u lp%u lc%u: %u\n",
+                    pb,lp,lc, (unsigned)result.size());
+            s.best_mode = compress_mode;
+            s.cutoff    = result.size();
+            s.bestresult.swap(result);
+        }
+        pthread_mutex_unlock(&s.lock);
+    }
+    return 0;
+}
+
+static const std::vector<unsigned char> LZMACompressHeavyThreaded(
+    const unsigned char* data, size_t length,
+    const char* why)
+{
+    HeavySearch s;
+    s.data           = data;
+    s.length         = length;
+    s.use_small_dict = false;
+    s.why            = why;
+    s.next_mode      = 0;
+    s.best_mode      = -1;
+    s.cutoff         = ~0U;
+    pthread_mutex_init(&s.lock, 0);
+
+    if(LZMA_verbose >= 1)
+    {
+        std::fprintf(stderr, "Start LZMA(%s, %u bytes, %u threads)\n",
+            why, (unsigned)length, LZMA_NumThreads);
+        std::fflush(stderr);
+    }
+
+    std::vector<pthread_t> threads;
+    for(unsigned a=0; a<LZMA_NumThreads; ++a)
+    {
+        pthread_t t;
+        if(pthread_create(&t, 0, LZMACompressHeavyWorker, &s) != 0)
+            break;
+        threads.push_back(t);
+    }
+    /* If no thread could be started, do the work ourselves. */
+    if(threads.empty())
+        LZMACompressHeavyWorker(&s);
+    for(size_t a=0; a<threads.size(); ++a)
+        pthread_join(threads[a], 0);
+
+    pthread_mutex_destroy(&s.lock);
+
+    if(LZMA_verbose >= 1)
+    {
+        std::fprintf(stderr, "Best LZMA for %s(%u->%u): pb%u lp%u lc%u\n",
+            why,
+            (unsigned)length,
+            (unsigned)s.bestresult.size(),
+            s.best_mode % 5, (s.best_mode / 5) % 5, (s.best_mode / 5 / 5) % 9);
+    }
+    std::fflush(stderr);
+    return s.bestresult;
+}
+
 const std::vector<unsigned char> LZMACompressHeavy(const unsigned char* data, size_t length,
     const char* why)
 {
+    if(LZMA_NumThreads > 1 && length)
+        return LZMACompressHeavyThreaded(data, length, why);
+
     std::vector<unsigned char> bestresult;
     char best[512];
     bool first = true;
@@ -405,6 +596,8 @@ const std::vector<unsigned char> LZMACompressHeavy(const unsigned char* data, si
         const unsigned lp = (compress_mode / 5) % 5;
         const unsigned lc = (compress_mode / 5 / 5) % 9;
 
+        if(lc + lp > LZMA_MaxLcLp) continue;
+
         std::vector<unsigned char>
             result = use_small_dict
                 ? LZMACompress(data,length,pb,lp,lc, 4096)
@@ -819,12 +1012,61 @@ extern "C" {
 
 void do_lzma_compress(char *in, int in_len, char *out, int *out_len) {
 	std::vector<unsigned char> result;
-	result = LZMACompress(std::vector<unsigned char>(in, in + in_len));
+	result = DoLZMACompress(LZMA_HeavyLevel,
+		std::vector<unsigned char>(in, in + in_len));
 	*out_len = result.size();
 	if (*out_len < in_len)
 		std::memcpy(out, &result[0], *out_len);
 }
 
+/**
+ * Compress a buffer into independently decodable lzma blocks
+ * (CBFS_COMPRESS_LZMA_BLOCKED). The result is a 16 byte header
+ * (magic, block size, block count, uncompressed size), an offset table with
+ * one entry per block plus an end marker, and the lzma streams of the
+ * blocks. All fields are little endian.
+ * Don't copy the result back if it is too large.
+ * @param in a pointer to the buffer
+ * @param in_len the length in bytes
+ * @param out a pointer to a buffer of at least size in_len
+ * @param out_len a pointer to the compressed length of in
+ */
+
+void do_lzma_blocked_compress(char *in, int in_len, char *out, int *out_len) {
+	const unsigned block_size = LZMA_BlockSize;
+	const unsigned num_blocks = (in_len + block_size - 1) / block_size;
+	std::vector<unsigned char> result(16 + 4 * (num_blocks + 1));
+	const unsigned char *data = (const unsigned char *)in;
+
+	put_32(&result[0], 0x4b425a4c); /* "LZBK" */
+	put_32(&result[4], block_size);
+	put_32(&result[8], num_blocks);
+	put_32(&result[12], in_len);
+	for (unsigned i = 0; i < num_blocks; i++) {
+		size_t len = std::min<size_t>(block_size, in_len - i * block_size);
+		std::vector<unsigned char> block = DoLZMACompress(LZMA_HeavyLevel,
+			data + i * block_size, len);
+		put_32(&result[16 + 4 * i], result.size());
+		result.insert(result.end(), block.begin(), block.end());
+	}
+	put_32(&result[16 + 4 * num_blocks], result.size());
+
+	*out_len = result.size();
+	if (*out_len < in_len)
+		std::memcpy(out, &result[0], *out_len);
+}
+
+/**
+ * Select how hard do_lzma_compress searches for the best parameters
+ * @param heavy_level 0 = default settings, 1 = auto search, 2 = full search
+ * @param threads number of worker threads for the full search
+ */
+
+void do_lzma_set_search(int heavy_level, int threads) {
+	LZMA_HeavyLevel = heavy_level;
+	LZMA_NumThreads = threads > 0 ? threads : 1;
+}
+
 void do_lzma_uncompress(char *dst, int dst_len, char *src, int src_len) {
 	std::vector<unsigned char> result;
 	result = LZMADeCompress(std::vector<unsigned char>(src, src + src_len));
@@ -5,6 +5,11 @@
 
 extern int LZMA_verbose;
 
+extern unsigned LZMA_NumThreads;
+extern int LZMA_HeavyLevel;
+extern unsigned LZMA_MaxLcLp;
+extern unsigned LZMA_BlockSize;
+
 extern unsigned LZMA_NumFastBytes;
 extern unsigned LZMA_AlgorithmNo;
 extern unsigned LZMA_PosStateBits;
@@ -66,6 +71,8 @@ static inline const std::vector<unsigned char> LZMACompress(
 /* LZMA-compress data with every settings (5*5*9 times), taking the best.
  * It will consume a lot of time and output useful statistics,
  * so a context parameter ("why") is also given.
+ * With LZMA_NumThreads > 1 the candidates are tried in parallel; the
+ * result is identical to the serial search.
  */
 const std::vector<unsigned char> LZMACompressHeavy
     (const unsigned char* data, std::size_t length,
@@ -29,6 +29,7 @@
 #include <sys/mman.h>
 #include <libgen.h>
 #include <assert.h>
+#include <elf.h>
 
 #define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
 #define MAP_BYTES (1024*1024)
@@ -41,6 +42,9 @@ typedef uint64_t u64;
 
 #include "cbmem.h"
 #include "timestamp.h"
+#include "device/profile.h"
+#include "trace.h"
+#include "console/printk_dict.h"
 
 #define CBMEM_VERSION "1.0"
 
@@ -292,8 +296,9 @@ static void dump_timestamps(void)
 	printf("%d entries total:\n\n", tst_p->num_entries);
 	for (i = 0; i < tst_p->num_entries; i++) {
 		const struct timestamp_entry *tse_p = tst_p->entries + i;
+		u32 id = tse_p->entry_id & ((1 << TS_BUS_SHIFT) - 1);
 
-		printf("%4d:", tse_p->entry_id);
+		printf("%4d:", id);
 		print_norm(tse_p->entry_stamp / cpu_freq_MHz, 0);
 		if (i) {
 			printf(" (");
@@ -302,18 +307,238 @@ static void dump_timestamps(void)
 				   cpu_freq_MHz, 0);
 			printf(")");
 		}
+		if (id == TS_PCI_SCAN_BUS_START || id == TS_PCI_SCAN_BUS_END)
+			printf(" bus %02x", tse_p->entry_id >> TS_BUS_SHIFT);
 		printf("\n");
 	}
 
 	unmap_memory();
 }
 
+/*
+ * Read a 32-bit ELF file, such as coreboot_ram.debug, into memory. Returns
+ * NULL after printing why if that didn't work.
+ */
+static Elf32_Ehdr *read_elf(const char *filename)
+{
+	FILE *f;
+	long len;
+	char *elf;
+	Elf32_Ehdr *ehdr;
+
+	f = fopen(filename, "rb");
+	if (!f) {
+		fprintf(stderr, "Could not open %s: %s\n", filename,
+			strerror(errno));
+		return NULL;
+	}
+	fseek(f, 0, SEEK_END);
+	len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+	elf = malloc(len);
+	if (!elf || fread(elf, len, 1, f) != 1) {
+		fprintf(stderr, "Could not read %s.\n", filename);
+		fclose(f);
+		free(elf);
+		return NULL;
+	}
+	fclose(f);
+
+	ehdr = (Elf32_Ehdr *)elf;
+	if (len < sizeof(*ehdr) || memcmp(ehdr->e_ident, ELFMAG, SELFMAG) ||
+	    ehdr->e_ident[EI_CLASS] != ELFCLASS32 ||
+	    ehdr->e_shoff + ehdr->e_shnum * sizeof(Elf32_Shdr) > len ||
+	    ehdr->e_shstrndx >= ehdr->e_shnum) {
+		fprintf(stderr, "%s is not a 32-bit ELF file.\n", filename);
+		free(elf);
+		return NULL;
+	}
+	return ehdr;
+}
+
+/* The .printk_fmt section of the ramstage, see console/printk_dict.h. */
+static const char *dict_fmt;
+static u32 dict_fmt_addr, dict_fmt_size;
+
+static int load_dictionary(const char *filename)
+{
+	Elf32_Ehdr *ehdr = read_elf(filename);
+	Elf32_Shdr *shdr;
+	const char *names;
+	int i;
+
+	if (!ehdr)
+		return 0;
+	shdr = (Elf32_Shdr *)((char *)ehdr + ehdr->e_shoff);
+	names = (char *)ehdr + shdr[ehdr->e_shstrndx].sh_offset;
+
+	for (i = 0; i < ehdr->e_shnum; i++) {
+		if (strcmp(names + shdr[i].sh_name, ".printk_fmt"))
+			continue;
+		dict_fmt = (char *)ehdr + shdr[i].sh_offset;
+		dict_fmt_addr = shdr[i].sh_addr;
+		dict_fmt_size = shdr[i].sh_size;
+		return 1;
+	}
+	fprintf(stderr, "No printk dictionary in %s.\n", filename);
+	return 0;
+}
+
+struct dict_arg {
+	int type;
+	u64 value;
+	const char *string;
+};
+
+/*
+ * Format one dictionary record the way coreboot's vtxprintf() would have.
+ * Every conversion is handed to the host printf() with the argument widened
+ * to 64 bits.
+ */
+static void print_dict_message(const char *fmt, const struct dict_arg *args,
+			       int nargs)
+{
+	char spec[64];
+	int a = 0, n;
+	u64 v;
+
+	while (*fmt) {
+		const char *start = fmt;
+		char qualifier = 0;
+
+		if (*fmt != '%') {
+			putchar(*fmt++);
+			continue;
+		}
+
+		/* Copy the flags, width and precision, resolving '*'. */
+		n = 0;
+		spec[n++] = *fmt++;
+		while (*fmt && strchr("-+ #0123456789.*", *fmt) &&
+		       n < sizeof(spec) - 16) {
+			if (*fmt == '*')
+				n += sprintf(spec + n, "%d", a < nargs ?
+					     (int)args[a++].value : 0);
+			else
+				spec[n++] = *fmt;
+			fmt++;
+		}
+		spec[n] = 0;
+
+		if (*fmt == 'h' || *fmt == 'l' || *fmt == 'L' || *fmt == 'z') {
+			qualifier = *fmt++;
+			if (*fmt == 'l') {
+				qualifier = 'L';
+				fmt++;
+			}
+		}
+
+		if (!*fmt)
+			break;
+		if (*fmt == '%') {
+			putchar('%');
+			fmt++;
+			continue;
+		}
+		if (!strchr("cspnoXxdiu", *fmt) || a >= nargs) {
+			printf("%.*s", (int)(fmt - start + 1), start);
+			fmt++;
+			continue;
+		}
+
+		v = args[a].value;
+		switch (*fmt) {
+		case 's':
+			strcat(spec, "s");
+			printf(spec, args[a].string ? args[a].string : "<NULL>");
+			break;
+		case 'c':
+			strcat(spec, "c");
+			printf(spec, (int)(unsigned char)v);
+			break;
+		case 'p':
+			printf("%08x", (u32)v);
+			break;
+		case 'n':
+			break;
+		default:
+			if (qualifier == 'h')
+				v = (*fmt == 'd' || *fmt == 'i') ?
+					(u64)(int16_t)v : (u16)v;
+			else if (qualifier != 'L')
+				v = (*fmt == 'd' || *fmt == 'i') ?
+					(u64)(int32_t)v : (u32)v;
+			spec[n++] = 'l';
+			spec[n++] = 'l';
+			spec[n++] = *fmt;
+			spec[n] = 0;
+			printf(spec, (unsigned long long)v);
+			break;
+		}
+		a++;
+		fmt++;
+	}
+}
+
+static u32 dict_u32(const char *p)
+{
+	const uint8_t *b = (const uint8_t *)p;
+
+	return b[0] | b[1] << 8 | b[2] << 16 | (u32)b[3] << 24;
+}
+
+/*
+ * Print the dictionary record at the start of buf and return its length.
+ */
+static u32 print_dict_record(const char *buf, u32 len)
+{
+	struct dict_arg args[PRINTK_DICT_MAX_ARGS];
+	u32 pos, fmt, types;
+	int nargs = 0;
+
+	if (len < 9)
+		return len;
+	fmt = dict_u32(buf + 1);
+	types = dict_u32(buf + 5);
+	pos = 9;
+
+	for (; types && nargs < PRINTK_DICT_MAX_ARGS; types >>= 2, nargs++) {
+		struct dict_arg *arg = &args[nargs];
+
+		arg->type = types & 3;
+		arg->string = NULL;
+		if (pos + (arg->type == PRINTK_ARG_QUAD ? 8 : 4) > len)
+			return len;
+		arg->value = dict_u32(buf + pos);
+		pos += 4;
+		if (arg->type == PRINTK_ARG_QUAD) {
+			arg->value |= (u64)dict_u32(buf + pos) << 32;
+			pos += 4;
+		} else if (arg->type == PRINTK_ARG_STRING) {
+			if (arg->value)
+				arg->string = buf + pos;
+			while (pos < len && buf[pos])
+				pos++;
+			if (pos++ >= len)
+				return len;
+		}
+	}
+
+	if (dict_fmt && fmt >= dict_fmt_addr &&
+	    fmt - dict_fmt_addr < dict_fmt_size)
+		print_dict_message(dict_fmt + fmt - dict_fmt_addr, args,
+				   nargs);
+	else
+		printf("<printk 0x%x>\n", fmt);
+	return pos;
+}
+
 /* dump the cbmem console */
 static void dump_console(void)
 {
 	void *console_p;
 	char *console_c;
-	uint32_t size;
+	uint32_t size, cursor, i;
 
 	if (console.tag != LB_TAG_CBMEM_CONSOLE) {
 		fprintf(stderr, "No console found in coreboot table.\n");
@@ -328,6 +553,9 @@ static void dump_console(void)
 	 * Hence we have to add 8 to get to the actual console string.
 	 */
 	size = *(uint32_t *)console_p;
+	cursor = *(uint32_t *)(console_p + 4);
+	if (cursor < size)
+		size = cursor;
 	console_c = malloc(size + 1);
 	if (!console_c) {
 		fprintf(stderr, "Not enough memory for console.\n");
@@ -337,7 +565,13 @@ static void dump_console(void)
 	memcpy(console_c, console_p + 8, size);
 	console_c[size] = 0;
 
-	printf("%s", console_c);
+	/* Ramstage messages may be dictionary records, see printk_dict.h. */
+	for (i = 0; i < size; ) {
+		if (console_c[i] == PRINTK_DICT_MARKER)
+			i += print_dict_record(console_c + i, size - i);
+		else
+			putchar(console_c[i++]);
+	}
 
 	free(console_c);
 
@@ -345,7 +579,7 @@ static void dump_console(void)
 }
 
 #define CBMEM_MAGIC 0x434f5245
-#define MAX_CBMEM_ENTRIES 16
+#define MAX_CBMEM_ENTRIES 20
 
 struct cbmem_entry {
 	uint32_t magic;
@@ -392,6 +626,9 @@ static void dump_cbmem_toc(void)
 		case CBMEM_ID_CONSOLE:   printf("CONSOLE     "); break;
 		case CBMEM_ID_ELOG:      printf("ELOG        "); break;
 		case CBMEM_ID_COVERAGE:  printf("COVERAGE    "); break;
+		case CBMEM_ID_CBFS_CACHE: printf("CBFS CACHE  "); break;
+		case CBMEM_ID_DEVICE_PROFILE: printf("DEV PROFILE "); break;
+		case CBMEM_ID_TRACE:     printf("TRACE       "); break;
 		default:                 printf("%08x    ",
 						entries[i].id); break;
 		}
@@ -505,6 +742,520 @@ static void dump_coverage(void)
 	unmap_memory();
 }
 
+#define CBFS_CACHE_MAGIC 0x43424643
+#define CBFS_CACHE_COMPLETE (1 << 0)
+#define CBFS_CACHE_OVERFLOW (1 << 1)
+struct cbfs_cache_entry {
+	uint32_t offset;
+	uint32_t data_offset;
+	uint32_t len;
+	uint32_t type;
+	char name[48];
+} __attribute__((packed));
+
+struct cbfs_cache {
+	uint32_t magic;
+	uint32_t flags;
+	uint32_t count;
+	uint32_t next_offset;
+	uint32_t lookups;
+	uint32_t hits;
+	uint32_t misses;
+	uint32_t media_bytes;
+	struct cbfs_cache_entry entries[0];
+} __attribute__((packed));
+
+static void dump_cbfs_cache(void)
+{
+	int i, found = 0;
+	uint32_t j;
+	uint64_t start;
+	struct cbmem_entry *entries;
+	struct cbfs_cache *cache;
+
+	if (cbmem.type != LB_MEM_TABLE) {
+		fprintf(stderr, "No coreboot table area found!\n");
+		return;
+	}
+
+	start = unpack_lb64(cbmem.start);
+
+	entries = (struct cbmem_entry *)map_memory(start);
+
+	for (i=0; i<MAX_CBMEM_ENTRIES; i++) {
+		if (entries[i].magic != CBMEM_MAGIC)
+			break;
+		if (entries[i].id == CBMEM_ID_CBFS_CACHE) {
+			found = 1;
+			break;
+		}
+	}
+
+	if (!found) {
+		unmap_memory();
+		fprintf(stderr, "No CBFS cache found in CBMEM area.\n");
+		return;
+	}
+
+	start = entries[i].base;
+	unmap_memory();
+	cache = (struct cbfs_cache *)map_memory(start);
+
+	if (cache->magic != CBFS_CACHE_MAGIC) {
+		fprintf(stderr, "CBFS cache is corrupted.\n");
+		unmap_memory();
+		return;
+	}
+
+	printf("CBFS cache: %d files%s%s\n", cache->count,
+	       cache->flags & CBFS_CACHE_COMPLETE ? ", complete" : "",
+	       cache->flags & CBFS_CACHE_OVERFLOW ? ", overflowed" : "");
+	printf("  lookups:     %d\n", cache->lookups);
+	printf("  cache hits:  %d\n", cache->hits);
+	printf("  misses:      %d\n", cache->misses);
+	printf("  media bytes: %d\n", cache->media_bytes);
+	for (j = 0; j < cache->count; j++)
+		printf("  0x%08x %-48s type 0x%x, %d bytes\n",
+		       cache->entries[j].offset, cache->entries[j].name,
+		       cache->entries[j].type, cache->entries[j].len);
+	unmap_memory();
+}
+
+static const char *device_profile_op_name(uint8_t op)
+{
+	switch (op) {
+	case DEVPROF_SCAN_BUS:		return "scan_bus";
+	case DEVPROF_READ_RESOURCES:	return "read_resources";
+	case DEVPROF_ENABLE_RESOURCES:	return "enable_resources";
+	case DEVPROF_INIT:		return "init";
+	}
+	return "unknown";
+}
+
+/* Map the CBMEM entry with the given id, or return NULL if there is none. */
+static void *map_cbmem_entry(u32 id, const char *what)
+{
+	int i, found = 0;
+	uint64_t start;
+	struct cbmem_entry *entries;
+
+	if (cbmem.type != LB_MEM_TABLE) {
+		fprintf(stderr, "No coreboot table area found!\n");
+		return NULL;
+	}
+
+	start = unpack_lb64(cbmem.start);
+
+	entries = (struct cbmem_entry *)map_memory(start);
+
+	for (i=0; i<MAX_CBMEM_ENTRIES; i++) {
+		if (entries[i].magic != CBMEM_MAGIC)
+			break;
+		if (entries[i].id == id) {
+			found = 1;
+			break;
+		}
+	}
+
+	if (!found) {
+		unmap_memory();
+		fprintf(stderr, "No %s found in CBMEM area.\n", what);
+		return NULL;
+	}
+
+	start = entries[i].base;
+	unmap_memory();
+	return map_memory(start);
+}
+
+/*
+ * Time spent in entry i itself, that is its duration minus the duration of
+ * the calls it made (the following entries one level deeper).
+ */
+static u64 device_profile_self(const struct device_profile_table *prof,
+			       u32 i)
+{
+	const struct device_profile_entry *e = prof->entries;
+	u64 self = e[i].end - e[i].start;
+	u32 j;
+
+	for (j = i + 1; j < prof->num_entries; j++) {
+		if (e[j].depth <= e[i].depth)
+			break;
+		if (e[j].depth == e[i].depth + 1 && e[j].end)
+			self -= e[j].end - e[j].start;
+	}
+	return self;
+}
+
+struct device_profile_total {
+	const char *path;
+	u64 self;
+	u64 op[DEVPROF_INIT + 1];
+};
+
+static int device_profile_cmp(const void *a, const void *b)
+{
+	const struct device_profile_total *x = a, *y = b;
+
+	if (x->self == y->self)
+		return 0;
+	return x->self < y->self ? 1 : -1;
+}
+
+#define DEVICE_PROFILE_TOP 10
+
+/* Print the devices the ramstage device operations spent most time on. */
+static void dump_device_profile(void)
+{
+	u32 i, j, n = 0;
+	u64 cpu_freq_MHz = get_cpu_freq_KHz() / 1000;
+	struct device_profile_table *prof;
+	struct device_profile_total *totals;
+
+	prof = map_cbmem_entry(CBMEM_ID_DEVICE_PROFILE, "device profile");
+	if (!prof)
+		return;
+
+	totals = calloc(prof->num_entries + 1, sizeof(*totals));
+	if (!totals) {
+		fprintf(stderr, "Out of memory.\n");
+		unmap_memory();
+		return;
+	}
+
+	for (i = 0; i < prof->num_entries; i++) {
+		const struct device_profile_entry *e = prof->entries + i;
+		u64 self;
+
+		if (!e->end || e->op > DEVPROF_INIT)
+			continue;
+		self = device_profile_self(prof, i);
+
+		for (j = 0; j < n; j++)
+			if (!strncmp(totals[j].path, e->path,
+				     DEVPROF_PATH_LEN))
+				break;
+		if (j == n)
+			totals[n++].path = e->path;
+		totals[j].self += self;
+		totals[j].op[e->op] += self;
+	}
+
+	qsort(totals, n, sizeof(*totals), device_profile_cmp);
+
+	printf("%d device operations recorded", prof->num_entries);
+	if (prof->dropped)
+		printf(", %d dropped", prof->dropped);
+	printf(".\n\nSlowest devices (self time in us):\n\n");
+	printf("  %-28s %10s %10s %10s %10s %10s\n", "device", "total",
+	       "scan", "read", "enable", "init");
+	for (j = 0; j < n && j < DEVICE_PROFILE_TOP; j++) {
+		printf("  %-28.28s %10llu %10llu %10llu %10llu %10llu\n",
+		       totals[j].path,
+		       (unsigned long long)(totals[j].self / cpu_freq_MHz),
+		       (unsigned long long)(totals[j].op[DEVPROF_SCAN_BUS] /
+					    cpu_freq_MHz),
+		       (unsigned long long)(totals[j].op[DEVPROF_READ_RESOURCES] /
+					    cpu_freq_MHz),
+		       (unsigned long long)(totals[j].op[DEVPROF_ENABLE_RESOURCES] /
+					    cpu_freq_MHz),
+		       (unsigned long long)(totals[j].op[DEVPROF_INIT] /
+					    cpu_freq_MHz));
+	}
+
+	free(totals);
+	unmap_memory();
+}
+
+/*
+ * Print the device profile as folded stacks, one line per call, in the
+ * format flamegraph.pl reads: "frame;frame;frame self_us".
+ */
+static void dump_device_flame(void)
+{
+	u32 i, stack[256];
+	int d;
+	u64 cpu_freq_MHz = get_cpu_freq_KHz() / 1000;
+	struct device_profile_table *prof;
+
+	prof = map_cbmem_entry(CBMEM_ID_DEVICE_PROFILE, "device profile");
+	if (!prof)
+		return;
+
+	for (i = 0; i < prof->num_entries; i++) {
+		const struct device_profile_entry *e = prof->entries + i;
+
+		stack[e->depth] = i;
+		if (!e->end)
+			continue;
+
+		for (d = 0; d <= e->depth; d++) {
+			const struct device_profile_entry *f =
+				prof->entries + stack[d];
+
+			printf("%s%s(%.*s)", d ? ";" : "",
+			       device_profile_op_name(f->op),
+			       DEVPROF_PATH_LEN, f->path);
+		}
+		printf(" %llu\n", (unsigned long long)
+		       (device_profile_self(prof, i) / cpu_freq_MHz));
+	}
+
+	unmap_memory();
+}
+
+/* Functions of the ramstage ELF, sorted by address. */
+struct trace_symbol {
+	u32 addr;
+	u32 size;
+	const char *name;
+};
+
+static struct trace_symbol *trace_syms;
+static int trace_num_syms;
+
+static int trace_symbol_cmp(const void *a, const void *b)
+{
+	const struct trace_symbol *x = a, *y = b;
+
+	if (x->addr == y->addr)
+		return 0;
+	return x->addr < y->addr ? -1 : 1;
+}
+
+/* Read the function symbols of a 32-bit ELF file. */
+static int load_trace_symbols(const char *filename)
+{
+	char *elf;
+	Elf32_Ehdr *ehdr;
+	Elf32_Shdr *shdr;
+	int i;
+
+	/* The symbol names point into the file, so it is never freed. */
+	ehdr = read_elf(filename);
+	if (!ehdr)
+		return 0;
+	elf = (char *)ehdr;
+	shdr = (Elf32_Shdr *)(elf + ehdr->e_shoff);
+
+	for (i = 0; i < ehdr->e_shnum; i++) {
+		Elf32_Sym *sym;
+		const char *strtab;
+		int j, n;
+
+		if (shdr[i].sh_type != SHT_SYMTAB ||
+		    shdr[i].sh_link >= ehdr->e_shnum)
+			continue;
+		sym = (Elf32_Sym *)(elf + shdr[i].sh_offset);
+		strtab = elf + shdr[shdr[i].sh_link].sh_offset;
+		n = shdr[i].sh_size / sizeof(*sym);
+
+		trace_syms = realloc(trace_syms, (trace_num_syms + n) *
+				     sizeof(*trace_syms));
+		if (!trace_syms) {
+			fprintf(stderr, "Out of memory.\n");
+			exit(1);
+		}
+		for (j = 0; j < n; j++) {
+			if (ELF32_ST_TYPE(sym[j].st_info) != STT_FUNC)
+				continue;
+			trace_syms[trace_num_syms].addr = sym[j].st_value;
+			trace_syms[trace_num_syms].size = sym[j].st_size;
+			trace_syms[trace_num_syms].name =
+				strtab + sym[j].st_name;
+			trace_num_syms++;
+		}
+	}
+
+	qsort(trace_syms, trace_num_syms, sizeof(*trace_syms),
+	      trace_symbol_cmp);
+	debug("%d functions in %s.\n", trace_num_syms, filename);
+	return 1;
+}
+
+static const char *trace_symbol_name(u32 addr)
+{
+	int lo = 0, hi = trace_num_syms;
+
+	while (lo < hi) {
+		int mid = (lo + hi) / 2;
+
+		if (trace_syms[mid].addr <= addr)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	if (lo && addr < trace_syms[lo - 1].addr +
+	    (trace_syms[lo - 1].size ? trace_syms[lo - 1].size : 1))
+		return trace_syms[lo - 1].name;
+	return NULL;
+}
+
+/*
+ * One node of the call tree: all calls of func made from the same chain
+ * of callers.
+ */
+struct trace_node {
+	u32 func;
+	int parent, child, sibling, last_child;
+	u32 calls;
+	u64 inclusive;
+};
+
+static struct trace_node *trace_nodes;
+static int trace_num_nodes;
+
+static int trace_node_child(int parent, u32 func)
+{
+	struct trace_node *n;
+	int i;
+
+	for (i = parent >= 0 ? trace_nodes[parent].child : -1; i >= 0;
+	     i = trace_nodes[i].sibling)
+		if (trace_nodes[i].func == func)
+			return i;
+
+	trace_nodes = realloc(trace_nodes, (trace_num_nodes + 1) *
+			      sizeof(*trace_nodes));
+	if (!trace_nodes) {
+		fprintf(stderr, "Out of memory.\n");
+		exit(1);
+	}
+	i = trace_num_nodes++;
+	n = &trace_nodes[i];
+	memset(n, 0, sizeof(*n));
+	n->func = func;
+	n->parent = parent;
+	n->child = n->sibling = n->last_child = -1;
+
+	if (parent >= 0) {
+		if (trace_nodes[parent].last_child >= 0)
+			trace_nodes[trace_nodes[parent].last_child].sibling = i;
+		else
+			trace_nodes[parent].child = i;
+		trace_nodes[parent].last_child = i;
+	}
+	return i;
+}
+
+static void print_trace_node(int i, int depth, u64 cpu_freq_MHz)
+{
+	const struct trace_node *n = &trace_nodes[i];
+	const char *name = trace_symbol_name(n->func);
+	u64 exclusive = n->inclusive;
+	int c;
+
+	for (c = n->child; c >= 0; c = trace_nodes[c].sibling)
+		exclusive -= trace_nodes[c].inclusive;
+
+	printf("%12.1f %12.1f %8d  %*s", (double)n->inclusive / cpu_freq_MHz,
+	       (double)exclusive / cpu_freq_MHz, n->calls, depth * 2, "");
+	if (name)
+		printf("%s\n", name);
+	else
+		printf("0x%08x\n", n->func);
+
+	for (c = n->child; c >= 0; c = trace_nodes[c].sibling)
+		print_trace_node(c, depth + 1, cpu_freq_MHz);
+}
+
+#define TRACE_MAX_DEPTH 1024
+
+/* Print the function trace as a call tree, times in microseconds. */
+static void dump_trace(const char *elf)
+{
+	struct {
+		int node;
+		u64 start;
+	} stack[TRACE_MAX_DEPTH];
+	int sp = 0, c;
+	u32 i, n, first;
+	u64 tsc = 0, cpu_freq_MHz = get_cpu_freq_KHz() / 1000;
+	struct trace_buffer *buf;
+
+	if (!load_trace_symbols(elf))
+		fprintf(stderr, "Printing addresses only.\n");
+
+	buf = map_cbmem_entry(CBMEM_ID_TRACE, "function trace");
+	if (!buf)
+		return;
+
+	if (buf->magic != TRACE_MAGIC || !buf->max_entries) {
+		fprintf(stderr, "Function trace is corrupted.\n");
+		unmap_memory();
+		return;
+	}
+
+	n = buf->written;
+	first = 0;
+	if (n > buf->max_entries) {
+		first = n % buf->max_entries;
+		n = buf->max_entries;
+	}
+	if (sizeof(*buf) + buf->max_entries * sizeof(buf->entries[0]) >
+	    MAP_BYTES - getpagesize()) {
+		fprintf(stderr, "Function trace is too large.\n");
+		unmap_memory();
+		return;
+	}
+
+	/* Node 0 is the root; its children are the outermost calls. */
+	trace_num_nodes = 0;
+	trace_node_child(-1, 0);
+
+	for (i = 0; i < n; i++) {
+		const struct trace_entry *e =
+			&buf->entries[(first + i) % buf->max_entries];
+		int top = sp ? stack[sp - 1].node : 0;
+
+		tsc = e->tsc & ~TRACE_EXIT;
+
+		if (!(e->tsc & TRACE_EXIT)) {
+			if (sp == TRACE_MAX_DEPTH) {
+				fprintf(stderr, "Call stack too deep.\n");
+				break;
+			}
+			stack[sp].node = trace_node_child(top, e->func);
+			stack[sp].start = tsc;
+			trace_nodes[stack[sp].node].calls++;
+			sp++;
+			continue;
+		}
+
+		/*
+		 * Returns whose call was overwritten in the ring, or was not
+		 * recorded, are skipped.
+		 */
+		for (c = sp - 1; c >= 0; c--)
+			if (trace_nodes[stack[c].node].func == e->func)
+				break;
+		if (c < 0)
+			continue;
+		while (sp > c) {
+			sp--;
+			trace_nodes[stack[sp].node].inclusive +=
+				tsc - stack[sp].start;
+		}
+	}
+
+	/* Calls that had not returned yet count up to the last record. */
+	while (sp > 0) {
+		sp--;
+		trace_nodes[stack[sp].node].inclusive += tsc - stack[sp].start;
+	}
+
+	printf("%d of %d function trace records:\n\n", n, buf->written);
+	printf("%12s %12s %8s  %s\n", "inclusive", "exclusive", "calls",
+	       "function");
+	for (c = trace_nodes[0].child; c >= 0; c = trace_nodes[c].sibling)
+		print_trace_node(c, 0, cpu_freq_MHz);
+
+	free(trace_nodes);
+	trace_nodes = NULL;
+	unmap_memory();
+}
+
 static void print_version(void)
 {
 	printf("cbmem v%s -- ", CBMEM_VERSION);
@@ -523,12 +1274,17 @@ static void print_version(void)
 
 static void print_usage(const char *name)
 {
-	printf("usage: %s [-cCltVvh?]\n", name);
+	printf("usage: %s [-cCfltpPVvh?] [-d <elf>] [-T <elf>]\n", name);
 	printf("\n"
 	     "   -c | --console:                   print cbmem console\n"
+	     "   -d | --dictionary <elf>:          expand binary console messages\n"
 	     "   -C | --coverage:                  dump coverage information\n"
+	     "   -f | --cbfs-cache:                print CBFS lookup cache\n"
 	     "   -l | --list:                      print cbmem table of contents\n"
 	     "   -t | --timestamps:                print timestamp information\n"
+	     "   -p | --profile:                   print slowest devices\n"
+	     "   -P | --flame:                     print device profile as folded stacks\n"
+	     "   -T | --trace <elf>:               print function trace as a call tree\n"
 	     "   -V | --verbose:                   verbose (debugging) output\n"
 	     "   -v | --version:                   print the version\n"
 	     "   -h | --help:                      print this help\n"
@@ -544,31 +1300,50 @@ int main(int argc, char** argv)
 	int print_defaults = 1;
 	int print_console = 0;
 	int print_coverage = 0;
+	int print_cbfs_cache = 0;
 	int print_list = 0;
 	int print_timestamps = 0;
+	int print_profile = 0;
+	int print_flame = 0;
+	const char *trace_elf = NULL;
 
 	int opt, option_index = 0;
 	static struct option long_options[] = {
 		{"console", 0, 0, 'c'},
+		{"dictionary", 1, 0, 'd'},
 		{"coverage", 0, 0, 'C'},
+		{"cbfs-cache", 0, 0, 'f'},
 		{"list", 0, 0, 'l'},
 		{"timestamps", 0, 0, 't'},
+		{"profile", 0, 0, 'p'},
+		{"flame", 0, 0, 'P'},
+		{"trace", 1, 0, 'T'},
 		{"verbose", 0, 0, 'V'},
 		{"version", 0, 0, 'v'},
 		{"help", 0, 0, 'h'},
 		{0, 0, 0, 0}
 	};
-	while ((opt = getopt_long(argc, argv, "cCltVvh?",
+	while ((opt = getopt_long(argc, argv, "cd:CfltpPT:Vvh?",
 				  long_options, &option_index)) != EOF) {
 		switch (opt) {
 		case 'c':
 			print_console = 1;
 			print_defaults = 0;
 			break;
+		case 'd':
+			if (!load_dictionary(optarg))
+				exit(1);
+			print_console = 1;
+			print_defaults = 0;
+			break;
 		case 'C':
 			print_coverage = 1;
 			print_defaults = 0;
 			break;
+		case 'f':
+			print_cbfs_cache = 1;
+			print_defaults = 0;
+			break;
 		case 'l':
 			print_list = 1;
 			print_defaults = 0;
@@ -577,6 +1352,18 @@ int main(int argc, char** argv)
 			print_timestamps = 1;
 			print_defaults = 0;
 			break;
+		case 'p':
+			print_profile = 1;
+			print_defaults = 0;
+			break;
+		case 'P':
+			print_flame = 1;
+			print_defaults = 0;
+			break;
+		case 'T':
+			trace_elf = optarg;
+			print_defaults = 0;
+			break;
 		case 'V':
 			verbose = 1;
 			break;
@@ -612,12 +1399,24 @@ int main(int argc, char** argv)
 	if (print_coverage)
 		dump_coverage();
 
+	if (print_cbfs_cache)
+		dump_cbfs_cache();
+
 	if (print_list)
 		dump_cbmem_toc();
 
 	if (print_defaults || print_timestamps)
 		dump_timestamps();
 
+	if (print_profile)
+		dump_device_profile();
+
+	if (print_flame)
+		dump_device_flame();
+
+	if (trace_elf)
+		dump_trace(trace_elf);
+
 	close(fd);
 	return 0;
 }
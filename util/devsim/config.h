@@ -0,0 +1,34 @@
+/*
+ * Kconfig values for building the coreboot device code into devsim. This
+ * stands in for the build/config.h a real coreboot build generates.
+ */
+
+#define CONFIG_ARCH_X86 0
+#define CONFIG_PCI 1
+#define CONFIG_SMP 0
+#define CONFIG_GFXUMA 0
+#define CONFIG_CHROMEOS 0
+#define CONFIG_PC80_SYSTEM 0
+#define CONFIG_VGA_ROM_RUN 0
+#define CONFIG_PCI_ROM_RUN 0
+#define CONFIG_S3_VGA_ROM_RUN 0
+#define CONFIG_ONBOARD_VGA_IS_PRIMARY 0
+#define CONFIG_PCI_64BIT_PREF_MEM 0
+#define CONFIG_PCI_BUS_SEGN_BITS 0
+#define CONFIG_HYPERTRANSPORT_PLUGIN_SUPPORT 0
+#define CONFIG_PCIX_PLUGIN_SUPPORT 0
+#define CONFIG_PCIEXP_PLUGIN_SUPPORT 0
+#define CONFIG_AGP_PLUGIN_SUPPORT 0
+#define CONFIG_CARDBUS_PLUGIN_SUPPORT 0
+#define CONFIG_MAINBOARD_PART_NUMBER "devsim"
+#define CONFIG_MAINBOARD_VENDOR "coreboot"
+#define CONFIG_DEFAULT_CONSOLE_LOGLEVEL 8
+#define CONFIG_MAXIMUM_CONSOLE_LOGLEVEL 8
+#define CONFIG_CONSOLE_SERIAL 0
+#define CONFIG_USBDEBUG 0
+#define CONFIG_CONSOLE_NE2K 0
+#define CONFIG_CONSOLE_CBMEM 0
+#define CONFIG_EARLY_CONSOLE 0
+#define CONFIG_COLLECT_TIMESTAMPS 0
+#define CONFIG_HAVE_ACPI_RESUME 0
+#define CONFIG_GENERATE_ACPI_TABLES 0
@@ -0,0 +1,226 @@
+/*
+ * devsim - run the coreboot device tree code on a simulated machine
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * The coreboot half of devsim: the glue the device code expects from the
+ * rest of ramstage, and a static device tree with a single PCI domain whose
+ * config space is the simulated one. Everything below the domain is found
+ * by the normal PCI scan.
+ */
+
+#include <console/console.h>
+#include <device/device.h>
+#include <device/pci.h>
+#include <device/pci_ops.h>
+#include <device/resource.h>
+#include <delay.h>
+#include <arch/io.h>
+#include "devsim.h"
+
+int do_printk(int msg_level, const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	sim_vprintk(msg_level, fmt, args);
+	va_end(args);
+	return 0;
+}
+
+void die(const char *msg)
+{
+	sim_die(msg);
+}
+
+void udelay(unsigned usecs)
+{
+	sim_udelay(usecs);
+}
+
+void mdelay(unsigned msecs)
+{
+	sim_udelay(msecs * 1000);
+}
+
+void delay(unsigned secs)
+{
+	sim_udelay(secs * 1000000);
+}
+
+void post_code(u8 value)
+{
+	outb(value, 0x80);
+}
+
+/* No drivers are linked in, every device gets the default PCI ops. */
+struct pci_driver pci_drivers[1];
+__asm__(".globl epci_drivers\n.set epci_drivers, pci_drivers\n");
+
+static u8 sim_read8(struct bus *pbus, int bus, int devfn, int where)
+{
+	return sim_pci_read(bus, devfn, where, 1);
+}
+
+static u16 sim_read16(struct bus *pbus, int bus, int devfn, int where)
+{
+	return sim_pci_read(bus, devfn, where, 2);
+}
+
+static u32 sim_read32(struct bus *pbus, int bus, int devfn, int where)
+{
+	return sim_pci_read(bus, devfn, where, 4);
+}
+
+static void sim_write8(struct bus *pbus, int bus, int devfn, int where,
+		       u8 val)
+{
+	sim_pci_write(bus, devfn, where, 1, val);
+}
+
+static void sim_write16(struct bus *pbus, int bus, int devfn, int where,
+			u16 val)
+{
+	sim_pci_write(bus, devfn, where, 2, val);
+}
+
+static void sim_write32(struct bus *pbus, int bus, int devfn, int where,
+			u32 val)
+{
+	sim_pci_write(bus, devfn, where, 4, val);
+}
+
+/* Stands in for the CF8/CFC mechanism, which is what pci_config_default()
+ * hands out on x86. */
+const struct pci_bus_operations pci_cf8_conf1 = {
+	.read8 = sim_read8,
+	.read16 = sim_read16,
+	.read32 = sim_read32,
+	.write8 = sim_write8,
+	.write16 = sim_write16,
+	.write32 = sim_write32,
+};
+
+static void sim_domain_set_resources(device_t dev)
+{
+	unsigned long memk = sim_memory_kb();
+
+	/* Everything above 3GB is left for MMIO, like most chipsets do. */
+	if (memk > 3 * 1024 * 1024)
+		memk = 3 * 1024 * 1024;
+	ram_resource(dev, 3, 0, 640);
+	ram_resource(dev, 4, 1024, memk - 1024);
+
+	assign_resources(dev->link_list);
+}
+
+static struct device_operations sim_domain_ops = {
+	.read_resources   = pci_domain_read_resources,
+	.set_resources    = sim_domain_set_resources,
+	.enable_resources = NULL,
+	.init             = NULL,
+	.scan_bus         = pci_domain_scan_bus,
+	.ops_pci_bus      = &pci_cf8_conf1,
+};
+
+/* What sconfig would generate for "device domain 0 on end". */
+struct bus dev_root_links[];
+static struct device pci_domain_0;
+static struct bus pci_domain_0_links[];
+
+struct device dev_root = {
+	.ops = &default_dev_ops_root,
+	.bus = &dev_root_links[0],
+	.path = { .type = DEVICE_PATH_ROOT },
+	.enabled = 1,
+	.on_mainboard = 1,
+	.link_list = &dev_root_links[0],
+	.name = mainboard_name,
+	.next = &pci_domain_0,
+};
+
+struct bus dev_root_links[] = {
+	[0] = {
+		.link_num = 0,
+		.dev = &dev_root,
+		.children = &pci_domain_0,
+		.next = NULL,
+	},
+};
+
+static struct device pci_domain_0 = {
+	.ops = &sim_domain_ops,
+	.bus = &dev_root_links[0],
+	.path = { .type = DEVICE_PATH_DOMAIN, { .domain = { .domain = 0 } } },
+	.enabled = 1,
+	.on_mainboard = 1,
+	.link_list = &pci_domain_0_links[0],
+};
+
+static struct bus pci_domain_0_links[] = {
+	[0] = {
+		.link_num = 0,
+		.dev = &pci_domain_0,
+		.next = NULL,
+	},
+};
+
+struct device *last_dev = &pci_domain_0;
+
+/* The device part of hardwaremain(), one phase at a time. */
+void sim_boot(void)
+{
+	sim_phase("enumerate");
+	dev_initialize_chips();
+	dev_enumerate();
+
+	sim_phase("configure");
+	dev_configure();
+
+	sim_phase("enable");
+	dev_enable();
+
+	sim_phase("initialize");
+	dev_initialize();
+
+	sim_phase(NULL);
+}
+
+void sim_report(void)
+{
+	struct device *dev;
+	struct resource *res;
+	int devices = 0, resources = 0, bridges = 0;
+
+	for (dev = all_devices; dev; dev = dev->next) {
+		devices++;
+		if (dev->link_list && dev->path.type == DEVICE_PATH_PCI)
+			bridges++;
+		for (res = dev->resource_list; res; res = res->next) {
+			resources++;
+			if (!(res->flags & IORESOURCE_ASSIGNED) &&
+			    !(res->flags & IORESOURCE_FIXED) && res->size)
+				sim_printf("%s: resource %lx (%s, size %llx) "
+					   "not assigned\n", dev_path(dev),
+					   res->index, resource_type(res),
+					   res->size);
+		}
+	}
+	sim_printf("%d devices, %d PCI bridges, %d resources\n",
+		   devices, bridges, resources);
+}
@@ -0,0 +1,52 @@
+/*
+ * devsim - run the coreboot device tree code on a simulated machine
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * The simulator is built from two halves that cannot share headers: the
+ * coreboot half (coreboot.c plus the device code from src/device) is
+ * compiled against the coreboot include tree, the host half (sim.c,
+ * topology.c) against the host C library. This is everything they pass
+ * between each other, so it only uses plain C types.
+ */
+
+#ifndef DEVSIM_H
+#define DEVSIM_H
+
+#include <stdarg.h>
+
+/* Provided by the host half. */
+unsigned int sim_pci_read(int bus, int devfn, int where, int width);
+void sim_pci_write(int bus, int devfn, int where, int width, unsigned int val);
+unsigned int sim_io_read(unsigned int port, int width);
+void sim_io_write(unsigned int port, int width, unsigned int val);
+unsigned int sim_mmio_read(unsigned long addr, int width);
+void sim_mmio_write(unsigned long addr, int width, unsigned int val);
+unsigned long long sim_tsc(void);
+void sim_udelay(unsigned int usecs);
+unsigned long sim_memory_kb(void);
+void sim_vprintk(int level, const char *fmt, va_list args);
+void sim_die(const char *msg) __attribute__((noreturn));
+void sim_phase(const char *name);
+void sim_printf(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+/* Provided by the coreboot half. */
+void sim_boot(void);
+void sim_report(void);
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * Port and MMIO accessors for devsim. These shadow the ones in
+ * src/arch/x86/include/arch/io.h and hand every access to the simulator.
+ */
+
+#ifndef _ASM_IO_H
+#define _ASM_IO_H
+
+#include <stdint.h>
+#include "../../devsim.h"
+
+static inline void outb(uint8_t value, uint16_t port)
+{
+	sim_io_write(port, 1, value);
+}
+
+static inline void outw(uint16_t value, uint16_t port)
+{
+	sim_io_write(port, 2, value);
+}
+
+static inline void outl(uint32_t value, uint16_t port)
+{
+	sim_io_write(port, 4, value);
+}
+
+static inline uint8_t inb(uint16_t port)
+{
+	return sim_io_read(port, 1);
+}
+
+static inline uint16_t inw(uint16_t port)
+{
+	return sim_io_read(port, 2);
+}
+
+static inline uint32_t inl(uint16_t port)
+{
+	return sim_io_read(port, 4);
+}
+
+static inline uint8_t read8(unsigned long addr)
+{
+	return sim_mmio_read(addr, 1);
+}
+
+static inline uint16_t read16(unsigned long addr)
+{
+	return sim_mmio_read(addr, 2);
+}
+
+static inline uint32_t read32(unsigned long addr)
+{
+	return sim_mmio_read(addr, 4);
+}
+
+static inline void write8(unsigned long addr, uint8_t value)
+{
+	sim_mmio_write(addr, 1, value);
+}
+
+static inline void write16(unsigned long addr, uint16_t value)
+{
+	sim_mmio_write(addr, 2, value);
+}
+
+static inline void write32(unsigned long addr, uint32_t value)
+{
+	sim_mmio_write(addr, 4, value);
+}
+
+#endif
@@ -0,0 +1,32 @@
+/*
+ * The simulated TSC: it advances by the modelled cost of every simulated
+ * hardware access, not with host time.
+ */
+
+#ifndef CPU_X86_TSC_H
+#define CPU_X86_TSC_H
+
+#include "../../../devsim.h"
+
+struct tsc_struct {
+	unsigned lo;
+	unsigned hi;
+};
+typedef struct tsc_struct tsc_t;
+
+static inline tsc_t rdtsc(void)
+{
+	unsigned long long now = sim_tsc();
+	tsc_t res;
+
+	res.lo = now;
+	res.hi = now >> 32;
+	return res;
+}
+
+static inline unsigned long long rdtscll(void)
+{
+	return sim_tsc();
+}
+
+#endif
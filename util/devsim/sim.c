@@ -0,0 +1,323 @@
+/*
+ * devsim - run the coreboot device tree code on a simulated machine
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+
+/*
+ * The host half of devsim: config space routing over the simulated
+ * hierarchy, a simulated clock that charges every port, MMIO and config
+ * access its modelled cost, and per-phase accounting.
+ */
+
+#include <err.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "devsim.h"
+#include "sim.h"
+
+static struct sim_topology topo = { .memory_mb = 4096 };
+static int loglevel = 4;
+
+/* Modelled cost of each kind of access, in nanoseconds. */
+static unsigned long cfg_ns = 600;
+static unsigned long io_ns = 500;
+static unsigned long mmio_ns = 150;
+static unsigned long tsc_mhz = 1800;
+
+static unsigned long long sim_ns;
+
+struct counters {
+	unsigned long long host_ns;
+	unsigned long long sim_ns;
+	unsigned long cfg_reads, cfg_writes, cfg_absent;
+	unsigned long io, mmio;
+};
+
+static struct counters now;
+
+#define MAX_PHASES 8
+static struct {
+	const char *name;
+	struct counters start, end;
+} phases[MAX_PHASES];
+static int nphases;
+
+static unsigned long long host_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static struct sim_func *find_func(int busno, int devfn)
+{
+	struct sim_bus *bus = &topo.root;
+	int this = 0;
+
+	/* Route type 1 cycles down through whichever bridge decodes the bus
+	 * number, the same way real bridges forward them. */
+	while (busno != this) {
+		struct sim_func *f;
+
+		for (f = bus->funcs; f; f = f->next) {
+			int sec = f->cfg[0x19], sub = f->cfg[0x1a];
+			if (f->child && sec > this && sec <= busno &&
+			    busno <= sub)
+				break;
+		}
+		if (!f)
+			return NULL;
+		bus = f->child;
+		this = f->cfg[0x19];
+	}
+	return bus->slot[devfn & 0xff];
+}
+
+unsigned int sim_pci_read(int bus, int devfn, int where, int width)
+{
+	struct sim_func *f = find_func(bus, devfn);
+	unsigned int val = 0;
+	int i;
+
+	sim_ns += cfg_ns;
+	now.cfg_reads++;
+	if (!f) {
+		now.cfg_absent++;
+		return width == 4 ? 0xffffffff : (1U << (width * 8)) - 1;
+	}
+	where &= 0xff & ~(width - 1);
+	for (i = width - 1; i >= 0; i--)
+		val = val << 8 | f->cfg[where + i];
+	return val;
+}
+
+void sim_pci_write(int bus, int devfn, int where, int width, unsigned int val)
+{
+	struct sim_func *f = find_func(bus, devfn);
+	int i;
+
+	sim_ns += cfg_ns;
+	now.cfg_writes++;
+	if (!f)
+		return;
+	where &= 0xff & ~(width - 1);
+	for (i = 0; i < width; i++, val >>= 8) {
+		uint8_t m = f->wmask[where + i];
+		f->cfg[where + i] = (f->cfg[where + i] & ~m) | (val & m);
+	}
+}
+
+unsigned int sim_io_read(unsigned int port, int width)
+{
+	sim_ns += io_ns;
+	now.io++;
+	return width == 4 ? 0xffffffff : (1U << (width * 8)) - 1;
+}
+
+void sim_io_write(unsigned int port, int width, unsigned int val)
+{
+	sim_ns += io_ns;
+	now.io++;
+}
+
+/* Nothing is mapped behind the BARs; MMIO reads as a floating bus. */
+unsigned int sim_mmio_read(unsigned long addr, int width)
+{
+	sim_ns += mmio_ns;
+	now.mmio++;
+	return width == 4 ? 0xffffffff : (1U << (width * 8)) - 1;
+}
+
+void sim_mmio_write(unsigned long addr, int width, unsigned int val)
+{
+	sim_ns += mmio_ns;
+	now.mmio++;
+}
+
+unsigned long long sim_tsc(void)
+{
+	return sim_ns * tsc_mhz / 1000;
+}
+
+void sim_udelay(unsigned int usecs)
+{
+	sim_ns += usecs * 1000ULL;
+}
+
+unsigned long sim_memory_kb(void)
+{
+	return topo.memory_mb * 1024;
+}
+
+void sim_vprintk(int level, const char *fmt, va_list args)
+{
+	if (level <= loglevel)
+		vprintf(fmt, args);
+}
+
+void sim_printf(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	vprintf(fmt, args);
+	va_end(args);
+}
+
+void sim_die(const char *msg)
+{
+	fflush(stdout);
+	errx(1, "die: %s", msg);
+}
+
+void sim_phase(const char *name)
+{
+	now.host_ns = host_ns();
+	now.sim_ns = sim_ns;
+	if (nphases)
+		phases[nphases - 1].end = now;
+	if (!name)
+		return;
+	if (nphases == MAX_PHASES)
+		errx(1, "too many phases");
+	phases[nphases].name = name;
+	phases[nphases].start = now;
+	nphases++;
+}
+
+static void report_phases(void)
+{
+	struct counters total;
+	int i;
+
+	memset(&total, 0, sizeof(total));
+	printf("\n%-12s %10s %10s %9s %9s %9s %7s %7s\n", "phase",
+	       "host us", "sim us", "cfg rd", "cfg wr", "absent", "io",
+	       "mmio");
+	for (i = 0; i <= nphases; i++) {
+		struct counters d;
+
+		if (i < nphases) {
+			d.host_ns = phases[i].end.host_ns -
+				phases[i].start.host_ns;
+			d.sim_ns = phases[i].end.sim_ns - phases[i].start.sim_ns;
+			d.cfg_reads = phases[i].end.cfg_reads -
+				phases[i].start.cfg_reads;
+			d.cfg_writes = phases[i].end.cfg_writes -
+				phases[i].start.cfg_writes;
+			d.cfg_absent = phases[i].end.cfg_absent -
+				phases[i].start.cfg_absent;
+			d.io = phases[i].end.io - phases[i].start.io;
+			d.mmio = phases[i].end.mmio - phases[i].start.mmio;
+			total.host_ns += d.host_ns;
+			total.sim_ns += d.sim_ns;
+			total.cfg_reads += d.cfg_reads;
+			total.cfg_writes += d.cfg_writes;
+			total.cfg_absent += d.cfg_absent;
+			total.io += d.io;
+			total.mmio += d.mmio;
+		} else {
+			d = total;
+		}
+		printf("%-12s %10llu %10llu %9lu %9lu %9lu %7lu %7lu\n",
+		       i < nphases ? phases[i].name : "total",
+		       d.host_ns / 1000, d.sim_ns / 1000, d.cfg_reads,
+		       d.cfg_writes, d.cfg_absent, d.io, d.mmio);
+	}
+}
+
+static void usage(const char *prog)
+{
+	fprintf(stderr,
+		"usage: %s [options] <topology file>\n"
+		"       %s [options] -g|-w|-D <n>\n\n"
+		"  -g <n>     generate a synthetic fabric with n bridges\n"
+		"  -w <n>     generate one bus with n six-BAR functions\n"
+		"  -D <n>     generate a chain of n bridges\n"
+		"  -d         print the topology and exit\n"
+		"  -v <level> console log level (default %d)\n"
+		"  -c <ns>    cost of a config space access (default %lu)\n"
+		"  -i <ns>    cost of an I/O port access (default %lu)\n"
+		"  -m <ns>    cost of an MMIO access (default %lu)\n"
+		"  -t <MHz>   simulated TSC frequency (default %lu)\n",
+		prog, prog, loglevel, cfg_ns, io_ns, mmio_ns, tsc_mhz);
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	int opt, generate = 0, count = 0, dump = 0;
+
+	while ((opt = getopt(argc, argv, "g:w:D:dv:c:i:m:t:h")) != -1) {
+		switch (opt) {
+		case 'g':
+		case 'w':
+		case 'D':
+			generate = opt;
+			count = atoi(optarg);
+			break;
+		case 'd':
+			dump = 1;
+			break;
+		case 'v':
+			loglevel = atoi(optarg);
+			break;
+		case 'c':
+			cfg_ns = strtoul(optarg, NULL, 0);
+			break;
+		case 'i':
+			io_ns = strtoul(optarg, NULL, 0);
+			break;
+		case 'm':
+			mmio_ns = strtoul(optarg, NULL, 0);
+			break;
+		case 't':
+			tsc_mhz = strtoul(optarg, NULL, 0);
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+
+	if (generate == 'g' && optind == argc)
+		topology_fabric(&topo, count);
+	else if (generate == 'w' && optind == argc)
+		topology_wide(&topo, count);
+	else if (generate == 'D' && optind == argc)
+		topology_chain(&topo, count);
+	else if (!generate && optind == argc - 1)
+		topology_load(&topo, argv[optind]);
+	else
+		usage(argv[0]);
+
+	if (dump) {
+		topology_dump(&topo, stdout);
+		return 0;
+	}
+
+	printf("devsim: %d functions, %d bridges, %lu MB\n", topo.functions,
+	       topo.bridges, topo.memory_mb);
+	sim_boot();
+	sim_report();
+	report_phases();
+	return 0;
+}
@@ -0,0 +1,81 @@
+/*
+ * devsim - run the coreboot device tree code on a simulated machine
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/* Host half of devsim: the simulated PCI hierarchy. */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+struct sim_bus;
+
+enum {
+	BAR_NONE,
+	BAR_IO,
+	BAR_MEM,
+	BAR_MEMPF,
+	BAR_MEM64,
+	BAR_MEM64PF,
+};
+
+/* PCIe device/port types, as in the capability's flags register. */
+enum {
+	PCIE_ENDPOINT = 0,
+	PCIE_ROOTPORT = 4,
+	PCIE_UPSTREAM = 5,
+	PCIE_DOWNSTREAM = 6,
+};
+
+/* One PCI function. cfg holds what reads return; a write only changes the
+ * bits set in wmask, which is how BAR sizing and read-only registers fall
+ * out without special cases. */
+struct sim_func {
+	int devfn;
+	uint8_t cfg[256];
+	uint8_t wmask[256];
+	int bar_type[6];		/* BAR_*, as given in the topology */
+	uint64_t bar_size[6];
+	uint32_t rom_size;
+	int pcie;			/* PCIe port type + 1, 0 if none */
+	struct sim_bus *child;		/* secondary side, for bridges */
+	struct sim_func *next;
+};
+
+struct sim_bus {
+	struct sim_func *funcs;
+	struct sim_func *slot[256];	/* by devfn */
+};
+
+struct sim_topology {
+	struct sim_bus root;
+	unsigned long memory_mb;
+	int functions;
+	int bridges;
+};
+
+/* topology.c */
+int topology_load(struct sim_topology *topo, const char *path);
+void topology_fabric(struct sim_topology *topo, int bridges);
+void topology_wide(struct sim_topology *topo, int functions);
+void topology_chain(struct sim_topology *topo, int bridges);
+void topology_dump(struct sim_topology *topo, FILE *out);
+
+#endif
@@ -0,0 +1,477 @@
+/*
+ * devsim - run the coreboot device tree code on a simulated machine
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * Topology files describe the PCI hierarchy below domain 0, one function
+ * per line:
+ *
+ *   memory 4096
+ *   device 00.0 8086:0154 class 060000
+ *   device 02.0 8086:0166 class 030000 bar 0 mem64 4M bar 2 mem64pf 256M
+ *   device 1c.0 8086:1c10 class 060400 {
+ *           device 00.0 8086:0089 class 028000 bar 0 mem64 8K
+ *   }
+ *
+ * A function ending in "{" is a bridge; the functions up to the matching
+ * "}" sit on its secondary bus. BAR types are io, mem, mempf, mem64 and
+ * mem64pf; sizes take K, M and G suffixes. "rom <size>" adds an expansion
+ * ROM BAR, and "pcie <type>" a PCI Express capability for an endpoint,
+ * rootport, upstream or downstream port. Everything after a '#' is a
+ * comment.
+ */
+
+#include <ctype.h>
+#include <err.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+static const char *bar_names[] = {
+	[BAR_IO] = "io",
+	[BAR_MEM] = "mem",
+	[BAR_MEMPF] = "mempf",
+	[BAR_MEM64] = "mem64",
+	[BAR_MEM64PF] = "mem64pf",
+};
+
+static void set16(uint8_t *p, unsigned int v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+}
+
+static void set32(uint8_t *p, uint32_t v)
+{
+	set16(p, v);
+	set16(p + 2, v >> 16);
+}
+
+static struct sim_func *add_func(struct sim_topology *topo,
+				 struct sim_bus *bus, int devfn,
+				 unsigned int vendor, unsigned int device,
+				 uint32_t class, int bridge)
+{
+	struct sim_func *f, **pp;
+
+	if (bus->slot[devfn])
+		errx(1, "function %02x.%x defined twice", devfn >> 3,
+		     devfn & 7);
+	f = calloc(1, sizeof(*f));
+	if (!f)
+		err(1, "calloc");
+	f->devfn = devfn;
+	set16(f->cfg + 0x00, vendor);
+	set16(f->cfg + 0x02, device);
+	f->cfg[0x09] = class;
+	set16(f->cfg + 0x0a, class >> 8);
+	/* command, cache line size, latency timer, interrupt line */
+	set16(f->wmask + 0x04, 0x07ff);
+	f->wmask[0x0c] = f->wmask[0x0d] = f->wmask[0x3c] = 0xff;
+
+	if (bridge) {
+		f->cfg[0x0e] = 1;
+		/* bus numbers, I/O and memory windows, bridge control */
+		memset(f->wmask + 0x18, 0xff, 4);
+		f->wmask[0x1c] = f->wmask[0x1d] = 0xf0;
+		set32(f->wmask + 0x20, 0xfff0fff0);
+		set32(f->wmask + 0x24, 0xfff0fff0);
+		f->cfg[0x24] = f->cfg[0x26] = 0x01;	/* 64-bit prefetch */
+		memset(f->wmask + 0x28, 0xff, 12);
+		set16(f->wmask + 0x3e, 0x0fff);
+		f->child = calloc(1, sizeof(*f->child));
+		if (!f->child)
+			err(1, "calloc");
+		topo->bridges++;
+	}
+
+	/* Keep each bus sorted by devfn, like a scan would find them. */
+	for (pp = &bus->funcs; *pp && (*pp)->devfn < devfn; pp = &(*pp)->next)
+		;
+	f->next = *pp;
+	*pp = f;
+	bus->slot[devfn] = f;
+	topo->functions++;
+
+	/* Functions other than 0 make the device multi-function. */
+	if ((devfn & 7) && bus->slot[devfn & ~7])
+		bus->slot[devfn & ~7]->cfg[0x0e] |= 0x80;
+	if (!(devfn & 7)) {
+		int fn;
+		for (fn = 1; fn < 8; fn++)
+			if (bus->slot[devfn + fn])
+				f->cfg[0x0e] |= 0x80;
+	}
+	return f;
+}
+
+static void add_bar(struct sim_func *f, int index, int type, uint64_t size)
+{
+	int nbars = (f->cfg[0x0e] & 0x7f) ? 2 : 6;
+	int where = 0x10 + index * 4;
+	uint64_t mask;
+
+	if (index < 0 || index >= nbars ||
+	    ((type == BAR_MEM64 || type == BAR_MEM64PF) && index + 1 >= nbars))
+		errx(1, "BAR %d out of range", index);
+	if (size & (size - 1) || size < (type == BAR_IO ? 4 : 16))
+		errx(1, "BAR %d: bad size 0x%llx", index,
+		     (unsigned long long)size);
+	f->bar_type[index] = type;
+	f->bar_size[index] = size;
+
+	mask = ~(size - 1);
+	switch (type) {
+	case BAR_IO:
+		f->cfg[where] = 0x01;
+		set32(f->wmask + where, mask & ~3ULL);
+		break;
+	case BAR_MEM:
+	case BAR_MEMPF:
+		f->cfg[where] = (type == BAR_MEMPF) ? 0x08 : 0;
+		set32(f->wmask + where, mask & ~0xfULL);
+		break;
+	case BAR_MEM64:
+	case BAR_MEM64PF:
+		f->cfg[where] = 0x04 | ((type == BAR_MEM64PF) ? 0x08 : 0);
+		set32(f->wmask + where, mask & ~0xfULL);
+		set32(f->wmask + where + 4, mask >> 32);
+		break;
+	}
+}
+
+static void add_rom(struct sim_func *f, uint32_t size)
+{
+	int where = (f->cfg[0x0e] & 0x7f) ? 0x38 : 0x30;
+
+	if (size & (size - 1) || size < 2048)
+		errx(1, "bad ROM size 0x%x", size);
+	f->rom_size = size;
+	set32(f->wmask + where, ~(size - 1) | 1);
+}
+
+static const char *pcie_names[] = {
+	[PCIE_ENDPOINT] = "endpoint",
+	[PCIE_ROOTPORT] = "rootport",
+	[PCIE_UPSTREAM] = "upstream",
+	[PCIE_DOWNSTREAM] = "downstream",
+};
+
+static void add_pcie(struct sim_func *f, int type)
+{
+	f->pcie = type + 1;
+	f->cfg[0x06] |= 0x10;			/* capability list */
+	f->cfg[0x34] = 0x40;
+	f->cfg[0x40] = 0x10;			/* PCI Express, version 2 */
+	set16(f->cfg + 0x42, type << 4 | 2);
+}
+
+static uint64_t parse_size(const char *s)
+{
+	char *end;
+	uint64_t v = strtoull(s, &end, 0);
+
+	switch (toupper(*end)) {
+	case 'G':
+		v <<= 10;
+	case 'M':
+		v <<= 10;
+	case 'K':
+		v <<= 10;
+		end++;
+	}
+	if (*end)
+		errx(1, "bad size '%s'", s);
+	return v;
+}
+
+struct parser {
+	FILE *in;
+	const char *path;
+	int line;
+};
+
+static int parse_bus(struct sim_topology *topo, struct parser *p,
+		     struct sim_bus *bus, int depth)
+{
+	char buf[512], *tok[64];
+	int ntok, i;
+
+	while (fgets(buf, sizeof(buf), p->in)) {
+		char *s = strchr(buf, '#');
+
+		p->line++;
+		if (s)
+			*s = 0;
+		ntok = 0;
+		for (s = strtok(buf, " \t\r\n"); s && ntok < 64;
+		     s = strtok(NULL, " \t\r\n"))
+			tok[ntok++] = s;
+		if (!ntok)
+			continue;
+
+		if (!strcmp(tok[0], "}")) {
+			if (!depth)
+				errx(1, "%s:%d: unmatched '}'", p->path,
+				     p->line);
+			return 0;
+		} else if (!strcmp(tok[0], "memory") && ntok == 2) {
+			topo->memory_mb = strtoul(tok[1], NULL, 0);
+		} else if (!strcmp(tok[0], "device") && ntok >= 3) {
+			unsigned int dev, fn, vendor, device;
+			uint32_t class = 0;
+			int bridge = !strcmp(tok[ntok - 1], "{");
+			struct sim_func *f;
+
+			if (bridge)
+				ntok--;
+			if (sscanf(tok[1], "%x.%x", &dev, &fn) != 2 ||
+			    dev > 0x1f || fn > 7 ||
+			    sscanf(tok[2], "%x:%x", &vendor, &device) != 2)
+				errx(1, "%s:%d: bad device line", p->path,
+				     p->line);
+			for (i = 3; i + 1 < ntok; i += 2)
+				if (!strcmp(tok[i], "class"))
+					class = strtoul(tok[i + 1], NULL, 16);
+			f = add_func(topo, bus, dev << 3 | fn, vendor, device,
+				     class, bridge);
+			for (i = 3; i < ntok; i++) {
+				if (!strcmp(tok[i], "class") && i + 1 < ntok) {
+					i++;
+				} else if (!strcmp(tok[i], "rom") &&
+					   i + 1 < ntok) {
+					add_rom(f, parse_size(tok[++i]));
+				} else if (!strcmp(tok[i], "pcie") &&
+					   i + 1 < ntok) {
+					int type;
+					i++;
+					for (type = 0; type <= PCIE_DOWNSTREAM;
+					     type++)
+						if (pcie_names[type] &&
+						    !strcmp(tok[i],
+							    pcie_names[type]))
+							break;
+					if (type > PCIE_DOWNSTREAM)
+						errx(1, "%s:%d: bad PCIe type "
+						     "'%s'", p->path, p->line,
+						     tok[i]);
+					add_pcie(f, type);
+				} else if (!strcmp(tok[i], "bar") &&
+					   i + 3 < ntok) {
+					int type;
+					for (type = BAR_IO; type <= BAR_MEM64PF;
+					     type++)
+						if (!strcmp(tok[i + 2],
+							    bar_names[type]))
+							break;
+					if (type > BAR_MEM64PF)
+						errx(1, "%s:%d: bad BAR type "
+						     "'%s'", p->path, p->line,
+						     tok[i + 2]);
+					add_bar(f, strtoul(tok[i + 1], NULL, 0),
+						type, parse_size(tok[i + 3]));
+					i += 3;
+				} else {
+					errx(1, "%s:%d: unknown '%s'", p->path,
+					     p->line, tok[i]);
+				}
+			}
+			if (bridge)
+				parse_bus(topo, p, f->child, depth + 1);
+		} else {
+			errx(1, "%s:%d: syntax error", p->path, p->line);
+		}
+	}
+	if (depth)
+		errx(1, "%s: missing '}'", p->path);
+	return 0;
+}
+
+int topology_load(struct sim_topology *topo, const char *path)
+{
+	struct parser p = { .path = path };
+
+	p.in = fopen(path, "r");
+	if (!p.in)
+		err(1, "%s", path);
+	parse_bus(topo, &p, &topo->root, 0);
+	fclose(p.in);
+	return 0;
+}
+
+/*
+ * A synthetic PCIe fabric for stressing enumeration and allocation: up to
+ * eight root ports, each leading to a tree of switches with four downstream
+ * ports, until the requested number of bridges (root ports, upstream and
+ * downstream ports) exists. The remaining links end in two-function
+ * endpoints whose BARs cycle through a set of sizes and types.
+ */
+void topology_fabric(struct sim_topology *topo, int bridges)
+{
+	static const struct {
+		int type;
+		uint64_t size;
+	} bars[] = {
+		{ BAR_MEM, 16 << 10 },
+		{ BAR_MEM64, 1 << 20 },
+		{ BAR_IO, 256 },
+		{ BAR_MEM64PF, 64 << 20 },
+		{ BAR_MEM, 4 << 10 },
+		{ BAR_MEMPF, 8 << 20 },
+	};
+	struct sim_bus **links;
+	struct sim_func *f;
+	int head = 0, tail = 0, made = 0, n = 0, i;
+
+	if (bridges > 254)
+		errx(1, "at most 254 bridges fit in 256 bus numbers");
+	links = calloc(bridges + 1, sizeof(*links));
+	if (!links)
+		err(1, "calloc");
+
+	add_func(topo, &topo->root, 0, 0x8086, 0x0154, 0x060000, 0);
+	for (i = 0; i < 8 && made < bridges; i++, made++) {
+		f = add_func(topo, &topo->root, 0x1c << 3 | i, 0x8086,
+			     0x1e10 + 2 * i, 0x060400, 1);
+		add_pcie(f, PCIE_ROOTPORT);
+		links[tail++] = f->child;
+	}
+
+	while (head < tail) {
+		struct sim_bus *link = links[head++];
+
+		if (made + 5 <= bridges) {
+			/* A switch: upstream port, internal bus, four
+			 * downstream ports. */
+			f = add_func(topo, link, 0, 0x10b5, 0x8632, 0x060400, 1);
+			add_pcie(f, PCIE_UPSTREAM);
+			link = f->child;
+			made++;
+			for (i = 0; i < 4; i++, made++) {
+				f = add_func(topo, link, i << 3, 0x10b5, 0x8632,
+					     0x060400, 1);
+				add_pcie(f, PCIE_DOWNSTREAM);
+				links[tail++] = f->child;
+			}
+			continue;
+		}
+
+		for (i = 0; i < 2; i++, n++) {
+			f = add_func(topo, link, i, 0x1af4, 0x1000 + n % 64,
+				     0x020000, 0);
+			add_pcie(f, PCIE_ENDPOINT);
+			add_bar(f, 0, bars[n % 6].type, bars[n % 6].size);
+			add_bar(f, 2, bars[(n + 1) % 6].type,
+				bars[(n + 1) % 6].size);
+			if (n % 5 == 0)
+				add_rom(f, 64 << 10);
+		}
+	}
+	free(links);
+}
+
+/*
+ * One conventional PCI bus holding up to 256 functions with six BARs each,
+ * sizes spread over 16 bytes to 8MB, for allocator scaling within a bus.
+ */
+void topology_wide(struct sim_topology *topo, int functions)
+{
+	struct sim_bus *bus;
+	struct sim_func *f;
+	int i, bar;
+
+	if (functions > 256)
+		errx(1, "at most 256 functions fit on a bus");
+
+	add_func(topo, &topo->root, 0, 0x8086, 0x0154, 0x060000, 0);
+	f = add_func(topo, &topo->root, 0x1e << 3, 0x8086, 0x244e, 0x060400,
+		     1);
+	bus = f->child;
+	for (i = 0; i < functions; i++) {
+		f = add_func(topo, bus, i, 0x1af4, 0x1000 + i % 64, 0x020000,
+			     0);
+		for (bar = 0; bar < 6; bar++) {
+			int k = i * 7 + bar * 3;
+			if (bar == 5)
+				add_bar(f, bar, BAR_IO, 4 << (k % 6));
+			else
+				add_bar(f, bar, (k & 1) ? BAR_MEMPF : BAR_MEM,
+					16 << (k % 20));
+		}
+	}
+}
+
+/*
+ * A chain of bridges, each with an endpoint next to the next bridge, for
+ * allocator scaling with depth.
+ */
+void topology_chain(struct sim_topology *topo, int bridges)
+{
+	struct sim_bus *bus = &topo->root;
+	struct sim_func *f;
+	int i;
+
+	if (bridges > 255)
+		errx(1, "at most 255 bridges fit in 256 bus numbers");
+
+	add_func(topo, bus, 0, 0x8086, 0x0154, 0x060000, 0);
+	for (i = 0; i < bridges; i++) {
+		f = add_func(topo, bus, 0x08, 0x1af4, 0x1000 + i % 64,
+			     0x020000, 0);
+		add_bar(f, 0, BAR_MEM, 4096 << (i % 4));
+		add_bar(f, 1, BAR_IO, 16 << (i % 3));
+		add_bar(f, 2, BAR_MEM64PF, 1 << (20 + i % 3));
+		f = add_func(topo, bus, 0x10, 0x8086, 0x244e, 0x060400, 1);
+		bus = f->child;
+	}
+}
+
+static void dump_bus(struct sim_bus *bus, FILE *out, int depth)
+{
+	struct sim_func *f;
+	int i;
+
+	for (f = bus->funcs; f; f = f->next) {
+		fprintf(out, "%*sdevice %02x.%x %02x%02x:%02x%02x class "
+			"%02x%02x%02x", depth * 8, "", f->devfn >> 3,
+			f->devfn & 7, f->cfg[1], f->cfg[0], f->cfg[3],
+			f->cfg[2], f->cfg[0x0b], f->cfg[0x0a], f->cfg[0x09]);
+		for (i = 0; i < 6; i++)
+			if (f->bar_type[i])
+				fprintf(out, " bar %d %s 0x%llx", i,
+					bar_names[f->bar_type[i]],
+					(unsigned long long)f->bar_size[i]);
+		if (f->rom_size)
+			fprintf(out, " rom 0x%x", f->rom_size);
+		if (f->pcie)
+			fprintf(out, " pcie %s", pcie_names[f->pcie - 1]);
+		if (f->child) {
+			fprintf(out, " {\n");
+			dump_bus(f->child, out, depth + 1);
+			fprintf(out, "%*s}\n", depth * 8, "");
+		} else {
+			fprintf(out, "\n");
+		}
+	}
+}
+
+void topology_dump(struct sim_topology *topo, FILE *out)
+{
+	fprintf(out, "memory %lu\n", topo->memory_mb);
+	dump_bus(&topo->root, out, 0);
+}
@@ -0,0 +1,497 @@
+/*
+ * This file is part of i915tool
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * i915prog compiles a register trace of the kernel driver, in the iodefs
+ * format that the mainboard code used to interpret at boot (see
+ * src/mainboard/google/link/i915io.trace), into the register program run
+ * by i915lightup():
+ *
+ *  - reads that were repeated, or that follow a read of the same register,
+ *    were the kernel polling; they become poll-until-mask ops with a timeout.
+ *    A poll directly followed by another poll of the same register only saw
+ *    a transient state and is dropped.
+ *  - all other reads only fed read-modify-write cycles whose results are
+ *    in the trace already, so they are dropped. So are polls that expect a
+ *    register that is not a status register to read back what was last
+ *    written to it.
+ *  - delays between a write and a poll of the status register showing the
+ *    effect of that write are dropped; the poll waits exactly as long as the
+ *    hardware needs.
+ *  - writes of the value a register was last written with are dropped,
+ *    unless writing the register has side effects.
+ *  - kernel messages become comments, verbosity changes are dropped, and
+ *    back to back delays are merged.
+ *
+ * Register names are copied through as they are, so the output is compiled
+ * against the same i915_reg.h as the trace.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <getopt.h>
+#include <libgen.h>
+
+#define DEFAULT_TIMEOUT 2000 /* microseconds */
+
+#define SIDE_EFFECTS	(1 << 0)	/* every write does something */
+#define STATUS		(1 << 1)	/* reads show hardware state */
+
+/* How to treat a few registers specially. */
+static const struct reg_rule {
+	const char *name;
+	const char *mask;	/* bits to poll on, NULL: value never settles */
+	unsigned long timeout;	/* poll timeout in microseconds */
+	int flags;
+	const char *trigger;	/* register whose effect a poll waits for */
+} rules[] = {
+	/* AUX transaction finished, either way. */
+	{ "DPA_AUX_CH_CTL", "DP_AUX_CH_CTL_SEND_BUSY | DP_AUX_CH_CTL_DONE",
+	  10000, SIDE_EFFECTS | STATUS, "DPA_AUX_CH_CTL" },
+	/* Panel power sequencer settled. The sequencer enforces the panel
+	 * delays programmed in PCH_PP_ON/OFF_DELAYS and PCH_PP_DIVISOR
+	 * itself, so this is all the waiting the panel needs. */
+	{ "PCH_PP_STATUS", "PP_ON | PP_SEQUENCE_MASK | PP_CYCLE_DELAY_ACTIVE | "
+	  "PP_SEQUENCE_STATE_MASK", 5000000, STATUS, "PCH_PP_CONTROL" },
+	{ "_PIPEADSL", NULL, 0, 0, NULL },	/* scan line counter */
+	{ "_PIPEASTAT", "0xffffffff", DEFAULT_TIMEOUT, SIDE_EFFECTS | STATUS,
+	  NULL },
+	{ "PCH_PP_CONTROL", "0xffffffff", DEFAULT_TIMEOUT, SIDE_EFFECTS, NULL },
+	/* forcewake */
+	{ "0xa188", "0xffffffff", DEFAULT_TIMEOUT, SIDE_EFFECTS, NULL },
+};
+
+static const struct reg_rule default_rule = {
+	NULL, "0xffffffff", DEFAULT_TIMEOUT, 0, NULL
+};
+
+enum { M = 1, R = 2, W = 3, V = 4, I = 8 };
+
+struct trace_entry {
+	int op;
+	unsigned long count;
+	char *msg;
+	char *addr;
+	char *data;
+	unsigned long udelay;
+};
+
+enum { OP_WRITE, OP_POLL, OP_DELAY, OP_MSG };
+
+struct insn {
+	int op;
+	const char *addr;
+	const char *data;
+	const struct reg_rule *rule;
+	unsigned long delay;
+	const char *msg;
+};
+
+static struct trace_entry *trace;
+static int trace_len;
+static struct insn *prog;
+static int prog_len;
+
+static void *xrealloc(void *p, size_t size)
+{
+	p = realloc(p, size);
+	if (!p) {
+		fprintf(stderr, "Out of memory.\n");
+		exit(1);
+	}
+	return p;
+}
+
+static const struct reg_rule *find_rule(const char *addr)
+{
+	int i;
+
+	for (i = 0; i < sizeof(rules) / sizeof(rules[0]); i++)
+		if (!strcmp(rules[i].name, addr))
+			return &rules[i];
+	return &default_rule;
+}
+
+static char *skip_space(char *p)
+{
+	for (;;) {
+		while (isspace(*p))
+			p++;
+		if (p[0] == '/' && p[1] == '/') {
+			while (*p && *p != '\n')
+				p++;
+		} else if (p[0] == '/' && p[1] == '*') {
+			p = strstr(p + 2, "*/");
+			if (!p) {
+				fprintf(stderr, "Unterminated comment.\n");
+				exit(1);
+			}
+			p += 2;
+		} else {
+			return p;
+		}
+	}
+}
+
+/* Parses one field of an initializer: a run of string literals (returned
+ * concatenated) or a token up to the next ',' or '}'. */
+static char *parse_field(char **pp)
+{
+	char *p = skip_space(*pp), *s;
+	size_t len = 0;
+
+	if (*p == '"') {
+		s = xrealloc(NULL, 1);
+		*s = '\0';
+		while (*p == '"') {
+			char *end = strchr(p + 1, '"');
+			if (!end) {
+				fprintf(stderr, "Unterminated string.\n");
+				exit(1);
+			}
+			s = xrealloc(s, len + (end - p));
+			memcpy(s + len, p + 1, end - p - 1);
+			len += end - p - 1;
+			s[len] = '\0';
+			p = skip_space(end + 1);
+		}
+	} else {
+		char *start = p;
+		while (*p && *p != ',' && *p != '}')
+			p++;
+		while (p > start && isspace(p[-1]))
+			p--;
+		s = xrealloc(NULL, p - start + 1);
+		memcpy(s, start, p - start);
+		s[p - start] = '\0';
+		p = skip_space(p);
+	}
+	if (*p == ',')
+		p++;
+	*pp = p;
+	return s;
+}
+
+static int parse_op(const char *s)
+{
+	static const struct { const char *name; int op; } ops[] = {
+		{ "M", M }, { "R", R }, { "W", W }, { "V", V }, { "I", I },
+		{ "0", 0 },
+	};
+	int i;
+
+	for (i = 0; i < sizeof(ops) / sizeof(ops[0]); i++)
+		if (!strcmp(ops[i].name, s))
+			return ops[i].op;
+	fprintf(stderr, "Unknown op '%s'.\n", s);
+	exit(1);
+}
+
+static void parse_trace(char *p)
+{
+	for (p = skip_space(p); *p; p = skip_space(p)) {
+		struct trace_entry *e;
+		char *fields[6] = { NULL, };
+		int n;
+
+		if (*p != '{') {
+			/* Anything outside the initializers is ignored. */
+			p++;
+			continue;
+		}
+		p++;
+		for (n = 0; n < 6; n++) {
+			p = skip_space(p);
+			if (*p == '}')
+				break;
+			fields[n] = parse_field(&p);
+		}
+		p = skip_space(p);
+		if (*p != '}') {
+			fprintf(stderr, "Entry %d has too many fields.\n",
+				trace_len);
+			exit(1);
+		}
+		p++;
+		if (n == 0)
+			continue;
+
+		trace = xrealloc(trace, (trace_len + 1) * sizeof(*trace));
+		e = &trace[trace_len++];
+		e->op = parse_op(fields[0]);
+		e->count = fields[1] ? strtoul(fields[1], NULL, 0) : 0;
+		e->msg = fields[2];
+		e->addr = fields[3];
+		e->data = fields[4];
+		e->udelay = fields[5] ? strtoul(fields[5], NULL, 0) : 0;
+		if ((e->op == R || e->op == W) && (!e->addr || !e->data)) {
+			fprintf(stderr, "Entry %d lacks address or data.\n",
+				trace_len - 1);
+			exit(1);
+		}
+		if (e->op == 0)
+			break;
+	}
+}
+
+static struct insn *emit(int op)
+{
+	prog = xrealloc(prog, (prog_len + 1) * sizeof(*prog));
+	memset(&prog[prog_len], 0, sizeof(*prog));
+	prog[prog_len].op = op;
+	return &prog[prog_len++];
+}
+
+static void emit_delay(unsigned long delay)
+{
+	if (prog_len && prog[prog_len - 1].op == OP_DELAY)
+		prog[prog_len - 1].delay += delay;
+	else
+		emit(OP_DELAY)->delay = delay;
+}
+
+/* Drops the delays at the end of the program if they follow a write to
+ * trigger (messages aside). */
+static void drop_delays(const char *trigger)
+{
+	int i, j;
+
+	for (i = prog_len; i > 0 && (prog[i - 1].op == OP_DELAY ||
+				     prog[i - 1].op == OP_MSG); i--)
+		;
+	if (!trigger || i == 0 || prog[i - 1].op != OP_WRITE ||
+	    strcmp(prog[i - 1].addr, trigger))
+		return;
+	for (j = i; i < prog_len; i++)
+		if (prog[i].op != OP_DELAY)
+			prog[j++] = prog[i];
+	prog_len = j;
+}
+
+/* Returns the instruction index of the last write to addr, or -1. */
+static int last_write(const char *addr)
+{
+	int i;
+
+	for (i = prog_len - 1; i >= 0; i--)
+		if (prog[i].op == OP_WRITE && !strcmp(prog[i].addr, addr))
+			return i;
+	return -1;
+}
+
+static void compile(int *reads_dropped, int *writes_dropped)
+{
+	const struct trace_entry *e, *last_read = NULL;
+	const struct reg_rule *rule;
+	struct insn *insn;
+	int i, j;
+
+	for (i = 0; i < trace_len && trace[i].op; i++) {
+		e = &trace[i];
+		switch (e->op) {
+		case M:
+			emit(OP_MSG)->msg = e->msg;
+			break;
+		case R:
+			rule = find_rule(e->addr);
+			j = last_write(e->addr);
+			if (!(rule->flags & STATUS) && j >= 0 &&
+			    strtoul(prog[j].data, NULL, 0) ==
+			    strtoul(e->data, NULL, 0)) {
+				(*reads_dropped)++;
+			} else if (rule->mask && (e->count > 1 || (last_read &&
+				   !strcmp(last_read->addr, e->addr)))) {
+				/* A poll right after a poll of the same
+				 * register (delays and messages aside)
+				 * replaces it. */
+				for (j = prog_len - 1; j >= 0 &&
+				     prog[j].op != OP_WRITE &&
+				     prog[j].op != OP_POLL; j--)
+					;
+				if (j >= 0 && prog[j].op == OP_POLL &&
+				    !strcmp(prog[j].addr, e->addr)) {
+					memmove(&prog[j], &prog[j + 1],
+						(prog_len - j - 1) *
+						sizeof(*prog));
+					prog_len--;
+					(*reads_dropped)++;
+				}
+				drop_delays(rule->trigger);
+				insn = emit(OP_POLL);
+				insn->addr = e->addr;
+				insn->data = e->data;
+				insn->rule = rule;
+			} else {
+				(*reads_dropped)++;
+			}
+			last_read = e;
+			break;
+		case W:
+			rule = find_rule(e->addr);
+			j = last_write(e->addr);
+			if (!(rule->flags & SIDE_EFFECTS) && j >= 0 &&
+			    strtoul(prog[j].data, NULL, 0) ==
+			    strtoul(e->data, NULL, 0)) {
+				(*writes_dropped)++;
+				break;
+			}
+			insn = emit(OP_WRITE);
+			insn->addr = e->addr;
+			insn->data = e->data;
+			insn->rule = rule;
+			break;
+		case V:
+		case I:
+			break;
+		}
+		if (e->udelay)
+			emit_delay(e->udelay);
+	}
+
+	/* Dropping polls may have left delays next to each other. */
+	for (i = j = 0; i < prog_len; i++) {
+		if (j && prog[i].op == OP_DELAY && prog[j - 1].op == OP_DELAY)
+			prog[j - 1].delay += prog[i].delay;
+		else
+			prog[j++] = prog[i];
+	}
+	prog_len = j;
+}
+
+static int output(FILE *f, const char *source, int reads_dropped,
+		  int writes_dropped)
+{
+	const char *p;
+	int i, words = 1;
+
+	for (i = 0; i < prog_len; i++) {
+		switch (prog[i].op) {
+		case OP_WRITE:
+			words += 2;
+			break;
+		case OP_POLL:
+			words += 4;
+			break;
+		case OP_DELAY:
+			words += 1;
+			break;
+		}
+	}
+
+	fprintf(f, "/*\n"
+		" * This file was generated by util/i915tool/i915prog from\n"
+		" * %s. Do not edit.\n"
+		" *\n"
+		" * %d trace entries, %d reads and %d writes dropped,\n"
+		" * %d words of program.\n"
+		" */\n\n", source, trace_len, reads_dropped, writes_dropped,
+		words);
+	fprintf(f, "#include <types.h>\n#include \"i915io.h\"\n\n");
+	fprintf(f, "const u32 i915_program[] = {\n");
+	for (i = 0; i < prog_len; i++) {
+		const struct insn *insn = &prog[i];
+
+		switch (insn->op) {
+		case OP_MSG:
+			fprintf(f, "\t/* ");
+			for (p = insn->msg; *p; p++) {
+				/* Don't let the message end the comment. */
+				if (p[0] == '*' && p[1] == '/')
+					fputc(' ', f);
+				else
+					fputc(*p, f);
+			}
+			fprintf(f, " */\n");
+			break;
+		case OP_WRITE:
+			fprintf(f, "\tI915_WRITE(%s, %s),\n", insn->addr,
+				insn->data);
+			break;
+		case OP_POLL:
+			fprintf(f, "\tI915_POLL(%s, %s, %s, %lu),\n",
+				insn->addr, insn->rule->mask, insn->data,
+				insn->rule->timeout);
+			break;
+		case OP_DELAY:
+			fprintf(f, "\tI915_DELAY(%lu),\n", insn->delay);
+			break;
+		}
+	}
+	fprintf(f, "\tI915_END(),\n};\n");
+	return ferror(f) ? -1 : 0;
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "usage: %s [-o output.c] trace\n", name);
+	exit(1);
+}
+
+int main(int argc, char **argv)
+{
+	const char *outname = NULL;
+	int opt, reads_dropped = 0, writes_dropped = 0;
+	FILE *in, *out = stdout;
+	char *buf = NULL;
+	size_t len = 0, n;
+
+	while ((opt = getopt(argc, argv, "o:h")) != -1) {
+		switch (opt) {
+		case 'o':
+			outname = optarg;
+			break;
+		default:
+			usage(argv[0]);
+		}
+	}
+	if (optind != argc - 1)
+		usage(argv[0]);
+
+	in = fopen(argv[optind], "r");
+	if (!in) {
+		perror(argv[optind]);
+		return 1;
+	}
+	do {
+		buf = xrealloc(buf, len + 4096 + 1);
+		n = fread(buf + len, 1, 4096, in);
+		len += n;
+	} while (n > 0);
+	buf[len] = '\0';
+	fclose(in);
+
+	parse_trace(buf);
+	compile(&reads_dropped, &writes_dropped);
+
+	if (outname) {
+		out = fopen(outname, "w");
+		if (!out) {
+			perror(outname);
+			return 1;
+		}
+	}
+	if (output(out, basename(argv[optind]), reads_dropped,
+		   writes_dropped) || (outname && fclose(out))) {
+		fprintf(stderr, "Could not write program.\n");
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,316 @@
+/*
+ * cursesbench - count what tinycurses sends to the consoles
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * menu.c redraws a bayou-like menu through tinycurses over and over, as
+ * if the user kept pressing the down key. tinycurses draws to the
+ * coreboot framebuffer console and to drivers/serial.c, whose UART
+ * feeds a VT100 model here. What each redraw costs is counted on both:
+ * putc() calls into the video console, and bytes and cursor motions on
+ * the serial line.
+ *
+ * Then the screens are checked. A second process draws only the last
+ * frame onto fresh consoles, and both the video cells and the terminal
+ * must end up the same as after all the redraws. The terminal must also
+ * show the same text as the video console, apart from line drawing,
+ * which the two map differently.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+#include "lpconsole.h"
+
+#define COLUMNS		80
+#define ROWS		25
+#define UART		0x3f8
+#define BAUD		115200
+
+void *host_malloc(unsigned long size)
+{
+	return malloc(size);
+}
+
+void host_free(void *ptr)
+{
+	free(ptr);
+}
+
+void host_vprintf(const char *fmt, va_list args)
+{
+	vprintf(fmt, args);
+}
+
+/* What the terminal shows in one cell. */
+struct term_cell {
+	unsigned char ch;
+	unsigned char acs, bold, reverse;
+	signed char fg, bg;
+};
+
+/* Everything that is compared between the two processes. */
+struct screens {
+	unsigned int video[ROWS * COLUMNS];
+	struct term_cell term[ROWS][COLUMNS];
+};
+
+static struct {
+	struct term_cell pen;
+	int y, x;
+	char seq[16];
+	int seq_len;		/* 0: not in an escape sequence */
+	unsigned long bytes, motions;
+	struct term_cell (*cells)[COLUMNS];
+} term;
+
+static void term_reset_pen(void)
+{
+	term.pen.bold = term.pen.reverse = 0;
+	term.pen.fg = term.pen.bg = -1;
+}
+
+/* The sequences drivers/serial.c sends, see VT100_* there. */
+static void term_csi(char final, const char *params)
+{
+	int a = 0, b = 0, n, y, x;
+	const char *p;
+
+	n = sscanf(params, "%d;%d", &a, &b);
+	switch (final) {
+	case 'H':
+		term.y = n >= 1 ? a - 1 : 0;
+		term.x = n >= 2 ? b - 1 : 0;
+		term.motions++;
+		break;
+	case 'J':
+		for (y = term.y; y < ROWS; y++)
+			for (x = y == term.y ? term.x : 0; x < COLUMNS; x++)
+				term.cells[y][x] = (struct term_cell){
+					.ch = ' ', .fg = -1, .bg = -1 };
+		break;
+	case 'm':
+		if (!*params)
+			term_reset_pen();
+		for (p = params; *p; p++) {
+			n = strtol(p, (char **)&p, 10);
+			if (n == 0)
+				term_reset_pen();
+			else if (n == 1)
+				term.pen.bold = 1;
+			else if (n == 7)
+				term.pen.reverse = 1;
+			else if (n >= 30 && n < 38)
+				term.pen.fg = n - 30;
+			else if (n >= 40 && n < 48)
+				term.pen.bg = n - 40;
+			if (!*p)
+				break;
+		}
+		break;
+	}
+}
+
+static void term_putchar(unsigned char c)
+{
+	term.bytes++;
+	if (term.seq_len) {
+		term.seq[term.seq_len++] = c;
+		if (term.seq[1] == '(' && term.seq_len == 3) {
+			term.pen.acs = c == '0';
+			term.seq_len = 0;
+		} else if (term.seq[1] == '[' && term.seq_len > 2 &&
+			   c >= '@' && c <= '~') {
+			term.seq[term.seq_len - 1] = '\0';
+			if (term.seq[2] != '?')
+				term_csi(c, term.seq + 2);
+			term.seq_len = 0;
+		} else if (term.seq_len == sizeof(term.seq)) {
+			printf("FAIL: runaway escape sequence\n");
+			exit(1);
+		}
+		return;
+	}
+	if (c == 0x1b) {
+		term.seq[0] = c;
+		term.seq_len = 1;
+		return;
+	}
+	if (term.y < ROWS && term.x < COLUMNS) {
+		term.cells[term.y][term.x] = term.pen;
+		term.cells[term.y][term.x].ch = c;
+	}
+	if (term.x < COLUMNS - 1)
+		term.x++;
+}
+
+/* A 16550 that is always ready to send. */
+unsigned int host_in(int port, int width)
+{
+	if (port == UART + 5)
+		return 0x60;
+	return 0xff;
+}
+
+void host_out(int port, int width, unsigned int val)
+{
+	if (port == UART)
+		term_putchar(val);
+}
+
+static unsigned long video_calls;
+
+/* Bring up both consoles and the menu, the rest is left to menu.c. */
+static void start(struct screens *s)
+{
+	static unsigned char fb[COLUMNS * 8 * ROWS * 16 * 4];
+
+	term.cells = s->term;
+	term_reset_pen();
+	if (lp_video_init(fb, COLUMNS * 8, ROWS * 16, 32)) {
+		printf("no video console\n");
+		exit(1);
+	}
+	lp_video_watch(s->video, &video_calls);
+	lp_serial_init(UART);
+	lp_menu_init();
+}
+
+static int compare(const struct screens *all, const struct screens *last)
+{
+	int y, x, errors = 0;
+
+	for (y = 0; y < ROWS; y++) {
+		for (x = 0; x < COLUMNS; x++) {
+			const struct term_cell *t = &all->term[y][x];
+			unsigned int v = all->video[y * COLUMNS + x];
+
+			if (v != last->video[y * COLUMNS + x] &&
+			    errors++ < 10)
+				printf("FAIL: video %d,%d is %04x, drawing only "
+				       "the last frame gives %04x\n", y, x, v,
+				       last->video[y * COLUMNS + x]);
+			if (memcmp(t, &last->term[y][x], sizeof(*t)) &&
+			    errors++ < 10)
+				printf("FAIL: terminal %d,%d is '%c', drawing "
+				       "only the last frame gives '%c'\n", y, x,
+				       t->ch, last->term[y][x].ch);
+			if (!t->acs && t->ch != (v & 0xff) && errors++ < 10)
+				printf("FAIL: terminal %d,%d is '%c', video "
+				       "is '%c'\n", y, x, t->ch, v & 0xff);
+		}
+	}
+	return errors;
+}
+
+static double now(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/* Line drawing shows as the VT100 characters that select it. */
+static void show(const struct screens *s)
+{
+	int y, x;
+
+	for (y = 0; y < ROWS; y++) {
+		for (x = 0; x < COLUMNS; x++)
+			putchar(s->term[y][x].ch);
+		putchar('\n');
+	}
+}
+
+static void usage(void)
+{
+	printf("usage: cursesbench [-n redraws] [-s]\n"
+	       "  -n  key presses, each redrawing the menu (50)\n"
+	       "  -s  show the terminal at the end\n");
+}
+
+int main(int argc, char *argv[])
+{
+	struct screens *all, *last;
+	unsigned long bytes, motions, calls;
+	int c, i, status, redraws = 50, show_term = 0;
+	double start_time, elapsed;
+	pid_t pid;
+
+	while ((c = getopt(argc, argv, "n:sh")) != -1) {
+		switch (c) {
+		case 'n': redraws = atoi(optarg); break;
+		case 's': show_term = 1; break;
+		default: usage(); return c != 'h';
+		}
+	}
+	if (redraws < 1) {
+		usage();
+		return 1;
+	}
+
+	/* The first frame only, into a fresh copy of everything. */
+	last = mmap(NULL, sizeof(*last), PROT_READ | PROT_WRITE,
+		    MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+	if (last == MAP_FAILED) {
+		perror("mmap");
+		return 1;
+	}
+	fflush(stdout);
+	pid = fork();
+	if (pid == 0) {
+		start(last);
+		lp_menu_draw(redraws);
+		exit(0);
+	}
+	waitpid(pid, &status, 0);
+	if (!WIFEXITED(status) || WEXITSTATUS(status))
+		return 1;
+
+	all = calloc(1, sizeof(*all));
+	start(all);
+	lp_menu_draw(0);
+	bytes = term.bytes;
+	motions = term.motions;
+	calls = video_calls;
+	start_time = now();
+	for (i = 1; i <= redraws; i++)
+		lp_menu_draw(i);
+	elapsed = now() - start_time;
+	bytes = term.bytes - bytes;
+	motions = term.motions - motions;
+	calls = video_calls - calls;
+
+	if (show_term)
+		show(all);
+	printf("%d redraws, per redraw:\n", redraws);
+	printf("  video:  %lu putc() calls\n", calls / redraws);
+	printf("  serial: %lu bytes, %lu cursor motions, %.1f ms at %d "
+	       "baud\n", bytes / redraws, motions / redraws,
+	       bytes * 10.0 / BAUD / redraws * 1e3, BAUD);
+	printf("  cpu:    %.1f us\n", elapsed / redraws * 1e6);
+	if (compare(all, last))
+		return 1;
+	printf("screens: match drawing only the last frame\n");
+	return 0;
+}
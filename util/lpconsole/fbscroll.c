@@ -0,0 +1,228 @@
+/*
+ * fbscroll - time and check scrolling on the coreboot framebuffer console
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * corebootfb.c and video.c draw into a framebuffer in host memory.
+ * Lines of text are printed through video_console_putchar() until the
+ * screen has scrolled many times over, and the time that takes is
+ * reported. The result is then checked in two ways: the pixels must be
+ * the same as drawing the text that should be left on the screen into
+ * a cleared screen, and every cell must hold ink exactly when it should
+ * hold a character. Nothing may be drawn past the end of the
+ * framebuffer.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "lpconsole.h"
+
+#define FONT_WIDTH	8
+#define FONT_HEIGHT	16
+
+/* Bytes after the framebuffer that nothing may write to. */
+#define GUARD		4096
+
+void *host_malloc(unsigned long size)
+{
+	return malloc(size);
+}
+
+void host_free(void *ptr)
+{
+	free(ptr);
+}
+
+void host_vprintf(const char *fmt, va_list args)
+{
+	vprintf(fmt, args);
+}
+
+static unsigned int width = 2560, height = 1700, bpp = 32;
+static unsigned int rows, columns;
+static int wide;
+
+/*
+ * Line n of the output, log-like lengths or, with -w, up to full width.
+ * Before the first line the screen is empty.
+ */
+static int make_line(char *buf, int n)
+{
+	int len, i;
+
+	if (n < 0)
+		len = 0;
+	else if (wide)
+		len = 20 + (n * 37) % (columns - 20);
+	else
+		len = (n * 37) % 80;
+	if (len > columns - 1)
+		len = columns - 1;
+	for (i = 0; i < len; i++)
+		buf[i] = 'A' + (n + i) % 26;
+	buf[len] = '\0';
+	return len;
+}
+
+static double now(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+/* Whether any pixel of the cell differs from the black background. */
+static int cell_has_ink(const unsigned char *fb, int row, int col)
+{
+	unsigned int pitch = width * (bpp / 8), cell = FONT_WIDTH * (bpp / 8);
+	const unsigned char *p;
+	int y, x;
+
+	for (y = 0; y < FONT_HEIGHT; y++) {
+		p = fb + (row * FONT_HEIGHT + y) * pitch + col * cell;
+		for (x = 0; x < cell; x++)
+			if (p[x])
+				return 1;
+	}
+	return 0;
+}
+
+static int check(unsigned char *fb, size_t size, int lines)
+{
+	char *line = malloc(columns + 1);
+	unsigned char *scrolled = malloc(size);
+	int row, col, len, first, errors = 0;
+
+	/*
+	 * Once the screen has scrolled, the last rows - 1 lines are left
+	 * and the cursor sits on the empty bottom row.
+	 */
+	first = lines > rows - 1 ? lines - (rows - 1) : 0;
+	memcpy(scrolled, fb, size);
+	lp_video_clear();
+	for (row = 0; row < rows - 1; row++) {
+		make_line(line, first + row < lines ? first + row : -1);
+		for (col = 0; line[col]; col++)
+			lp_video_putc(row, col, 0x0700 | line[col]);
+	}
+	lp_video_set_cursor(0, lines - first);
+	if (memcmp(scrolled, fb, size)) {
+		printf("FAIL: scrolled screen differs from a redraw\n");
+		errors++;
+	}
+
+	/* The cursor cell is inverted, leave it out. */
+	for (row = 0; row < rows - 1; row++) {
+		len = make_line(line, first + row < lines ? first + row : -1);
+		for (col = 0; col < columns; col++) {
+			if (row == lines - first && col == 0)
+				continue;
+			if (cell_has_ink(scrolled, row, col) == (col < len))
+				continue;
+			if (errors++ < 10)
+				printf("FAIL: row %d column %d should be %s\n",
+				       row, col, col < len ? "set" : "blank");
+		}
+	}
+	/* Every pixel of the bottom right cell, on a light background. */
+	lp_video_putc(rows - 1, columns - 1, 0x7000 | ' ');
+	for (col = 0; col < GUARD; col++) {
+		if (fb[size + col] != 0x5a) {
+			printf("FAIL: wrote past the end of the framebuffer\n");
+			errors++;
+			break;
+		}
+	}
+
+	free(scrolled);
+	free(line);
+	return errors;
+}
+
+static void usage(void)
+{
+	printf("usage: fbscroll [-r WIDTHxHEIGHT] [-d bpp] [-n lines] [-w]\n"
+	       "  -r  framebuffer resolution (2560x1700)\n"
+	       "  -d  bits per pixel, 16, 24 or 32 (32)\n"
+	       "  -n  lines to print (500)\n"
+	       "  -w  lines up to the full screen width instead of up to"
+	       " 80 columns\n");
+}
+
+int main(int argc, char *argv[])
+{
+	unsigned char *fb;
+	char *line;
+	unsigned long long read0, written0, read, written;
+	size_t size;
+	int c, n, lines = 500;
+	double start, elapsed;
+
+	while ((c = getopt(argc, argv, "r:d:n:wh")) != -1) {
+		switch (c) {
+		case 'r':
+			if (sscanf(optarg, "%ux%u", &width, &height) != 2) {
+				usage();
+				return 1;
+			}
+			break;
+		case 'd': bpp = atoi(optarg); break;
+		case 'n': lines = atoi(optarg); break;
+		case 'w': wide = 1; break;
+		default: usage(); return c != 'h';
+		}
+	}
+	if (bpp != 16 && bpp != 24 && bpp != 32) {
+		usage();
+		return 1;
+	}
+
+	size = (size_t)width * height * (bpp / 8);
+	fb = calloc(1, size + GUARD);
+	memset(fb + size, 0x5a, GUARD);
+	if (lp_video_init(fb, width, height, bpp)) {
+		printf("no video console\n");
+		return 1;
+	}
+	lp_video_size(&rows, &columns);
+	line = malloc(columns + 2);
+
+	lp_video_traffic(&read0, &written0);
+	start = now();
+	for (n = 0; n < lines; n++) {
+		strcpy(line + make_line(line, n), "\n");
+		lp_video_puts(line);
+	}
+	elapsed = now() - start;
+	lp_video_traffic(&read, &written);
+
+	printf("%ux%ux%u, %ux%u cells: %d lines in %.1f ms, %.0f lines/s\n",
+	       width, height, bpp, columns, rows, lines, elapsed * 1e3,
+	       lines / elapsed);
+	printf("framebuffer per line: %llu KiB read, %llu KiB written\n",
+	       (read - read0) / lines / 1024,
+	       (written - written0) / lines / 1024);
+	if (check(fb, size, lines))
+		return 1;
+	printf("screen: matches a redraw\n");
+	return 0;
+}
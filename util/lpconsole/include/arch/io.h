@@ -0,0 +1,70 @@
+/*
+ * lpconsole - run the libpayload console drivers on the host
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * Stands in for libpayload's include/x86/arch/io.h. Port I/O goes to the
+ * host half instead of the hardware, which is how drivers/serial.c ends
+ * up talking to a terminal model.
+ */
+
+#ifndef _ARCH_IO_H
+#define _ARCH_IO_H
+
+#define readb(_a) (*(volatile unsigned char *) (_a))
+#define readw(_a) (*(volatile unsigned short *) (_a))
+#define readl(_a) (*(volatile unsigned long *) (_a))
+
+#define writeb(_v, _a) (*(volatile unsigned char *) (_a) = (_v))
+#define writew(_v, _a) (*(volatile unsigned short *) (_a) = (_v))
+#define writel(_v, _a) (*(volatile unsigned long *) (_a) = (_v))
+
+unsigned int host_in(int port, int width);
+void host_out(int port, int width, unsigned int val);
+
+static inline unsigned long inl(int port)
+{
+	return host_in(port, 4);
+}
+
+static inline unsigned short inw(int port)
+{
+	return host_in(port, 2);
+}
+
+static inline unsigned char inb(int port)
+{
+	return host_in(port, 1);
+}
+
+static inline void outl(unsigned long val, int port)
+{
+	host_out(port, 4, val);
+}
+
+static inline void outw(unsigned short val, int port)
+{
+	host_out(port, 2, val);
+}
+
+static inline void outb(unsigned char val, int port)
+{
+	host_out(port, 1, val);
+}
+
+#endif
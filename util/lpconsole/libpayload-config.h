@@ -0,0 +1,38 @@
+/*
+ * lpconsole - run the libpayload console drivers on the host
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/* The libpayload configuration the console drivers are built with. */
+
+#define CONFIG_TARGET_I386 1
+#define CONFIG_LITTLE_ENDIAN 1
+#define CONFIG_VIDEO_CONSOLE 1
+#define CONFIG_COREBOOT_VIDEO_CONSOLE 1
+#define CONFIG_SERIAL_CONSOLE 1
+
+/*
+ * The drivers end up in the same program as the host C library, so the
+ * libpayload functions that exist in both are renamed and provided by
+ * libpayload.c. memcpy() and memset() are taken over too, to count how
+ * much of the framebuffer the drivers read and write.
+ */
+#define malloc lp_malloc
+#define memcpy lp_memcpy
+#define memset lp_memset
+#define free lp_free
+#define printf lp_printf
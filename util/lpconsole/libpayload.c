@@ -0,0 +1,188 @@
+/*
+ * lpconsole - run the libpayload console drivers on the host
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * The libpayload half of lpconsole: the glue the console drivers expect
+ * from the rest of libpayload, and the calls the host half drives them
+ * with. The drivers are used as they are.
+ */
+
+#include <libpayload.h>
+#include <coreboot_tables.h>
+#include <video_console.h>
+#include "lpconsole.h"
+
+/* The framebuffer address is a host pointer, used as it is. */
+unsigned long virtual_offset = 0;
+
+struct sysinfo_t lib_sysinfo;
+
+void *malloc(size_t size)
+{
+	return host_malloc(size);
+}
+
+void free(void *ptr)
+{
+	host_free(ptr);
+}
+
+int printf(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	host_vprintf(fmt, args);
+	va_end(args);
+	return 0;
+}
+
+/*
+ * Framebuffer traffic through memcpy() and memset(). corebootfb moves
+ * and clears pixels with these, and draws glyphs at 32 bpp with them;
+ * the stores it does itself at other depths are not counted.
+ */
+static unsigned char *fb_start, *fb_end;
+static unsigned long long fb_read, fb_written;
+
+static int in_fb(const void *ptr)
+{
+	return (unsigned char *)ptr >= fb_start &&
+		(unsigned char *)ptr < fb_end;
+}
+
+void *memcpy(void *dst, const void *src, size_t n)
+{
+	if (in_fb(src))
+		fb_read += n;
+	if (in_fb(dst))
+		fb_written += n;
+	return __builtin_memcpy(dst, src, n);
+}
+
+void *memset(void *s, int c, size_t n)
+{
+	if (in_fb(s))
+		fb_written += n;
+	return __builtin_memset(s, c, n);
+}
+
+void lp_video_traffic(unsigned long long *read, unsigned long long *written)
+{
+	*read = fb_read;
+	*written = fb_written;
+}
+
+/* The host half calls the consoles directly. */
+void console_add_output_driver(struct console_output_driver *out)
+{
+}
+
+void console_add_input_driver(struct console_input_driver *in)
+{
+}
+
+int lp_video_init(void *fb, unsigned int width, unsigned int height,
+		  unsigned int bpp)
+{
+	static struct cb_framebuffer info;
+	unsigned int rows, columns;
+
+	info.physical_address = (unsigned long)fb;
+	info.x_resolution = width;
+	info.y_resolution = height;
+	info.bits_per_pixel = bpp;
+	info.bytes_per_line = width * ((bpp + 7) / 8);
+	if (bpp == 16) {
+		info.red_mask_pos = 11;
+		info.red_mask_size = 5;
+		info.green_mask_pos = 5;
+		info.green_mask_size = 6;
+		info.blue_mask_size = 5;
+	} else {
+		info.red_mask_pos = 16;
+		info.red_mask_size = 8;
+		info.green_mask_pos = 8;
+		info.green_mask_size = 8;
+		info.blue_mask_size = 8;
+	}
+	lib_sysinfo.framebuffer = &info;
+	fb_start = fb;
+	fb_end = fb_start + info.bytes_per_line * height;
+
+	/* video_init() has no return value when no console comes up. */
+	video_init();
+	video_get_rows_cols(&rows, &columns);
+	return rows ? 0 : -1;
+}
+
+void lp_video_size(unsigned int *rows, unsigned int *columns)
+{
+	video_get_rows_cols(rows, columns);
+}
+
+/*
+ * Count the putc() calls that reach the video console and keep a copy of
+ * what they put on the screen.
+ */
+extern struct video_console coreboot_video_console;
+static void (*video_putc)(unsigned int row, unsigned int col,
+			  unsigned int ch);
+static unsigned int *watched_cells;
+static unsigned long *watched_calls;
+
+static void watch_putc(unsigned int row, unsigned int col, unsigned int ch)
+{
+	watched_cells[row * coreboot_video_console.columns + col] = ch;
+	(*watched_calls)++;
+	video_putc(row, col, ch);
+}
+
+void lp_video_watch(unsigned int *cells, unsigned long *calls)
+{
+	watched_cells = cells;
+	watched_calls = calls;
+	video_putc = coreboot_video_console.putc;
+	coreboot_video_console.putc = watch_putc;
+}
+
+/* Hand over a string the way putchar() in libc/console.c does. */
+void lp_video_puts(const char *s)
+{
+	for (; *s; s++) {
+		if (*s == '\n')
+			video_console_putchar('\r');
+		video_console_putchar(*s);
+	}
+}
+
+void lp_video_putc(unsigned int row, unsigned int col, unsigned int ch)
+{
+	video_console_putc(row, col, ch);
+}
+
+void lp_video_clear(void)
+{
+	video_console_clear();
+}
+
+void lp_video_set_cursor(unsigned int x, unsigned int y)
+{
+	video_console_set_cursor(x, y);
+}
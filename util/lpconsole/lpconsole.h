@@ -0,0 +1,52 @@
+/*
+ * lpconsole - run the libpayload console drivers on the host
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * Like usbsim, lpconsole is built from a libpayload half (libpayload.c
+ * plus the console drivers) and a host half with main(), which cannot
+ * share headers. This is what they pass between each other.
+ */
+
+#ifndef LPCONSOLE_H
+#define LPCONSOLE_H
+
+#include <stdarg.h>
+
+/* Provided by the host half. */
+void *host_malloc(unsigned long size);
+void host_free(void *ptr);
+void host_vprintf(const char *fmt, va_list args);
+unsigned int host_in(int port, int width);
+void host_out(int port, int width, unsigned int val);
+
+/* Provided by the libpayload half. */
+int lp_video_init(void *fb, unsigned int width, unsigned int height,
+		  unsigned int bpp);
+void lp_video_size(unsigned int *rows, unsigned int *columns);
+void lp_video_puts(const char *s);
+void lp_video_putc(unsigned int row, unsigned int col, unsigned int ch);
+void lp_video_clear(void);
+void lp_video_set_cursor(unsigned int x, unsigned int y);
+void lp_video_traffic(unsigned long long *read, unsigned long long *written);
+void lp_video_watch(unsigned int *cells, unsigned long *calls);
+void lp_serial_init(unsigned int port);
+void lp_menu_init(void);
+void lp_menu_draw(int selected);
+
+#endif
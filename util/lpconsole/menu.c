@@ -0,0 +1,120 @@
+/*
+ * lpconsole - run the libpayload console drivers on the host
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * A payload chooser drawn the way bayou's menu.c draws it: every key
+ * press wclear()s the menu and the status line and redraws both, then
+ * wrefresh()es them.
+ */
+
+#include <libpayload.h>
+#include <curses.h>
+#include <coreboot_tables.h>
+#include "lpconsole.h"
+
+#define SCREEN_X 80
+#define SCREEN_Y 25
+
+static const struct {
+	const char *name, *desc;
+} entries[] = {
+	{ "coreinfo", "Show information about the system" },
+	{ "nvramcui", "Edit the CMOS options" },
+	{ "SeaBIOS", "Boot a legacy operating system" },
+	{ "FILO", "Boot Linux from a disk, configured in menu.lst" },
+	{ "memtest86+", "Test the memory" },
+	{ "Linux", "Boot the kernel and initramfs from the flash" },
+};
+
+#define NENTRIES (sizeof(entries) / sizeof(entries[0]))
+
+/* drivers/serial.c on an I/O port UART, see include/arch/io.h. */
+void lp_serial_init(unsigned int port)
+{
+	static struct cb_serial serial;
+
+	serial.type = CB_SERIAL_TYPE_IO_MAPPED;
+	serial.baseaddr = port;
+	serial.baud = 115200;
+	lib_sysinfo.serial = &serial;
+	lib_sysinfo.ser_ioport = port;
+	serial_init();
+}
+
+static WINDOW *menuwin, *status;
+static int menu_width = 30;
+
+void lp_menu_init(void)
+{
+	initscr();
+
+	init_pair(1, COLOR_WHITE, COLOR_RED);
+	init_pair(2, COLOR_BLACK, COLOR_WHITE);
+	init_pair(3, COLOR_BLACK, COLOR_WHITE);
+	init_pair(4, COLOR_CYAN, COLOR_WHITE);
+	init_pair(5, COLOR_WHITE, COLOR_RED);
+
+	wattrset(stdscr, COLOR_PAIR(1));
+	wclear(stdscr);
+
+	status = newwin(1, 80, 24, 0);
+	wattrset(status, COLOR_PAIR(2));
+	wclear(status);
+
+	refresh();
+
+	menuwin = newwin(NENTRIES + 3, menu_width,
+			 (SCREEN_Y - (NENTRIES + 3)) / 2,
+			 (SCREEN_X - menu_width) / 2);
+}
+
+void lp_menu_draw(int selected)
+{
+	const char *desc;
+	int i;
+
+	selected %= NENTRIES;
+
+	wattrset(menuwin, COLOR_PAIR(3));
+	wclear(menuwin);
+	wborder(menuwin, ACS_VLINE, ACS_VLINE, ACS_HLINE, ACS_HLINE,
+		ACS_ULCORNER, ACS_URCORNER, ACS_LLCORNER, ACS_LRCORNER);
+
+	wattrset(menuwin, COLOR_PAIR(4) | A_BOLD);
+	mvwprintw(menuwin, 0, (menu_width - 17) / 2, " Payload Chooser ");
+
+	for (i = 0; i < NENTRIES; i++) {
+		const char *name = entries[i].name;
+		int col = (menu_width - (2 + strlen(name))) / 2;
+
+		if (i == selected)
+			wattrset(menuwin, COLOR_PAIR(5) | A_BOLD);
+		else
+			wattrset(menuwin, COLOR_PAIR(3));
+
+		mvwprintw(menuwin, 2 + i, col, "%s", name);
+	}
+
+	wclear(status);
+	desc = entries[selected].desc;
+	mvwprintw(status, 0, (80 - strlen(desc)) / 2, "%s", desc);
+
+	wrefresh(menuwin);
+	wrefresh(status);
+}
@@ -0,0 +1,8 @@
+/*
+ * Kconfig values for building the coreboot string functions into
+ * membench. This stands in for the build/config.h a real coreboot build
+ * generates. CONFIG_SSE is set on the command line, since the x86
+ * memcpy() is built once with and once without it.
+ */
+
+#define CONFIG_ARCH_X86 1
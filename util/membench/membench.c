@@ -0,0 +1,613 @@
+/*
+ * membench - check and time coreboot's and libpayload's memcpy, memmove
+ * and memset
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * Compares every memcpy(), memmove() and memset() in membench.h with a
+ * byte loop, for every alignment of source and destination, all short
+ * lengths and every overlap, then for random ones, and times them.
+ *
+ * The x86 versions are inline assembly for a 32-bit target, so this is
+ * a 32-bit Linux program. It does not need a 32-bit C library: it starts
+ * at _start and makes its few system calls itself.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include "membench.h"
+
+#define SYS_exit		1
+#define SYS_write		4
+#define SYS_rt_sigaction	174
+#define SYS_clock_gettime	265
+
+#define SIGSEGV			11
+#define SA_SIGINFO		0x00000004
+#define SA_RESTORER		0x04000000
+#define CLOCK_MONOTONIC		1
+
+static long syscall4(long nr, long a, long b, long c, long d)
+{
+	long ret;
+
+	asm volatile ("int $0x80"
+		      : "=a" (ret)
+		      : "0" (nr), "b" (a), "c" (b), "d" (c), "S" (d)
+		      : "memory");
+	return ret;
+}
+
+static char out[4096];
+static int out_len;
+
+static void flush(void)
+{
+	syscall4(SYS_write, 1, (long)out, out_len, 0);
+	out_len = 0;
+}
+
+static void put_char(char c)
+{
+	if (out_len == sizeof(out))
+		flush();
+	out[out_len++] = c;
+}
+
+static void put_str(const char *s)
+{
+	while (*s)
+		put_char(*s++);
+}
+
+/* Prints s left-aligned in a field of width characters. */
+static void put_str_w(const char *s, int width)
+{
+	for (; *s; width--)
+		put_char(*s++);
+	while (width-- > 0)
+		put_char(' ');
+}
+
+/* Prints s right-aligned in a field of width characters. */
+static void put_str_r(const char *s, int width)
+{
+	const char *end = s;
+
+	while (*end)
+		end++;
+	while (width-- > end - s)
+		put_char(' ');
+	put_str(s);
+}
+
+/* Prints n right-aligned in a field of width characters. */
+static void put_uint(uint32_t n, int width)
+{
+	char digits[10];
+	int i = 0;
+
+	do {
+		digits[i++] = '0' + n % 10;
+		n /= 10;
+	} while (n);
+	while (width-- > i)
+		put_char(' ');
+	while (i)
+		put_char(digits[--i]);
+}
+
+void exit_program(int status) __attribute__((noreturn, used));
+void exit_program(int status)
+{
+	flush();
+	for (;;)
+		syscall4(SYS_exit, status, 0, 0, 0);
+}
+
+int main(int argc, char *argv[]) __attribute__((used));
+
+asm(".text\n"
+    ".globl _start\n"
+    "_start:\n"
+    "	xorl %ebp, %ebp\n"
+    "	movl %esp, %eax\n"
+    "	andl $-16, %esp\n"
+    "	subl $8, %esp\n"
+    "	leal 4(%eax), %edx\n"
+    "	pushl %edx\n"		/* argv */
+    "	pushl (%eax)\n"		/* argc */
+    "	call main\n"
+    "	movl %eax, (%esp)\n"
+    "	call exit_program\n");
+
+/* Microseconds on a monotonic clock. Wraps after an hour, which is fine
+ * for differences. */
+static uint32_t now_us(void)
+{
+	struct {
+		int32_t sec, nsec;
+	} ts;
+
+	syscall4(SYS_clock_gettime, CLOCK_MONOTONIC, (long)&ts, 0, 0);
+	return ts.sec * 1000000 + ts.nsec / 1000;
+}
+
+/*
+ * The SSE memcpy() reads CR4 to see whether the OS enabled SSE, which
+ * faults outside ring 0. Emulate that one instruction, mov r32, %cr4,
+ * and report OSFXSR set: Linux does enable SSE for its programs.
+ */
+static uint32_t cr4_reads;
+
+struct kernel_sigaction {
+	void (*handler)(int sig, void *info, void *context);
+	uint32_t flags;
+	void (*restorer)(void);
+	uint32_t mask[2];
+};
+
+void restore_rt(void);
+asm(".text\n"
+    "restore_rt:\n"
+    "	movl $173, %eax\n"	/* rt_sigreturn */
+    "	int $0x80\n");
+
+static void fault(int sig, void *info, void *context)
+{
+	/* uc_mcontext is at offset 20 of the i386 ucontext. */
+	uint32_t *regs = (uint32_t *)((char *)context + 20);
+	const uint8_t *ip = (const uint8_t *)regs[14];
+	/* Index in regs of eax, ecx, edx, ebx, esp, ebp, esi and edi */
+	static const uint8_t reg_index[8] = { 11, 10, 9, 8, 7, 6, 5, 4 };
+
+	if (ip[0] != 0x0f || ip[1] != 0x20 || (ip[2] & 0xf8) != 0xe0) {
+		put_str("membench: unexpected fault\n");
+		exit_program(2);
+	}
+	regs[reg_index[ip[2] & 7]] = 1 << 9;
+	regs[14] += 3;
+	cr4_reads++;
+}
+
+static void emulate_cr4(void)
+{
+	struct kernel_sigaction sa = {
+		.handler = fault,
+		.flags = SA_SIGINFO | SA_RESTORER,
+		.restorer = restore_rt,
+	};
+
+	syscall4(SYS_rt_sigaction, SIGSEGV, (long)&sa, 0,
+		 sizeof(sa.mask));
+}
+
+/* The byte loops everything is compared with, as src/lib had them. */
+static void *byte_memcpy(void *vdest, const void *vsrc, size_t bytes)
+{
+	const char *src = vsrc;
+	char *dest = vdest;
+	int i;
+
+	for (i = 0; i < (int)bytes; i++)
+		dest[i] = src[i];
+
+	return vdest;
+}
+
+static void *byte_memmove(void *vdest, const void *vsrc, size_t count)
+{
+	const char *src = vsrc;
+	char *dest = vdest;
+
+	if (dest <= src) {
+		while (count--) {
+			*dest++ = *src++;
+		}
+	} else {
+		src  += count - 1;
+		dest += count - 1;
+		while(count--) {
+			*dest-- = *src--;
+		}
+	}
+	return vdest;
+}
+
+static void *byte_memset(void *s, int c, size_t n)
+{
+	int i;
+	char *ss = (char *) s;
+
+	for (i = 0; i < (int)n; i++)
+		ss[i] = c;
+
+	return s;
+}
+
+struct impl {
+	const char *name;
+	void *(*memcpy)(void *dest, const void *src, size_t n);
+	void *(*memmove)(void *dest, const void *src, size_t n);
+	void *(*memset)(void *s, int c, size_t n);
+};
+
+static const struct impl impls[] = {
+	{ "bytes", byte_memcpy, byte_memmove, byte_memset },
+	{ "src/lib", lib_memcpy, lib_memmove, lib_memset },
+	{ "x86", x86_memcpy, x86_memmove, x86_memset },
+	{ "x86 SSE", sse_memcpy, sse_memmove, x86_memset },
+	{ "lp x86", lpx86_memcpy, lpx86_memmove, lpx86_memset },
+	{ "lp libc", lpc_memcpy, lpc_memmove, lpc_memset },
+};
+
+#define NUM_IMPLS (sizeof(impls) / sizeof(impls[0]))
+
+static uint32_t seed = 1;
+
+static uint32_t rand32(void)
+{
+	seed ^= seed << 13;
+	seed ^= seed >> 17;
+	seed ^= seed << 5;
+	return seed;
+}
+
+/*
+ * Checks run in a window of area: the bytes an operation touches, with
+ * a margin on both sides that must come out unchanged.
+ */
+#define MAX_LEN		(64 * 1024 + 17)
+#define MARGIN		64
+#define AREA		(3 * MAX_LEN + 8 * MARGIN)
+
+static uint8_t area[AREA], expected[AREA];
+static int failures;
+
+static void fill_random(uint8_t *p, size_t n)
+{
+	uint32_t r;
+
+	for (; n >= 4; n -= 4) {
+		r = rand32();
+		*p++ = r;
+		*p++ = r >> 8;
+		*p++ = r >> 16;
+		*p++ = r >> 24;
+	}
+	while (n--)
+		*p++ = rand32();
+}
+
+static int direction_flag(void)
+{
+	uint32_t flags;
+
+	asm volatile ("pushfl; popl %0" : "=r" (flags));
+	return (flags >> 10) & 1;
+}
+
+/* Compares n bytes of area with expected from start on, and the return
+ * value of the operation with what it should be. */
+static void compare(const struct impl *impl, const char *op, uint32_t start,
+		    uint32_t n, void *ret, void *want, uint32_t dst,
+		    uint32_t src, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = start; i < start + n; i++)
+		if (area[i] != expected[i])
+			break;
+	if (i == start + n && ret == want && !direction_flag())
+		return;
+
+	if (failures++ < 20) {
+		put_str(impl->name);
+		put_str(" ");
+		put_str(op);
+		put_str(": dst ");
+		put_uint(dst, 0);
+		put_str(", src ");
+		put_uint(src, 0);
+		put_str(", len ");
+		put_uint(len, 0);
+		if (i != start + n) {
+			put_str(": byte ");
+			put_uint(i, 0);
+			put_str(" differs\n");
+		} else if (ret != want) {
+			put_str(": wrong return value\n");
+		} else {
+			put_str(": left the direction flag set\n");
+		}
+	}
+	asm volatile ("cld");
+}
+
+/* Copies len bytes from src to dst, both offsets into area, which must
+ * not overlap. */
+static void check_copy(const struct impl *impl, uint32_t dst, uint32_t src,
+		       uint32_t len)
+{
+	uint32_t lo = (dst < src ? dst : src) - MARGIN;
+	uint32_t hi = (dst > src ? dst : src) + len + MARGIN;
+	void *ret;
+
+	fill_random(area + lo, hi - lo);
+	byte_memcpy(expected + lo, area + lo, hi - lo);
+	byte_memcpy(expected + dst, area + src, len);
+	ret = impl->memcpy(area + dst, area + src, len);
+	compare(impl, "memcpy", lo, hi - lo, ret, area + dst, dst, src, len);
+}
+
+/* Like check_copy(), but src and dst may overlap. */
+static void check_move(const struct impl *impl, uint32_t dst, uint32_t src,
+		       uint32_t len)
+{
+	uint32_t lo = (dst < src ? dst : src) - MARGIN;
+	uint32_t hi = (dst > src ? dst : src) + len + MARGIN;
+	void *ret;
+
+	fill_random(area + lo, hi - lo);
+	byte_memcpy(expected + lo, area + lo, hi - lo);
+	byte_memmove(expected + dst, expected + src, len);
+	ret = impl->memmove(area + dst, area + src, len);
+	compare(impl, "memmove", lo, hi - lo, ret, area + dst, dst, src, len);
+}
+
+static void check_set(const struct impl *impl, uint32_t dst, int c,
+		      uint32_t len)
+{
+	uint32_t lo = dst - MARGIN;
+	uint32_t hi = dst + len + MARGIN;
+	void *ret;
+
+	fill_random(area + lo, hi - lo);
+	byte_memcpy(expected + lo, area + lo, hi - lo);
+	byte_memset(expected + dst, c, len);
+	ret = impl->memset(area + dst, c, len);
+	compare(impl, "memset", lo, hi - lo, ret, area + dst, dst, c, len);
+}
+
+/* Lengths around the points where the versions change strategy: word
+ * and SSE thresholds, block sizes, and a tail of every size. */
+static const uint32_t long_lens[] = {
+	127, 128, 129, 255, 256, 257, 511, 512, 513, 575, 576, 577,
+	1023, 1024, 1025, 4095, 4096, 4097, 65535, 65536, MAX_LEN,
+};
+
+#define NUM_LONG_LENS (sizeof(long_lens) / sizeof(long_lens[0]))
+#define SHORT_LENS 80
+
+static uint32_t nth_len(int i)
+{
+	return i < SHORT_LENS ? i : long_lens[i - SHORT_LENS];
+}
+
+/* Every alignment of source and destination modulo 16, and every overlap
+ * of up to 16 bytes more than the length, in both directions. */
+static void check_all(const struct impl *impl)
+{
+	static const int values[] = { 0, 0xa5, 0xff, 0x1234, -1 };
+	uint32_t base = 2 * MARGIN, len, d, s;
+	int i, delta, c;
+
+	for (i = 0; i < SHORT_LENS + NUM_LONG_LENS; i++) {
+		len = nth_len(i);
+		for (d = 0; d < 16; d++) {
+			for (s = 0; s < 16; s++)
+				check_copy(impl, base + d,
+					   base + len + MARGIN + s, len);
+			for (c = 0; c < sizeof(values) / sizeof(values[0]);
+			     c++)
+				check_set(impl, base + d, values[c], len);
+		}
+
+		/* Long lengths only get the interesting overlaps. */
+		for (delta = -(int)len - 16; delta <= (int)len + 16; delta++) {
+			if (len >= SHORT_LENS && delta > -(int)len + 16 &&
+			    delta < -16)
+				delta = -16;
+			if (len >= SHORT_LENS && delta > 16 &&
+			    delta < (int)len - 16)
+				delta = len - 16;
+			for (s = 0; s < 4; s++)
+				check_move(impl, base + len + 16 + s + delta,
+					   base + len + 16 + s, len);
+		}
+	}
+}
+
+/* Random lengths, mostly short, alignments and overlaps. */
+static void check_random(const struct impl *impl, uint32_t count)
+{
+	uint32_t len, dst, src, pick;
+
+	while (count--) {
+		pick = rand32() % 10;
+		if (pick < 5)
+			len = rand32() % 64;
+		else if (pick < 8)
+			len = rand32() % 4096;
+		else
+			len = rand32() % MAX_LEN;
+		src = 2 * MARGIN + rand32() % (AREA - 4 * MARGIN - len);
+		switch (rand32() % 3) {
+		case 0:
+			dst = 2 * MARGIN + rand32() %
+			      (AREA - 4 * MARGIN - len);
+			if (dst + len > src && src + len > dst)
+				check_move(impl, dst, src, len);
+			else
+				check_copy(impl, dst, src, len);
+			break;
+		case 1:
+			dst = src + rand32() % (2 * len + 1) - len;
+			if (dst < 2 * MARGIN || dst > AREA - 2 * MARGIN - len)
+				dst = src;
+			check_move(impl, dst, src, len);
+			break;
+		default:
+			check_set(impl, src, rand32(), len);
+			break;
+		}
+	}
+}
+
+/*
+ * Timing. Every case moves BENCH_BYTES in total, in calls of one size,
+ * and is given in MB/s. Copies are from one buffer to another unless
+ * they overlap.
+ */
+#define BENCH_BYTES	(64 * 1024 * 1024)
+#define BENCH_MAX	(1024 * 1024)
+
+static uint8_t bench_a[BENCH_MAX + 64] __attribute__((aligned(64)));
+static uint8_t bench_b[BENCH_MAX + 64] __attribute__((aligned(64)));
+
+enum { COPY, MOVE_BACK, SET };
+
+static const struct bench {
+	const char *name;
+	int op;
+	uint32_t len;
+	uint32_t dst, src;
+} benches[] = {
+	{ "memcpy 16",		COPY,	   16,		0, 0 },
+	{ "memcpy 256",		COPY,	   256,		0, 0 },
+	{ "memcpy 4k",		COPY,	   4096,	0, 0 },
+	{ "memcpy 4k +1",	COPY,	   4096,	1, 0 },
+	{ "memcpy 64k",		COPY,	   65536,	0, 0 },
+	{ "memcpy 1M",		COPY,	   BENCH_MAX,	0, 0 },
+	{ "memmove 4k back",	MOVE_BACK, 4096,	8, 0 },
+	{ "memmove 1M back",	MOVE_BACK, BENCH_MAX,	8, 0 },
+	{ "memset 16",		SET,	   16,		0, 0 },
+	{ "memset 4k",		SET,	   4096,	0, 0 },
+	{ "memset 1M",		SET,	   BENCH_MAX,	0, 0 },
+};
+
+#define NUM_BENCHES (sizeof(benches) / sizeof(benches[0]))
+
+static uint32_t run_bench(const struct impl *impl, const struct bench *b)
+{
+	uint32_t calls = BENCH_BYTES / b->len, i, start, us;
+
+	start = now_us();
+	for (i = 0; i < calls; i++) {
+		switch (b->op) {
+		case COPY:
+			impl->memcpy(bench_b + b->dst, bench_a + b->src,
+				     b->len);
+			break;
+		case MOVE_BACK:
+			impl->memmove(bench_a + b->dst, bench_a + b->src,
+				      b->len);
+			break;
+		default:
+			impl->memset(bench_a + b->dst, i, b->len);
+			break;
+		}
+		/* Keep the loop from being folded into fewer calls. */
+		asm volatile ("" : : : "memory");
+	}
+	us = now_us() - start;
+	return us ? (calls * b->len) / us : 0;
+}
+
+static void bench_all(void)
+{
+	int i, j;
+
+	put_str_w("MB/s", 16);
+	for (j = 0; j < NUM_IMPLS; j++) {
+		put_char(' ');
+		put_str_r(impls[j].name, 8);
+	}
+	put_char('\n');
+
+	for (i = 0; i < NUM_BENCHES; i++) {
+		put_str_w(benches[i].name, 16);
+		for (j = 0; j < NUM_IMPLS; j++) {
+			put_char(' ');
+			put_uint(run_bench(&impls[j], &benches[i]), 8);
+		}
+		put_char('\n');
+		flush();
+	}
+}
+
+static void usage(void)
+{
+	put_str("usage: membench [-c] [-n count] [-s seed]\n"
+		"  -c  check only, do not time\n"
+		"  -n  random checks per version (20000)\n"
+		"  -s  random seed (1)\n");
+}
+
+static uint32_t parse_uint(const char *s)
+{
+	uint32_t n = 0;
+
+	while (*s >= '0' && *s <= '9')
+		n = n * 10 + *s++ - '0';
+	return n;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t count = 20000;
+	int check_only = 0, i;
+
+	for (i = 1; i < argc; i++) {
+		if (argv[i][0] == '-' && argv[i][1] == 'c' && !argv[i][2]) {
+			check_only = 1;
+		} else if (argv[i][0] == '-' && argv[i][1] == 'n' &&
+			   !argv[i][2] && i + 1 < argc) {
+			count = parse_uint(argv[++i]);
+		} else if (argv[i][0] == '-' && argv[i][1] == 's' &&
+			   !argv[i][2] && i + 1 < argc) {
+			seed = parse_uint(argv[++i]) | 1;
+		} else {
+			usage();
+			return 1;
+		}
+	}
+
+	emulate_cr4();
+
+	/* The byte loops are the reference, so they are not checked. */
+	for (i = 1; i < NUM_IMPLS; i++) {
+		int before = failures;
+
+		check_all(&impls[i]);
+		check_random(&impls[i], count);
+		put_str_w(impls[i].name, 9);
+		put_str(failures == before ? "ok\n" : "FAILED\n");
+		flush();
+	}
+	if (!cr4_reads) {
+		put_str("x86 SSE: SSE path never taken\n");
+		failures++;
+	}
+	if (failures)
+		return 1;
+
+	if (!check_only)
+		bench_all();
+	return 0;
+}
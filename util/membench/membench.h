@@ -0,0 +1,54 @@
+/*
+ * membench - check and time coreboot's and libpayload's memcpy, memmove
+ * and memset
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * The string functions under test. Each source file is built with its
+ * functions renamed by the Makefile, so the versions can live in one
+ * program next to each other.
+ */
+
+#ifndef MEMBENCH_H
+#define MEMBENCH_H
+
+#include <stddef.h>
+
+/* src/arch/x86/lib, without and with CONFIG_SSE */
+void *x86_memcpy(void *dest, const void *src, size_t n);
+void *x86_memmove(void *dest, const void *src, size_t n);
+void *x86_memset(void *s, int c, size_t n);
+void *sse_memcpy(void *dest, const void *src, size_t n);
+void *sse_memmove(void *dest, const void *src, size_t n);
+
+/* src/lib, used where there is no arch version */
+void *lib_memcpy(void *dest, const void *src, size_t n);
+void *lib_memmove(void *dest, const void *src, size_t n);
+void *lib_memset(void *s, int c, size_t n);
+
+/* payloads/libpayload/arch/x86/string.c */
+void *lpx86_memcpy(void *dest, const void *src, size_t n);
+void *lpx86_memmove(void *dest, const void *src, size_t n);
+void *lpx86_memset(void *s, int c, size_t n);
+
+/* payloads/libpayload/libc/memory.c, the defaults other arches get */
+void *lpc_memcpy(void *dest, const void *src, size_t n);
+void *lpc_memmove(void *dest, const void *src, size_t n);
+void *lpc_memset(void *s, int c, size_t n);
+
+#endif
@@ -0,0 +1,489 @@
+/*
+ * usbsim - run the libpayload USB stack against simulated controllers
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * An EHCI controller, as far as libpayload uses one: the capability and
+ * operational registers with their write semantics, the root ports with
+ * reset and companion handover, and the schedules. Once per frame the
+ * periodic list entry is walked; in between, the async ring is run one
+ * transaction at a time, each taking the bus time of its packet. Queue
+ * heads advance through their qTDs the way EHCI 1.0 section 4.10 says,
+ * so toggles, short packets and alternate next pointers behave as on
+ * hardware. Schedule enable bits take effect at the next microframe.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "usbsim.h"
+#include "sim.h"
+
+#define MAX_PORTS	15
+#define UFRAME_NS	(125 * NS_PER_US)
+#define FRAME_NS	NS_PER_MS
+
+/* Bus time of a transaction. High-speed packets carry about 60 bytes per
+ * microsecond; full- and low-speed ones go through a transaction
+ * translator, with the start and the complete split in two different
+ * microframes. */
+#define HS_PACKET_NS	1000
+#define HS_NS_PER_BYTE	17
+#define SPLIT_NS	(2 * UFRAME_NS)
+#define FS_NS_PER_BYTE	667
+#define LS_NS_PER_BYTE	5333
+
+#define CAPLENGTH	0x20
+#define HCSPARAMS	0x04
+#define USBCMD		(CAPLENGTH + 0x00)
+#define USBSTS		(CAPLENGTH + 0x04)
+#define FRINDEX		(CAPLENGTH + 0x0c)
+#define PERIODICLISTBASE (CAPLENGTH + 0x14)
+#define ASYNCLISTADDR	(CAPLENGTH + 0x18)
+#define CONFIGFLAG	(CAPLENGTH + 0x40)
+#define PORTSC(i)	(CAPLENGTH + 0x44 + 4 * (i))
+
+#define CMD_RS		(1 << 0)
+#define CMD_HCRESET	(1 << 1)
+#define CMD_PSE		(1 << 4)
+#define CMD_ASE		(1 << 5)
+#define STS_HCH		(1 << 12)
+#define STS_PSS		(1 << 14)
+#define STS_ASS		(1 << 15)
+#define STS_RWC		0x3f
+
+#define PS_CCS		(1 << 0)
+#define PS_CSC		(1 << 1)
+#define PS_PE		(1 << 2)
+#define PS_PEC		(1 << 3)
+#define PS_OCC		(1 << 5)
+#define PS_PR		(1 << 8)
+#define PS_LINE_K	(1 << 10)
+#define PS_LINE_J	(2 << 10)
+#define PS_LINE		(3 << 10)
+#define PS_PP		(1 << 12)
+#define PS_PO		(1 << 13)
+#define PS_RWC		(PS_CSC | PS_PEC | PS_OCC)
+
+#define TOK_XACTERR	(1 << 3)
+#define TOK_HALTED	(1 << 6)
+#define TOK_ACTIVE	(1 << 7)
+#define TOK_PID(t)	((t) >> 8 & 3)
+#define TOK_CERR(t)	((t) >> 10 & 3)
+#define TOK_BYTES(t)	((t) >> 16 & 0x7fff)
+#define TOK_TOGGLE	(1U << 31)
+
+enum { PID_OUT, PID_IN, PID_SETUP };
+
+#define QH_DTC		(1 << 14)
+
+struct qtd {
+	uint32_t next, alt, token;
+	uint32_t buf[5], buf_hi[5];
+};
+
+struct qh {
+	uint32_t link, epchar, epcaps, current;
+	struct qtd ov;
+};
+
+struct ehci {
+	uint8_t *regs;
+	int nports;
+	struct vdev *dev[MAX_PORTS];
+	uint64_t t;		/* how far the schedules have run */
+	uint64_t started;	/* when RS was set, for FRINDEX */
+	uint64_t flip_at;	/* when USBSTS follows PSE and ASE */
+	uint64_t frame;		/* the last frame the periodic list ran in */
+};
+
+#define REG(e, off)	(*(uint32_t *)((e)->regs + (off)))
+
+static void port_update(struct ehci *e, int i)
+{
+	uint32_t ps = REG(e, PORTSC(i));
+	const int present = e->dev[i] && (ps & PS_PP) && !(ps & PS_PO);
+
+	if (present != !!(ps & PS_CCS)) {
+		ps ^= PS_CCS;
+		ps |= PS_CSC;
+		if (!present)
+			ps &= ~PS_PE;
+	}
+
+	/* Until the port is enabled, the line state tells what's there. */
+	ps &= ~PS_LINE;
+	if (present && !(ps & PS_PE))
+		ps |= vdev_speed(e->dev[i]) == SPEED_LOW ? PS_LINE_K : PS_LINE_J;
+	REG(e, PORTSC(i)) = ps;
+}
+
+static void ehci_reset(struct ehci *e)
+{
+	int i;
+
+	memset(e->regs + CAPLENGTH, 0, 4096 - CAPLENGTH);
+	REG(e, USBCMD) = 0x00080000;
+	REG(e, USBSTS) = STS_HCH;
+	/* Without CONFIGFLAG, the companion controllers own the ports. */
+	for (i = 0; i < e->nports; i++) {
+		REG(e, PORTSC(i)) = PS_PO;
+		port_update(e, i);
+	}
+	e->frame = ~0ULL;
+}
+
+static void port_write(struct ehci *e, int i, uint32_t old)
+{
+	const uint32_t val = REG(e, PORTSC(i));
+	uint32_t ps = old & ~(val & PS_RWC);
+
+	ps = (ps & ~(PS_PP | PS_PO | PS_PR)) | (val & (PS_PP | PS_PO | PS_PR));
+	/* PE can only be cleared by software */
+	if (!(val & PS_PE))
+		ps &= ~PS_PE;
+
+	if ((val & PS_PR) && !(old & PS_PR)) {
+		ps &= ~PS_PE;
+	} else if (!(val & PS_PR) && (old & PS_PR) && (ps & PS_CCS)) {
+		/* End of reset: only a high-speed device chirps back and
+		 * gets the port enabled, anything else is for a companion. */
+		vdev_bus_reset(e->dev[i]);
+		if (vdev_speed(e->dev[i]) == SPEED_HIGH)
+			ps |= PS_PE;
+	}
+	REG(e, PORTSC(i)) = ps;
+	port_update(e, i);
+}
+
+static void ehci_read(void *ctx, uint32_t off)
+{
+	struct ehci *e = ctx;
+
+	if (off == FRINDEX && !(REG(e, USBSTS) & STS_HCH))
+		REG(e, FRINDEX) = (sim_now - e->started) / UFRAME_NS & 0x3fff;
+}
+
+static void ehci_write(void *ctx, uint32_t off, uint32_t old)
+{
+	struct ehci *e = ctx;
+	const uint32_t val = REG(e, off);
+	uint32_t sts;
+	int i;
+
+	if (off < CAPLENGTH) {
+		REG(e, off) = old;
+		return;
+	}
+
+	switch (off) {
+	case USBCMD:
+		if (val & CMD_HCRESET) {
+			ehci_reset(e);
+			break;
+		}
+		sts = REG(e, USBSTS);
+		if ((val ^ old) & CMD_RS) {
+			if (val & CMD_RS) {
+				sts &= ~STS_HCH;
+				e->started = sim_now;
+				if (e->t < sim_now)
+					e->t = sim_now;
+			} else {
+				sts |= STS_HCH;
+				sts &= ~(STS_PSS | STS_ASS);
+			}
+		}
+		if ((val ^ old) & (CMD_PSE | CMD_ASE))
+			e->flip_at = (sim_now / UFRAME_NS + 1) * UFRAME_NS;
+		REG(e, USBSTS) = sts;
+		break;
+	case USBSTS:
+		REG(e, USBSTS) = old & ~(val & STS_RWC);
+		break;
+	case CONFIGFLAG:
+		for (i = 0; i < e->nports; i++) {
+			if (val & 1)
+				REG(e, PORTSC(i)) &= ~PS_PO;
+			else
+				REG(e, PORTSC(i)) |= PS_PO;
+			port_update(e, i);
+		}
+		break;
+	default:
+		if (off >= PORTSC(0) && off < PORTSC(e->nports))
+			port_write(e, (off - PORTSC(0)) / 4, old);
+		break;
+	}
+}
+
+static struct vdev *route(struct ehci *e, int address)
+{
+	struct vdev *dev;
+	int i;
+
+	for (i = 0; i < e->nports; i++) {
+		if (!(REG(e, PORTSC(i)) & PS_PE))
+			continue;
+		dev = vdev_route(e->dev[i], address, e->t);
+		if (dev)
+			return dev;
+	}
+	return NULL;
+}
+
+/* Copies between a packet and the pages of a qTD's buffer. */
+static void td_copy(struct qtd *td, int offset, uint8_t *pkt, int len,
+		    int to_td)
+{
+	uint32_t pos = (td->buf[0] & 0xfff) + offset;
+
+	while (len > 0) {
+		const int page = pos >> 12;
+		int chunk = 4096 - (pos & 0xfff);
+		uint8_t *mem;
+
+		if (page > 4)
+			sim_die("ehci: qTD buffer overrun\n");
+		mem = phys((td->buf[page] & ~0xfff) + (pos & 0xfff));
+		if (chunk > len)
+			chunk = len;
+		if (to_td)
+			memcpy(mem, pkt, chunk);
+		else
+			memcpy(pkt, mem, chunk);
+		pkt += chunk;
+		pos += chunk;
+		len -= chunk;
+	}
+}
+
+static uint64_t bus_ns(int speed, int bytes)
+{
+	if (speed == SPEED_HIGH)
+		return HS_PACKET_NS + bytes * HS_NS_PER_BYTE;
+	return SPLIT_NS + bytes * (speed == SPEED_LOW ? LS_NS_PER_BYTE
+						       : FS_NS_PER_BYTE);
+}
+
+/* One transaction for the qTD in the overlay. Returns 0 if the endpoint
+ * NAKed, 1 if anything happened. */
+static int transact(struct ehci *e, struct qh *qh, struct qtd *td,
+		    uint64_t *retry)
+{
+	const uint32_t epchar = qh->epchar;
+	const int address = epchar & 0x7f, ep = epchar >> 8 & 0xf;
+	const int speed = epchar >> 12 & 3, mps = epchar >> 16 & 0x7ff;
+	uint32_t tok = qh->ov.token;
+	const int pid = TOK_PID(tok), toggle = tok >> 31;
+	int left = TOK_BYTES(tok);
+	const int done = TOK_BYTES(td->token) - left;
+	int len = left < mps ? left : mps;
+	uint8_t pkt[2048];
+	struct vdev *dev;
+	int ret;
+
+	dev = route(e, address);
+	if (!dev) {
+		/* Nobody answers. Each timeout costs an error count; with
+		 * CERR at 0 the controller keeps trying forever. */
+		e->t += bus_ns(speed, 0);
+		if (TOK_CERR(tok) == 1)
+			tok = (tok | TOK_XACTERR | TOK_HALTED) & ~TOK_ACTIVE;
+		if (TOK_CERR(tok))
+			tok -= 1 << 10;
+		goto out;
+	}
+
+	switch (pid) {
+	case PID_SETUP:
+		td_copy(td, 0, pkt, 8, 0);
+		ret = vdev_setup(dev, pkt, e->t);
+		if (ret >= 0)
+			ret = 8;
+		break;
+	case PID_IN:
+		ret = vdev_in(dev, ep, toggle, pkt, len, e->t, retry);
+		if (ret > len)
+			sim_die("ehci: babble\n");
+		if (ret > 0)
+			td_copy(td, done, pkt, ret, 1);
+		break;
+	case PID_OUT:
+		td_copy(td, done, pkt, len, 0);
+		ret = vdev_out(dev, ep, toggle, pkt, len, e->t, retry);
+		if (ret >= 0)
+			ret = len;
+		break;
+	default:
+		sim_die("ehci: invalid PID\n");
+	}
+
+	if (ret == USB_NAK)
+		return 0;
+	if (ret == USB_STALL) {
+		e->t += bus_ns(speed, 0);
+		tok = (tok | TOK_HALTED) & ~TOK_ACTIVE;
+		goto out;
+	}
+
+	e->t += bus_ns(speed, ret);
+	left -= ret;
+	tok ^= TOK_TOGGLE;
+	if (!left || (pid == PID_IN && ret < mps))
+		tok &= ~TOK_ACTIVE;
+	tok = (tok & ~(0x7fff << 16)) | left << 16;
+out:
+	qh->ov.token = tok;
+	/* The controller writes the qTD back when it's done with it. */
+	if (!(tok & TOK_ACTIVE))
+		td->token = tok;
+	return 1;
+}
+
+/* Runs the queue head's current qTD, or moves on to the next one first. */
+static int qh_run(struct ehci *e, struct qh *qh, uint64_t *retry)
+{
+	struct qtd *const ov = &qh->ov, *td;
+	uint32_t next, tok;
+
+	if (!(ov->token & TOK_ACTIVE)) {
+		if (ov->token & TOK_HALTED)
+			return 0;
+		/* after a short packet, the alternate pointer is taken */
+		next = (TOK_BYTES(ov->token) && !(ov->alt & 1)) ? ov->alt
+								  : ov->next;
+		if (next & 1)
+			return 0;
+		td = phys(next & ~31);
+		if (!(td->token & TOK_ACTIVE))
+			return 0;
+		qh->current = next & ~31;
+		ov->next = td->next;
+		ov->alt = td->alt;
+		tok = td->token;
+		if (!(qh->epchar & QH_DTC))
+			tok = (tok & ~TOK_TOGGLE) | (ov->token & TOK_TOGGLE);
+		ov->token = tok;
+		memcpy(ov->buf, td->buf, sizeof(ov->buf));
+	}
+	return transact(e, qh, phys(qh->current), retry);
+}
+
+static int async_pass(struct ehci *e, uint64_t *retry)
+{
+	const uint32_t head = REG(e, ASYNCLISTADDR) & ~31;
+	uint32_t link = head;
+	int n = 0, progress = 0;
+
+	do {
+		struct qh *qh = phys(link);
+		progress |= qh_run(e, qh, retry);
+		if (qh->link & 1)
+			break;
+		link = qh->link & ~31;
+	} while (link != head && ++n < 64);
+	return progress;
+}
+
+/* Interrupt queue heads run in microframe 0 of the frames they are
+ * linked into. */
+static void periodic(struct ehci *e, uint64_t frame)
+{
+	const uint32_t *list = phys(REG(e, PERIODICLISTBASE) & ~0xfff);
+	uint32_t link = list[frame & 1023];
+	uint64_t retry;
+	int n = 0;
+
+	while (!(link & 1) && n++ < 64) {
+		struct qh *qh;
+		if ((link >> 1 & 3) != 1)
+			sim_die("ehci: only QHs in the periodic list\n");
+		qh = phys(link & ~31);
+		if (qh->epcaps & 0xff)
+			qh_run(e, qh, &retry);
+		link = qh->link;
+	}
+}
+
+static void ehci_run(void *ctx, uint64_t until)
+{
+	struct ehci *e = ctx;
+
+	while (e->t < until) {
+		const uint32_t cmd = REG(e, USBCMD);
+		const uint32_t sts = REG(e, USBSTS);
+		const uint32_t want = (cmd >> 4 & 3) << 14;
+		uint64_t next = until, retry = ~0ULL;
+
+		if (!(cmd & CMD_RS)) {
+			e->t = until;
+			break;
+		}
+
+		if ((sts & (STS_PSS | STS_ASS)) != want) {
+			if (e->t >= e->flip_at) {
+				REG(e, USBSTS) = (sts & ~(STS_PSS | STS_ASS)) |
+						 want;
+				continue;
+			}
+			if (e->flip_at < next)
+				next = e->flip_at;
+		}
+
+		if (sts & STS_PSS) {
+			const uint64_t frame = e->t / FRAME_NS;
+			if (frame != e->frame) {
+				e->frame = frame;
+				periodic(e, frame);
+				continue;
+			}
+			if ((frame + 1) * FRAME_NS < next)
+				next = (frame + 1) * FRAME_NS;
+		}
+
+		if (sts & STS_ASS) {
+			if (async_pass(e, &retry))
+				continue;
+			if (retry < next)
+				next = retry;
+		}
+
+		e->t = next > e->t ? next : e->t + HS_PACKET_NS;
+	}
+}
+
+static const struct mmio_ops ehci_ops = {
+	.read = ehci_read,
+	.write = ehci_write,
+	.run = ehci_run,
+};
+
+uint32_t ehci_create(struct vdev **ports, int nports)
+{
+	struct ehci *e = calloc(1, sizeof(*e));
+	uint32_t base;
+
+	e->nports = nports;
+	memcpy(e->dev, ports, nports * sizeof(*ports));
+	base = mmio_map(4096, &ehci_ops, e, &e->regs);
+
+	REG(e, 0) = 0x0100 << 16 | CAPLENGTH;
+	REG(e, HCSPARAMS) = 1 << 12 | 0x10 | nports;	/* one companion, PPC */
+	ehci_reset(e);
+	return base;
+}
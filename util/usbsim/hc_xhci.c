@@ -0,0 +1,267 @@
+/*
+ * usbsim - run the libpayload USB stack against simulated controllers
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * An xHCI controller, as far as libpayload's driver gets with one: the
+ * register blocks, a command ring that completes No Op commands, one
+ * event ring segment, and root ports that show their devices as
+ * connected. The driver doesn't enable slots yet, so no transfer rings.
+ * Port change events are posted while the controller runs, as a change
+ * bit goes from 0 to 1; the ones present at reset only set PCD.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+#define MAX_PORTS	15
+#define UFRAME_NS	(125 * NS_PER_US)
+#define COMMAND_NS	(5 * NS_PER_US)
+
+#define CAPLENGTH	0x80
+#define HCSPARAMS1	0x04
+#define DBOFF		0x14
+#define RTSOFF		0x18
+
+#define USBCMD		(CAPLENGTH + 0x00)
+#define USBSTS		(CAPLENGTH + 0x04)
+#define PAGESIZE	(CAPLENGTH + 0x08)
+#define CRCR_LO		(CAPLENGTH + 0x18)
+#define PORTSC(i)	(CAPLENGTH + 0x400 + 0x10 * (i))
+
+#define RUNTIME		0x600
+#define MFINDEX		(RUNTIME + 0x00)
+#define IMAN		(RUNTIME + 0x20)
+#define ERSTBA_LO	(RUNTIME + 0x30)
+#define DOORBELL	0x800
+
+#define CMD_RS		(1 << 0)
+#define CMD_HCRST	(1 << 1)
+#define STS_HCH		(1 << 0)
+#define STS_EINT	(1 << 3)
+#define STS_PCD		(1 << 4)
+#define STS_RWC		((1 << 2) | STS_EINT | STS_PCD | (1 << 10))
+#define CRCR_RCS	(1 << 0)
+#define CRCR_CRR	(1 << 3)
+
+#define PS_CCS		(1 << 0)
+#define PS_PED		(1 << 1)
+#define PS_PP		(1 << 9)
+#define PS_CSC		(1 << 17)
+#define PS_RWC		(0x7f << 17)
+
+#define TRB_TYPE(dw3)	((dw3) >> 10 & 0x3f)
+#define TRB_LINK	6
+#define TRB_CMD_NOOP	23
+#define TRB_EV_CMD_CMPL	33
+#define TRB_EV_PORTSC	34
+#define CC_SUCCESS	1
+#define CC_TRB_ERROR	5
+
+struct trb {
+	uint32_t dw[4];
+};
+
+struct erst_entry {
+	uint32_t base_lo, base_hi, size, rsvd;
+};
+
+struct xhci {
+	uint8_t *regs;
+	int nports;
+	struct vdev *dev[MAX_PORTS];
+	uint64_t started;
+	uint64_t command_at;	/* when the doorbell rang, if it did */
+	int command_pending;
+	uint32_t cmd_deq;
+	int cmd_ccs;
+	uint32_t ev_base, ev_size, ev_enq;
+	int ev_pcs;
+};
+
+#define REG(x, off)	(*(uint32_t *)((x)->regs + (off)))
+
+static void post_event(struct xhci *x, uint32_t ptr, uint32_t code,
+		       uint32_t type)
+{
+	struct trb *ev;
+
+	if (!x->ev_size)
+		return;
+	ev = phys(x->ev_enq);
+	ev->dw[0] = ptr;
+	ev->dw[1] = 0;
+	ev->dw[2] = code << 24;
+	ev->dw[3] = type << 10 | x->ev_pcs;
+
+	x->ev_enq += sizeof(*ev);
+	if (x->ev_enq == x->ev_base + x->ev_size * sizeof(*ev)) {
+		x->ev_enq = x->ev_base;
+		x->ev_pcs ^= 1;
+	}
+	REG(x, USBSTS) |= STS_EINT;
+	REG(x, IMAN) |= 1;
+}
+
+static void port_change(struct xhci *x, int i, uint32_t old)
+{
+	const uint32_t ps = REG(x, PORTSC(i));
+
+	if ((ps & PS_RWC & ~old) == 0)
+		return;
+	REG(x, USBSTS) |= STS_PCD;
+	if (REG(x, USBCMD) & CMD_RS)
+		post_event(x, (i + 1) << 24, CC_SUCCESS, TRB_EV_PORTSC);
+}
+
+static void xhci_reset(struct xhci *x)
+{
+	int i;
+
+	memset(x->regs + CAPLENGTH, 0, 4096 - CAPLENGTH);
+	REG(x, USBSTS) = STS_HCH;
+	REG(x, PAGESIZE) = 1;
+	for (i = 0; i < x->nports; i++) {
+		REG(x, PORTSC(i)) = PS_PP;
+		if (x->dev[i])
+			REG(x, PORTSC(i)) |= PS_CCS | PS_CSC;
+		port_change(x, i, 0);
+	}
+	x->command_pending = 0;
+	x->ev_size = 0;
+}
+
+static void run_commands(struct xhci *x)
+{
+	for (;;) {
+		struct trb *trb = phys(x->cmd_deq);
+		const uint32_t dw3 = trb->dw[3];
+
+		if ((dw3 & 1) != x->cmd_ccs)
+			break;
+		if (TRB_TYPE(dw3) == TRB_LINK) {
+			x->cmd_deq = trb->dw[0] & ~15;
+			if (dw3 & 2)
+				x->cmd_ccs ^= 1;
+			continue;
+		}
+		post_event(x, x->cmd_deq, TRB_TYPE(dw3) == TRB_CMD_NOOP ?
+			   CC_SUCCESS : CC_TRB_ERROR, TRB_EV_CMD_CMPL);
+		x->cmd_deq += sizeof(*trb);
+	}
+}
+
+static void xhci_read(void *ctx, uint32_t off)
+{
+	struct xhci *x = ctx;
+
+	if (off == MFINDEX && (REG(x, USBCMD) & CMD_RS))
+		REG(x, MFINDEX) = (sim_now - x->started) / UFRAME_NS & 0x3fff;
+}
+
+static void xhci_write(void *ctx, uint32_t off, uint32_t old)
+{
+	struct xhci *x = ctx;
+	const uint32_t val = REG(x, off);
+	struct erst_entry *erst;
+	int i;
+
+	if (off < CAPLENGTH) {
+		REG(x, off) = old;
+		return;
+	}
+
+	switch (off) {
+	case USBCMD:
+		if (val & CMD_HCRST) {
+			xhci_reset(x);
+		} else if ((val ^ old) & CMD_RS) {
+			REG(x, USBSTS) ^= STS_HCH;
+			x->started = sim_now;
+		}
+		break;
+	case USBSTS:
+		REG(x, USBSTS) = old & ~(val & STS_RWC);
+		break;
+	case CRCR_LO:
+		/* Only the ring running flag reads back. */
+		if (!(REG(x, CRCR_LO) & CRCR_CRR)) {
+			x->cmd_deq = val & ~63;
+			x->cmd_ccs = val & CRCR_RCS;
+		}
+		REG(x, CRCR_LO) = old & CRCR_CRR;
+		break;
+	case ERSTBA_LO:
+		erst = phys(val & ~63);
+		x->ev_base = x->ev_enq = erst->base_lo;
+		x->ev_size = erst->size;
+		x->ev_pcs = 1;
+		break;
+	case DOORBELL:
+		if (REG(x, USBCMD) & CMD_RS) {
+			REG(x, CRCR_LO) |= CRCR_CRR;
+			x->command_at = sim_now + COMMAND_NS;
+			x->command_pending = 1;
+		}
+		break;
+	default:
+		if (off >= PORTSC(0) && off < PORTSC(x->nports) &&
+		    (off & 0xf) == 0) {
+			i = (off - PORTSC(0)) / 0x10;
+			/* Writing PED disables the port. */
+			REG(x, off) = (old & ~(val & (PS_RWC | PS_PED))) |
+				      (val & PS_PP);
+			port_change(x, i, old);
+		}
+		break;
+	}
+}
+
+static void xhci_run(void *ctx, uint64_t until)
+{
+	struct xhci *x = ctx;
+
+	if (x->command_pending && x->command_at <= until) {
+		x->command_pending = 0;
+		run_commands(x);
+	}
+}
+
+static const struct mmio_ops xhci_ops = {
+	.read = xhci_read,
+	.write = xhci_write,
+	.run = xhci_run,
+};
+
+uint32_t xhci_create(struct vdev **ports, int nports)
+{
+	struct xhci *x = calloc(1, sizeof(*x));
+	uint32_t base;
+
+	x->nports = nports;
+	memcpy(x->dev, ports, nports * sizeof(*ports));
+	base = mmio_map(4096, &xhci_ops, x, &x->regs);
+
+	REG(x, 0) = 0x0100 << 16 | CAPLENGTH;
+	REG(x, HCSPARAMS1) = nports << 24 | 1 << 8 | 8;	/* 8 slots */
+	REG(x, DBOFF) = DOORBELL;
+	REG(x, RTSOFF) = RUNTIME;
+	xhci_reset(x);
+	return base;
+}
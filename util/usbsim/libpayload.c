@@ -0,0 +1,233 @@
+/*
+ * usbsim - run the libpayload USB stack against simulated controllers
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * The libpayload half of usbsim: the glue the USB drivers expect from the
+ * rest of libpayload, and the calls the scenarios in sim.c drive the
+ * stack with. The drivers are used as they are, the same way a payload
+ * would after usb_initialize().
+ */
+
+#include <libpayload.h>
+#include <usb/usb.h>
+#include <usb/usbmsc.h>
+#include <usb/usbdisk.h>
+#include "ehci.h"
+#include "xhci.h"
+#include "usbsim.h"
+
+/* The arena sim.c allocates from is identity mapped below 4GB. */
+unsigned long virtual_offset = 0;
+
+extern hci_t *usb_hcs;
+
+void (*reset_handler)(void) = NULL;
+
+void *malloc(size_t size)
+{
+	return sim_memalign(16, size);
+}
+
+void *memalign(size_t align, size_t size)
+{
+	return sim_memalign(align, size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+	void *ptr = sim_memalign(16, nmemb * size);
+
+	if (ptr)
+		memset(ptr, 0, nmemb * size);
+	return ptr;
+}
+
+void free(void *ptr)
+{
+	sim_free(ptr);
+}
+
+int vprintf(const char *fmt, va_list args)
+{
+	sim_vprintf(fmt, args);
+	return 0;
+}
+
+int printf(const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	sim_vprintf(fmt, args);
+	va_end(args);
+	return 0;
+}
+
+void fatal(const char *msg)
+{
+	sim_die(msg);
+}
+
+void udelay(unsigned int n)
+{
+	sim_udelay(n);
+}
+
+void mdelay(unsigned int n)
+{
+	sim_udelay(n * 1000);
+}
+
+void delay(unsigned int n)
+{
+	sim_udelay(n * 1000000);
+}
+
+u8 pci_read_config8(u32 device, u16 reg)
+{
+	return sim_pci_read(device, reg, 1);
+}
+
+u16 pci_read_config16(u32 device, u16 reg)
+{
+	return sim_pci_read(device, reg, 2);
+}
+
+u32 pci_read_config32(u32 device, u16 reg)
+{
+	return sim_pci_read(device, reg, 4);
+}
+
+void pci_write_config8(u32 device, u16 reg, u8 val)
+{
+	sim_pci_write(device, reg, 1, val);
+}
+
+void pci_write_config16(u32 device, u16 reg, u16 val)
+{
+	sim_pci_write(device, reg, 2, val);
+}
+
+void pci_write_config32(u32 device, u16 reg, u32 val)
+{
+	sim_pci_write(device, reg, 4, val);
+}
+
+/* usbhid registers itself as a console, lp_getchar() reads it directly. */
+void console_add_input_driver(struct console_input_driver *in)
+{
+}
+
+#define MAX_DISKS 4
+static usbdev_t *disks[MAX_DISKS];
+static int ndisks;
+
+void usbdisk_create(usbdev_t *dev)
+{
+	if (ndisks < MAX_DISKS)
+		disks[ndisks++] = dev;
+}
+
+void usbdisk_remove(usbdev_t *dev)
+{
+	int i;
+
+	for (i = 0; i < ndisks; i++) {
+		if (disks[i] == dev) {
+			disks[i] = disks[--ndisks];
+			break;
+		}
+	}
+}
+
+void lp_init_ehci(unsigned int pcidev)
+{
+	ehci_init(pcidev);
+}
+
+void lp_init_xhci(unsigned int pcidev)
+{
+	xhci_init(pcidev);
+}
+
+/* Takes bulk_batch away from every controller, so usbmsc falls back to
+ * one command at a time. */
+void lp_set_batching(int enable)
+{
+	static int (*saved[8])(bulk_xfer_t *, int);
+	hci_t *hc;
+	int i;
+
+	for (hc = usb_hcs, i = 0; hc && i < 8; hc = hc->next, i++) {
+		if (!enable && hc->bulk_batch) {
+			saved[i] = hc->bulk_batch;
+			hc->bulk_batch = NULL;
+		} else if (enable && saved[i]) {
+			hc->bulk_batch = saved[i];
+		}
+	}
+}
+
+void lp_poll(void)
+{
+	usb_poll();
+}
+
+/* Counts the devices that have an address, not the root hubs. */
+int lp_attached(void)
+{
+	hci_t *hc;
+	int i, n = 0;
+
+	for (hc = usb_hcs; hc; hc = hc->next) {
+		for (i = 1; i < 128; i++) {
+			if (hc->devices[i] && hc->devices[i]->address > 0)
+				n++;
+		}
+	}
+	return n;
+}
+
+int lp_disks(void)
+{
+	return ndisks;
+}
+
+unsigned long long lp_disk_blocks(int disk)
+{
+	return MSC_INST(disks[disk])->numblocks;
+}
+
+int lp_disk_read(int disk, unsigned long long lba, int count, void *buf)
+{
+	return readwrite_blocks(disks[disk], lba, count,
+				cbw_direction_data_in, buf);
+}
+
+int lp_getchar(void)
+{
+	if (!usbhid_havechar())
+		return -1;
+	return usbhid_getchar();
+}
+
+void lp_exit(void)
+{
+	usb_exit();
+}
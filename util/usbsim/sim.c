@@ -0,0 +1,685 @@
+/*
+ * usbsim - run the libpayload USB stack against simulated controllers
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * The host half: memory the drivers can hand to a controller, PCI config
+ * space, the MMIO trap, the clock, and the scenarios.
+ *
+ * The drivers keep physical addresses in 32-bit fields, so everything
+ * they touch lives in an arena below 4GB, including the stack of the
+ * thread they run on. Register blocks are mapped twice: once without
+ * access rights at the address the BAR points to, once for the model.
+ * An access to the first mapping faults; the handler runs the read hook,
+ * opens the page and single-steps the instruction, and the trap after it
+ * closes the page again and runs the write hook. This only works on
+ * x86-64 Linux.
+ */
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include "usbsim.h"
+#include "sim.h"
+
+#define ARENA_SIZE	(256 << 20)
+#define STACK_SIZE	(1 << 20)
+#define MAX_REGIONS	4
+#define MAX_NODES	32
+#define MAX_ROOT_PORTS	8
+
+/* While waiting for a key or a device, the payload polls this often. */
+#define POLL_GAP_US	100
+
+/* Register accesses are slow: reads wait for the completion, writes are
+ * posted. */
+#define MMIO_READ_NS	500
+#define MMIO_WRITE_NS	100
+
+#define PCI_DEV(b, d, f) (0x80000000 | (b) << 16 | (d) << 11 | (f) << 8)
+#define EHCI_PCI	PCI_DEV(0, 0x1d, 0)
+#define XHCI_PCI	PCI_DEV(0, 0x14, 0)
+
+uint64_t sim_now;
+struct sim_stats stats;
+
+static int verbose;
+
+/* -------- memory -------- */
+
+/* Blocks come in powers of two and are aligned to their size, so any
+ * alignment up to the size is free. cls[] remembers the class of each
+ * block by its 16-byte granule. */
+static uint8_t *arena, *arena_top;
+static uint8_t *cls;
+static void *freelist[32];
+
+void *sim_memalign(unsigned long align, unsigned long size)
+{
+	unsigned long want = size > align ? size : align;
+	uintptr_t p;
+	int k = 4;
+	void *ptr;
+
+	while ((1UL << k) < want)
+		k++;
+	if (freelist[k]) {
+		ptr = freelist[k];
+		freelist[k] = *(void **)ptr;
+		return ptr;
+	}
+	p = ((uintptr_t)arena_top + (1UL << k) - 1) & ~((1UL << k) - 1);
+	if (p + (1UL << k) > (uintptr_t)arena + ARENA_SIZE)
+		return NULL;
+	arena_top = (uint8_t *)p + (1UL << k);
+	cls[(p - (uintptr_t)arena) >> 4] = k;
+	return (void *)p;
+}
+
+void sim_free(void *ptr)
+{
+	int k;
+
+	if (!ptr)
+		return;
+	k = cls[((uint8_t *)ptr - arena) >> 4];
+	*(void **)ptr = freelist[k];
+	freelist[k] = ptr;
+}
+
+/* -------- console -------- */
+
+void sim_vprintf(const char *fmt, va_list args)
+{
+	if (verbose)
+		vprintf(fmt, args);
+}
+
+void sim_log(const char *fmt, ...)
+{
+	va_list args;
+
+	fprintf(stderr, "usbsim: %.3f ms: ", sim_now / 1e6);
+	va_start(args, fmt);
+	vfprintf(stderr, fmt, args);
+	va_end(args);
+}
+
+void sim_die(const char *msg)
+{
+	fprintf(stderr, "usbsim: %.3f ms: fatal: %s", sim_now / 1e6, msg);
+	exit(1);
+}
+
+/* -------- MMIO and the clock -------- */
+
+struct region {
+	uint8_t *drv, *regs;
+	uint32_t size;
+	const struct mmio_ops *ops;
+	void *ctx;
+};
+
+static struct region regions[MAX_REGIONS];
+static int nregions;
+
+/* The access being single-stepped. */
+static struct {
+	struct region *r;
+	uint32_t off, old;
+	int write;
+} trap;
+
+void sim_advance(uint64_t ns)
+{
+	const uint64_t until = sim_now + ns;
+	int i;
+
+	for (i = 0; i < nregions; i++)
+		regions[i].ops->run(regions[i].ctx, until);
+	sim_now = until;
+}
+
+void sim_udelay(unsigned int usecs)
+{
+	sim_advance(usecs * NS_PER_US);
+}
+
+static void mmio_fault(int sig, siginfo_t *si, void *uc_)
+{
+	ucontext_t *uc = uc_;
+	uint8_t *addr = si->si_addr;
+	struct region *r = NULL;
+	int i;
+
+	for (i = 0; i < nregions; i++) {
+		if (addr >= regions[i].drv &&
+		    addr < regions[i].drv + regions[i].size)
+			r = &regions[i];
+	}
+	if (!r || trap.r) {
+		/* a real crash */
+		signal(SIGSEGV, SIG_DFL);
+		return;
+	}
+
+	trap.r = r;
+	trap.off = (addr - r->drv) & ~3;
+	trap.old = *(uint32_t *)(r->regs + trap.off);
+	trap.write = !!(uc->uc_mcontext.gregs[REG_ERR] & 2);
+	if (!trap.write) {
+		stats.mmio_reads++;
+		sim_advance(MMIO_READ_NS);
+		if (r->ops->read)
+			r->ops->read(r->ctx, trap.off);
+	}
+
+	mprotect(r->drv, r->size, PROT_READ | PROT_WRITE);
+	uc->uc_mcontext.gregs[REG_EFL] |= 0x100;
+}
+
+static void mmio_step(int sig, siginfo_t *si, void *uc_)
+{
+	ucontext_t *uc = uc_;
+	struct region *r = trap.r;
+
+	if (!r) {
+		signal(SIGTRAP, SIG_DFL);
+		return;
+	}
+	uc->uc_mcontext.gregs[REG_EFL] &= ~0x100;
+	mprotect(r->drv, r->size, PROT_NONE);
+	trap.r = NULL;
+
+	if (trap.write) {
+		stats.mmio_writes++;
+		if (r->ops->write)
+			r->ops->write(r->ctx, trap.off, trap.old);
+		sim_advance(MMIO_WRITE_NS);
+	}
+}
+
+uint32_t mmio_map(uint32_t size, const struct mmio_ops *ops, void *ctx,
+		  uint8_t **regs)
+{
+	struct region *r = &regions[nregions++];
+	int fd = memfd_create("usbsim-mmio", 0);
+
+	if (fd < 0 || ftruncate(fd, size) < 0)
+		sim_die("memfd_create failed\n");
+	r->drv = mmap(NULL, size, PROT_NONE, MAP_SHARED | MAP_32BIT, fd, 0);
+	r->regs = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (r->drv == MAP_FAILED || r->regs == MAP_FAILED)
+		sim_die("mapping registers failed\n");
+	close(fd);
+	r->size = size;
+	r->ops = ops;
+	r->ctx = ctx;
+	*regs = r->regs;
+	return (uint32_t)(uintptr_t)r->drv;
+}
+
+/* -------- PCI -------- */
+
+static struct {
+	unsigned int dev;
+	uint32_t bar;
+	uint16_t command;
+	uint8_t fladj;
+} hc_pci;
+
+unsigned int sim_pci_read(unsigned int dev, int where, int width)
+{
+	if (dev != hc_pci.dev)
+		return width == 4 ? 0xffffffff : (1U << width * 8) - 1;
+
+	switch (where) {
+	case 0x04:
+		return hc_pci.command;
+	case 0x10:
+		return hc_pci.bar;
+	case 0x61:
+		return hc_pci.fladj;
+	default:
+		return 0;
+	}
+}
+
+void sim_pci_write(unsigned int dev, int where, int width, unsigned int val)
+{
+	if (dev != hc_pci.dev)
+		return;
+	if (where == 0x04)
+		hc_pci.command = val;
+	else if (where == 0x61)
+		hc_pci.fladj = val;
+}
+
+/* -------- topology -------- */
+
+static struct node {
+	char path[16];
+	struct vdev *dev;
+} nodes[MAX_NODES];
+static int nnodes;
+
+static struct vdev *root[MAX_ROOT_PORTS];
+static int nroot = 4;
+
+static const char *path_of(struct vdev *dev)
+{
+	int i;
+
+	for (i = 0; i < nnodes; i++) {
+		if (nodes[i].dev == dev)
+			return nodes[i].path;
+	}
+	return "?";
+}
+
+/* "1:msc,2:hub,2.1:kbd": devices by port path, root port first. */
+static int parse_topology(const char *spec)
+{
+	char *copy = strdup(spec), *tok, *save, *type, *dot;
+	struct node *n, *parent;
+	int i, port;
+
+	for (tok = strtok_r(copy, ",", &save); tok;
+	     tok = strtok_r(NULL, ",", &save)) {
+		type = strchr(tok, ':');
+		if (!type || nnodes == MAX_NODES || type - tok >= 16)
+			goto bad;
+		*type++ = '\0';
+		n = &nodes[nnodes];
+		strcpy(n->path, tok);
+		n->dev = vdev_create(type);
+		if (!n->dev)
+			goto bad;
+
+		dot = strrchr(tok, '.');
+		port = atoi(dot ? dot + 1 : tok);
+		if (!dot) {
+			if (port < 1 || port > MAX_ROOT_PORTS || root[port - 1])
+				goto bad;
+			root[port - 1] = n->dev;
+			if (port > nroot)
+				nroot = port;
+		} else {
+			*dot = '\0';
+			for (parent = NULL, i = 0; i < nnodes; i++) {
+				if (!strcmp(nodes[i].path, tok))
+					parent = &nodes[i];
+			}
+			if (!parent || !vdev_is_hub(parent->dev) ||
+			    vdev_plug(parent->dev, port, n->dev))
+				goto bad;
+			*dot = '.';
+		}
+		nnodes++;
+	}
+	free(copy);
+	return 0;
+bad:
+	fprintf(stderr, "usbsim: bad topology entry '%s'\n", tok);
+	free(copy);
+	return -1;
+}
+
+/* What the EHCI driver should get to: everything behind a high-speed
+ * root port. Slower devices on root ports belong to a companion. */
+static int reachable(struct vdev *dev)
+{
+	int n = 1, i;
+
+	if (vdev_is_hub(dev)) {
+		for (i = 1; i <= 7; i++) {
+			if (vdev_child(dev, i))
+				n += reachable(vdev_child(dev, i));
+		}
+	}
+	return n;
+}
+
+/* -------- scenarios -------- */
+
+static const char *speed_name[] = { "full", "low", "high" };
+
+static struct {
+	int xhci, batching, polls, keys;
+	int mib, kib;
+	long long fail_lba;
+	int fail_stall;
+} opt = {
+	.batching = 1, .polls = 1000, .keys = 20, .mib = 32, .kib = 1024,
+	.fail_lba = -1,
+};
+
+static int failures;
+
+static double host_ms(const struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (now.tv_sec - start->tv_sec) * 1e3 +
+	       (now.tv_nsec - start->tv_nsec) / 1e6;
+}
+
+static void enumerate(void)
+{
+	struct sim_stats s = stats;
+	const uint64_t t0 = sim_now;
+	struct vdev *dev;
+	int expect = 0, i;
+
+	for (i = 0; i < nroot && !opt.xhci; i++) {
+		if (root[i] && vdev_speed(root[i]) == SPEED_HIGH)
+			expect += reachable(root[i]);
+	}
+
+	if (opt.xhci)
+		lp_init_xhci(XHCI_PCI);
+	else
+		lp_init_ehci(EHCI_PCI);
+	if (!opt.batching)
+		lp_set_batching(0);
+	while (lp_attached() < expect && sim_now - t0 < 30000 * NS_PER_MS) {
+		lp_poll();
+		sim_udelay(POLL_GAP_US);
+	}
+
+	printf("enumeration            addressed  configured\n");
+	for (dev = vdev_next(NULL); dev; dev = vdev_next(dev)) {
+		printf("  %-6s %-4s %-5s", path_of(dev), vdev_name(dev),
+		       speed_name[vdev_speed(dev)]);
+		if (vdev_addressed_at(dev))
+			printf(" %8.1f ms", (vdev_addressed_at(dev) - t0) / 1e6);
+		else
+			printf("          -");
+		if (vdev_configured_at(dev))
+			printf(" %8.1f ms\n",
+			       (vdev_configured_at(dev) - t0) / 1e6);
+		else
+			printf("          -\n");
+	}
+	printf("  %d of %d devices in %.1f ms, %lu control transfers, "
+	       "%lu MMIO reads, %lu writes\n\n", lp_attached(), expect,
+	       (sim_now - t0) / 1e6, stats.setups - s.setups,
+	       stats.mmio_reads - s.mmio_reads,
+	       stats.mmio_writes - s.mmio_writes);
+	if (lp_attached() < expect)
+		failures++;
+}
+
+static void idle_polls(void)
+{
+	struct sim_stats s = stats;
+	const uint64_t t0 = sim_now;
+	int i;
+
+	if (!opt.polls)
+		return;
+	for (i = 0; i < opt.polls; i++)
+		lp_poll();
+
+	printf("usb_poll, idle, %d calls\n", opt.polls);
+	printf("  each %.1f us, %.1f MMIO reads, %.1f writes, "
+	       "%.2f control transfers\n\n",
+	       (sim_now - t0) / 1e3 / opt.polls,
+	       (double)(stats.mmio_reads - s.mmio_reads) / opt.polls,
+	       (double)(stats.mmio_writes - s.mmio_writes) / opt.polls,
+	       (double)(stats.setups - s.setups) / opt.polls);
+}
+
+static void keyboard(void)
+{
+	struct vdev *kbd;
+	uint64_t at, lat, min = ~0ULL, max = 0, sum = 0;
+	int k, c, got = 0;
+
+	for (kbd = vdev_next(NULL); kbd; kbd = vdev_next(kbd)) {
+		if (!strcmp(vdev_name(kbd), "kbd") && vdev_configured_at(kbd))
+			break;
+	}
+	if (!kbd || !opt.keys)
+		return;
+
+	while (lp_getchar() >= 0)
+		;
+	for (k = 0; k < opt.keys; k++) {
+		/* Spread the presses over the polling interval. */
+		at = sim_now + (5 + k * 7919 % 23) * NS_PER_MS +
+		     k * 3 * NS_PER_US;
+		vdev_kbd_press(kbd, 4 + k % 26, at, 50 * NS_PER_MS);
+		while ((c = lp_getchar()) < 0 &&
+		       sim_now < at + 1000 * NS_PER_MS) {
+			lp_poll();
+			sim_udelay(POLL_GAP_US);
+		}
+		if (c != 'a' + k % 26) {
+			sim_log("key %d: got %d, expected '%c'\n", k, c,
+				'a' + k % 26);
+			failures++;
+			continue;
+		}
+		lat = sim_now - at;
+		min = lat < min ? lat : min;
+		max = lat > max ? lat : max;
+		sum += lat;
+		got++;
+		/* let the release through before the next press */
+		while (sim_now < at + 60 * NS_PER_MS) {
+			lp_poll();
+			sim_udelay(POLL_GAP_US);
+		}
+	}
+
+	printf("keyboard at %s, %d presses\n", path_of(kbd), opt.keys);
+	if (got)
+		printf("  latency min %.2f ms, avg %.2f ms, max %.2f ms\n\n",
+		       min / 1e6, sum / 1e6 / got, max / 1e6);
+	else
+		printf("  no key arrived\n\n");
+}
+
+static int verify(const uint8_t *buf, uint64_t offset, unsigned long len)
+{
+	unsigned long i;
+
+	for (i = 0; i < len; i++) {
+		if (buf[i] != vdev_msc_pattern(offset + i)) {
+			sim_log("mismatch at byte %llu\n",
+				(unsigned long long)(offset + i));
+			return -1;
+		}
+	}
+	return 0;
+}
+
+static void disks(void)
+{
+	const int count = opt.kib * 2;
+	unsigned long long commands = 0, lba, total;
+	struct vdev *dev;
+	uint64_t t0;
+	uint8_t *buf;
+	int d, errors, bad;
+
+	if (!lp_disks())
+		return;
+	buf = sim_memalign(4096, count * 512);
+	if (!buf)
+		sim_die("no memory for the read buffer\n");
+
+	for (dev = vdev_next(NULL); dev; dev = vdev_next(dev)) {
+		if (!strcmp(vdev_name(dev), "msc")) {
+			if (opt.fail_lba >= 0)
+				vdev_msc_fail(dev, opt.fail_lba, opt.fail_stall);
+			commands -= vdev_msc_commands(dev);
+		}
+	}
+
+	for (d = 0; d < lp_disks(); d++) {
+		total = (unsigned long long)opt.mib * 2048;
+		if (total > lp_disk_blocks(d))
+			total = lp_disk_blocks(d);
+		errors = bad = 0;
+		t0 = sim_now;
+		for (lba = 0; lba < total; lba += count) {
+			const int n = total - lba < count ? total - lba : count;
+			/* a failed read is retried once, like a payload would */
+			if (lp_disk_read(d, lba, n, buf) &&
+			    (errors++, lp_disk_read(d, lba, n, buf))) {
+				sim_log("disk %d: read at %llu failed\n", d, lba);
+				bad++;
+				continue;
+			}
+			if (verify(buf, lba * 512, n * 512ULL))
+				bad++;
+		}
+
+		printf("disk %d: %llu blocks, read %llu MiB in %d KiB requests%s\n",
+		       d, lp_disk_blocks(d), total / 2048, opt.kib,
+		       opt.batching ? "" : ", unbatched");
+		printf("  %.1f MB/s, %llu errors retried, %s\n\n",
+		       total * 512.0 / ((sim_now - t0) / 1e9) / 1e6,
+		       (unsigned long long)errors,
+		       bad ? "DATA BAD" : "data verified");
+		failures += bad;
+	}
+
+	for (dev = vdev_next(NULL); dev; dev = vdev_next(dev)) {
+		if (!strcmp(vdev_name(dev), "msc"))
+			commands += vdev_msc_commands(dev);
+	}
+	printf("  %llu SCSI commands\n\n", commands);
+	sim_free(buf);
+}
+
+static void *scenario(void *arg)
+{
+	enumerate();
+	idle_polls();
+	keyboard();
+	disks();
+	lp_exit();
+
+	printf("%lu packets, %lu NAKs, %lu stalls, %lu toggle errors\n",
+	       stats.packets, stats.naks, stats.stalls, stats.toggle_errors);
+	failures += stats.toggle_errors;
+	return NULL;
+}
+
+static void usage(void)
+{
+	printf("usage: usbsim [options]\n"
+	       "  -t topology  devices by port path, default "
+	       "1:msc,2:hub,2.1:kbd\n"
+	       "  -x           xHCI instead of EHCI\n"
+	       "  -p polls     idle usb_poll() calls to time (1000)\n"
+	       "  -k keys      key presses to time (20)\n"
+	       "  -m MiB       how much to read from each disk (32)\n"
+	       "  -s KiB       size of each read (1024)\n"
+	       "  -b           don't batch bulk transfers in usbmsc\n"
+	       "  -f lba       fail the command reading lba, once\n"
+	       "  -F lba       the same, with the data stage stalled\n"
+	       "  -v           show the USB stack's debug output\n");
+}
+
+int main(int argc, char *argv[])
+{
+	const char *topology = "1:msc,2:hub,2.1:kbd";
+	struct sigaction sa;
+	struct timespec start;
+	pthread_attr_t attr;
+	pthread_t thread;
+	uint32_t bar;
+	int c, i;
+
+	while ((c = getopt(argc, argv, "t:xp:k:m:s:bf:F:vh")) != -1) {
+		switch (c) {
+		case 't': topology = optarg; break;
+		case 'x': opt.xhci = 1; break;
+		case 'p': opt.polls = atoi(optarg); break;
+		case 'k': opt.keys = atoi(optarg); break;
+		case 'm': opt.mib = atoi(optarg); break;
+		case 's': opt.kib = atoi(optarg); break;
+		case 'b': opt.batching = 0; break;
+		case 'F': opt.fail_stall = 1; /* fall through */
+		case 'f': opt.fail_lba = atoll(optarg); break;
+		case 'v': verbose = 1; break;
+		default: usage(); return c != 'h';
+		}
+	}
+	if (opt.kib < 1 || opt.kib > 32768 || opt.mib < 0 ||
+	    parse_topology(topology))
+		return 1;
+
+	arena = mmap(NULL, ARENA_SIZE, PROT_READ | PROT_WRITE,
+		     MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT | MAP_NORESERVE,
+		     -1, 0);
+	if (arena == MAP_FAILED) {
+		perror("usbsim: arena");
+		return 1;
+	}
+	arena_top = arena;
+	cls = calloc(ARENA_SIZE >> 4, 1);
+
+	memset(&sa, 0, sizeof(sa));
+	sa.sa_flags = SA_SIGINFO;
+	sa.sa_sigaction = mmio_fault;
+	sigaction(SIGSEGV, &sa, NULL);
+	sa.sa_sigaction = mmio_step;
+	sigaction(SIGTRAP, &sa, NULL);
+
+	if (opt.xhci)
+		bar = xhci_create(root, nroot);
+	else
+		bar = ehci_create(root, nroot);
+	hc_pci.dev = opt.xhci ? XHCI_PCI : EHCI_PCI;
+	hc_pci.bar = bar;
+
+	printf("usbsim: %s, %d root ports:", opt.xhci ? "xHCI" : "EHCI", nroot);
+	for (i = 0; i < nnodes; i++)
+		printf(" %s:%s", nodes[i].path, vdev_name(nodes[i].dev));
+	printf("\n\n");
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	pthread_attr_init(&attr);
+	pthread_attr_setstack(&attr, sim_memalign(4096, STACK_SIZE),
+			      STACK_SIZE);
+	errno = pthread_create(&thread, &attr, scenario, NULL);
+	if (errno) {
+		perror("usbsim: pthread_create");
+		return 1;
+	}
+	pthread_join(thread, NULL);
+
+	printf("%.3f s simulated in %.0f ms\n", sim_now / 1e9,
+	       host_ms(&start));
+	return failures != 0;
+}
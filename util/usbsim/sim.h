@@ -0,0 +1,110 @@
+/*
+ * usbsim - run the libpayload USB stack against simulated controllers
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/* Host half of usbsim: the clock, the controllers and the devices. */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include <stdint.h>
+
+#define NS_PER_US	1000ULL
+#define NS_PER_MS	1000000ULL
+
+/* Simulated time in nanoseconds. Everything the driver does is charged to
+ * it: udelay() directly, register accesses by their modelled cost. The
+ * controller models catch up with it in sim_advance(). */
+extern uint64_t sim_now;
+
+struct sim_stats {
+	unsigned long mmio_reads, mmio_writes;
+	unsigned long setups;		/* control transfers */
+	unsigned long packets;		/* data packets ACKed */
+	unsigned long naks;
+	unsigned long stalls;
+	unsigned long toggle_errors;
+};
+extern struct sim_stats stats;
+
+void sim_advance(uint64_t ns);
+void sim_log(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+/*
+ * A register block. The driver sees it at a 32-bit address without access
+ * rights; every access faults, and sim.c runs it against regs with the
+ * hooks around it. read() is called before a 32-bit read at off, write()
+ * after a write, with the value the register had before.
+ */
+struct mmio_ops {
+	void (*read)(void *ctx, uint32_t off);
+	void (*write)(void *ctx, uint32_t off, uint32_t old);
+	void (*run)(void *ctx, uint64_t until);
+};
+
+uint32_t mmio_map(uint32_t size, const struct mmio_ops *ops, void *ctx,
+		  uint8_t **regs);
+
+/* Addresses the driver hands to the controller are host pointers. */
+static inline void *phys(uint32_t addr)
+{
+	return (void *)(uintptr_t)addr;
+}
+
+/*
+ * usbdev.c: the devices behind the root ports. vdev_in() and vdev_out()
+ * return the bytes moved, USB_NAK or USB_STALL. On a NAK, the device
+ * lowers *retry to when it will have something; the caller starts it
+ * at ~0ULL.
+ */
+enum { SPEED_FULL = 0, SPEED_LOW = 1, SPEED_HIGH = 2 };
+
+/* What a device answers besides data. */
+#define USB_NAK		-1
+#define USB_STALL	-2
+
+struct vdev;
+
+struct vdev *vdev_create(const char *type);
+int vdev_plug(struct vdev *hub, int port, struct vdev *dev);
+const char *vdev_name(struct vdev *dev);
+int vdev_speed(struct vdev *dev);
+int vdev_is_hub(struct vdev *dev);
+struct vdev *vdev_next(struct vdev *dev);
+struct vdev *vdev_child(struct vdev *hub, int port);
+void vdev_bus_reset(struct vdev *dev);
+struct vdev *vdev_route(struct vdev *dev, int address, uint64_t now);
+int vdev_setup(struct vdev *dev, const uint8_t *req, uint64_t now);
+int vdev_in(struct vdev *dev, int ep, int toggle, uint8_t *buf, int len,
+	    uint64_t now, uint64_t *retry);
+int vdev_out(struct vdev *dev, int ep, int toggle, const uint8_t *buf,
+	     int len, uint64_t now, uint64_t *retry);
+uint64_t vdev_addressed_at(struct vdev *dev);
+uint64_t vdev_configured_at(struct vdev *dev);
+
+void vdev_kbd_press(struct vdev *kbd, uint8_t usage, uint64_t at,
+		    uint64_t hold);
+void vdev_msc_fail(struct vdev *msc, uint64_t lba, int stall);
+uint8_t vdev_msc_pattern(uint64_t offset);
+unsigned long long vdev_msc_commands(struct vdev *msc);
+
+/* hc_ehci.c, hc_xhci.c: the controllers, given their root ports. */
+uint32_t ehci_create(struct vdev **ports, int nports);
+uint32_t xhci_create(struct vdev **ports, int nports);
+
+#endif
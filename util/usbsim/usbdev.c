@@ -0,0 +1,907 @@
+/*
+ * usbsim - run the libpayload USB stack against simulated controllers
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * The simulated devices, seen from the wire: the controllers hand them
+ * SETUP, IN and OUT packets, and they answer with data, NAK or STALL.
+ * Control transfers, addressing, configuration and data toggles are
+ * common to all of them; the hub, the boot keyboard and the bulk-only
+ * mass storage device add their class requests and endpoints.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "sim.h"
+
+#define MAX_PORTS	7
+
+/* Standard requests. */
+#define GET_STATUS		0
+#define CLEAR_FEATURE		1
+#define SET_FEATURE		3
+#define SET_ADDRESS		5
+#define GET_DESCRIPTOR		6
+#define GET_CONFIGURATION	8
+#define SET_CONFIGURATION	9
+
+/* Hub port status and feature selectors, usb20 spec 11.24.2.7. */
+#define PORT_CONNECTION		0x0001
+#define PORT_ENABLE		0x0002
+#define PORT_RESET		0x0010
+#define PORT_POWER		0x0100
+#define PORT_LOW_SPEED		0x0200
+#define PORT_HIGH_SPEED		0x0400
+#define C_PORT_CONNECTION	0x0001
+#define C_PORT_RESET		0x0010
+#define SEL_PORT_ENABLE		1
+#define SEL_PORT_RESET		4
+#define SEL_PORT_POWER		8
+#define SEL_C_PORT_CONNECTION	16
+
+/* The hub drives reset for 10ms, usb20 spec 7.1.7.5. */
+#define HUB_RESET_NS		(10 * NS_PER_MS)
+
+/* Mass storage: command turnaround, and how fast the media delivers. */
+#define MSC_COMMAND_NS		(250 * NS_PER_US)
+#define MSC_NS_PER_512		14600
+#define MSC_BLOCKS		(1ULL << 24)	/* 8GB */
+
+struct port {
+	struct vdev *dev;
+	uint16_t status, change;
+	uint64_t reset_done;
+};
+
+struct report {
+	uint8_t data[8];
+	uint64_t at;
+};
+
+enum { CBW, DATA_IN, DATA_OUT, CSW };
+
+struct vdev {
+	const char *name;
+	int speed;
+	const uint8_t *dev_desc, *conf_desc;
+	int conf_len;
+	int (*request)(struct vdev *dev, const uint8_t *req, uint8_t *data,
+		       int len, uint64_t now);
+	int (*in)(struct vdev *dev, int ep, uint8_t *buf, int len,
+		  uint64_t now, uint64_t *retry);
+	int (*out)(struct vdev *dev, int ep, const uint8_t *buf, int len,
+		   uint64_t now, uint64_t *retry);
+
+	int address, pending_address, configured;
+	uint64_t addressed_at, configured_at;
+	uint8_t toggle[16][2];		/* next DATAx, by endpoint and IN */
+	uint8_t halted[16][2];
+
+	/* the control transfer in progress */
+	uint8_t req[8];
+	uint8_t ctl[1024];
+	int ctl_len, ctl_pos, ctl_stall;
+
+	/* hub */
+	int nports;
+	struct port port[MAX_PORTS + 1];
+
+	/* keyboard */
+	struct report *reports;
+	int nreports, next_report, report_pending;
+	uint8_t report[8];
+	uint64_t idle, last_report;
+
+	/* mass storage */
+	struct {
+		int state;
+		uint32_t tag, residue;
+		uint8_t status, sense, asc;
+		uint8_t resp[36];
+		int resp_len, resp_pos, media;
+		uint64_t offset, left, ready, data_at;
+		uint64_t fail_lba;
+		int fail, fail_stall;
+		unsigned long long commands;
+	} msc;
+
+	struct vdev *next;
+};
+
+static struct vdev *devices, **last = &devices;
+
+static uint16_t le16(const uint8_t *p)
+{
+	return p[0] | p[1] << 8;
+}
+
+static uint32_t be32(const uint8_t *p)
+{
+	return (uint32_t)p[0] << 24 | p[1] << 16 | p[2] << 8 | p[3];
+}
+
+/* Lowers *retry to when an endpoint that NAKed has something to say. */
+static void retry_at(uint64_t *retry, uint64_t at)
+{
+	if (at < *retry)
+		*retry = at;
+}
+
+static void put_be32(uint8_t *p, uint32_t v)
+{
+	p[0] = v >> 24;
+	p[1] = v >> 16;
+	p[2] = v >> 8;
+	p[3] = v;
+}
+
+static void put_le32(uint8_t *p, uint32_t v)
+{
+	p[0] = v;
+	p[1] = v >> 8;
+	p[2] = v >> 16;
+	p[3] = v >> 24;
+}
+
+/* Requests every device answers the same way. Returns NOT_STANDARD for
+ * the rest. */
+#define NOT_STANDARD	-3
+
+static int standard_request(struct vdev *dev, const uint8_t *req,
+			    uint8_t *data, int len, uint64_t now)
+{
+	const uint16_t value = le16(req + 2), index = le16(req + 4);
+	int i;
+
+	if (req[0] & 0x60)
+		return NOT_STANDARD;
+
+	switch (req[1]) {
+	case GET_STATUS:
+		memset(data, 0, 2);
+		return 2;
+	case CLEAR_FEATURE:
+		/* ENDPOINT_HALT, which also resets the toggle */
+		if ((req[0] & 0x1f) != 2 || value != 0)
+			return USB_STALL;
+		dev->halted[index & 0xf][index >> 7 & 1] = 0;
+		dev->toggle[index & 0xf][index >> 7 & 1] = 0;
+		return 0;
+	case SET_ADDRESS:
+		dev->pending_address = value & 0x7f;
+		return 0;
+	case GET_DESCRIPTOR:
+		if (value >> 8 == 1) {
+			memcpy(data, dev->dev_desc, 18);
+			return 18;
+		}
+		if (value >> 8 == 2) {
+			memcpy(data, dev->conf_desc, dev->conf_len);
+			return dev->conf_len;
+		}
+		return NOT_STANDARD;
+	case GET_CONFIGURATION:
+		data[0] = dev->configured;
+		return 1;
+	case SET_CONFIGURATION:
+		dev->configured = value;
+		dev->configured_at = now;
+		for (i = 1; i < 16; i++) {
+			memset(dev->toggle[i], 0, 2);
+			memset(dev->halted[i], 0, 2);
+		}
+		return 0;
+	}
+	return NOT_STANDARD;
+}
+
+/* Returns the length of the answer, 0 for requests without data, or
+ * USB_STALL. Class requests go to the device type's handler. */
+static int control(struct vdev *dev, const uint8_t *req, uint8_t *data,
+		   int len, uint64_t now)
+{
+	int ret = standard_request(dev, req, data, len, now);
+
+	if (ret != NOT_STANDARD)
+		return ret;
+	if (dev->request)
+		return dev->request(dev, req, data, len, now);
+	return USB_STALL;
+}
+
+static void check_toggle(struct vdev *dev, int ep, int in, int toggle)
+{
+	if (toggle != dev->toggle[ep][in]) {
+		stats.toggle_errors++;
+		sim_log("%s: ep %d %s: DATA%d, expected DATA%d\n", dev->name,
+			ep, in ? "in" : "out", toggle, dev->toggle[ep][in]);
+	}
+	dev->toggle[ep][in] = !toggle;
+}
+
+int vdev_setup(struct vdev *dev, const uint8_t *req, uint64_t now)
+{
+	int ret;
+
+	stats.setups++;
+	memcpy(dev->req, req, 8);
+	dev->toggle[0][0] = dev->toggle[0][1] = 1;
+	dev->halted[0][0] = dev->halted[0][1] = 0;
+	dev->ctl_len = dev->ctl_pos = dev->ctl_stall = 0;
+
+	/* Answers are ready right away; OUT requests run at their status
+	 * stage, once the data is in. */
+	if (req[0] & 0x80) {
+		ret = control(dev, req, dev->ctl, le16(req + 6), now);
+		if (ret < 0)
+			dev->ctl_stall = 1;
+		else
+			dev->ctl_len = ret < le16(req + 6) ? ret : le16(req + 6);
+	}
+	return 0;
+}
+
+int vdev_in(struct vdev *dev, int ep, int toggle, uint8_t *buf, int len,
+	    uint64_t now, uint64_t *retry)
+{
+	int ret;
+
+	if (ep == 0) {
+		if (dev->ctl_stall) {
+			stats.stalls++;
+			return USB_STALL;
+		}
+		if (dev->req[0] & 0x80) {
+			ret = dev->ctl_len - dev->ctl_pos;
+			if (ret > len)
+				ret = len;
+			memcpy(buf, dev->ctl + dev->ctl_pos, ret);
+			dev->ctl_pos += ret;
+		} else {
+			/* status stage of an OUT request */
+			ret = control(dev, dev->req, dev->ctl, dev->ctl_len,
+				      now);
+			if (ret < 0) {
+				dev->ctl_stall = 1;
+				stats.stalls++;
+				return USB_STALL;
+			}
+			if (dev->req[1] == SET_ADDRESS && !(dev->req[0] & 0x60)) {
+				dev->address = dev->pending_address;
+				dev->addressed_at = now;
+			}
+			ret = 0;
+		}
+		check_toggle(dev, 0, 1, toggle);
+		stats.packets++;
+		return ret;
+	}
+
+	if (dev->halted[ep][1]) {
+		stats.stalls++;
+		return USB_STALL;
+	}
+	ret = dev->in ? dev->in(dev, ep, buf, len, now, retry) : USB_STALL;
+	if (ret == USB_NAK) {
+		stats.naks++;
+	} else if (ret == USB_STALL) {
+		dev->halted[ep][1] = 1;
+		stats.stalls++;
+	} else {
+		check_toggle(dev, ep, 1, toggle);
+		stats.packets++;
+	}
+	return ret;
+}
+
+int vdev_out(struct vdev *dev, int ep, int toggle, const uint8_t *buf,
+	     int len, uint64_t now, uint64_t *retry)
+{
+	int ret;
+
+	if (ep == 0) {
+		if (dev->ctl_stall) {
+			stats.stalls++;
+			return USB_STALL;
+		}
+		/* data stage of an OUT request, or the status stage of an IN
+		 * request, which needs nothing */
+		if (!(dev->req[0] & 0x80)) {
+			if (dev->ctl_len + len > (int)sizeof(dev->ctl))
+				return USB_STALL;
+			memcpy(dev->ctl + dev->ctl_len, buf, len);
+			dev->ctl_len += len;
+		}
+		check_toggle(dev, 0, 0, toggle);
+		stats.packets++;
+		return len;
+	}
+
+	if (dev->halted[ep][0]) {
+		stats.stalls++;
+		return USB_STALL;
+	}
+	ret = dev->out ? dev->out(dev, ep, buf, len, now, retry) : USB_STALL;
+	if (ret == USB_NAK) {
+		stats.naks++;
+	} else if (ret == USB_STALL) {
+		dev->halted[ep][0] = 1;
+		stats.stalls++;
+	} else {
+		check_toggle(dev, ep, 0, toggle);
+		stats.packets++;
+	}
+	return ret;
+}
+
+static void hub_update(struct vdev *hub, uint64_t now)
+{
+	int i;
+
+	for (i = 1; i <= hub->nports; i++) {
+		struct port *p = &hub->port[i];
+		if (!(p->status & PORT_RESET) || now < p->reset_done)
+			continue;
+		p->status &= ~PORT_RESET;
+		p->status |= PORT_ENABLE;
+		p->change |= C_PORT_RESET;
+		if (p->dev->speed == SPEED_LOW)
+			p->status |= PORT_LOW_SPEED;
+		else if (p->dev->speed == SPEED_HIGH)
+			p->status |= PORT_HIGH_SPEED;
+		vdev_bus_reset(p->dev);
+	}
+}
+
+/* Bus reset: back to address 0, unconfigured. A hub also loses power on
+ * all its ports, so everything behind it goes away, too. */
+void vdev_bus_reset(struct vdev *dev)
+{
+	int i;
+
+	dev->address = 0;
+	dev->configured = 0;
+	dev->ctl_len = dev->ctl_pos = dev->ctl_stall = 0;
+	memset(dev->toggle, 0, sizeof(dev->toggle));
+	memset(dev->halted, 0, sizeof(dev->halted));
+	dev->msc.state = CBW;
+
+	for (i = 1; i <= dev->nports; i++) {
+		dev->port[i].status = 0;
+		dev->port[i].change = 0;
+		if (dev->port[i].dev)
+			vdev_bus_reset(dev->port[i].dev);
+	}
+}
+
+/* The device that answers to address, if the path to it is enabled. */
+struct vdev *vdev_route(struct vdev *dev, int address, uint64_t now)
+{
+	struct vdev *found;
+	int i;
+
+	if (dev->address == address)
+		return dev;
+	if (!dev->nports || !dev->configured)
+		return NULL;
+	hub_update(dev, now);
+	for (i = 1; i <= dev->nports; i++) {
+		if (!(dev->port[i].status & PORT_ENABLE) || !dev->port[i].dev)
+			continue;
+		found = vdev_route(dev->port[i].dev, address, now);
+		if (found)
+			return found;
+	}
+	return NULL;
+}
+
+static const uint8_t hub_dev_desc[18] = {
+	18, 1, 0x00, 0x02, 0x09, 0x00, 0x01, 64,
+	0x09, 0x12, 0x01, 0x00, 0x00, 0x01, 0, 0, 0, 1,
+};
+
+static const uint8_t hub_conf_desc[25] = {
+	9, 2, 25, 0, 1, 1, 0, 0xe0, 0,
+	9, 4, 0, 0, 1, 0x09, 0, 0, 0,
+	7, 5, 0x81, 0x03, 1, 0, 12,
+};
+
+static int hub_request(struct vdev *hub, const uint8_t *req, uint8_t *data,
+		       int len, uint64_t now)
+{
+	const uint16_t value = le16(req + 2), index = le16(req + 4);
+	struct port *p;
+
+	hub_update(hub, now);
+
+	switch (req[0] << 8 | req[1]) {
+	case 0xa000 | GET_DESCRIPTOR:
+		if (value >> 8 != 0x29)
+			return USB_STALL;
+		data[0] = 9;
+		data[1] = 0x29;
+		data[2] = hub->nports;
+		data[3] = 0x09;		/* per-port power and overcurrent */
+		data[4] = 0;
+		data[5] = 50;		/* 100ms until power is good */
+		data[6] = 100;
+		data[7] = 0;
+		data[8] = 0xff;
+		return 9;
+	case 0xa000 | GET_STATUS:
+		memset(data, 0, 4);
+		return 4;
+	case 0x2000 | CLEAR_FEATURE:
+		return 0;
+	}
+
+	if (index < 1 || index > hub->nports)
+		return USB_STALL;
+	p = &hub->port[index];
+
+	switch (req[0] << 8 | req[1]) {
+	case 0xa300 | GET_STATUS:
+		data[0] = p->status;
+		data[1] = p->status >> 8;
+		data[2] = p->change;
+		data[3] = p->change >> 8;
+		return 4;
+	case 0x2300 | SET_FEATURE:
+		if (value == SEL_PORT_POWER && !(p->status & PORT_POWER)) {
+			p->status |= PORT_POWER;
+			if (p->dev) {
+				p->status |= PORT_CONNECTION;
+				p->change |= C_PORT_CONNECTION;
+			}
+		} else if (value == SEL_PORT_RESET &&
+			   (p->status & PORT_CONNECTION)) {
+			p->status &= ~(PORT_ENABLE | PORT_LOW_SPEED |
+				       PORT_HIGH_SPEED);
+			p->status |= PORT_RESET;
+			p->reset_done = now + HUB_RESET_NS;
+		}
+		return 0;
+	case 0x2300 | CLEAR_FEATURE:
+		if (value == SEL_PORT_ENABLE)
+			p->status &= ~PORT_ENABLE;
+		else if (value == SEL_PORT_POWER)
+			p->status = 0;
+		else if (value >= SEL_C_PORT_CONNECTION && value <= 20)
+			p->change &= ~(1 << (value - SEL_C_PORT_CONNECTION));
+		return 0;
+	}
+	return USB_STALL;
+}
+
+/* The status change endpoint: one bit per port with a change pending. */
+static int hub_in(struct vdev *hub, int ep, uint8_t *buf, int len,
+		  uint64_t now, uint64_t *retry)
+{
+	uint8_t map = 0;
+	int i;
+
+	if (ep != 1)
+		return USB_STALL;
+	hub_update(hub, now);
+	for (i = 1; i <= hub->nports; i++) {
+		if (hub->port[i].change)
+			map |= 1 << i;
+		else if (hub->port[i].status & PORT_RESET)
+			retry_at(retry, hub->port[i].reset_done);
+	}
+	if (!map)
+		return USB_NAK;
+	buf[0] = map;
+	return 1;
+}
+
+static const uint8_t kbd_dev_desc[18] = {
+	18, 1, 0x10, 0x01, 0, 0, 0, 8,
+	0x09, 0x12, 0x02, 0x00, 0x00, 0x01, 0, 0, 0, 1,
+};
+
+static const uint8_t kbd_conf_desc[34] = {
+	9, 2, 34, 0, 1, 1, 0, 0xa0, 50,
+	9, 4, 0, 0, 1, 0x03, 1, 1, 0,
+	9, 0x21, 0x11, 0x01, 0, 1, 0x22, 63, 0,
+	7, 5, 0x81, 0x03, 8, 0, 10,
+};
+
+static int kbd_request(struct vdev *kbd, const uint8_t *req, uint8_t *data,
+		       int len, uint64_t now)
+{
+	const uint16_t value = le16(req + 2);
+
+	switch (req[0] << 8 | req[1]) {
+	case 0x8100 | GET_DESCRIPTOR:
+		if (value >> 8 != 0x21)
+			return USB_STALL;
+		memcpy(data, kbd_conf_desc + 18, 9);
+		return 9;
+	case 0x210a:	/* SET_IDLE, in units of 4ms */
+		kbd->idle = (value >> 8) * 4 * NS_PER_MS;
+		kbd->last_report = now;
+		return 0;
+	case 0x210b:	/* SET_PROTOCOL */
+		return 0;
+	}
+	return USB_STALL;
+}
+
+/* Sends a report when the keys change, and again every idle period. */
+static int kbd_in(struct vdev *kbd, int ep, uint8_t *buf, int len,
+		  uint64_t now, uint64_t *retry)
+{
+	while (kbd->next_report < kbd->nreports &&
+	       kbd->reports[kbd->next_report].at <= now) {
+		memcpy(kbd->report, kbd->reports[kbd->next_report].data, 8);
+		kbd->next_report++;
+		kbd->report_pending = 1;
+	}
+
+	if (kbd->report_pending ||
+	    (kbd->idle && now >= kbd->last_report + kbd->idle)) {
+		memcpy(buf, kbd->report, len < 8 ? len : 8);
+		kbd->report_pending = 0;
+		kbd->last_report = now;
+		return len < 8 ? len : 8;
+	}
+
+	if (kbd->next_report < kbd->nreports)
+		retry_at(retry, kbd->reports[kbd->next_report].at);
+	if (kbd->idle)
+		retry_at(retry, kbd->last_report + kbd->idle);
+	return USB_NAK;
+}
+
+void vdev_kbd_press(struct vdev *kbd, uint8_t usage, uint64_t at,
+		    uint64_t hold)
+{
+	struct report *r;
+
+	kbd->reports = realloc(kbd->reports,
+			       (kbd->nreports + 2) * sizeof(*r));
+	r = &kbd->reports[kbd->nreports];
+	memset(r, 0, 2 * sizeof(*r));
+	r[0].data[2] = usage;
+	r[0].at = at;
+	r[1].at = at + hold;
+	kbd->nreports += 2;
+}
+
+static const uint8_t msc_dev_desc[18] = {
+	18, 1, 0x00, 0x02, 0, 0, 0, 64,
+	0x09, 0x12, 0x03, 0x00, 0x00, 0x01, 0, 0, 0, 1,
+};
+
+static const uint8_t msc_conf_desc[32] = {
+	9, 2, 32, 0, 1, 1, 0, 0x80, 50,
+	9, 4, 0, 0, 2, 0x08, 0x06, 0x50, 0,
+	7, 5, 0x81, 0x02, 0x00, 0x02, 0,
+	7, 5, 0x02, 0x02, 0x00, 0x02, 0,
+};
+
+/* What the media holds, so reads can be checked without storing it. */
+uint8_t vdev_msc_pattern(uint64_t offset)
+{
+	return offset * 7 + (offset >> 9) + (offset >> 33);
+}
+
+static int msc_request(struct vdev *msc, const uint8_t *req, uint8_t *data,
+		       int len, uint64_t now)
+{
+	switch (req[0] << 8 | req[1]) {
+	case 0xa1fe:	/* GET_MAX_LUN */
+		data[0] = 0;
+		return 1;
+	case 0x21ff:	/* Bulk-Only Mass Storage Reset */
+		msc->msc.state = CBW;
+		return 0;
+	}
+	return USB_STALL;
+}
+
+static void msc_respond(struct vdev *msc, uint32_t xfer_len, int len)
+{
+	msc->msc.resp_len = len < (int)xfer_len ? len : (int)xfer_len;
+	msc->msc.resp_pos = 0;
+	msc->msc.residue = xfer_len - msc->msc.resp_len;
+	msc->msc.state = xfer_len ? DATA_IN : CSW;
+}
+
+static void msc_check_condition(struct vdev *msc, uint8_t sense,
+				uint8_t asc)
+{
+	msc->msc.status = 1;
+	msc->msc.sense = sense;
+	msc->msc.asc = asc;
+}
+
+/* A CBW came in: decode the command and set up the data phase. */
+static void msc_command(struct vdev *msc, const uint8_t *cbw, uint64_t now)
+{
+	const uint32_t xfer_len = cbw[8] | cbw[9] << 8 | cbw[10] << 16 |
+				  (uint32_t)cbw[11] << 24;
+	const uint8_t *cb = cbw + 15;
+	uint8_t *resp = msc->msc.resp;
+	uint64_t lba = 0, last = MSC_BLOCKS - 1;
+	uint32_t count = 0;
+
+	msc->msc.commands++;
+	msc->msc.tag = cbw[4] | cbw[5] << 8 | cbw[6] << 16 |
+		       (uint32_t)cbw[7] << 24;
+	msc->msc.status = 0;
+	msc->msc.media = 0;
+	msc->msc.ready = now + MSC_COMMAND_NS;
+	memset(resp, 0, sizeof(msc->msc.resp));
+
+	switch (cb[0]) {
+	case 0x00:	/* TEST UNIT READY */
+	case 0x1b:	/* START STOP UNIT */
+		msc_respond(msc, xfer_len, 0);
+		return;
+	case 0x03:	/* REQUEST SENSE */
+		resp[0] = 0x70;
+		resp[2] = msc->msc.sense;
+		resp[7] = 10;
+		resp[12] = msc->msc.asc;
+		msc->msc.sense = msc->msc.asc = 0;
+		msc_respond(msc, xfer_len, 18);
+		return;
+	case 0x12:	/* INQUIRY */
+		resp[2] = 2;
+		resp[4] = 31;
+		memcpy(resp + 8, "usbsim  virtual disk    0001", 28);
+		msc_respond(msc, xfer_len, 36);
+		return;
+	case 0x25:	/* READ CAPACITY (10) */
+		put_be32(resp, last > 0xffffffff ? 0xffffffff : last);
+		put_be32(resp + 4, 512);
+		msc_respond(msc, xfer_len, 8);
+		return;
+	case 0x9e:	/* READ CAPACITY (16) */
+		put_be32(resp, last >> 32);
+		put_be32(resp + 4, last);
+		put_be32(resp + 8, 512);
+		msc_respond(msc, xfer_len, 32);
+		return;
+	case 0x28:	/* READ (10) */
+	case 0x2a:	/* WRITE (10) */
+		lba = be32(cb + 2);
+		count = cb[7] << 8 | cb[8];
+		break;
+	case 0x88:	/* READ (16) */
+	case 0x8a:	/* WRITE (16) */
+		lba = (uint64_t)be32(cb + 2) << 32 | be32(cb + 6);
+		count = be32(cb + 10);
+		break;
+	default:
+		/* not something we know */
+		msc_check_condition(msc, 5, 0x20);
+		msc_respond(msc, xfer_len, 0);
+		if (xfer_len && (cbw[12] & 0x80))
+			msc->halted[1][1] = 1;
+		return;
+	}
+
+	if (lba + count > MSC_BLOCKS || count * 512ULL != xfer_len) {
+		msc_check_condition(msc, 5, 0x21);
+		msc_respond(msc, xfer_len, 0);
+		if (xfer_len && (cbw[12] & 0x80))
+			msc->halted[1][1] = 1;
+		return;
+	}
+
+	/* An injected error fires once, so the retry goes through. */
+	if (msc->msc.fail && msc->msc.fail_lba >= lba &&
+	    msc->msc.fail_lba < lba + count) {
+		msc->msc.fail = 0;
+		msc_check_condition(msc, 3, 0x11);
+		if (msc->msc.fail_stall) {
+			msc_respond(msc, xfer_len, 0);
+			if (cbw[12] & 0x80)
+				msc->halted[1][1] = 1;
+			return;
+		}
+	}
+
+	msc->msc.media = 1;
+	msc->msc.offset = lba * 512;
+	msc->msc.left = xfer_len;
+	msc->msc.residue = 0;
+	msc->msc.data_at = msc->msc.ready;
+	msc->msc.state = (cbw[12] & 0x80) ? DATA_IN : DATA_OUT;
+}
+
+static int msc_in(struct vdev *msc, int ep, uint8_t *buf, int len,
+		  uint64_t now, uint64_t *retry)
+{
+	int i;
+
+	if (ep != 1)
+		return USB_STALL;
+	if (now < msc->msc.ready) {
+		retry_at(retry, msc->msc.ready);
+		return USB_NAK;
+	}
+
+	switch (msc->msc.state) {
+	case DATA_IN:
+		if (!msc->msc.media) {
+			len = msc->msc.resp_len - msc->msc.resp_pos;
+			if (len > 512)
+				len = 512;
+			memcpy(buf, msc->msc.resp + msc->msc.resp_pos, len);
+			msc->msc.resp_pos += len;
+			if (msc->msc.resp_pos == msc->msc.resp_len)
+				msc->msc.state = CSW;
+			return len;
+		}
+		/* The media streams into the device's buffer on its own
+		 * clock, packets go out once they are in. */
+		if (len > (int)msc->msc.left)
+			len = msc->msc.left;
+		if (now < msc->msc.data_at + len * MSC_NS_PER_512 / 512) {
+			retry_at(retry, msc->msc.data_at +
+				 len * MSC_NS_PER_512 / 512);
+			return USB_NAK;
+		}
+		msc->msc.data_at += len * MSC_NS_PER_512 / 512;
+		for (i = 0; i < len; i++)
+			buf[i] = vdev_msc_pattern(msc->msc.offset + i);
+		msc->msc.offset += len;
+		msc->msc.left -= len;
+		if (!msc->msc.left)
+			msc->msc.state = CSW;
+		return len;
+	case CSW:
+		if (len < 13)
+			return USB_STALL;
+		put_le32(buf, 0x53425355);
+		put_le32(buf + 4, msc->msc.tag);
+		put_le32(buf + 8, msc->msc.residue);
+		buf[12] = msc->msc.status;
+		msc->msc.state = CBW;
+		return 13;
+	}
+	return USB_STALL;
+}
+
+static int msc_out(struct vdev *msc, int ep, const uint8_t *buf, int len,
+		   uint64_t now, uint64_t *retry)
+{
+	if (ep != 2)
+		return USB_STALL;
+
+	switch (msc->msc.state) {
+	case CBW:
+		if (len != 31 || buf[0] != 'U' || buf[1] != 'S' ||
+		    buf[2] != 'B' || buf[3] != 'C')
+			return USB_STALL;
+		msc_command(msc, buf, now);
+		return len;
+	case DATA_OUT:
+		if (now < msc->msc.data_at) {
+			retry_at(retry, msc->msc.data_at);
+			return USB_NAK;
+		}
+		if (len > (int)msc->msc.left)
+			len = msc->msc.left;
+		msc->msc.left -= len;
+		msc->msc.data_at = now + len * MSC_NS_PER_512 / 512;
+		if (!msc->msc.left) {
+			msc->msc.ready = msc->msc.data_at;
+			msc->msc.state = CSW;
+		}
+		return len;
+	}
+	return USB_STALL;
+}
+
+void vdev_msc_fail(struct vdev *msc, uint64_t lba, int stall)
+{
+	msc->msc.fail = 1;
+	msc->msc.fail_lba = lba;
+	msc->msc.fail_stall = stall;
+}
+
+unsigned long long vdev_msc_commands(struct vdev *msc)
+{
+	return msc->msc.commands;
+}
+
+struct vdev *vdev_create(const char *type)
+{
+	struct vdev *dev = calloc(1, sizeof(*dev));
+
+	if (!strcmp(type, "hub")) {
+		dev->speed = SPEED_HIGH;
+		dev->dev_desc = hub_dev_desc;
+		dev->conf_desc = hub_conf_desc;
+		dev->conf_len = sizeof(hub_conf_desc);
+		dev->request = hub_request;
+		dev->in = hub_in;
+		dev->nports = 4;
+	} else if (!strcmp(type, "kbd")) {
+		dev->speed = SPEED_LOW;
+		dev->dev_desc = kbd_dev_desc;
+		dev->conf_desc = kbd_conf_desc;
+		dev->conf_len = sizeof(kbd_conf_desc);
+		dev->request = kbd_request;
+		dev->in = kbd_in;
+	} else if (!strcmp(type, "msc")) {
+		dev->speed = SPEED_HIGH;
+		dev->dev_desc = msc_dev_desc;
+		dev->conf_desc = msc_conf_desc;
+		dev->conf_len = sizeof(msc_conf_desc);
+		dev->request = msc_request;
+		dev->in = msc_in;
+		dev->out = msc_out;
+	} else {
+		free(dev);
+		return NULL;
+	}
+	dev->name = strdup(type);
+
+	*last = dev;
+	last = &dev->next;
+	return dev;
+}
+
+int vdev_plug(struct vdev *hub, int port, struct vdev *dev)
+{
+	if (port < 1 || port > hub->nports || hub->port[port].dev)
+		return -1;
+	hub->port[port].dev = dev;
+	return 0;
+}
+
+const char *vdev_name(struct vdev *dev)
+{
+	return dev->name;
+}
+
+int vdev_speed(struct vdev *dev)
+{
+	return dev->speed;
+}
+
+int vdev_is_hub(struct vdev *dev)
+{
+	return dev->nports != 0;
+}
+
+struct vdev *vdev_next(struct vdev *dev)
+{
+	return dev ? dev->next : devices;
+}
+
+struct vdev *vdev_child(struct vdev *hub, int port)
+{
+	return hub->port[port].dev;
+}
+
+uint64_t vdev_addressed_at(struct vdev *dev)
+{
+	return dev->addressed_at;
+}
+
+uint64_t vdev_configured_at(struct vdev *dev)
+{
+	return dev->configured_at;
+}
@@ -0,0 +1,54 @@
+/*
+ * usbsim - run the libpayload USB stack against simulated controllers
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * The simulator is built from two halves that cannot share headers: the
+ * libpayload half (libpayload.c plus the drivers from drivers/usb) is
+ * compiled against the libpayload include tree, the host half (sim.c
+ * and the models) against the host C library. This is everything they
+ * pass between each other, so it only uses plain C types.
+ */
+
+#ifndef USBSIM_H
+#define USBSIM_H
+
+#include <stdarg.h>
+
+/* Provided by the host half. */
+void *sim_memalign(unsigned long align, unsigned long size);
+void sim_free(void *ptr);
+unsigned int sim_pci_read(unsigned int dev, int where, int width);
+void sim_pci_write(unsigned int dev, int where, int width, unsigned int val);
+void sim_udelay(unsigned int usecs);
+void sim_vprintf(const char *fmt, va_list args);
+void sim_die(const char *msg) __attribute__((noreturn));
+
+/* Provided by the libpayload half. */
+void lp_init_ehci(unsigned int pcidev);
+void lp_init_xhci(unsigned int pcidev);
+void lp_set_batching(int enable);
+void lp_poll(void);
+int lp_attached(void);
+int lp_disks(void);
+unsigned long long lp_disk_blocks(int disk);
+int lp_disk_read(int disk, unsigned long long lba, int count, void *buf);
+int lp_getchar(void);
+void lp_exit(void);
+
+#endif
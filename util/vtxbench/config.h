@@ -0,0 +1,13 @@
+/*
+ * Kconfig values for building the coreboot console code into vtxbench.
+ * This stands in for the build/config.h a real coreboot build generates.
+ */
+
+#define CONFIG_ARCH_X86 0
+#define CONFIG_DEFAULT_CONSOLE_LOGLEVEL 8
+#define CONFIG_MAXIMUM_CONSOLE_LOGLEVEL 8
+#define CONFIG_CONSOLE_SERIAL 0
+#define CONFIG_USBDEBUG 0
+#define CONFIG_CONSOLE_NE2K 0
+#define CONFIG_CONSOLE_CBMEM 0
+#define CONFIG_EARLY_CONSOLE 0
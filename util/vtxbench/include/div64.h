@@ -0,0 +1,16 @@
+/*
+ * The x86 do_div() is 32-bit inline assembly. On the host, the compiler
+ * can divide 64-bit numbers by itself.
+ */
+
+#ifndef __I386_DIV64
+#define __I386_DIV64
+
+#define do_div(n, base) ({ \
+	unsigned int __base = (base); \
+	unsigned int __rem = (unsigned long long)(n) % __base; \
+	(n) = (unsigned long long)(n) / __base; \
+	__rem; \
+})
+
+#endif
@@ -0,0 +1,201 @@
+/*
+ * vtxbench - check and time coreboot's vtxprintf() on the host
+ *
+ * Copyright (C) 2013 The ChromiumOS Authors.  All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; version 2 of the License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA, 02110-1301 USA
+ */
+
+/*
+ * src/console/vtxprintf.c is built freestanding next to this file. Its
+ * output through both entry points, vtxprintf() with a byte callback and
+ * vtxprintf_buf() with a chunk callback, is compared against the host's
+ * vsnprintf() for the conversions coreboot uses. %p is left out; it is
+ * zero-padded without 0x on purpose. Then both are timed on a few lines
+ * typical of a ramstage log.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+int vtxprintf(void (*tx_byte)(unsigned char byte), const char *fmt,
+	      va_list args);
+/* Weak, so the harness also builds against trees from before it. */
+int vtxprintf_buf(void (*tx_buf)(const unsigned char *buf, int len),
+		  const char *fmt, va_list args) __attribute__((weak));
+
+static char out[4096];
+static int out_len;
+
+static void tx_byte(unsigned char byte)
+{
+	if (out_len < sizeof(out) - 1)
+		out[out_len++] = byte;
+}
+
+static void tx_buf(const unsigned char *buf, int len)
+{
+	while (len--)
+		tx_byte(*buf++);
+}
+
+static int failures;
+
+static void check(const char *fmt, ...)
+{
+	char ref[sizeof(out)], byte[sizeof(out)];
+	va_list args, copy;
+	int ret, ret_byte, ret_buf;
+
+	va_start(args, fmt);
+	va_copy(copy, args);
+	ret = vsnprintf(ref, sizeof(ref), fmt, copy);
+	va_end(copy);
+
+	va_copy(copy, args);
+	out_len = 0;
+	ret_byte = vtxprintf(tx_byte, fmt, copy);
+	out[out_len] = '\0';
+	strcpy(byte, out);
+	va_end(copy);
+
+	if (vtxprintf_buf) {
+		out_len = 0;
+		ret_buf = vtxprintf_buf(tx_buf, fmt, args);
+		out[out_len] = '\0';
+	} else {
+		strcpy(out, byte);
+		ret_buf = ret_byte;
+	}
+	va_end(args);
+
+	if (strcmp(byte, ref) || strcmp(out, ref) || ret_byte != ret ||
+	    ret_buf != ret) {
+		printf("FAIL \"%s\"\n  libc  %d [%s]\n  byte  %d [%s]\n"
+		       "  buf   %d [%s]\n", fmt, ret, ref, ret_byte, byte,
+		       ret_buf, out);
+		failures++;
+	}
+}
+
+static void check_all(void)
+{
+	unsigned long long v;
+
+	check("hello %d world %u %x %X %o\n", -5, 7u, 0xdeadbeef, 0xabcu,
+	      0777);
+	check("%llu %llx %lld %016llx", 18446744073709551615ULL,
+	      0x123456789abcdefULL, -1234567890123LL, 1ULL << 40);
+	check("%08x|%-8d|%+d|% d|%#x|%#o|%5s|%-5s|%.2s|%c%%", 0x12, -3, 4,
+	      5, 0xff, 8, "ab", "cd", "xyz", 'Q');
+	check("%s", "a string longer than the 64 bytes vtxprintf_buf() "
+	      "stages, so it is passed on directly");
+	check("%lu %ld %zu", 4294967295UL, -2L, (size_t)42);
+	check("%llu %llu %llu", 4294967296ULL, 10000000000ULL,
+	      99999999999999999ULL);
+	for (v = 1; v < ~0ULL / 3; v *= 3)
+		check("%llu %llo %llx %lld", v, v, v, -(long long)v);
+}
+
+static void null_byte(unsigned char byte)
+{
+}
+
+static void null_buf(const unsigned char *buf, int len)
+{
+}
+
+static void print(int buffered, const char *fmt, ...)
+{
+	va_list args;
+
+	va_start(args, fmt);
+	if (buffered)
+		vtxprintf_buf(null_buf, fmt, args);
+	else
+		vtxprintf(null_byte, fmt, args);
+	va_end(args);
+}
+
+static double ns_per_call(int buffered, int line, long iterations)
+{
+	struct timespec start, end;
+	long i;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	for (i = 0; i < iterations; i++) {
+		switch (line) {
+		case 0:
+			print(buffered, "PCI: %02x:%02x.%01x [%04x/%04x] "
+			      "enabled\n", 0, 31, 3, 0x8086, 0x1c22);
+			break;
+		case 1:
+			print(buffered, "PCI: %02x:%02x.%01x 10 * [0x%08llx - "
+			      "0x%08llx] mem\n", 0, 2, 0, 0xe0000000ULL,
+			      0xefffffffULL);
+			break;
+		case 2:
+			print(buffered, "Loading stage from %s at %p, %d "
+			      "bytes\n", "fallback/ramstage", (void *)0x100000,
+			      131072);
+			break;
+		}
+	}
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	return ((end.tv_sec - start.tv_sec) * 1e9 +
+		(end.tv_nsec - start.tv_nsec)) / iterations;
+}
+
+static void usage(void)
+{
+	printf("usage: vtxbench [-n iterations] [-c]\n"
+	       "  -n  calls per timed line (1000000)\n"
+	       "  -c  only check the output, don't time it\n");
+}
+
+int main(int argc, char *argv[])
+{
+	static const char *const lines[] = {
+		"device enabled", "resource", "stage load",
+	};
+	long iterations = 1000000;
+	int c, check_only = 0, i;
+
+	while ((c = getopt(argc, argv, "n:ch")) != -1) {
+		switch (c) {
+		case 'n': iterations = atol(optarg); break;
+		case 'c': check_only = 1; break;
+		default: usage(); return c != 'h';
+		}
+	}
+
+	check_all();
+	printf("output: %s\n", failures ? "MISMATCH" : "matches libc");
+	if (failures || check_only || iterations < 1)
+		return failures != 0;
+
+	printf("%-16s %12s %12s\n", "ns per line", "vtxprintf", "_buf");
+	for (i = 0; i < 3; i++) {
+		printf("%-16s %12.0f", lines[i], ns_per_call(0, i, iterations));
+		if (vtxprintf_buf)
+			printf(" %12.0f\n", ns_per_call(1, i, iterations));
+		else
+			printf(" %12s\n", "-");
+	}
+	return 0;
+}